@@ -79,6 +79,9 @@ void setup() {
   /*
     use the following if you enabled RADIOLIB_LR1110_FIRMWARE_IN_RAM
     state = radio.updateFirmware(lr11xx_firmware_image, RADIOLIB_LR11X0_FIRMWARE_IMAGE_SIZE, false);
+
+    the image can also be read from a file or external memory in chunks
+    by passing a read callback instead of the image, see LR11x0::updateFirmware
   */
   if (state == RADIOLIB_ERR_NONE) {
     Serial.println(F("success!"));
@@ -0,0 +1,129 @@
+/*
+  RadioLib LoRaWAN Non-Blocking Example
+
+  This example joins a LoRaWAN network and sends uplink
+  packets, same as the Starter example. However, instead of
+  waiting in sendReceive for the transmission and both
+  receive windows, the uplink is started by startUplink
+  and the rest of the sequence is done by calling tick
+  from the loop. This leaves the MCU free for other tasks
+  (here just blinking an LED) while the uplink is in progress.
+
+  Before you start, you will have to register your device
+  at https://www.thethingsnetwork.org/ and go through
+  the notes of the Starter example.
+
+  Running this examples REQUIRES you to check "Resets DevNonces"
+  on your LoRaWAN dashboard. Refer to the network's
+  documentation on how to do this.
+
+  For default module settings, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/Default-configuration
+
+  For full API reference, see the GitHub Pages
+  https://jgromes.github.io/RadioLib/
+
+  For LoRaWAN details, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/LoRaWAN
+
+*/
+
+#include "config.h"
+
+// time of the last uplink
+unsigned long lastUplink = 0;
+
+// whether an uplink sequence is in progress
+bool uplinkBusy = false;
+
+// something else to do while the uplink is in progress
+unsigned long lastBlink = 0;
+#if defined(LED_BUILTIN)
+bool ledState = false;
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+  delay(5000);  // Give time to switch to the serial monitor
+  Serial.println(F("\nSetup ... "));
+
+  #if defined(LED_BUILTIN)
+  pinMode(LED_BUILTIN, OUTPUT);
+  #endif
+
+  Serial.println(F("Initialise the radio"));
+  int16_t state = radio.begin();
+  debug(state != RADIOLIB_ERR_NONE, F("Initialise radio failed"), state, true);
+
+  // Setup the OTAA session information
+  node.beginOTAA(joinEUI, devEUI, nwkKey, appKey);
+
+  Serial.println(F("Join ('login') the LoRaWAN Network"));
+  state = node.activateOTAA();
+  debug(state != RADIOLIB_LORAWAN_NEW_SESSION, F("Join failed"), state, true);
+
+  Serial.println(F("Ready!\n"));
+  lastUplink = millis() - uplinkIntervalSeconds * 1000UL;
+}
+
+void loop() {
+  // start a new uplink once the interval has passed
+  if(!uplinkBusy && (millis() - lastUplink >= uplinkIntervalSeconds * 1000UL)) {
+    Serial.println(F("Sending uplink"));
+
+    // This is the place to gather the sensor inputs
+    // Instead of reading any real sensor, we just generate some random numbers as example
+    uint8_t value1 = radio.random(100);
+    uint16_t value2 = radio.random(2000);
+
+    // Build payload byte array
+    uint8_t uplinkPayload[3];
+    uplinkPayload[0] = value1;
+    uplinkPayload[1] = highByte(value2);   // See notes for high/lowByte functions
+    uplinkPayload[2] = lowByte(value2);
+
+    // Start the uplink, this returns as soon as the transmission is started
+    int16_t state = node.startUplink(uplinkPayload, sizeof(uplinkPayload), 1);
+    debug(state != RADIOLIB_ERR_NONE, F("Error in startUplink"), state, false);
+    uplinkBusy = (state == RADIOLIB_ERR_NONE);
+    lastUplink = millis();
+  }
+
+  // advance the uplink sequence, this never blocks
+  // tick must be called often enough to open the receive windows on time,
+  // timeUntilTick says how long the loop can do something else
+  if(uplinkBusy && (node.timeUntilTick() == 0)) {
+    uint8_t downlinkPayload[251];
+    size_t downlinkSize = 0;
+    int16_t state = node.tick(downlinkPayload, &downlinkSize);
+    if(state != RADIOLIB_LORAWAN_BUSY) {
+      uplinkBusy = false;
+      if(state == RADIOLIB_ERR_NONE) {
+        Serial.print(F("Received a downlink, "));
+        Serial.print(downlinkSize);
+        Serial.println(F(" bytes"));
+        if(downlinkSize > 0) {
+          arrayDump(downlinkPayload, downlinkSize);
+        }
+      } else if(state == RADIOLIB_LORAWAN_NO_DOWNLINK) {
+        Serial.println(F("No downlink received"));
+      } else {
+        debug(true, F("Error in tick"), state, false);
+      }
+
+      Serial.print(F("Uplink complete, next in "));
+      Serial.print(uplinkIntervalSeconds);
+      Serial.println(F(" seconds"));
+    }
+  }
+
+  // meanwhile, the MCU is free to do other things
+  if(millis() - lastBlink >= 500) {
+    lastBlink = millis();
+    #if defined(LED_BUILTIN)
+    ledState = !ledState;
+    digitalWrite(LED_BUILTIN, ledState);
+    #endif
+  }
+}
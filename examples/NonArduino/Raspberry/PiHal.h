@@ -7,6 +7,14 @@
 // include the library for Raspberry GPIO pins
 #include "pigpio.h"
 
+// used to sleep in waitForPin until the alert handler reports an edge
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// used to run timer callbacks
+#include <thread>
+
 // these should really be swapped, but for some reason,
 // it seems like the change directions are inverted in gpioSetAlert functions
 #define PI_RISING     (FALLING_EDGE)
@@ -41,6 +49,18 @@ class PiHal : public RadioLibHal {
     }
 
     void term() override {
+      // stop the timer thread
+      if(timerThread.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(timerMutex);
+          timerExit = true;
+          timerCb = nullptr;
+        }
+        timerCond.notify_all();
+        timerThread.join();
+        timerExit = false;
+      }
+
       // stop the SPI
       spiEnd();
 
@@ -102,8 +122,49 @@ class PiHal : public RadioLibHal {
       interruptModes[interruptNum] = 0;
       interruptCallbacks[interruptNum] = NULL;
 
-      // disable pigpio alert callback
-      gpioSetAlertFuncEx(interruptNum, NULL, NULL);
+      // disable pigpio alert callback, unless it is still needed by waitForPin
+      if(!waitEnabled[interruptNum]) {
+        gpioSetAlertFuncEx(interruptNum, NULL, NULL);
+      }
+    }
+
+    // sleep on pigpio level alerts instead of polling the pin in a loop
+    int16_t waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) override {
+      if((pin == RADIOLIB_NC) || (pin > PI_MAX_USER_GPIO)) {
+        return(RADIOLIB_ERR_UNSUPPORTED);
+      }
+
+      std::unique_lock<std::mutex> lock(waitMutex);
+
+      // the alert callback stays registered, so only the first wait on each pin pays for this
+      if(!waitEnabled[pin]) {
+        waitEnabled[pin] = true;
+        gpioSetAlertFuncEx(pin, pigpioAlertHandler, (void*)this);
+      }
+
+      bool reached = waitCond.wait_for(lock, std::chrono::microseconds(timeout), [&]() {
+        return(gpioRead(pin) == (int)level);
+      });
+      return(reached ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_SPI_CMD_TIMEOUT);
+    }
+
+    // one-shot timer running the callback from a separate thread,
+    // used e.g. to send the symbols of RTTY or Pager while the main thread is doing something else
+    int16_t timerStart(RadioLibTime_t us, void (*cb)(void)) override {
+      std::lock_guard<std::mutex> lock(timerMutex);
+      timerDeadline = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+      timerCb = cb;
+      if(!timerThread.joinable()) {
+        timerThread = std::thread(&PiHal::timerLoop, this);
+      }
+      timerCond.notify_all();
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    void timerStop() override {
+      std::lock_guard<std::mutex> lock(timerMutex);
+      timerCb = nullptr;
+      timerCond.notify_all();
     }
 
     void delay(RadioLibTime_t ms) override {
@@ -161,14 +222,65 @@ class PiHal : public RadioLibHal {
       }
     }
 
+    // radios on the same SPI bus can be used from multiple threads,
+    // RadioLib may lock the bus again while already holding it, so the mutex must be recursive
+    void spiLock() override {
+      spiMutex.lock();
+    }
+
+    bool spiTryLock() override {
+      return(spiMutex.try_lock());
+    }
+
+    void spiUnlock() override {
+      spiMutex.unlock();
+    }
+
     // interrupt emulation
     bool interruptEnabled[PI_MAX_USER_GPIO + 1];
     uint32_t interruptModes[PI_MAX_USER_GPIO + 1];
     typedef void (*RadioLibISR)(void);
     RadioLibISR interruptCallbacks[PI_MAX_USER_GPIO + 1];
 
+    // pin waiting
+    bool waitEnabled[PI_MAX_USER_GPIO + 1] = { false };
+    std::mutex waitMutex;
+    std::condition_variable waitCond;
+
+    // SPI bus arbitration
+    std::recursive_mutex spiMutex;
+
+    // timer
+    std::thread timerThread;
+    std::mutex timerMutex;
+    std::condition_variable timerCond;
+    std::chrono::steady_clock::time_point timerDeadline;
+    void (*timerCb)(void) = nullptr;
+    bool timerExit = false;
+
   private:
     // the HAL can contain any additional private members
+    void timerLoop() {
+      std::unique_lock<std::mutex> lock(timerMutex);
+      while(!timerExit) {
+        if(!timerCb) {
+          timerCond.wait(lock);
+          continue;
+        }
+        if(std::chrono::steady_clock::now() < timerDeadline) {
+          timerCond.wait_until(lock, timerDeadline);
+          continue;
+        }
+
+        // the callback may restart the timer, so it must run unlocked
+        void (*cb)(void) = timerCb;
+        timerCb = nullptr;
+        lock.unlock();
+        cb();
+        lock.lock();
+      }
+    }
+
     const unsigned int _spiSpeed;
     const uint8_t _spiChannel;
     int _spiHandle = -1;
@@ -183,6 +295,12 @@ static void pigpioAlertHandler(int event, int level, uint32_t tick, void *userda
   // PiHal isntance is passed via the user data
   PiHal* hal = (PiHal*)userdata;
 
+  // wake up anyone waiting for this pin
+  if(hal->waitEnabled[event]) {
+    std::lock_guard<std::mutex> lock(hal->waitMutex);
+    hal->waitCond.notify_all();
+  }
+
   // check the interrupt is enabled, the level matches and a callback exists
   if((hal->interruptEnabled[event]) &&
      (hal->interruptModes[event] == level) &&
@@ -0,0 +1,117 @@
+/*
+   RadioLib SX126x Spectrum Scan Stream Example
+
+   This example shows how to perform a continuous spectrum power sweep
+   using SX126x. Unlike SX126x_Spectrum_Scan_Frequency, the sweep runs
+   in the background and the scanlines are sent over Serial as binary
+   records, which is much faster than printing them as text.
+   Each record starts with two sync bytes (0xA5 0x5A), followed by
+   the frequency step index, the sweep counter and 33 power bins,
+   all of them 16-bit little-endian numbers.
+
+   To show the results in a plot, run the Python script
+   RadioLib/extras/SX126x_Spectrum_Scan/SpectrumScan.py
+   with the --binary option.
+
+   WARNING: This functionality is experimental and requires a binary patch
+   to be uploaded to the SX126x device. There may be some undocumented
+   side effects!
+
+   For default module settings, see the wiki page
+   https://github.com/jgromes/RadioLib/wiki/Default-configuration#sx126x---lora-modem
+
+   For full API reference, see the GitHub Pages
+   https://jgromes.github.io/RadioLib/
+*/
+
+// include the library
+#include <RadioLib.h>
+
+// this file contains binary patch for the SX1262
+#include <modules/SX126x/patches/SX126x_patch_scan.h>
+
+// SX1262 has the following connections:
+// NSS pin:   10
+// DIO1 pin:  2
+// NRST pin:  3
+// BUSY pin:  9
+SX1262 radio = new Module(10, 2, 3, 9);
+
+// frequency range and step in MHz to scan
+// the frequency step should be slightly smaller
+// or the same as the Rx bandwidth set in setup
+const float freqStart = 431;
+const float freqEnd = 435;
+const float freqStep = 0.2;
+
+// buffer for the scanlines
+SX126xSpectralScanRecord_t records[16];
+
+void setup() {
+  Serial.begin(921600);
+
+  // initialize SX1262 FSK modem at the initial frequency
+  Serial.print(F("[SX1262] Initializing ... "));
+  int state = radio.beginFSK(freqStart);
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while(true);
+  }
+
+  // upload a patch to the SX1262 to enable spectral scan
+  // NOTE: this patch is uploaded into volatile memory,
+  //       and must be re-uploaded on every power up
+  Serial.print(F("[SX1262] Uploading patch ... "));
+  state = radio.uploadPatch(sx126x_patch_scan, sizeof(sx126x_patch_scan));
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while(true);
+  }
+
+  // configure scan bandwidth to 234.4 kHz
+  // and disable the data shaping
+  Serial.print(F("[SX1262] Setting scan parameters ... "));
+  state = radio.setRxBandwidth(234.3);
+  state |= radio.setDataShaping(RADIOLIB_SHAPING_NONE);
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while(true);
+  }
+
+  // start the sweep
+  // number of samples: 512 (fewer samples = faster sweep)
+  Serial.print(F("[SX1262] Starting spectral scan sweep ... "));
+  state = radio.spectralScanSweepStart(freqStart, freqEnd, freqStep, records, sizeof(records)/sizeof(records[0]), 512);
+  if(state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while(true);
+  }
+}
+
+void loop() {
+  // keep the sweep going
+  radio.spectralScanSweepProcess();
+
+  // send out everything that has been scanned so far
+  SX126xSpectralScanRecord_t rec;
+  while(radio.spectralScanSweepRead(&rec) == RADIOLIB_ERR_NONE) {
+    const uint8_t sync[] = { 0xA5, 0x5A };
+    Serial.write(sync, sizeof(sync));
+    Serial.write((uint8_t*)&rec, sizeof(rec));
+
+    // the sweep has to keep up with the Serial port
+    radio.spectralScanSweepProcess();
+  }
+}
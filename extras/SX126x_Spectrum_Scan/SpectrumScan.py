@@ -3,7 +3,9 @@
 
 import argparse
 import serial
+import struct
 import sys
+import time
 import numpy as np
 import matplotlib as mpl
 import matplotlib.pyplot as plt
@@ -19,6 +21,10 @@ SCAN_MARK_START = 'SCAN '
 SCAN_MARK_FREQ = 'FREQ '
 SCAN_MARK_END = ' END'
 
+# binary record sync bytes and layout (step index, sweep counter, power bins)
+BIN_SYNC = b'\xA5\x5A'
+BIN_FORMAT = '<HH' + 'H'*SCAN_WIDTH
+
 # output path
 OUT_PATH = 'out'
 
@@ -27,6 +33,7 @@ DEFAULT_BAUDRATE = 115200
 DEFAULT_COLOR_MAP = 'viridis'
 DEFAULT_SCAN_LEN = 200
 DEFAULT_RSSI_OFFSET = -11
+DEFAULT_FREQ_STEP = 0.2
 
 # Print iterations progress
 # from https://stackoverflow.com/questions/3173320/text-progress-bar-in-terminal-with-block-characters
@@ -87,8 +94,23 @@ def main():
         default=-1,
         type=float,
         help=f'Default starting frequency in MHz')
+    parser.add_argument('--step',
+        default=DEFAULT_FREQ_STEP,
+        type=float,
+        help=f'Frequency step in MHz for binary mode (defaults to {DEFAULT_FREQ_STEP})')
+    parser.add_argument('--binary',
+        action='store_true',
+        help='Read binary records from the SX126x_Spectrum_Scan_Stream example, one full sweep is plotted')
     args = parser.parse_args()
 
+    if args.binary:
+        if args.freq == -1:
+            print('Binary mode requires the starting frequency (--freq)')
+            sys.exit(1)
+        arr, freq_list = read_binary(args)
+        plot(args, arr, len(freq_list), freq_list)
+        return
+
     freq_mode = False
     scan_len = args.len
     if (args.freq != -1):
@@ -140,13 +162,61 @@ def main():
                 if (not freq_mode) and (row >= scan_len):
                     break
     
+    if freq_mode:
+        scan_len = len(freq_list)
+    else:
+        freq_list = None
+
+    plot(args, arr, scan_len, freq_list)
+
+def read_binary(args):
+    # scanlines of a single sweep, indexed by the step
+    lines = {}
+    bins = 0
+    start = None
+    with serial.Serial(args.port, args.speed, timeout=None) as com:
+        sweep = None
+        prev = b''
+        while(True):
+            # find the sync bytes
+            byte = com.read(1)
+            if prev + byte != BIN_SYNC:
+                prev = byte
+                continue
+            prev = b''
+            rec = struct.unpack(BIN_FORMAT, com.read(struct.calcsize(BIN_FORMAT)))
+            step, count, scanline = rec[0], rec[1], rec[2:]
+            if start is None:
+                start = time.monotonic()
+            bins += SCAN_WIDTH
+
+            # wait for the beginning of a sweep, stop at the end of it
+            if sweep is None:
+                if step != 0:
+                    continue
+                sweep = count
+            elif count != sweep:
+                break
+            lines[step] = scanline
+            print('{:.3f}'.format(args.freq + step*args.step), end = '\r')
+
+    elapsed = time.monotonic() - start
+    if elapsed > 0:
+        print(f'Received {bins/elapsed:.0f} bins/s')
+
+    steps = sorted(lines.keys())
+    arr = np.zeros((SCAN_WIDTH, len(steps)))
+    for col, step in enumerate(steps):
+        arr[:,col] = lines[step]
+    return(arr, [args.freq + step*args.step for step in steps])
+
+def plot(args, arr, scan_len, freq_list):
+    freq_mode = freq_list is not None
+
     # scale to the number of scans (sum of any given scanline)
     num_samples = arr.sum(axis=0)[0]
     arr *= (num_samples/arr.max())
 
-    if freq_mode:
-        scan_len = len(freq_list)
-
     # create the figure
     fig, ax = plt.subplots()
 
@@ -0,0 +1,175 @@
+#include "FleetHal.h"
+#include "SimPhy.h"
+
+#include <string.h>
+
+FleetHal* FleetHal::active = nullptr;
+
+FleetHal::FleetHal() : medium(this) {
+  this->attach(&this->medium);
+}
+
+FleetHal::~FleetHal() {
+}
+
+void FleetHal::attachPhy(SimPhy* phy) {
+  this->pins[phy->cs] = phy;
+  this->pins[phy->irq] = phy;
+  this->pins[phy->rst] = phy;
+}
+
+void FleetHal::listen(SimPhy* phy, bool enable) {
+  if(enable) {
+    this->medium.listeners.insert(phy);
+  } else {
+    this->medium.listeners.erase(phy);
+  }
+}
+
+void FleetHal::spawn(std::function<void()> task, size_t stackSize) {
+  std::unique_ptr<Task> t(new Task());
+  t->fn = task;
+  t->stack.reset(new uint8_t[stackSize]);
+  t->stackSize = stackSize;
+  t->stackUsed = 0;
+  t->wake = this->now();
+  t->done = false;
+  memset(t->stack.get(), FLEET_STACK_PATTERN, stackSize);
+
+  getcontext(&t->ctx);
+  t->ctx.uc_stack.ss_sp = t->stack.get();
+  t->ctx.uc_stack.ss_size = stackSize;
+  t->ctx.uc_link = &this->scheduler;
+  makecontext(&t->ctx, FleetHal::entry, 0);
+
+  this->queue.push({ { t->wake, this->seq++ }, this->tasks.size() });
+  this->tasks.push_back(std::move(t));
+  this->numRunning++;
+}
+
+void FleetHal::entry() {
+  FleetHal* hal = FleetHal::active;
+  hal->current->fn();
+  hal->current->done = true;
+}
+
+void FleetHal::run(uint64_t limitUs) {
+  FleetHal::active = this;
+  while(!this->queue.empty()) {
+    std::pair<Key, size_t> next = this->queue.top();
+    if(next.first.first > limitUs) {
+      break;
+    }
+    this->queue.pop();
+
+    // process everything on air up to the wake-up time, including events due right now
+    this->advance((next.first.first > this->now()) ? (next.first.first - this->now()) : 0);
+
+    this->current = this->tasks[next.second].get();
+    swapcontext(&this->scheduler, &this->current->ctx);
+    Task* task = this->current;
+    this->current = nullptr;
+
+    if(!task->done) {
+      this->queue.push({ { task->wake, this->seq++ }, next.second });
+      continue;
+    }
+
+    // the stack grows down, so the untouched pattern is at its start
+    size_t untouched = 0;
+    while((untouched < task->stackSize) && (task->stack[untouched] == FLEET_STACK_PATTERN)) {
+      untouched++;
+    }
+    task->stackUsed = task->stackSize - untouched;
+    task->stack.reset();
+    this->numRunning--;
+  }
+  FleetHal::active = nullptr;
+}
+
+size_t FleetHal::running() const {
+  return(this->numRunning);
+}
+
+size_t FleetHal::stackMax() const {
+  size_t max = 0;
+  for(const std::unique_ptr<Task>& task : this->tasks) {
+    if(task->stackUsed > max) {
+      max = task->stackUsed;
+    }
+  }
+  return(max);
+}
+
+size_t FleetHal::stackTotal() const {
+  size_t total = 0;
+  for(const std::unique_ptr<Task>& task : this->tasks) {
+    total += task->stackUsed;
+  }
+  return(total);
+}
+
+void FleetHal::suspend(uint64_t wake) {
+  this->current->wake = wake;
+  swapcontext(&this->current->ctx, &this->scheduler);
+}
+
+void FleetHal::digitalWrite(uint32_t pin, uint32_t value) {
+  auto it = this->pins.find(pin);
+  if(it != this->pins.end()) {
+    it->second->writePin(pin, value);
+    return;
+  }
+  SimHal::digitalWrite(pin, value);
+}
+
+uint32_t FleetHal::digitalRead(uint32_t pin) {
+  auto it = this->pins.find(pin);
+  if(it != this->pins.end()) {
+    return(it->second->readPin(pin));
+  }
+  return(SimHal::digitalRead(pin));
+}
+
+void FleetHal::delay(RadioLibTime_t ms) {
+  this->delayMicroseconds(ms * 1000);
+}
+
+void FleetHal::delayMicroseconds(RadioLibTime_t us) {
+  if(!this->current) {
+    SimHal::delayMicroseconds(us);
+    return;
+  }
+  this->suspend(this->now() + us);
+}
+
+void FleetHal::yield() {
+  if(!this->current) {
+    SimHal::yield();
+    return;
+  }
+
+  // nothing a node polls for can change before the next event on air
+  uint64_t wake = this->now() + FLEET_YIELD_MAX_US;
+  uint64_t next = this->nextEvent();
+  if(next < wake) {
+    wake = (next > this->now()) ? next : this->now();
+  }
+  this->suspend(wake);
+}
+
+void FleetHal::Medium::airStart(const SimPacket& pkt) {
+  for(SimPhy* phy : this->listeners) {
+    if(phy != pkt.sender) {
+      phy->airStart(pkt);
+    }
+  }
+}
+
+void FleetHal::Medium::airEnd(const SimPacket& pkt) {
+  for(SimPhy* phy : this->listeners) {
+    if(phy != pkt.sender) {
+      phy->airEnd(pkt);
+    }
+  }
+}
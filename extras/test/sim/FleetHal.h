@@ -0,0 +1,100 @@
+#ifndef FLEET_HAL_H
+#define FLEET_HAL_H
+
+#include "SimHal.h"
+
+#include <ucontext.h>
+
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class SimPhy;
+
+// longest time a node spends in a single call to yield, in microseconds
+// yield returns at the next event on air, so this only limits how late time-based checks are noticed
+#define FLEET_YIELD_MAX_US    (1000)
+
+// pattern used to find out how much of each stack was used
+#define FLEET_STACK_PATTERN   (0xA5)
+
+// simulated HAL that runs many nodes on a single thread
+// every node is a coroutine with its own stack: delays and yields suspend the node
+// instead of advancing the time, and the scheduler resumes the node that is due next,
+// so that all nodes run interleaved in the same virtual time
+class FleetHal : public SimHal {
+  public:
+    FleetHal();
+    ~FleetHal();
+
+    // add a radio, its pins are looked up directly and it receives packets while listening
+    void attachPhy(SimPhy* phy);
+
+    // start or stop passing packets on air to a radio
+    void listen(SimPhy* phy, bool enable);
+
+    // add a node, the task runs on its own stack until it returns
+    void spawn(std::function<void()> task, size_t stackSize);
+
+    // run the nodes until all of them returned or the virtual time limit was reached
+    void run(uint64_t limitUs);
+
+    // number of nodes that did not return yet
+    size_t running() const;
+
+    // highest and total number of stack bytes used by the nodes
+    size_t stackMax() const;
+    size_t stackTotal() const;
+
+    void digitalWrite(uint32_t pin, uint32_t value) override;
+    uint32_t digitalRead(uint32_t pin) override;
+    void delay(RadioLibTime_t ms) override;
+    void delayMicroseconds(RadioLibTime_t us) override;
+    void yield() override;
+
+  private:
+    struct Task {
+      ucontext_t ctx;
+      std::function<void()> fn;
+      std::unique_ptr<uint8_t[]> stack;
+      size_t stackSize;
+      size_t stackUsed;
+      uint64_t wake;
+      bool done;
+    };
+
+    // forwards packets on air to the listening radios only, instead of all of them
+    class Medium : public SimRadio {
+      public:
+        explicit Medium(SimHal* hal) : SimRadio(hal, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC) {}
+        void transfer(const uint8_t* out, uint8_t* in, size_t len) override { (void)out; (void)in; (void)len; }
+        uint32_t readPin(uint32_t pin) override { (void)pin; return(SIM_LOW); }
+        uint64_t nextEvent() override { return(UINT64_MAX); }
+        void process() override {}
+        void airStart(const SimPacket& pkt) override;
+        void airEnd(const SimPacket& pkt) override;
+        std::unordered_set<SimPhy*> listeners;
+    };
+
+    Medium medium;
+    std::unordered_map<uint32_t, SimPhy*> pins;
+    std::vector<std::unique_ptr<Task>> tasks;
+    size_t numRunning = 0;
+
+    // tasks ordered by wake-up time, ties are resumed in the order they were suspended
+    typedef std::pair<uint64_t, uint64_t> Key;
+    std::priority_queue<std::pair<Key, size_t>, std::vector<std::pair<Key, size_t>>, std::greater<std::pair<Key, size_t>>> queue;
+    uint64_t seq = 0;
+
+    ucontext_t scheduler;
+    Task* current = nullptr;
+
+    void suspend(uint64_t wake);
+    static void entry();
+    static FleetHal* active;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include "LR11x0Emu.h"
+
+#include <algorithm>
+#include <string.h>
+
+// approximate time the chip keeps BUSY high, in microseconds
+#define LR11X0_EMU_BUSY_BOOT          (273000)
+#define LR11X0_EMU_BUSY_CALIBRATE     (3500)
+#define LR11X0_EMU_BUSY_ERASE         (2500000)
+#define LR11X0_EMU_BUSY_FLASH_WRITE   (1000)
+#define LR11X0_EMU_BUSY_DEFAULT       (10)
+
+// version reported by the emulated LR1110
+#define LR11X0_EMU_HW_VERSION         (0x22)
+#define LR11X0_EMU_FW_VERSION         (0x0401)
+#define LR11X0_EMU_BOOT_VERSION       (0x6500)
+
+// length of a WiFi scan result in complete format
+#define LR11X0_EMU_WIFI_COMPLETE_LEN  (22)
+
+LR11x0Emu::LR11x0Emu(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio, size_t imageLen)
+  : SimRadio(hal, cs, irq, rst, gpio),
+    flash(imageLen*sizeof(uint32_t), 0x00),
+    programmed(imageLen, true) {
+  // the device ships with a valid firmware
+  this->reset();
+}
+
+void LR11x0Emu::reset() {
+  this->boot = !this->imageValid();
+  this->stat1 = RADIOLIB_LR11X0_STAT_1_CMD_OK;
+  this->packetType = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
+  memset(this->rsp, 0x00, sizeof(this->rsp));
+  this->busyUntil = this->hal->now() + LR11X0_EMU_BUSY_BOOT;
+}
+
+void LR11x0Emu::powerCycle() {
+  this->inReset = false;
+  this->reset();
+}
+
+bool LR11x0Emu::imageValid() const {
+  for(bool word : this->programmed) {
+    if(!word) {
+      return(false);
+    }
+  }
+  return(true);
+}
+
+void LR11x0Emu::transfer(const uint8_t* out, uint8_t* in, size_t len) {
+  if(this->inReset || (len == 0)) {
+    return;
+  }
+
+  // the first byte is always the status of the previous command, the rest is data of the previous read
+  memset(in, 0x00, len);
+  in[0] = this->stat1;
+  memcpy(&in[1], this->rsp, RADIOLIB_MIN(len - 1, sizeof(this->rsp)));
+
+  // NOP transactions only read, everything else is a new command
+  if((len < 2) || ((out[0] == 0x00) && (out[1] == 0x00))) {
+    return;
+  }
+  this->command(out, len);
+}
+
+void LR11x0Emu::command(const uint8_t* out, size_t len) {
+  uint16_t cmd = ((uint16_t)out[0] << 8) | out[1];
+  const uint8_t* data = &out[2];
+  size_t dataLen = len - 2;
+  uint64_t busy = LR11X0_EMU_BUSY_DEFAULT;
+  uint8_t status = RADIOLIB_LR11X0_STAT_1_CMD_OK;
+  memset(this->rsp, 0x00, sizeof(this->rsp));
+
+  switch(cmd) {
+    case RADIOLIB_LR11X0_CMD_GET_VERSION: {
+      uint16_t ver = this->boot ? LR11X0_EMU_BOOT_VERSION : LR11X0_EMU_FW_VERSION;
+      this->rsp[0] = LR11X0_EMU_HW_VERSION;
+      this->rsp[1] = this->boot ? RADIOLIB_LR11X0_DEVICE_BOOT : RADIOLIB_LR11X0_DEVICE_LR1110;
+      this->rsp[2] = (uint8_t)(ver >> 8);
+      this->rsp[3] = (uint8_t)(ver & 0xFF);
+      status = RADIOLIB_LR11X0_STAT_1_CMD_DAT;
+    } break;
+
+    case RADIOLIB_LR11X0_CMD_GET_PACKET_TYPE:
+      this->rsp[0] = this->packetType;
+      status = RADIOLIB_LR11X0_STAT_1_CMD_DAT;
+      break;
+
+    case RADIOLIB_LR11X0_CMD_SET_PACKET_TYPE:
+      if(dataLen >= 1) {
+        this->packetType = data[0];
+      }
+      break;
+
+    case RADIOLIB_LR11X0_CMD_WIFI_GET_NB_RESULTS:
+      this->rsp[0] = (uint8_t)this->wifiResults.size();
+      status = RADIOLIB_LR11X0_STAT_1_CMD_DAT;
+      break;
+
+    case RADIOLIB_LR11X0_CMD_WIFI_READ_RESULTS: {
+      // only the basic and complete formats are supported, the complete one has frame control and no other data
+      size_t resultLen = 0;
+      if(dataLen >= 3) {
+        resultLen = (data[2] == RADIOLIB_LR11X0_WIFI_RESULT_TYPE_BASIC) ? RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN : LR11X0_EMU_WIFI_COMPLETE_LEN;
+      }
+      if((resultLen == 0) || ((size_t)data[0] + data[1] > this->wifiResults.size()) || (data[1]*resultLen > sizeof(this->rsp))) {
+        status = RADIOLIB_LR11X0_STAT_1_CMD_FAIL;
+        break;
+      }
+      for(size_t i = 0; i < data[1]; i++) {
+        const uint8_t* res = this->wifiResults[data[0] + i].data();
+        uint8_t* dst = &this->rsp[i*resultLen];
+        memcpy(dst, res, 3);
+        if(resultLen == RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN) {
+          memcpy(&dst[3], &res[3], RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN);
+        } else {
+          memcpy(&dst[4], &res[3], RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN);
+        }
+      }
+      status = RADIOLIB_LR11X0_STAT_1_CMD_DAT;
+    } break;
+
+    case RADIOLIB_LR11X0_CMD_CALIBRATE:
+      busy = LR11X0_EMU_BUSY_CALIBRATE;
+      break;
+
+    case RADIOLIB_LR11X0_CMD_REBOOT:
+    case RADIOLIB_LR11X0_CMD_BOOT_REBOOT:
+      this->reset();
+      this->boot = this->boot || ((dataLen >= 1) && (data[0] != 0));
+      return;
+
+    case RADIOLIB_LR11X0_CMD_BOOT_ERASE_FLASH:
+      if(!this->boot) {
+        status = RADIOLIB_LR11X0_STAT_1_CMD_FAIL;
+        break;
+      }
+      std::fill(this->flash.begin(), this->flash.end(), 0xFF);
+      std::fill(this->programmed.begin(), this->programmed.end(), false);
+      busy = LR11X0_EMU_BUSY_ERASE;
+      break;
+
+    case RADIOLIB_LR11X0_CMD_BOOT_WRITE_FLASH_ENCRYPTED: {
+      // offset in bytes followed by whole words, programmed words may only be written again with the same data
+      size_t offset = 0;
+      if(dataLen >= 4) {
+        offset = ((size_t)data[0] << 24) | ((size_t)data[1] << 16) | ((size_t)data[2] << 8) | (size_t)data[3];
+      }
+      size_t num = (dataLen - 4) / sizeof(uint32_t);
+      if(!this->boot || (dataLen < 4) || (dataLen > 4 + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN) ||
+         ((dataLen - 4) % sizeof(uint32_t)) || (offset % sizeof(uint32_t)) || (offset + num*sizeof(uint32_t) > this->flash.size())) {
+        status = RADIOLIB_LR11X0_STAT_1_CMD_FAIL;
+        break;
+      }
+      for(size_t i = 0; i < num; i++) {
+        size_t word = offset/sizeof(uint32_t) + i;
+        if(this->programmed[word] && memcmp(&this->flash[word*sizeof(uint32_t)], &data[4 + i*sizeof(uint32_t)], sizeof(uint32_t))) {
+          status = RADIOLIB_LR11X0_STAT_1_CMD_FAIL;
+          break;
+        }
+        memcpy(&this->flash[word*sizeof(uint32_t)], &data[4 + i*sizeof(uint32_t)], sizeof(uint32_t));
+        this->programmed[word] = true;
+      }
+      this->flashWrites++;
+      busy = LR11X0_EMU_BUSY_FLASH_WRITE;
+    } break;
+
+    default:
+      break;
+  }
+
+  this->stat1 = status;
+  this->busyUntil = this->hal->now() + busy;
+}
+
+uint32_t LR11x0Emu::readPin(uint32_t pin) {
+  if(pin == this->gpio) {
+    return((this->inReset || (this->hal->now() < this->busyUntil)) ? SIM_HIGH : SIM_LOW);
+  }
+  return(SIM_LOW);
+}
+
+void LR11x0Emu::writePin(uint32_t pin, uint32_t level) {
+  if(pin != this->rst) {
+    return;
+  }
+
+  if(level == SIM_LOW) {
+    this->inReset = true;
+  } else if(this->inReset) {
+    this->inReset = false;
+    this->reset();
+  }
+}
+
+uint64_t LR11x0Emu::nextEvent() {
+  if(this->busyUntil > this->hal->now()) {
+    return(this->busyUntil);
+  }
+  return(UINT64_MAX);
+}
+
+void LR11x0Emu::process() {
+}
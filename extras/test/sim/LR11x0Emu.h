@@ -0,0 +1,51 @@
+#ifndef LR11X0_EMU_H
+#define LR11X0_EMU_H
+
+#include "SimHal.h"
+
+#include <array>
+
+// command-level emulator of LR11x0 series (LR1110), covering initialization, the bootloader and readout of WiFi scan results
+// all other commands are accepted and ignored, reads return zeros
+// the GPIO pin is BUSY, the IRQ pin is never raised
+class LR11x0Emu : public SimRadio {
+  public:
+    LR11x0Emu(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio, size_t imageLen);
+
+    void transfer(const uint8_t* out, uint8_t* in, size_t len) override;
+    uint32_t readPin(uint32_t pin) override;
+    void writePin(uint32_t pin, uint32_t level) override;
+    uint64_t nextEvent() override;
+    void process() override;
+
+    // loss of power, flash contents are kept
+    void powerCycle();
+
+    // flash of the bootloader, as received over SPI (i.e. big endian words)
+    std::vector<uint8_t> flash;
+
+    // number of accepted flash write commands
+    uint32_t flashWrites = 0;
+
+    // results of the last WiFi scan in basic format, i.e. type, channel, RSSI and MAC address
+    std::vector<std::array<uint8_t, RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN>> wifiResults;
+
+  private:
+    bool boot = false;
+    bool inReset = false;
+    uint64_t busyUntil = 0;
+    uint8_t stat1 = 0;
+    uint8_t packetType = 0;
+
+    // which words of the flash were written since the last erase
+    std::vector<bool> programmed;
+
+    // data returned by the last read command
+    uint8_t rsp[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
+
+    void reset();
+    bool imageValid() const;
+    void command(const uint8_t* out, size_t len);
+};
+
+#endif
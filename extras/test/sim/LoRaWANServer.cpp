@@ -0,0 +1,176 @@
+#include "LoRaWANServer.h"
+
+#include <string.h>
+
+// home network ID of the simulated network
+#define LORAWAN_SERVER_NET_ID         (0x000013)
+
+// Rx1 delay announced in join-accept, in seconds
+#define LORAWAN_SERVER_RX_DELAY       (1)
+
+template<typename T>
+static T readLE(const uint8_t* buff, size_t len = sizeof(T)) {
+  T val = 0;
+  for(size_t i = 0; i < len; i++) {
+    val |= (T)buff[i] << (8*i);
+  }
+  return(val);
+}
+
+template<typename T>
+static void writeLE(uint8_t* buff, T val, size_t len = sizeof(T)) {
+  for(size_t i = 0; i < len; i++) {
+    buff[i] = (val >> (8*i)) & 0xFF;
+  }
+}
+
+LoRaWANServer::LoRaWANServer(SimHal* hal) : hal(hal) {
+}
+
+void LoRaWANServer::addDevice(uint64_t joinEUI, uint64_t devEUI, const uint8_t* nwkKey) {
+  Device dev;
+  memset(&dev, 0x00, sizeof(dev));
+  dev.joinEUI = joinEUI;
+  memcpy(dev.nwkKey, nwkKey, RADIOLIB_AES128_KEY_SIZE);
+  this->devices[devEUI] = dev;
+}
+
+void LoRaWANServer::mic(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out) {
+  uint8_t cmac[RADIOLIB_AES128_BLOCK_SIZE];
+  uint8_t keyBuff[RADIOLIB_AES128_KEY_SIZE];
+  memcpy(keyBuff, key, RADIOLIB_AES128_KEY_SIZE);
+  this->aes.init(keyBuff);
+  this->aes.initCMAC();
+  this->aes.updateCMAC(data, len);
+  this->aes.finalCMAC(cmac);
+  memcpy(out, cmac, sizeof(uint32_t));
+}
+
+void LoRaWANServer::handle(const SimPacket& pkt) {
+  // downlinks (including our own) are sent with inverted IQ
+  if(pkt.invertIQ || pkt.data.empty()) {
+    return;
+  }
+
+  uint8_t mType = pkt.data[0] & RADIOLIB_LORAWAN_MHDR_MTYPE_MASK;
+  if(mType == RADIOLIB_LORAWAN_MHDR_MTYPE_JOIN_REQUEST) {
+    this->handleJoin(pkt);
+  } else if((mType == RADIOLIB_LORAWAN_MHDR_MTYPE_UNCONF_DATA_UP) || (mType == RADIOLIB_LORAWAN_MHDR_MTYPE_CONF_DATA_UP)) {
+    this->handleUplink(pkt);
+  }
+}
+
+void LoRaWANServer::handleJoin(const SimPacket& pkt) {
+  if(pkt.data.size() != RADIOLIB_LORAWAN_JOIN_REQUEST_LEN) {
+    return;
+  }
+
+  const uint8_t* msg = pkt.data.data();
+  uint64_t joinEUI = readLE<uint64_t>(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_JOIN_EUI_POS]);
+  uint64_t devEUI = readLE<uint64_t>(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_DEV_EUI_POS]);
+  uint16_t devNonce = readLE<uint16_t>(&msg[RADIOLIB_LORAWAN_JOIN_REQUEST_DEV_NONCE_POS]);
+  auto it = this->devices.find(devEUI);
+  if((it == this->devices.end()) || (it->second.joinEUI != joinEUI)) {
+    return;
+  }
+  Device& dev = it->second;
+
+  // check join-request MIC
+  uint8_t micCalc[sizeof(uint32_t)];
+  this->mic(dev.nwkKey, msg, RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t), micCalc);
+  if(memcmp(micCalc, &msg[RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t)], sizeof(uint32_t)) != 0) {
+    return;
+  }
+
+  // build the join-accept without CFList
+  uint8_t accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN - RADIOLIB_LORAWAN_JOIN_ACCEPT_CFLIST_LEN] = { 0 };
+  size_t acceptLen = sizeof(accept);
+  this->joinNonce++;
+  if(dev.devAddr == 0) {
+    dev.devAddr = this->nextDevAddr++;
+    this->sessions[dev.devAddr] = &dev;
+  }
+  dev.fCntDown = 0;
+  accept[0] = RADIOLIB_LORAWAN_MHDR_MTYPE_JOIN_ACCEPT | RADIOLIB_LORAWAN_MHDR_MAJOR_R1;
+  writeLE<uint32_t>(&accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_JOIN_NONCE_POS], this->joinNonce, 3);
+  writeLE<uint32_t>(&accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_HOME_NET_ID_POS], LORAWAN_SERVER_NET_ID, 3);
+  writeLE<uint32_t>(&accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_DEV_ADDR_POS], dev.devAddr);
+  accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_DL_SETTINGS_POS] = RADIOLIB_LORAWAN_JOIN_ACCEPT_R_1_0;
+  accept[RADIOLIB_LORAWAN_JOIN_ACCEPT_RX_DELAY_POS] = LORAWAN_SERVER_RX_DELAY;
+  this->mic(dev.nwkKey, accept, acceptLen - sizeof(uint32_t), &accept[acceptLen - sizeof(uint32_t)]);
+
+  // derive the session keys
+  uint8_t keyBuff[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+  writeLE<uint32_t>(&keyBuff[RADIOLIB_LORAWAN_JOIN_ACCEPT_JOIN_NONCE_POS], this->joinNonce, 3);
+  writeLE<uint32_t>(&keyBuff[RADIOLIB_LORAWAN_JOIN_ACCEPT_HOME_NET_ID_POS], LORAWAN_SERVER_NET_ID, 3);
+  writeLE<uint16_t>(&keyBuff[RADIOLIB_LORAWAN_JOIN_ACCEPT_DEV_ADDR_POS], devNonce);
+  this->aes.init(dev.nwkKey);
+  keyBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_APP_S_KEY;
+  this->aes.encryptECB(keyBuff, RADIOLIB_AES128_BLOCK_SIZE, dev.appSKey);
+  keyBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_F_NWK_S_INT_KEY;
+  this->aes.encryptECB(keyBuff, RADIOLIB_AES128_BLOCK_SIZE, dev.nwkSKey);
+
+  // the device "decrypts" join-accept by encrypting it, so the server has to decrypt
+  uint8_t acceptEnc[sizeof(accept)];
+  acceptEnc[0] = accept[0];
+  this->aes.init(dev.nwkKey);
+  this->aes.decryptECB(&accept[1], acceptLen - 1, &acceptEnc[1]);
+
+  this->joins++;
+  this->reply(pkt, RADIOLIB_LORAWAN_JOIN_ACCEPT_DELAY_1_MS, acceptEnc, acceptLen);
+}
+
+void LoRaWANServer::handleUplink(const SimPacket& pkt) {
+  if(pkt.data.size() < 12) {
+    return;
+  }
+
+  const uint8_t* msg = pkt.data.data();
+  uint32_t devAddr = readLE<uint32_t>(&msg[1]);
+  auto it = this->sessions.find(devAddr);
+  if(it == this->sessions.end()) {
+    return;
+  }
+  Device* dev = it->second;
+  this->uplinks++;
+
+  if((msg[0] & RADIOLIB_LORAWAN_MHDR_MTYPE_MASK) != RADIOLIB_LORAWAN_MHDR_MTYPE_CONF_DATA_UP) {
+    return;
+  }
+
+  // empty acknowledgement: MHDR, DevAddr, FCtrl, FCnt and MIC preceded by the B0 block
+  uint8_t frame[RADIOLIB_AES128_BLOCK_SIZE + 12] = { 0 };
+  uint8_t* ack = &frame[RADIOLIB_AES128_BLOCK_SIZE];
+  size_t ackLen = 12;
+  ack[0] = RADIOLIB_LORAWAN_MHDR_MTYPE_UNCONF_DATA_DOWN | RADIOLIB_LORAWAN_MHDR_MAJOR_R1;
+  writeLE<uint32_t>(&ack[1], dev->devAddr);
+  ack[5] = RADIOLIB_LORAWAN_FCTRL_ACK;
+  writeLE<uint16_t>(&ack[6], dev->fCntDown);
+
+  frame[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_MIC_BLOCK_MAGIC;
+  frame[RADIOLIB_LORAWAN_BLOCK_DIR_POS] = RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK;
+  writeLE<uint32_t>(&frame[RADIOLIB_LORAWAN_BLOCK_DEV_ADDR_POS], dev->devAddr);
+  writeLE<uint32_t>(&frame[RADIOLIB_LORAWAN_BLOCK_FCNT_POS], dev->fCntDown);
+  frame[RADIOLIB_LORAWAN_MIC_BLOCK_LEN_POS] = ackLen - sizeof(uint32_t);
+  this->mic(dev->nwkSKey, frame, sizeof(frame) - sizeof(uint32_t), &ack[ackLen - sizeof(uint32_t)]);
+  dev->fCntDown++;
+
+  this->reply(pkt, LORAWAN_SERVER_RX_DELAY * 1000, ack, ackLen);
+}
+
+void LoRaWANServer::reply(const SimPacket& uplink, uint32_t delayMs, const uint8_t* data, size_t len) {
+  // Rx1 uses the uplink channel and data rate, downlinks have no CRC and inverted IQ
+  SimPacket pkt;
+  pkt.start = uplink.end + (uint64_t)delayMs * 1000;
+  pkt.freq = uplink.freq;
+  pkt.sf = uplink.sf;
+  pkt.bw = uplink.bw;
+  pkt.crc = false;
+  pkt.invertIQ = true;
+  pkt.data.assign(data, data + len);
+  pkt.sender = nullptr;
+  bool ldro = ((double)(1UL << pkt.sf) / pkt.bw) >= 16.0;
+  pkt.end = pkt.start + SimRadio::loraTimeOnAir(pkt.sf, pkt.bw, 1, 8, true, false, ldro, len);
+  this->hal->transmitPacket(pkt);
+  this->downlinks++;
+}
@@ -0,0 +1,48 @@
+#ifndef LORAWAN_SERVER_H
+#define LORAWAN_SERVER_H
+
+#include "SimHal.h"
+
+#include <map>
+
+// minimal LoRaWAN 1.0 network and join server
+// accepts OTAA join-requests and acknowledges confirmed uplinks in Rx1
+class LoRaWANServer {
+  public:
+    explicit LoRaWANServer(SimHal* hal);
+
+    // register a device that is allowed to join
+    void addDevice(uint64_t joinEUI, uint64_t devEUI, const uint8_t* nwkKey);
+
+    // handle a packet that ended on air
+    void handle(const SimPacket& pkt);
+
+    // statistics
+    uint32_t joins = 0;
+    uint32_t uplinks = 0;
+    uint32_t downlinks = 0;
+
+  private:
+    struct Device {
+      uint64_t joinEUI;
+      uint8_t nwkKey[RADIOLIB_AES128_KEY_SIZE];
+      uint8_t nwkSKey[RADIOLIB_AES128_KEY_SIZE];
+      uint8_t appSKey[RADIOLIB_AES128_KEY_SIZE];
+      uint32_t devAddr;
+      uint16_t fCntDown;
+    };
+
+    SimHal* hal;
+    RadioLibAES128 aes;
+    std::map<uint64_t, Device> devices;
+    std::map<uint32_t, Device*> sessions;
+    uint32_t joinNonce = 0;
+    uint32_t nextDevAddr = 0x26000001;
+
+    void handleJoin(const SimPacket& pkt);
+    void handleUplink(const SimPacket& pkt);
+    void reply(const SimPacket& uplink, uint32_t delayMs, const uint8_t* data, size_t len);
+    void mic(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out);
+};
+
+#endif
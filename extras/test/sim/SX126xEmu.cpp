@@ -0,0 +1,371 @@
+#include "SX126xEmu.h"
+
+#include <math.h>
+#include <string.h>
+
+// approximate time the chip keeps BUSY high, in microseconds
+#define SX126X_EMU_BUSY_BOOT          (3500)
+#define SX126X_EMU_BUSY_CALIBRATE     (3500)
+#define SX126X_EMU_BUSY_CALIB_IMAGE   (1000)
+#define SX126X_EMU_BUSY_MODE          (100)
+#define SX126X_EMU_BUSY_DEFAULT       (10)
+
+// version string reported by SX1261/SX1262
+static const char SX126xEmuVersion[16] = "SX1261 V2D 2D02";
+
+SX126xEmu::SX126xEmu(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio)
+  : SimRadio(hal, cs, irq, rst, gpio) {
+  this->reset();
+}
+
+void SX126xEmu::reset() {
+  memset(this->regs, 0x00, sizeof(this->regs));
+  memcpy(&this->regs[RADIOLIB_SX126X_REG_VERSION_STRING], SX126xEmuVersion, sizeof(SX126xEmuVersion));
+  memset(this->buff, 0x00, sizeof(this->buff));
+  this->mode = STBY_RC;
+  this->txEnd = UINT64_MAX;
+  this->rxTimeout = UINT64_MAX;
+  this->rxLocked = false;
+  this->packetType = RADIOLIB_SX126X_PACKET_TYPE_GFSK;
+  this->irqMask = 0;
+  this->dio1Mask = 0;
+  this->irqFlags = 0;
+  this->rxLen = 0;
+  this->busyUntil = this->hal->now() + SX126X_EMU_BUSY_BOOT;
+}
+
+uint8_t SX126xEmu::status() const {
+  // only the chip mode is reported, command status is always "reserved" (= OK)
+  const uint8_t modes[] = { 0x02, 0x02, 0x03, 0x04, 0x05, 0x06 };
+  return(modes[this->mode] << 4);
+}
+
+double SX126xEmu::freq() const {
+  return((double)this->frf * 32000000.0 / (double)(1UL << 25));
+}
+
+float SX126xEmu::bw() const {
+  switch(this->bwCode) {
+    case RADIOLIB_SX126X_LORA_BW_7_8: return(7.8);
+    case RADIOLIB_SX126X_LORA_BW_10_4: return(10.4);
+    case RADIOLIB_SX126X_LORA_BW_15_6: return(15.6);
+    case RADIOLIB_SX126X_LORA_BW_20_8: return(20.8);
+    case RADIOLIB_SX126X_LORA_BW_31_25: return(31.25);
+    case RADIOLIB_SX126X_LORA_BW_41_7: return(41.7);
+    case RADIOLIB_SX126X_LORA_BW_62_5: return(62.5);
+    case RADIOLIB_SX126X_LORA_BW_125_0: return(125.0);
+    case RADIOLIB_SX126X_LORA_BW_250_0: return(250.0);
+    case RADIOLIB_SX126X_LORA_BW_500_0: return(500.0);
+  }
+  return(0);
+}
+
+void SX126xEmu::setIrq(uint16_t flags) {
+  this->irqFlags |= (flags & this->irqMask);
+}
+
+void SX126xEmu::transfer(const uint8_t* out, uint8_t* in, size_t len) {
+  if(this->inReset || (len == 0)) {
+    return;
+  }
+
+  // the chip returns its status on all bytes that are not data
+  memset(in, this->status(), len);
+  this->command(out, in, len);
+}
+
+void SX126xEmu::command(const uint8_t* out, uint8_t* in, size_t len) {
+  uint64_t busy = SX126X_EMU_BUSY_DEFAULT;
+  uint64_t now = this->hal->now();
+
+  switch(out[0]) {
+    case RADIOLIB_SX126X_CMD_WRITE_REGISTER: {
+      uint16_t addr = ((uint16_t)out[1] << 8) | out[2];
+      for(size_t i = 3; i < len; i++) {
+        this->regs[(addr++) & 0x0FFF] = out[i];
+      }
+    } break;
+
+    case RADIOLIB_SX126X_CMD_READ_REGISTER: {
+      uint16_t addr = ((uint16_t)out[1] << 8) | out[2];
+      for(size_t i = 4; i < len; i++, addr++) {
+        if((addr >= RADIOLIB_SX126X_REG_RANDOM_NUMBER_0) && (addr <= RADIOLIB_SX126X_REG_RANDOM_NUMBER_3)) {
+          // deterministic pseudo-random numbers, so that runs are reproducible
+          this->rng = this->rng * 1103515245UL + 12345UL;
+          in[i] = (this->rng >> 16) & 0xFF;
+        } else {
+          in[i] = this->regs[addr & 0x0FFF];
+        }
+      }
+    } break;
+
+    case RADIOLIB_SX126X_CMD_WRITE_BUFFER:
+      for(size_t i = 2; i < len; i++) {
+        this->buff[(uint8_t)(out[1] + i - 2)] = out[i];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_READ_BUFFER:
+      for(size_t i = 3; i < len; i++) {
+        in[i] = this->buff[(uint8_t)(out[1] + i - 3)];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_GET_IRQ_STATUS:
+      if(len >= 4) {
+        in[2] = (this->irqFlags >> 8) & 0xFF;
+        in[3] = this->irqFlags & 0xFF;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_GET_RX_BUFFER_STATUS:
+      if(len >= 4) {
+        in[2] = this->rxLen;
+        in[3] = this->rxStart;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_GET_PACKET_STATUS:
+      if(len >= 5) {
+        // -32 dBm RSSI, 10 dB SNR
+        in[2] = 64;
+        in[3] = 40;
+        in[4] = 64;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_GET_RSSI_INST:
+      if(len >= 3) {
+        in[2] = 200;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_GET_PACKET_TYPE:
+      if(len >= 3) {
+        in[2] = this->packetType;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_GET_DEVICE_ERRORS:
+    case RADIOLIB_SX126X_CMD_GET_STATS:
+      for(size_t i = 2; i < len; i++) {
+        in[i] = 0;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_CLEAR_IRQ_STATUS:
+      if(len >= 3) {
+        this->irqFlags &= ~(((uint16_t)out[1] << 8) | out[2]);
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_DIO_IRQ_PARAMS:
+      if(len >= 5) {
+        this->irqMask = ((uint16_t)out[1] << 8) | out[2];
+        this->dio1Mask = ((uint16_t)out[3] << 8) | out[4];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_STANDBY:
+      this->mode = ((len >= 2) && out[1]) ? STBY_XOSC : STBY_RC;
+      this->txEnd = UINT64_MAX;
+      this->rxTimeout = UINT64_MAX;
+      this->rxLocked = false;
+      busy = SX126X_EMU_BUSY_MODE;
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_SLEEP:
+      this->mode = SLEEP;
+      this->txEnd = UINT64_MAX;
+      this->rxTimeout = UINT64_MAX;
+      this->rxLocked = false;
+      busy = SX126X_EMU_BUSY_MODE;
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_FS:
+      this->mode = FS;
+      busy = SX126X_EMU_BUSY_MODE;
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_PACKET_TYPE:
+      if(len >= 2) {
+        this->packetType = out[1];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY:
+      if(len >= 5) {
+        this->frf = ((uint32_t)out[1] << 24) | ((uint32_t)out[2] << 16) | ((uint32_t)out[3] << 8) | out[4];
+        this->frfWrites++;
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS:
+      if((this->packetType == RADIOLIB_SX126X_PACKET_TYPE_LORA) && (len >= 5)) {
+        this->sf = out[1];
+        this->bwCode = out[2];
+        this->cr = out[3];
+        this->ldro = out[4];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS:
+      if((this->packetType == RADIOLIB_SX126X_PACKET_TYPE_LORA) && (len >= 7)) {
+        this->preamble = ((uint16_t)out[1] << 8) | out[2];
+        this->implicitHeader = out[3];
+        this->payloadLen = out[4];
+        this->crcOn = out[5];
+        this->invertIQ = out[6];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_BUFFER_BASE_ADDRESS:
+      if(len >= 3) {
+        this->txBase = out[1];
+        this->rxBase = out[2];
+      }
+      break;
+
+    case RADIOLIB_SX126X_CMD_CALIBRATE:
+      busy = SX126X_EMU_BUSY_CALIBRATE;
+      break;
+
+    case RADIOLIB_SX126X_CMD_CALIBRATE_IMAGE:
+      busy = SX126X_EMU_BUSY_CALIB_IMAGE;
+      break;
+
+    case RADIOLIB_SX126X_CMD_SET_TX: {
+      busy = SX126X_EMU_BUSY_MODE;
+      this->mode = TX;
+      this->rxLocked = false;
+      this->rxTimeout = UINT64_MAX;
+      if(this->packetType != RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+        // only LoRa goes on air, other modems finish immediately
+        this->txEnd = now + busy;
+        break;
+      }
+
+      SimPacket pkt;
+      pkt.start = now + busy;
+      pkt.end = pkt.start + loraTimeOnAir(this->sf, this->bw(), this->cr, this->preamble, !this->implicitHeader, this->crcOn, this->ldro, this->payloadLen);
+      pkt.freq = this->freq();
+      pkt.sf = this->sf;
+      pkt.bw = this->bw();
+      pkt.crc = this->crcOn;
+      pkt.invertIQ = this->invertIQ;
+      for(uint8_t i = 0; i < this->payloadLen; i++) {
+        pkt.data.push_back(this->buff[(uint8_t)(this->txBase + i)]);
+      }
+      pkt.sender = this;
+      this->txEnd = pkt.end;
+      this->hal->transmitPacket(pkt);
+    } break;
+
+    case RADIOLIB_SX126X_CMD_SET_RX: {
+      busy = SX126X_EMU_BUSY_MODE;
+      uint32_t timeout = (len >= 4) ? (((uint32_t)out[1] << 16) | ((uint32_t)out[2] << 8) | out[3]) : 0;
+      this->mode = RX;
+      this->rxStartTime = now;
+      this->txEnd = UINT64_MAX;
+      this->rxLocked = false;
+      this->rxContinuous = (timeout == RADIOLIB_SX126X_RX_TIMEOUT_INF);
+      this->rxTimeout = UINT64_MAX;
+      if(!this->rxContinuous && (timeout != RADIOLIB_SX126X_RX_TIMEOUT_NONE)) {
+        this->rxTimeout = now + busy + (uint64_t)(timeout * 15.625);
+      }
+    } break;
+
+    default:
+      // everything else is accepted and ignored
+      break;
+  }
+
+  this->busyUntil = now + busy;
+}
+
+uint32_t SX126xEmu::readPin(uint32_t pin) {
+  if(pin == this->gpio) {
+    return((this->inReset || (this->hal->now() < this->busyUntil)) ? SIM_HIGH : SIM_LOW);
+  }
+  if(pin == this->irq) {
+    return((this->irqFlags & this->dio1Mask) ? SIM_HIGH : SIM_LOW);
+  }
+  return(SIM_LOW);
+}
+
+void SX126xEmu::writePin(uint32_t pin, uint32_t level) {
+  if(pin != this->rst) {
+    return;
+  }
+
+  if(level == SIM_LOW) {
+    this->inReset = true;
+  } else if(this->inReset) {
+    this->inReset = false;
+    this->reset();
+  }
+}
+
+uint64_t SX126xEmu::nextEvent() {
+  uint64_t next = UINT64_MAX;
+  if(this->busyUntil > this->hal->now()) {
+    next = this->busyUntil;
+  }
+  if(this->txEnd < next) {
+    next = this->txEnd;
+  }
+  if(this->rxTimeout < next) {
+    next = this->rxTimeout;
+  }
+  return(next);
+}
+
+void SX126xEmu::process() {
+  uint64_t now = this->hal->now();
+  if(this->txEnd <= now) {
+    this->txEnd = UINT64_MAX;
+    this->mode = STBY_RC;
+    this->setIrq(RADIOLIB_SX126X_IRQ_TX_DONE);
+  }
+
+  if(this->rxTimeout <= now) {
+    this->rxTimeout = UINT64_MAX;
+    this->mode = STBY_RC;
+    this->setIrq(RADIOLIB_SX126X_IRQ_TIMEOUT);
+  }
+}
+
+void SX126xEmu::airStart(const SimPacket& pkt) {
+  if((this->mode != RX) || this->rxLocked || (this->packetType != RADIOLIB_SX126X_PACKET_TYPE_LORA)) {
+    return;
+  }
+
+  // the packet can only be received when all parameters match
+  if((fabs(pkt.freq - this->freq()) > 1000.0) || (pkt.sf != this->sf) || (fabs(pkt.bw - this->bw()) > 0.01) || (pkt.invertIQ != (bool)this->invertIQ)) {
+    return;
+  }
+
+  // timeout is stopped on header detection
+  this->rxLocked = true;
+  this->rxLockStart = pkt.start;
+  this->rxLockSender = pkt.sender;
+  this->rxTimeout = UINT64_MAX;
+  this->setIrq(RADIOLIB_SX126X_IRQ_PREAMBLE_DETECTED | RADIOLIB_SX126X_IRQ_HEADER_VALID);
+}
+
+void SX126xEmu::airEnd(const SimPacket& pkt) {
+  if(!this->rxLocked || (pkt.start != this->rxLockStart) || (pkt.sender != this->rxLockSender)) {
+    return;
+  }
+
+  this->rxLocked = false;
+  for(size_t i = 0; i < pkt.data.size(); i++) {
+    this->buff[(uint8_t)(this->rxBase + i)] = pkt.data[i];
+  }
+  this->rxLen = pkt.data.size();
+  this->rxStart = this->rxBase;
+  if(!this->rxContinuous) {
+    this->mode = STBY_RC;
+  }
+  this->setIrq(RADIOLIB_SX126X_IRQ_RX_DONE);
+}
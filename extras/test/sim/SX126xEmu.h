@@ -0,0 +1,69 @@
+#ifndef SX126X_EMU_H
+#define SX126X_EMU_H
+
+#include "SimHal.h"
+
+// command-level emulator of SX126x series (SX1261/SX1262), LoRa modem only
+// the IRQ pin is DIO1, the GPIO pin is BUSY
+class SX126xEmu : public SimRadio {
+  public:
+    SX126xEmu(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio);
+
+    void transfer(const uint8_t* out, uint8_t* in, size_t len) override;
+    uint32_t readPin(uint32_t pin) override;
+    void writePin(uint32_t pin, uint32_t level) override;
+    uint64_t nextEvent() override;
+    void process() override;
+    void airStart(const SimPacket& pkt) override;
+    void airEnd(const SimPacket& pkt) override;
+
+    // number of accepted frequency changes
+    uint32_t frfWrites = 0;
+
+    // time of the last command to start receiving
+    uint64_t rxStartTime = 0;
+
+  private:
+    enum Mode { SLEEP, STBY_RC, STBY_XOSC, FS, RX, TX };
+
+    uint8_t regs[0x1000];
+    uint8_t buff[256];
+    Mode mode = STBY_RC;
+    bool inReset = false;
+    uint64_t busyUntil = 0;
+    uint64_t txEnd = UINT64_MAX;
+    uint64_t rxTimeout = UINT64_MAX;
+    bool rxContinuous = false;
+    bool rxLocked = false;
+    uint64_t rxLockStart = 0;
+    const SimRadio* rxLockSender = nullptr;
+
+    uint8_t packetType = 0;
+    uint32_t frf = 0;
+    uint8_t sf = 7;
+    uint8_t bwCode = 0x04;
+    uint8_t cr = 1;
+    uint8_t ldro = 0;
+    uint16_t preamble = 8;
+    uint8_t implicitHeader = 0;
+    uint8_t payloadLen = 0xFF;
+    uint8_t crcOn = 1;
+    uint8_t invertIQ = 0;
+    uint8_t txBase = 0;
+    uint8_t rxBase = 0;
+    uint16_t irqMask = 0;
+    uint16_t dio1Mask = 0;
+    uint16_t irqFlags = 0;
+    uint8_t rxLen = 0;
+    uint8_t rxStart = 0;
+    uint32_t rng = 0x12345678;
+
+    void reset();
+    uint8_t status() const;
+    void command(const uint8_t* out, uint8_t* in, size_t len);
+    void setIrq(uint16_t flags);
+    double freq() const;
+    float bw() const;
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "SX127xEmu.h"
+
+#include <math.h>
+#include <string.h>
+
+// operation modes in RegOpMode bits 2 - 0
+#define SX127X_EMU_MODE_SLEEP         (0)
+#define SX127X_EMU_MODE_STDBY         (1)
+#define SX127X_EMU_MODE_TX            (3)
+#define SX127X_EMU_MODE_RXCONT        (5)
+#define SX127X_EMU_MODE_RXSINGLE      (6)
+#define SX127X_EMU_MODE_CAD           (7)
+
+// time between entering Tx mode and start of the preamble, in microseconds
+#define SX127X_EMU_TX_RAMP            (100)
+
+SX127xEmu::SX127xEmu(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio)
+  : SimRadio(hal, cs, irq, rst, gpio) {
+  this->reset();
+}
+
+void SX127xEmu::reset() {
+  // LoRa mode defaults of the registers that are used
+  memset(this->regs, 0x00, sizeof(this->regs));
+  memset(this->fifo, 0x00, sizeof(this->fifo));
+  this->regs[RADIOLIB_SX127X_REG_OP_MODE] = 0x09;
+  this->regs[RADIOLIB_SX127X_REG_FRF_MSB] = 0x6C;
+  this->regs[RADIOLIB_SX127X_REG_FRF_MID] = 0x80;
+  this->regs[RADIOLIB_SX127X_REG_FIFO_TX_BASE_ADDR] = 0x80;
+  this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_1] = 0x72;
+  this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2] = 0x70;
+  this->regs[RADIOLIB_SX127X_REG_SYMB_TIMEOUT_LSB] = 0x64;
+  this->regs[RADIOLIB_SX127X_REG_PREAMBLE_LSB] = 0x08;
+  this->regs[RADIOLIB_SX127X_REG_PAYLOAD_LENGTH] = 0x01;
+  this->regs[RADIOLIB_SX127X_REG_INVERT_IQ] = 0x27;
+  this->regs[RADIOLIB_SX127X_REG_INVERT_IQ2] = 0x1D;
+  this->regs[RADIOLIB_SX127X_REG_VERSION] = RADIOLIB_SX1278_CHIP_VERSION;
+  this->txEnd = UINT64_MAX;
+  this->rxTimeout = UINT64_MAX;
+  this->rxLocked = false;
+}
+
+bool SX127xEmu::isLoRa() const {
+  return(this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0x80);
+}
+
+uint8_t SX127xEmu::getMode() const {
+  return(this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0x07);
+}
+
+double SX127xEmu::freq() const {
+  uint32_t frf = ((uint32_t)this->regs[RADIOLIB_SX127X_REG_FRF_MSB] << 16) | ((uint32_t)this->regs[RADIOLIB_SX127X_REG_FRF_MID] << 8) | this->regs[RADIOLIB_SX127X_REG_FRF_LSB];
+  return((double)frf * 32000000.0 / (double)(1UL << 19));
+}
+
+float SX127xEmu::bw() const {
+  const float bws[] = { 7.8, 10.4, 15.6, 20.8, 31.25, 41.7, 62.5, 125.0, 250.0, 500.0 };
+  uint8_t idx = this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_1] >> 4;
+  return((idx < 10) ? bws[idx] : 0);
+}
+
+uint8_t SX127xEmu::sf() const {
+  return(this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2] >> 4);
+}
+
+uint64_t SX127xEmu::timeOnAir(size_t len) const {
+  uint8_t cfg1 = this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_1];
+  uint8_t cfg2 = this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2];
+  uint16_t preamble = ((uint16_t)this->regs[RADIOLIB_SX127X_REG_PREAMBLE_MSB] << 8) | this->regs[RADIOLIB_SX127X_REG_PREAMBLE_LSB];
+  bool ldro = this->regs[RADIOLIB_SX1278_REG_MODEM_CONFIG_3] & 0x08;
+  return(loraTimeOnAir(this->sf(), this->bw(), (cfg1 >> 1) & 0x07, preamble, !(cfg1 & 0x01), cfg2 & 0x04, ldro, len));
+}
+
+void SX127xEmu::setIrq(uint8_t flags) {
+  this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS] |= (flags & ~this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS_MASK]);
+}
+
+void SX127xEmu::setMode(uint8_t mode) {
+  uint8_t prev = this->getMode();
+  this->regs[RADIOLIB_SX127X_REG_OP_MODE] = (this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0xF8) | mode;
+  if((mode == prev) && ((mode == SX127X_EMU_MODE_TX) || (mode == SX127X_EMU_MODE_RXCONT) || (mode == SX127X_EMU_MODE_RXSINGLE))) {
+    // writing the same mode again does not restart the operation
+    return;
+  }
+
+  this->txEnd = UINT64_MAX;
+  this->rxTimeout = UINT64_MAX;
+  this->rxLocked = false;
+  if(!this->isLoRa()) {
+    // only LoRa is emulated
+    return;
+  }
+
+  uint64_t now = this->hal->now();
+  if(mode == SX127X_EMU_MODE_TX) {
+    uint8_t len = this->regs[RADIOLIB_SX127X_REG_PAYLOAD_LENGTH];
+    uint8_t base = this->regs[RADIOLIB_SX127X_REG_FIFO_TX_BASE_ADDR];
+    SimPacket pkt;
+    pkt.start = now + SX127X_EMU_TX_RAMP;
+    pkt.end = pkt.start + this->timeOnAir(len);
+    pkt.freq = this->freq();
+    pkt.sf = this->sf();
+    pkt.bw = this->bw();
+    pkt.crc = this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2] & 0x04;
+
+    // Tx path inversion is swapped, see SX127x::invertIQ
+    pkt.invertIQ = !(this->regs[RADIOLIB_SX127X_REG_INVERT_IQ] & 0x01);
+    for(uint8_t i = 0; i < len; i++) {
+      pkt.data.push_back(this->fifo[(uint8_t)(base + i)]);
+    }
+    pkt.sender = this;
+    this->txEnd = pkt.end;
+    this->hal->transmitPacket(pkt);
+
+  } else if(mode == SX127X_EMU_MODE_RXSINGLE) {
+    uint16_t symbols = ((uint16_t)(this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2] & 0x03) << 8) | this->regs[RADIOLIB_SX127X_REG_SYMB_TIMEOUT_LSB];
+    double symbolUs = (double)(1UL << this->sf()) * 1000.0 / this->bw();
+    this->rxTimeout = now + (uint64_t)(symbols * symbolUs);
+
+  }
+}
+
+uint8_t SX127xEmu::readReg(uint8_t addr) {
+  if(addr == RADIOLIB_SX127X_REG_FIFO) {
+    return(this->fifo[this->regs[RADIOLIB_SX127X_REG_FIFO_ADDR_PTR]++]);
+  }
+
+  if(this->isLoRa() && (addr == RADIOLIB_SX127X_REG_RSSI_WIDEBAND)) {
+    // deterministic pseudo-random numbers, so that runs are reproducible
+    this->rng = this->rng * 1103515245UL + 12345UL;
+    return((this->rng >> 16) & 0xFF);
+  }
+
+  return(this->regs[addr]);
+}
+
+void SX127xEmu::writeReg(uint8_t addr, uint8_t val) {
+  // FSK/OOK registers are only stored, so that direct mode transmissions can be configured
+  if(!this->isLoRa() && (addr != RADIOLIB_SX127X_REG_FIFO) && (addr != RADIOLIB_SX127X_REG_OP_MODE)) {
+    if(addr != RADIOLIB_SX127X_REG_VERSION) {
+      this->regs[addr] = val;
+    }
+    return;
+  }
+
+  switch(addr) {
+    case RADIOLIB_SX127X_REG_FIFO:
+      this->fifo[this->regs[RADIOLIB_SX127X_REG_FIFO_ADDR_PTR]++] = val;
+      break;
+
+    case RADIOLIB_SX127X_REG_OP_MODE:
+      // the modem can only be changed in sleep mode
+      if(this->getMode() == SX127X_EMU_MODE_SLEEP) {
+        this->regs[addr] = (this->regs[addr] & 0x07) | (val & 0xF8);
+      } else {
+        this->regs[addr] = (this->regs[addr] & 0x87) | (val & 0x78);
+      }
+      this->setMode(val & 0x07);
+      break;
+
+    case RADIOLIB_SX127X_REG_IRQ_FLAGS:
+      this->regs[addr] &= ~val;
+      break;
+
+    case RADIOLIB_SX127X_REG_VERSION:
+    case RADIOLIB_SX127X_REG_RX_NB_BYTES:
+    case RADIOLIB_SX127X_REG_FIFO_RX_CURRENT_ADDR:
+      // read-only
+      break;
+
+    default:
+      this->regs[addr] = val;
+  }
+}
+
+void SX127xEmu::transfer(const uint8_t* out, uint8_t* in, size_t len) {
+  if(this->inReset || (len == 0)) {
+    return;
+  }
+
+  uint8_t addr = out[0] & 0x7F;
+  bool write = out[0] & 0x80;
+  for(size_t i = 1; i < len; i++) {
+    if(write) {
+      this->writeReg(addr, out[i]);
+    } else {
+      in[i] = this->readReg(addr);
+    }
+
+    // burst access increments the address, except for FIFO
+    if(addr != RADIOLIB_SX127X_REG_FIFO) {
+      addr = (addr + 1) & 0x7F;
+    }
+  }
+}
+
+uint32_t SX127xEmu::readPin(uint32_t pin) {
+  uint8_t flags = this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS];
+  uint8_t map = this->regs[RADIOLIB_SX127X_REG_DIO_MAPPING_1];
+  if(pin == this->irq) {
+    // DIO0: 00 - RxDone, 01 - TxDone, 10 - CadDone
+    const uint8_t dio0[] = { RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_DONE, RADIOLIB_SX127X_CLEAR_IRQ_FLAG_TX_DONE, RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DONE, 0 };
+    return((flags & dio0[(map >> 6) & 0x03]) ? SIM_HIGH : SIM_LOW);
+  }
+  if(pin == this->gpio) {
+    // DIO1: 00 - RxTimeout, 01 - FhssChangeChannel, 10 - CadDetected
+    const uint8_t dio1[] = { RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT, RADIOLIB_SX127X_CLEAR_IRQ_FLAG_FHSS_CHANGE_CHANNEL, RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED, 0 };
+    return((flags & dio1[(map >> 4) & 0x03]) ? SIM_HIGH : SIM_LOW);
+  }
+  return(SIM_LOW);
+}
+
+void SX127xEmu::writePin(uint32_t pin, uint32_t level) {
+  if(pin != this->rst) {
+    return;
+  }
+
+  if(level == SIM_LOW) {
+    this->inReset = true;
+  } else if(this->inReset) {
+    this->inReset = false;
+    this->reset();
+  }
+}
+
+uint64_t SX127xEmu::nextEvent() {
+  return((this->txEnd < this->rxTimeout) ? this->txEnd : this->rxTimeout);
+}
+
+void SX127xEmu::process() {
+  uint64_t now = this->hal->now();
+  if(this->txEnd <= now) {
+    this->txEnd = UINT64_MAX;
+    this->regs[RADIOLIB_SX127X_REG_OP_MODE] = (this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0xF8) | SX127X_EMU_MODE_STDBY;
+    this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_TX_DONE);
+  }
+
+  if(this->rxTimeout <= now) {
+    this->rxTimeout = UINT64_MAX;
+    this->regs[RADIOLIB_SX127X_REG_OP_MODE] = (this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0xF8) | SX127X_EMU_MODE_STDBY;
+    this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT);
+  }
+}
+
+void SX127xEmu::airStart(const SimPacket& pkt) {
+  uint8_t mode = this->getMode();
+  if(!this->isLoRa() || this->rxLocked || ((mode != SX127X_EMU_MODE_RXCONT) && (mode != SX127X_EMU_MODE_RXSINGLE))) {
+    return;
+  }
+
+  // the packet can only be received when all parameters match
+  bool invertIQ = this->regs[RADIOLIB_SX127X_REG_INVERT_IQ] & 0x40;
+  if((fabs(pkt.freq - this->freq()) > 1000.0) || (pkt.sf != this->sf()) || (fabs(pkt.bw - this->bw()) > 0.01) || (pkt.invertIQ != invertIQ)) {
+    return;
+  }
+
+  // symbol timeout only applies to preamble detection
+  this->rxLocked = true;
+  this->rxLockStart = pkt.start;
+  this->rxLockSender = pkt.sender;
+  this->rxTimeout = UINT64_MAX;
+}
+
+void SX127xEmu::airEnd(const SimPacket& pkt) {
+  if(!this->rxLocked || (pkt.start != this->rxLockStart) || (pkt.sender != this->rxLockSender)) {
+    return;
+  }
+
+  this->rxLocked = false;
+  uint8_t base = this->regs[RADIOLIB_SX127X_REG_FIFO_RX_BASE_ADDR];
+  for(size_t i = 0; i < pkt.data.size(); i++) {
+    this->fifo[(uint8_t)(base + i)] = pkt.data[i];
+  }
+  this->regs[RADIOLIB_SX127X_REG_FIFO_RX_CURRENT_ADDR] = base;
+  this->regs[RADIOLIB_SX127X_REG_RX_NB_BYTES] = pkt.data.size();
+  this->regs[RADIOLIB_SX127X_REG_HOP_CHANNEL] = pkt.crc ? 0x40 : 0x00;
+
+  // -32 dBm RSSI, 10 dB SNR
+  this->regs[RADIOLIB_SX127X_REG_PKT_SNR_VALUE] = 40;
+  this->regs[RADIOLIB_SX127X_REG_PKT_RSSI_VALUE] = 132;
+  if(this->getMode() == SX127X_EMU_MODE_RXSINGLE) {
+    this->regs[RADIOLIB_SX127X_REG_OP_MODE] = (this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0xF8) | SX127X_EMU_MODE_STDBY;
+  }
+  this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_VALID_HEADER | RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_DONE);
+}
@@ -0,0 +1,45 @@
+#ifndef SX127X_EMU_H
+#define SX127X_EMU_H
+
+#include "SimHal.h"
+
+// register-level emulator of SX1278, LoRa modem only
+// FSK/OOK registers are only stored, which is enough for direct mode transmissions
+// the IRQ pin is DIO0, the GPIO pin is DIO1
+class SX127xEmu : public SimRadio {
+  public:
+    SX127xEmu(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio);
+
+    void transfer(const uint8_t* out, uint8_t* in, size_t len) override;
+    uint32_t readPin(uint32_t pin) override;
+    void writePin(uint32_t pin, uint32_t level) override;
+    uint64_t nextEvent() override;
+    void process() override;
+    void airStart(const SimPacket& pkt) override;
+    void airEnd(const SimPacket& pkt) override;
+
+  private:
+    uint8_t regs[0x80];
+    uint8_t fifo[256];
+    bool inReset = false;
+    uint64_t txEnd = UINT64_MAX;
+    uint64_t rxTimeout = UINT64_MAX;
+    bool rxLocked = false;
+    uint64_t rxLockStart = 0;
+    const SimRadio* rxLockSender = nullptr;
+    uint32_t rng = 0x87654321;
+
+    void reset();
+    uint8_t readReg(uint8_t addr);
+    void writeReg(uint8_t addr, uint8_t val);
+    void setMode(uint8_t mode);
+    uint8_t getMode() const;
+    bool isLoRa() const;
+    void setIrq(uint8_t flags);
+    double freq() const;
+    float bw() const;
+    uint8_t sf() const;
+    uint64_t timeOnAir(size_t len) const;
+};
+
+#endif
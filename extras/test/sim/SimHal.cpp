@@ -0,0 +1,314 @@
+#include "SimHal.h"
+
+#include <math.h>
+#include <string.h>
+#include <thread>
+
+SimHal::SimHal()
+  : RadioLibHal(SIM_INPUT, SIM_OUTPUT, SIM_LOW, SIM_HIGH, SIM_RISING, SIM_FALLING) {
+}
+
+void SimHal::attach(SimRadio* radio) {
+  this->radios.push_back(radio);
+}
+
+void SimHal::transmitPacket(const SimPacket& pkt) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  this->air.push_back(pkt);
+  this->air.back().started = false;
+}
+
+SimRadio* SimHal::findRadio(uint32_t pin) {
+  for(SimRadio* radio : this->radios) {
+    if(radio->owns(pin)) {
+      return(radio);
+    }
+  }
+  return(nullptr);
+}
+
+uint64_t SimHal::nextEvent() {
+  uint64_t next = UINT64_MAX;
+  for(SimRadio* radio : this->radios) {
+    uint64_t t = radio->nextEvent();
+    if(t < next) {
+      next = t;
+    }
+  }
+  for(const SimPacket& pkt : this->air) {
+    uint64_t t = pkt.started ? pkt.end : pkt.start;
+    if(t < next) {
+      next = t;
+    }
+  }
+  if(this->timerCb && (this->timerDeadline < next)) {
+    next = this->timerDeadline;
+  }
+  return(next);
+}
+
+void SimHal::processEvents() {
+  // packets starting or ending now
+  for(size_t i = 0; i < this->air.size(); ) {
+    SimPacket& pkt = this->air[i];
+    if(!pkt.started && (pkt.start <= this->timeUs)) {
+      pkt.started = true;
+      for(SimRadio* radio : this->radios) {
+        if(radio != pkt.sender) {
+          radio->airStart(pkt);
+        }
+      }
+    }
+
+    if(pkt.started && (pkt.end <= this->timeUs)) {
+      SimPacket done = pkt;
+      this->air.erase(this->air.begin() + i);
+      for(SimRadio* radio : this->radios) {
+        if(radio != done.sender) {
+          radio->airEnd(done);
+        }
+      }
+      if(this->onPacket) {
+        this->onPacket(done);
+      }
+      continue;
+    }
+    i++;
+  }
+
+  // internal radio events
+  for(SimRadio* radio : this->radios) {
+    if(radio->nextEvent() <= this->timeUs) {
+      radio->process();
+    }
+  }
+
+  this->checkInterrupts();
+
+  // one-shot timer, cleared before the callback so that it can be restarted from there
+  if(this->timerCb && (this->timerDeadline <= this->timeUs)) {
+    void (*cb)(void) = this->timerCb;
+    this->timerCb = nullptr;
+    cb();
+  }
+}
+
+void SimHal::checkInterrupts() {
+  for(size_t i = 0; i < this->interrupts.size(); i++) {
+    SimInterrupt& irq = this->interrupts[i];
+    uint32_t level = this->digitalRead(irq.pin);
+    bool fire = false;
+    if((level == SIM_HIGH) && (irq.level == SIM_LOW) && (irq.mode == SIM_RISING)) {
+      fire = true;
+    } else if((level == SIM_LOW) && (irq.level == SIM_HIGH) && (irq.mode == SIM_FALLING)) {
+      fire = true;
+    }
+    irq.level = level;
+    if(fire && irq.cb) {
+      irq.cb();
+    }
+  }
+}
+
+void SimHal::advance(uint64_t us) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  uint64_t target = this->timeUs + us;
+  while(true) {
+    uint64_t next = this->nextEvent();
+    if(next > target) {
+      break;
+    }
+    if(next > this->timeUs) {
+      this->timeUs = next;
+    }
+    this->processEvents();
+  }
+
+  // callbacks may have advanced the time already
+  if(this->timeUs < target) {
+    this->timeUs = target;
+  }
+}
+
+void SimHal::pinMode(uint32_t pin, uint32_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void SimHal::digitalWrite(uint32_t pin, uint32_t value) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  SimRadio* radio = this->findRadio(pin);
+  if(radio) {
+    radio->writePin(pin, value);
+  }
+
+  // chip select is tracked per radio, so that SPI transfers can be routed
+  for(SimRadio* r : this->radios) {
+    if(r->cs == pin) {
+      if(value == SIM_LOW) {
+        this->selected = r;
+      } else if(this->selected == r) {
+        this->selected = nullptr;
+      }
+    }
+  }
+}
+
+uint32_t SimHal::digitalRead(uint32_t pin) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  SimRadio* radio = this->findRadio(pin);
+  if(!radio) {
+    return(SIM_LOW);
+  }
+  return(radio->readPin(pin));
+}
+
+void SimHal::attachInterrupt(uint32_t interruptNum, void (*interruptCb)(void), uint32_t mode) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  this->detachInterrupt(interruptNum);
+  SimInterrupt irq = { interruptNum, interruptCb, mode, this->digitalRead(interruptNum) };
+  this->interrupts.push_back(irq);
+}
+
+void SimHal::detachInterrupt(uint32_t interruptNum) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  for(size_t i = 0; i < this->interrupts.size(); i++) {
+    if(this->interrupts[i].pin == interruptNum) {
+      this->interrupts.erase(this->interrupts.begin() + i);
+      return;
+    }
+  }
+}
+
+void SimHal::delay(RadioLibTime_t ms) {
+  this->advance((uint64_t)ms * 1000);
+}
+
+void SimHal::delayMicroseconds(RadioLibTime_t us) {
+  this->advance(us);
+}
+
+RadioLibTime_t SimHal::millis() {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  return(this->timeUs / 1000);
+}
+
+RadioLibTime_t SimHal::micros() {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  return(this->timeUs);
+}
+
+long SimHal::pulseIn(uint32_t pin, uint32_t state, RadioLibTime_t timeout) {
+  uint64_t start = this->now();
+  while(this->digitalRead(pin) == state) {
+    if(this->now() - start > timeout) {
+      return(0);
+    }
+    this->yield();
+  }
+  return(this->now() - start);
+}
+
+void SimHal::spiBegin() {}
+
+void SimHal::spiBeginTransaction() {}
+
+void SimHal::spiTransfer(uint8_t* out, size_t len, uint8_t* in) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  memset(in, 0x00, len);
+  if(this->selected) {
+    this->selected->transfer(out, in, len);
+    this->selected->stats.transactions++;
+    this->selected->stats.bytes += len;
+
+    // the bus is free for other radios while one of them is busy
+    for(SimRadio* radio : this->radios) {
+      if((radio != this->selected) && (radio->gpio != RADIOLIB_NC) && (radio->readPin(radio->gpio) == SIM_HIGH)) {
+        this->stats.overlapped++;
+        break;
+      }
+    }
+  }
+  this->stats.transactions++;
+  this->stats.bytes += len;
+
+  // account for the time on the bus
+  this->advance((len * 8 * 1000000ULL + SIM_SPI_FREQ - 1) / SIM_SPI_FREQ);
+}
+
+void SimHal::spiEndTransaction() {}
+
+void SimHal::spiEnd() {}
+
+void SimHal::yield() {
+  this->advance(SIM_YIELD_US);
+  if(this->threaded) {
+    std::this_thread::yield();
+  }
+}
+
+int16_t SimHal::timerStart(RadioLibTime_t us, void (*cb)(void)) {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  if(!this->timerEnabled) {
+    return(RADIOLIB_ERR_UNSUPPORTED);
+  }
+  this->timerDeadline = this->timeUs + us;
+  this->timerCb = cb;
+  return(RADIOLIB_ERR_NONE);
+}
+
+void SimHal::timerStop() {
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  this->timerCb = nullptr;
+}
+
+void SimHal::spiLock() {
+  this->mutex.lock();
+}
+
+bool SimHal::spiTryLock() {
+  return(this->mutex.try_lock());
+}
+
+void SimHal::spiUnlock() {
+  this->mutex.unlock();
+}
+
+int16_t SimHal::waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) {
+  // other threads only get to run when polling
+  if(this->threaded) {
+    uint64_t start = this->now();
+    while(this->digitalRead(pin) != level) {
+      if(this->now() - start >= timeout) {
+        return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
+      }
+      this->yield();
+    }
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // jump straight to the next event instead of polling
+  std::lock_guard<std::recursive_mutex> guard(this->mutex);
+  uint64_t deadline = this->timeUs + timeout;
+  while(this->digitalRead(pin) != level) {
+    uint64_t next = this->nextEvent();
+    if(next > deadline) {
+      this->advance(deadline - this->timeUs);
+      return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
+    }
+    this->advance((next > this->timeUs) ? (next - this->timeUs) : 0);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+uint64_t SimRadio::loraTimeOnAir(uint8_t sf, float bw, uint8_t cr, uint16_t preamble, bool explicitHeader, bool crc, bool ldro, size_t len) {
+  // see Semtech AN1200.13
+  double tSym = (double)(1UL << sf) / (double)bw;
+  double nPayload = 8.0 * len - 4.0 * sf + 28.0 + (crc ? 16.0 : 0.0) - (explicitHeader ? 0.0 : 20.0);
+  nPayload = ceil(nPayload / (4.0 * (sf - (ldro ? 2 : 0)))) * (cr + 4);
+  if(nPayload < 0) {
+    nPayload = 0;
+  }
+  double nSym = preamble + 4.25 + 8 + nPayload;
+  return((uint64_t)(nSym * tSym * 1000.0));
+}
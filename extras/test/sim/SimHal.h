@@ -0,0 +1,175 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+// include RadioLib
+#include <RadioLib.h>
+
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class SimRadio;
+
+// simulated hardware levels, rising and falling must differ so that edges can be told apart
+#define SIM_INPUT             (0)
+#define SIM_OUTPUT            (1)
+#define SIM_LOW               (0)
+#define SIM_HIGH              (1)
+#define SIM_RISING            (1)
+#define SIM_FALLING           (2)
+
+// SPI clock used to account for the transfer time, in Hz
+#define SIM_SPI_FREQ          (8000000UL)
+
+// time spent in a single call to yield, in microseconds
+#define SIM_YIELD_US          (10)
+
+// a single LoRa packet on air
+struct SimPacket {
+  uint64_t start = 0;
+  uint64_t end = 0;
+  double freq = 0;
+  uint8_t sf = 0;
+  float bw = 0;
+  bool crc = false;
+  bool invertIQ = false;
+  std::vector<uint8_t> data;
+  const SimRadio* sender = nullptr;
+
+  // internal medium state
+  bool started = false;
+};
+
+// SPI and timing statistics
+struct SimStats {
+  uint64_t transactions = 0;
+  uint64_t bytes = 0;
+
+  // transactions while some other radio was busy
+  uint64_t overlapped = 0;
+};
+
+// simulated Linux hardware abstraction layer
+// the time is virtual: delays return immediately and the emulated radios
+// process everything that would have happened in the meantime,
+// which makes every run reproducible and much faster than real time
+// the simulated hardware is protected by a single lock, which is also the SPI bus lock,
+// so that multiple threads may use it (see the threaded flag)
+class SimHal : public RadioLibHal {
+  public:
+    SimHal();
+
+    // attach an emulated radio, its pins are routed by this HAL
+    void attach(SimRadio* radio);
+
+    // put a packet on air, the start time may be in the future
+    void transmitPacket(const SimPacket& pkt);
+
+    // callback for every packet when it ends, used to emulate the network server
+    std::function<void(const SimPacket&)> onPacket;
+
+    // current virtual time in microseconds
+    uint64_t now() const { std::lock_guard<std::recursive_mutex> guard(this->mutex); return(this->timeUs); }
+
+    // advance the virtual time, processing all events on the way
+    void advance(uint64_t us);
+
+    // SPI statistics of all attached radios
+    SimStats stats;
+
+    void pinMode(uint32_t pin, uint32_t mode) override;
+    void digitalWrite(uint32_t pin, uint32_t value) override;
+    uint32_t digitalRead(uint32_t pin) override;
+    void attachInterrupt(uint32_t interruptNum, void (*interruptCb)(void), uint32_t mode) override;
+    void detachInterrupt(uint32_t interruptNum) override;
+    void delay(RadioLibTime_t ms) override;
+    void delayMicroseconds(RadioLibTime_t us) override;
+    RadioLibTime_t millis() override;
+    RadioLibTime_t micros() override;
+    long pulseIn(uint32_t pin, uint32_t state, RadioLibTime_t timeout) override;
+    void spiBegin() override;
+    void spiBeginTransaction() override;
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override;
+    void spiEndTransaction() override;
+    void spiEnd() override;
+    void yield() override;
+    int16_t waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) override;
+    int16_t timerStart(RadioLibTime_t us, void (*cb)(void)) override;
+    void timerStop() override;
+    void spiLock() override;
+    bool spiTryLock() override;
+    void spiUnlock() override;
+
+    // when cleared, timerStart reports it is unsupported, to compare against blocking operation
+    bool timerEnabled = true;
+
+    // when set, waiting for a pin and yielding advance the time in small steps and let other threads run in between,
+    // otherwise the time jumps straight to the next event, which other threads could not take part in
+    bool threaded = false;
+
+  protected:
+    // time of the next event on air, in the radios or of the timer, UINT64_MAX if there is none
+    uint64_t nextEvent();
+
+  private:
+    mutable std::recursive_mutex mutex;
+    uint64_t timeUs = 0;
+    std::vector<SimRadio*> radios;
+    SimRadio* selected = nullptr;
+    std::vector<SimPacket> air;
+
+    struct SimInterrupt {
+      uint32_t pin;
+      void (*cb)(void);
+      uint32_t mode;
+      uint32_t level;
+    };
+    std::vector<SimInterrupt> interrupts;
+
+    void (*timerCb)(void) = nullptr;
+    uint64_t timerDeadline = 0;
+
+    SimRadio* findRadio(uint32_t pin);
+    void processEvents();
+    void checkInterrupts();
+};
+
+// base class of the emulated radios
+class SimRadio {
+  public:
+    SimRadio(SimHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio)
+      : hal(hal), cs(cs), irq(irq), rst(rst), gpio(gpio) {}
+    virtual ~SimRadio() {}
+
+    // a complete SPI transaction, from CS falling to CS rising
+    virtual void transfer(const uint8_t* out, uint8_t* in, size_t len) = 0;
+
+    // pin access
+    virtual uint32_t readPin(uint32_t pin) = 0;
+    virtual void writePin(uint32_t pin, uint32_t level) { (void)pin; (void)level; }
+
+    // time of the next internal event (end of BUSY, Tx done, Rx timeout), UINT64_MAX if there is none
+    virtual uint64_t nextEvent() = 0;
+
+    // handle internal events that are due
+    virtual void process() = 0;
+
+    // a packet started or ended on air
+    virtual void airStart(const SimPacket& pkt) { (void)pkt; }
+    virtual void airEnd(const SimPacket& pkt) { (void)pkt; }
+
+    bool owns(uint32_t pin) const { return((pin != RADIOLIB_NC) && ((pin == cs) || (pin == irq) || (pin == rst) || (pin == gpio))); }
+
+    // LoRa time-on-air in microseconds
+    static uint64_t loraTimeOnAir(uint8_t sf, float bw, uint8_t cr, uint16_t preamble, bool explicitHeader, bool crc, bool ldro, size_t len);
+
+    SimHal* hal;
+    const uint32_t cs;
+    const uint32_t irq;
+    const uint32_t rst;
+    const uint32_t gpio;
+    SimStats stats;
+};
+
+#endif
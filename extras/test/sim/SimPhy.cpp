@@ -0,0 +1,266 @@
+#include "SimPhy.h"
+
+#include <string.h>
+
+// frequency tolerance when matching packets, in Hz
+#define SIM_PHY_FREQ_TOLERANCE    (1000.0)
+
+SimPhy::SimPhy(FleetHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t seed)
+  : PhysicalLayer(1.0, sizeof(rxBuff) - 1),
+    SimRadio(hal, cs, irq, rst, RADIOLIB_NC),
+    fleet(hal),
+    mod(hal, cs, irq, rst),
+    rng(seed ? seed : 1) {
+}
+
+bool SimPhy::matches(const SimPacket& pkt) const {
+  double diff = pkt.freq - (double)this->freq * 1000000.0;
+  return((diff < SIM_PHY_FREQ_TOLERANCE) && (diff > -SIM_PHY_FREQ_TOLERANCE) &&
+         (pkt.sf == this->sf) && (pkt.bw == this->bw) && (pkt.invertIQ == this->iq));
+}
+
+void SimPhy::setMode(Mode mode) {
+  if((mode == MODE_RX) != (this->mode == MODE_RX)) {
+    this->fleet->listen(this, mode == MODE_RX);
+  }
+  this->mode = mode;
+}
+
+int16_t SimPhy::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  int16_t state = this->startTransmit(data, len, addr);
+  RADIOLIB_ASSERT(state);
+  this->mod.hal->delayMicroseconds(this->txEnd - this->fleet->now());
+  return(this->finishTransmit());
+}
+
+int16_t SimPhy::sleep() {
+  return(this->standby());
+}
+
+int16_t SimPhy::standby() {
+  this->setMode(MODE_STANDBY);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::standby(uint8_t mode) {
+  (void)mode;
+  return(this->standby());
+}
+
+int16_t SimPhy::startReceive() {
+  return(this->startReceive(0, 0, 0, 0));
+}
+
+int16_t SimPhy::startReceive(uint32_t timeout, uint32_t irqFlags, uint32_t irqMask, size_t len) {
+  (void)irqFlags;
+  (void)irqMask;
+  (void)len;
+  this->rxStart = this->fleet->now();
+  this->rxTimeout = timeout ? (this->rxStart + timeout) : 0;
+  this->rxLocked = false;
+  this->rxDone = false;
+  this->setMode(MODE_RX);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  (void)addr;
+  if(len >= sizeof(this->rxBuff)) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+
+  // LoRaWAN uplinks have CRC, downlinks (sent with inverted IQ) do not
+  SimPacket pkt;
+  pkt.start = this->fleet->now();
+  pkt.end = pkt.start + this->getTimeOnAir(len);
+  pkt.freq = (double)this->freq * 1000000.0;
+  pkt.sf = this->sf;
+  pkt.bw = this->bw;
+  pkt.crc = !this->iq;
+  pkt.invertIQ = this->iq;
+  pkt.data.assign(data, data + len);
+  pkt.sender = this;
+  this->fleet->transmitPacket(pkt);
+
+  this->txEnd = pkt.end;
+  this->setMode(MODE_TX);
+  this->packetsSent++;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::finishTransmit() {
+  return(this->standby());
+}
+
+int16_t SimPhy::readData(uint8_t* data, size_t len) {
+  if(!this->rxDone) {
+    return(RADIOLIB_ERR_RX_TIMEOUT);
+  }
+  if((len == 0) || (len > this->rxLen)) {
+    len = this->rxLen;
+  }
+  memcpy(data, this->rxBuff, len);
+  return(this->standby());
+}
+
+int16_t SimPhy::setFrequency(float freq) {
+  this->freq = freq;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::setDataShaping(uint8_t sh) {
+  (void)sh;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::setEncoding(uint8_t encoding) {
+  (void)encoding;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::invertIQ(bool enable) {
+  this->iq = enable;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::setOutputPower(int8_t power) {
+  int16_t state = this->checkOutputPower(power, NULL);
+  RADIOLIB_ASSERT(state);
+  this->power = power;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::checkOutputPower(int8_t power, int8_t* clipped) {
+  // same range as SX1262
+  if(clipped) {
+    *clipped = RADIOLIB_MAX(-9, RADIOLIB_MIN(22, power));
+  }
+  RADIOLIB_CHECK_RANGE(power, -9, 22, RADIOLIB_ERR_INVALID_OUTPUT_POWER);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::setSyncWord(uint8_t* sync, size_t len) {
+  (void)sync;
+  (void)len;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::setPreambleLength(size_t len) {
+  this->preamble = len;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::setDataRate(DataRate_t dr) {
+  int16_t state = this->checkDataRate(dr);
+  RADIOLIB_ASSERT(state);
+  this->sf = dr.lora.spreadingFactor;
+  this->bw = dr.lora.bandwidth;
+  this->cr = dr.lora.codingRate;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t SimPhy::checkDataRate(DataRate_t dr) {
+  // LoRa only, FSK data rates are rejected
+  RADIOLIB_CHECK_RANGE(dr.lora.spreadingFactor, 5, 12, RADIOLIB_ERR_INVALID_SPREADING_FACTOR);
+  RADIOLIB_CHECK_RANGE(dr.lora.bandwidth, 7.8f, 500.0f, RADIOLIB_ERR_INVALID_BANDWIDTH);
+  RADIOLIB_CHECK_RANGE(dr.lora.codingRate, 5, 8, RADIOLIB_ERR_INVALID_CODING_RATE);
+  return(RADIOLIB_ERR_NONE);
+}
+
+size_t SimPhy::getPacketLength(bool update) {
+  (void)update;
+  return(this->rxLen);
+}
+
+float SimPhy::getRSSI() {
+  return(-80.0);
+}
+
+float SimPhy::getSNR() {
+  return(10.0);
+}
+
+RadioLibTime_t SimPhy::getTimeOnAir(size_t len) {
+  bool ldro = ((double)(1UL << this->sf) / this->bw) >= 16.0;
+  return(SimRadio::loraTimeOnAir(this->sf, this->bw, this->cr - 4, this->preamble, true, !this->iq, ldro, len));
+}
+
+RadioLibTime_t SimPhy::calculateRxTimeout(RadioLibTime_t timeoutUs) {
+  // the timeout passed to startReceive is in microseconds already
+  return(timeoutUs);
+}
+
+int16_t SimPhy::irqRxDoneRxTimeout(uint32_t &irqFlags, uint32_t &irqMask) {
+  // there are no IRQ registers, the IRQ pin covers both
+  irqFlags = 0;
+  irqMask = 0;
+  return(RADIOLIB_ERR_NONE);
+}
+
+bool SimPhy::isRxTimeout() {
+  return((this->mode == MODE_RX) && !this->rxLocked && !this->rxDone && (this->rxTimeout != 0) && (this->fleet->now() >= this->rxTimeout));
+}
+
+int16_t SimPhy::scanChannel() {
+  return(RADIOLIB_CHANNEL_FREE);
+}
+
+uint8_t SimPhy::randomByte() {
+  // xorshift32, seeded per node so that every run is the same
+  this->rng ^= this->rng << 13;
+  this->rng ^= this->rng >> 17;
+  this->rng ^= this->rng << 5;
+  return(this->rng & 0xFF);
+}
+
+Module* SimPhy::getMod() {
+  return(&this->mod);
+}
+
+void SimPhy::transfer(const uint8_t* out, uint8_t* in, size_t len) {
+  (void)out;
+  (void)in;
+  (void)len;
+}
+
+uint32_t SimPhy::readPin(uint32_t pin) {
+  if(pin != this->irq) {
+    return(SIM_LOW);
+  }
+
+  // evaluated on demand, so the radio never has to be woken up by the HAL
+  bool level = false;
+  if(this->mode == MODE_TX) {
+    level = (this->fleet->now() >= this->txEnd);
+  } else if(this->mode == MODE_RX) {
+    level = this->rxDone || this->isRxTimeout();
+  }
+  return(level ? SIM_HIGH : SIM_LOW);
+}
+
+uint64_t SimPhy::nextEvent() {
+  return(UINT64_MAX);
+}
+
+void SimPhy::process() {
+}
+
+void SimPhy::airStart(const SimPacket& pkt) {
+  // lock onto the first matching packet whose preamble starts while the window is open
+  if((this->mode != MODE_RX) || this->rxLocked || this->rxDone || this->isRxTimeout() || !this->matches(pkt)) {
+    return;
+  }
+  this->rxLocked = true;
+  this->rxStart = pkt.start;
+}
+
+void SimPhy::airEnd(const SimPacket& pkt) {
+  if((this->mode != MODE_RX) || !this->rxLocked || (pkt.start != this->rxStart) || !this->matches(pkt)) {
+    return;
+  }
+  this->rxLen = RADIOLIB_MIN(pkt.data.size(), sizeof(this->rxBuff));
+  memcpy(this->rxBuff, pkt.data.data(), this->rxLen);
+  this->rxLocked = false;
+  this->rxDone = true;
+  this->packetsReceived++;
+}
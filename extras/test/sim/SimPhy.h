@@ -0,0 +1,90 @@
+#ifndef SIM_PHY_H
+#define SIM_PHY_H
+
+#include "FleetHal.h"
+
+// packet-level LoRa radio for the fleet simulator
+// unlike the register-level emulators, there is no SPI traffic at all:
+// packets go straight to the simulated medium, which makes thousands of nodes cheap to run
+// the IRQ pin is high once transmission is done, a packet was received or the Rx window timed out
+class SimPhy : public PhysicalLayer, public SimRadio {
+  public:
+    SimPhy(FleetHal* hal, uint32_t cs, uint32_t irq, uint32_t rst, uint32_t seed);
+
+    // PhysicalLayer
+    int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0) override;
+    int16_t sleep() override;
+    int16_t standby() override;
+    int16_t standby(uint8_t mode) override;
+    int16_t startReceive() override;
+    int16_t startReceive(uint32_t timeout, uint32_t irqFlags, uint32_t irqMask, size_t len) override;
+    int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0) override;
+    int16_t finishTransmit() override;
+    int16_t readData(uint8_t* data, size_t len) override;
+    int16_t setFrequency(float freq) override;
+    int16_t setDataShaping(uint8_t sh) override;
+    int16_t setEncoding(uint8_t encoding) override;
+    int16_t invertIQ(bool enable) override;
+    int16_t setOutputPower(int8_t power) override;
+    int16_t checkOutputPower(int8_t power, int8_t* clipped) override;
+    int16_t setSyncWord(uint8_t* sync, size_t len) override;
+    int16_t setPreambleLength(size_t len) override;
+    int16_t setDataRate(DataRate_t dr) override;
+    int16_t checkDataRate(DataRate_t dr) override;
+    size_t getPacketLength(bool update = true) override;
+    float getRSSI() override;
+    float getSNR() override;
+    RadioLibTime_t getTimeOnAir(size_t len) override;
+    RadioLibTime_t calculateRxTimeout(RadioLibTime_t timeoutUs) override;
+    int16_t irqRxDoneRxTimeout(uint32_t &irqFlags, uint32_t &irqMask) override;
+    bool isRxTimeout() override;
+    int16_t scanChannel() override;
+    uint8_t randomByte() override;
+    Module* getMod() override;
+
+    // SimRadio
+    void transfer(const uint8_t* out, uint8_t* in, size_t len) override;
+    uint32_t readPin(uint32_t pin) override;
+    uint64_t nextEvent() override;
+    void process() override;
+    void airStart(const SimPacket& pkt) override;
+    void airEnd(const SimPacket& pkt) override;
+
+    // statistics
+    uint32_t packetsSent = 0;
+    uint32_t packetsReceived = 0;
+
+  private:
+    enum Mode { MODE_STANDBY, MODE_TX, MODE_RX };
+
+    FleetHal* fleet;
+    Module mod;
+    Mode mode = MODE_STANDBY;
+
+    // modulation
+    float freq = 868.1;
+    uint8_t sf = 9;
+    float bw = 125.0;
+    uint8_t cr = 5;
+    int8_t power = 14;
+    bool iq = false;
+    size_t preamble = 8;
+
+    // transmission
+    uint64_t txEnd = 0;
+
+    // reception, a timeout of 0 means the window stays open until a packet is received
+    uint64_t rxTimeout = 0;
+    bool rxLocked = false;
+    bool rxDone = false;
+    uint64_t rxStart = 0;
+    uint8_t rxBuff[256];
+    size_t rxLen = 0;
+
+    uint32_t rng;
+
+    bool matches(const SimPacket& pkt) const;
+    void setMode(Mode mode);
+};
+
+#endif
@@ -0,0 +1,237 @@
+/*
+  RadioLib multi-node LoRaWAN simulator
+
+  Runs thousands of LoRaWANNode instances on a single host against
+  packet-level mock radios and the minimal network server used by the benchmark.
+  Every node is a coroutine and the time is virtual, so that Rx delays,
+  duty cycle limits and ADR backoff all run much faster than real time,
+  while the nodes still share the medium and interleave exactly as they would in the field.
+  The run fails if any node does not join, or if any uplink returns an error.
+
+  Usage:
+    radiolib-fleet [--nodes <n>] [--uplinks <n>] [--interval <s>] [--confirmed <n>] [--stack <bytes>]
+
+    --nodes <n>       number of simulated nodes (default 1000)
+    --uplinks <n>     number of uplinks sent by each node after joining (default 16)
+    --interval <s>    minimum interval between uplinks in seconds (default 300)
+    --confirmed <n>   send every n-th uplink as confirmed, 0 to only send unconfirmed (default 8)
+    --stack <bytes>   stack allocated to each node (default 16384)
+*/
+
+// include the library
+#include <RadioLib.h>
+
+#include "FleetHal.h"
+#include "SimPhy.h"
+#include "LoRaWANServer.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// pins of the first node, each node takes the next block
+#define FLEET_PIN_BASE          (1000)
+#define FLEET_PINS_PER_NODE     (4)
+
+// LoRaWAN credentials of the simulated devices, DevEUI is incremented for each node
+#define FLEET_JOIN_EUI          (0x0000000000000000ULL)
+#define FLEET_DEV_EUI           (0x70B3D57ED0100000ULL)
+static uint8_t fleetKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                                0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+// join attempts and the delay between them
+#define FLEET_JOIN_ATTEMPTS     (16)
+#define FLEET_JOIN_BACKOFF_MS   (15000)
+
+// time between two nodes starting to join, spreads the initial joins like a staggered power-up
+#define FLEET_START_SPACING_MS  (200)
+
+// stop even if some nodes did not finish, in virtual microseconds (30 days)
+#define FLEET_TIME_LIMIT_US     (30ULL*24*3600*1000000)
+
+static uint8_t payload[] = "RadioLib fleet";
+
+struct FleetConfig {
+  uint32_t nodes = 1000;
+  uint32_t uplinks = 16;
+  uint32_t intervalS = 300;
+  uint32_t confirmed = 8;
+  size_t stack = 16384;
+};
+
+struct FleetNode {
+  std::unique_ptr<SimPhy> phy;
+  std::unique_ptr<LoRaWANNode> node;
+  uint32_t joinAttempts = 0;
+  bool joined = false;
+  uint32_t uplinks = 0;
+  uint32_t acks = 0;
+  uint32_t errors = 0;
+  int16_t lastError = RADIOLIB_ERR_NONE;
+  uint8_t datarate = 0;
+};
+
+// life of a single node: join, then send uplinks within the duty cycle limits
+static void runNode(FleetHal& hal, FleetNode& n, uint32_t id, const FleetConfig& cfg) {
+  hal.delay((RadioLibTime_t)id * FLEET_START_SPACING_MS);
+
+  while(!n.joined && (n.joinAttempts < FLEET_JOIN_ATTEMPTS)) {
+    n.joinAttempts++;
+    int16_t state = n.node->activateOTAA();
+    if(state == RADIOLIB_LORAWAN_NEW_SESSION) {
+      n.joined = true;
+    } else {
+      hal.delay(FLEET_JOIN_BACKOFF_MS + n.phy->random(FLEET_JOIN_BACKOFF_MS));
+    }
+  }
+  if(!n.joined) {
+    return;
+  }
+
+  for(uint32_t i = 0; i < cfg.uplinks; i++) {
+    // random jitter keeps nodes from settling into lockstep
+    RadioLibTime_t wait = (RadioLibTime_t)cfg.intervalS * 1000 + n.phy->random(cfg.intervalS * 100 + 1);
+    RadioLibTime_t dutyCycle = n.node->timeUntilUplink();
+    hal.delay((dutyCycle > wait) ? dutyCycle : wait);
+
+    bool confirmed = (cfg.confirmed > 0) && ((i % cfg.confirmed) == (cfg.confirmed - 1));
+    uint8_t down[256];
+    size_t lenDown = 0;
+    LoRaWANEvent_t eventUp;
+    LoRaWANEvent_t eventDown;
+    memset(&eventUp, 0x00, sizeof(eventUp));
+    memset(&eventDown, 0x00, sizeof(eventDown));
+    int16_t state = n.node->sendReceive(payload, sizeof(payload), 1, down, &lenDown, confirmed, &eventUp, &eventDown);
+    // most uplinks are not expected to get any reply
+    if((state < RADIOLIB_ERR_NONE) && (state != RADIOLIB_LORAWAN_NO_DOWNLINK)) {
+      n.errors++;
+      n.lastError = state;
+      continue;
+    }
+    n.uplinks++;
+    n.datarate = eventUp.datarate;
+    if(confirmed && eventDown.confirming) {
+      n.acks++;
+    }
+  }
+}
+
+static bool parseArgs(int argc, char** argv, FleetConfig& cfg) {
+  for(int i = 1; i < argc; i++) {
+    if(i + 1 >= argc) {
+      return(false);
+    }
+    unsigned long val = strtoul(argv[i + 1], NULL, 0);
+    if(strcmp(argv[i], "--nodes") == 0) {
+      cfg.nodes = val;
+    } else if(strcmp(argv[i], "--uplinks") == 0) {
+      cfg.uplinks = val;
+    } else if(strcmp(argv[i], "--interval") == 0) {
+      cfg.intervalS = val;
+    } else if(strcmp(argv[i], "--confirmed") == 0) {
+      cfg.confirmed = val;
+    } else if(strcmp(argv[i], "--stack") == 0) {
+      cfg.stack = val;
+    } else {
+      return(false);
+    }
+    i++;
+  }
+  return(cfg.nodes > 0);
+}
+
+int main(int argc, char** argv) {
+  FleetConfig cfg;
+  if(!parseArgs(argc, argv, cfg)) {
+    fprintf(stderr, "Usage: %s [--nodes <n>] [--uplinks <n>] [--interval <s>] [--confirmed <n>] [--stack <bytes>]\n", argv[0]);
+    return(2);
+  }
+
+  FleetHal hal;
+  LoRaWANServer server(&hal);
+  hal.onPacket = [&server](const SimPacket& pkt) { server.handle(pkt); };
+
+  std::vector<FleetNode> nodes(cfg.nodes);
+  for(uint32_t i = 0; i < cfg.nodes; i++) {
+    FleetNode& n = nodes[i];
+    uint32_t pin = FLEET_PIN_BASE + i * FLEET_PINS_PER_NODE;
+    n.phy.reset(new SimPhy(&hal, pin, pin + 1, pin + 2, i + 1));
+    hal.attachPhy(n.phy.get());
+    n.node.reset(new LoRaWANNode(n.phy.get(), &EU868));
+    n.node->beginOTAA(FLEET_JOIN_EUI, FLEET_DEV_EUI + i, fleetKey, fleetKey);
+    server.addDevice(FLEET_JOIN_EUI, FLEET_DEV_EUI + i, fleetKey);
+    hal.spawn([&hal, &n, i, &cfg]() { runNode(hal, n, i, cfg); }, cfg.stack);
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+  hal.run(FLEET_TIME_LIMIT_US);
+  auto wallEnd = std::chrono::steady_clock::now();
+  double wallS = std::chrono::duration_cast<std::chrono::microseconds>(wallEnd - wallStart).count() / 1000000.0;
+  double virtualS = hal.now() / 1000000.0;
+
+  // totals over all nodes
+  uint32_t joined = 0, joinAttempts = 0, uplinks = 0, acks = 0, errors = 0;
+  uint32_t datarates[16] = { 0 };
+  std::map<int16_t, uint32_t> lastErrors;
+  for(const FleetNode& n : nodes) {
+    joined += n.joined;
+    joinAttempts += n.joinAttempts;
+    uplinks += n.uplinks;
+    acks += n.acks;
+    errors += n.errors;
+    if(n.errors) {
+      lastErrors[n.lastError]++;
+    }
+    if(n.joined && n.uplinks) {
+      datarates[n.datarate & 0x0F]++;
+    }
+  }
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("nodes                      %u (%u still running)\n", cfg.nodes, (unsigned)hal.running());
+  printf("virtual time [s]           %.1f\n", virtualS);
+  printf("wall time [s]              %.3f (%.0fx real time)\n", wallS, (wallS > 0) ? (virtualS / wallS) : 0);
+  printf("joins                      %u of %u attempts (server %u)\n", joined, joinAttempts, server.joins);
+  printf("joins/s                    %.2f virtual, %.0f wall\n", joined / virtualS, (wallS > 0) ? (joined / wallS) : 0);
+  printf("uplinks                    %u, %u errors (server %u)\n", uplinks, errors, server.uplinks);
+  printf("uplinks/s                  %.2f virtual, %.0f wall\n", uplinks / virtualS, (wallS > 0) ? (uplinks / wallS) : 0);
+  if(!lastErrors.empty()) {
+    printf("last error of each node    ");
+    for(const auto& it : lastErrors) {
+      printf(" %d: %u", it.first, it.second);
+    }
+    printf("\n");
+  }
+  printf("confirmed acknowledged     %u (server downlinks %u)\n", acks, server.downlinks);
+  printf("final uplink data rate    ");
+  for(int dr = 0; dr < 16; dr++) {
+    if(datarates[dr]) {
+      printf(" DR%d: %u", dr, datarates[dr]);
+    }
+  }
+  printf("\n");
+  printf("memory per node [B]        LoRaWANNode %zu, radio %zu, stack %zu avg / %zu max of %zu\n",
+    sizeof(LoRaWANNode), sizeof(SimPhy), hal.stackTotal() / cfg.nodes, hal.stackMax(), cfg.stack);
+  printf("max RSS per node [B]       %llu\n", (unsigned long long)usage.ru_maxrss * 1024 / cfg.nodes);
+
+  if(hal.stackMax() > cfg.stack * 3 / 4) {
+    fprintf(stderr, "WARNING: nodes used %zu of %zu bytes of stack, increase --stack\n", hal.stackMax(), cfg.stack);
+  }
+  if(joined != cfg.nodes) {
+    fprintf(stderr, "FAILED: %u nodes did not join\n", cfg.nodes - joined);
+    return(1);
+  }
+  if(errors != 0) {
+    fprintf(stderr, "FAILED: %u uplinks returned an error\n", errors);
+    return(1);
+  }
+  return(0);
+}
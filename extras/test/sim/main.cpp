@@ -0,0 +1,714 @@
+/*
+  RadioLib host-side benchmark
+
+  Runs the library against emulated SX1262 and SX1276 radios
+  on a simulated HAL with virtual time, and reports SPI traffic
+  and timing for the most common operations. Since the time is virtual,
+  SPI counts and virtual time are fully reproducible, which allows
+  regressions to be caught in CI without any hardware.
+
+  The session restore benchmarks wake up a joined node SIM_RESTORE_REPEAT times,
+  once from the MAC state snapshot and once by replaying the MAC commands.
+  Replaying the commands reconfigures the radio, restoring the snapshot does not.
+
+  The firmware update benchmarks stream a generated image of the same size as the LR1110 firmware
+  to an emulated LR1110 bootloader, once from the start and once resuming an update
+  that was interrupted half way through by power loss.
+
+  The WiFi benchmarks read the results of a scan from an emulated LR1110, one result per command
+  and in bulk, with and without merging results from the same MAC address.
+
+  The RTTY benchmarks send a short text from an SX1262 and an SX1276 in direct mode.
+  Every symbol is a single frequency change, so they show the SPI cost of retuning.
+
+  The SSTV benchmark sends one Martin 1 line from an SX1276 in direct mode and checks
+  that the line did not drift from its nominal length.
+
+  The same benchmarks are also built as radiolib-sim-cache, with the shadow register cache
+  enabled (RADIOLIB_SPI_CACHE). When run against the baseline of the uncached build,
+  it also reports the cache hit rate and the SPI traffic saved by the cache.
+
+  As radiolib-sim-metrics, they are built with SPI metrics enabled (RADIOLIB_SPI_METRICS)
+  and scratch buffers as small as on low-end platforms. Each benchmark then fails
+  if the metrics of any module disagree with the transactions and bytes seen on the simulated bus,
+  or with the number of heap allocations counted by the module.
+
+  Usage:
+    radiolib-sim [--csv] [--baseline <file>] [--write-baseline <file>]
+
+    --csv                     print results as CSV
+    --baseline <file>         fail if SPI transactions, SPI bytes or virtual time
+                              increased compared to the baseline file
+    --write-baseline <file>   save the results as a new baseline
+*/
+
+// include the library
+#include <RadioLib.h>
+
+#include "SimHal.h"
+#include "SX126xEmu.h"
+#include "SX127xEmu.h"
+#include "LR11x0Emu.h"
+#include "LoRaWANServer.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// pins of the emulated radios
+#define SX1262_CS           (10)
+#define SX1262_DIO1         (11)
+#define SX1262_RST          (12)
+#define SX1262_BUSY         (13)
+#define SX1276_CS           (20)
+#define SX1276_DIO0         (21)
+#define SX1276_RST          (22)
+#define SX1276_DIO1         (23)
+#define LR1110_CS           (30)
+#define LR1110_IRQ          (31)
+#define LR1110_RST          (32)
+#define LR1110_BUSY         (33)
+
+// LoRaWAN credentials of the simulated devices
+#define SIM_JOIN_EUI        (0x0000000000000000ULL)
+#define SIM_DEV_EUI_SX1262  (0x70B3D57ED0000001ULL)
+#define SIM_DEV_EUI_SX1276  (0x70B3D57ED0000002ULL)
+static uint8_t simKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                              0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+static uint8_t payload[] = "RadioLib host-side benchmark payload";
+
+// number of wake-ups in the session restore benchmarks, restoring once is too quick to measure wall time
+#define SIM_RESTORE_REPEAT  (1000)
+
+// size of the firmware image in 32-bit words, same as the LR1110 transceiver firmware
+#define SIM_FIRMWARE_SIZE   (61320)
+
+// number of WiFi scan results reported by the emulated LR1110, every few results repeat the previous MAC address
+#define SIM_WIFI_RESULTS    (32)
+#define SIM_WIFI_REPEAT     (4)
+
+// maximum timing error of an SSTV line in us, one Martin 1 pixel
+#define SIM_SSTV_MAX_ERROR_US   (458)
+
+// persistent buffers saved before the simulated deep sleep
+static uint8_t savedNonces[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+static uint8_t savedSession[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+
+// complete simulated setup: HAL, two radios on a shared medium, LR1110 for firmware updates and a network server
+struct SimEnv {
+  SimHal hal;
+  SX126xEmu emuSX1262;
+  SX127xEmu emuSX1276;
+  LR11x0Emu emuLR1110;
+  Module modSX1262;
+  Module modSX1276;
+  Module modLR1110;
+  SX1262 sx1262;
+  SX1276 sx1276;
+  LR1110 lr1110;
+  LoRaWANServer server;
+  std::unique_ptr<LoRaWANNode> node;
+
+  SimEnv() :
+    emuSX1262(&hal, SX1262_CS, SX1262_DIO1, SX1262_RST, SX1262_BUSY),
+    emuSX1276(&hal, SX1276_CS, SX1276_DIO0, SX1276_RST, SX1276_DIO1),
+    emuLR1110(&hal, LR1110_CS, LR1110_IRQ, LR1110_RST, LR1110_BUSY, SIM_FIRMWARE_SIZE),
+    modSX1262(&hal, SX1262_CS, SX1262_DIO1, SX1262_RST, SX1262_BUSY),
+    modSX1276(&hal, SX1276_CS, SX1276_DIO0, SX1276_RST, SX1276_DIO1),
+    modLR1110(&hal, LR1110_CS, LR1110_IRQ, LR1110_RST, LR1110_BUSY),
+    sx1262(&modSX1262),
+    sx1276(&modSX1276),
+    lr1110(&modLR1110),
+    server(&hal) {
+    hal.attach(&emuSX1262);
+    hal.attach(&emuSX1276);
+    hal.attach(&emuLR1110);
+    hal.onPacket = [this](const SimPacket& pkt) { this->server.handle(pkt); };
+    server.addDevice(SIM_JOIN_EUI, SIM_DEV_EUI_SX1262, simKey);
+    server.addDevice(SIM_JOIN_EUI, SIM_DEV_EUI_SX1276, simKey);
+  }
+};
+
+// a single benchmark: setup is not measured, run is measured, check verifies the result
+struct Benchmark {
+  const char* name;
+  std::function<int16_t(SimEnv&)> setup;
+  std::function<int16_t(SimEnv&)> run;
+  std::function<int16_t(SimEnv&)> check;
+};
+
+struct Result {
+  std::string name;
+  uint64_t transactions;
+  uint64_t bytes;
+  uint64_t virtualUs;
+  uint64_t wallUs;
+  int16_t state;
+  uint64_t cacheHits;
+  uint64_t cacheMisses;
+};
+
+static int16_t beginBoth(SimEnv& env) {
+  int16_t state = env.sx1262.begin();
+  RADIOLIB_ASSERT(state);
+  return(env.sx1276.begin());
+}
+
+static int16_t checkPayload(PhysicalLayer& radio) {
+  uint8_t buff[256] = { 0 };
+  size_t len = radio.getPacketLength();
+  int16_t state = radio.readData(buff, len);
+  RADIOLIB_ASSERT(state);
+  if((len != sizeof(payload)) || (memcmp(buff, payload, len) != 0)) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+// inject packet as if it was sent by some other device
+static void injectPacket(SimEnv& env, uint64_t delayUs) {
+  SimPacket pkt;
+  pkt.start = env.hal.now() + delayUs;
+  pkt.end = pkt.start + SimRadio::loraTimeOnAir(9, 125.0, 3, 8, true, true, false, sizeof(payload));
+  pkt.freq = 434000000.0;
+  pkt.sf = 9;
+  pkt.bw = 125.0;
+  pkt.crc = true;
+  pkt.invertIQ = false;
+  pkt.data.assign(payload, payload + sizeof(payload));
+  env.hal.transmitPacket(pkt);
+}
+
+static int16_t joinSetup(SimEnv& env, PhysicalLayer* radio, uint64_t devEUI) {
+  env.node.reset(new LoRaWANNode(radio, &EU868));
+  env.node->beginOTAA(SIM_JOIN_EUI, devEUI, simKey, simKey);
+  return(RADIOLIB_ERR_NONE);
+}
+
+static int16_t joinRun(SimEnv& env) {
+  int16_t state = env.node->activateOTAA();
+  return((state == RADIOLIB_LORAWAN_NEW_SESSION) ? RADIOLIB_ERR_NONE : state);
+}
+
+static int16_t uplinkRun(SimEnv& env) {
+  uint8_t down[256];
+  size_t lenDown = 0;
+  LoRaWANEvent_t eventDown;
+  memset(&eventDown, 0x00, sizeof(eventDown));
+  int16_t state = env.node->sendReceive(payload, sizeof(payload), 1, down, &lenDown, true, NULL, &eventDown);
+  RADIOLIB_ASSERT(state);
+  return(eventDown.confirming ? RADIOLIB_ERR_NONE : RADIOLIB_LORAWAN_NO_DOWNLINK);
+}
+
+static int16_t receiveSetup(SimEnv& env) {
+  int16_t state = beginBoth(env);
+  RADIOLIB_ASSERT(state);
+  injectPacket(env, 50000);
+  return(state);
+}
+
+static int16_t receiveRun(PhysicalLayer& radio) {
+  uint8_t buff[256] = { 0 };
+  int16_t state = radio.receive(buff, sizeof(payload));
+  RADIOLIB_ASSERT(state);
+  if(memcmp(buff, payload, sizeof(payload)) != 0) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  return(state);
+}
+
+static int16_t uplinkSetup(SimEnv& env, PhysicalLayer& radio, uint64_t devEUI) {
+  int16_t state = joinSetup(env, &radio, devEUI);
+  RADIOLIB_ASSERT(state);
+  return(joinRun(env));
+}
+
+// join, send an uplink and save the buffers, as a node would before going to deep sleep
+static int16_t restoreSetup(SimEnv& env, bool snapshot) {
+  int16_t state = env.sx1262.begin();
+  RADIOLIB_ASSERT(state);
+  state = uplinkSetup(env, env.sx1262, SIM_DEV_EUI_SX1262);
+  RADIOLIB_ASSERT(state);
+  state = uplinkRun(env);
+  RADIOLIB_ASSERT(state);
+  memcpy(savedNonces, env.node->getBufferNonces(), RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  memcpy(savedSession, env.node->getBufferSession(), RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+
+  // drop the MAC state snapshot to force restoring by replaying MAC commands,
+  // the signature is the same 16-bit XOR that LoRaWANNode uses
+  if(!snapshot) {
+    memset(&savedSession[RADIOLIB_LORAWAN_SESSION_STATE_VERSION], 0, RADIOLIB_LORAWAN_SESSION_LAYOUT - RADIOLIB_LORAWAN_SESSION_STATE_VERSION);
+    uint16_t signature = 0;
+    for(size_t i = 0; i < RADIOLIB_LORAWAN_SESSION_SIGNATURE; i += 2) {
+      signature ^= ((uint16_t)savedSession[i] << 8) | ((i + 1 < RADIOLIB_LORAWAN_SESSION_SIGNATURE) ? savedSession[i + 1] : 0);
+    }
+    savedSession[RADIOLIB_LORAWAN_SESSION_SIGNATURE] = signature & 0xFF;
+    savedSession[RADIOLIB_LORAWAN_SESSION_SIGNATURE + 1] = signature >> 8;
+  }
+  return(state);
+}
+
+// wake up from deep sleep: new node instance, restore both buffers and activate
+static int16_t restoreRun(SimEnv& env) {
+  for(int i = 0; i < SIM_RESTORE_REPEAT; i++) {
+    env.node.reset(new LoRaWANNode(&env.sx1262, &EU868));
+    env.node->beginOTAA(SIM_JOIN_EUI, SIM_DEV_EUI_SX1262, simKey, simKey);
+    int16_t state = env.node->setBufferNonces(savedNonces);
+    RADIOLIB_ASSERT(state);
+    state = env.node->setBufferSession(savedSession);
+    RADIOLIB_ASSERT(state);
+    state = env.node->activateOTAA();
+    if(state != RADIOLIB_LORAWAN_SESSION_RESTORED) {
+      return(state);
+    }
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+// generated firmware image, so that no image has to be compiled in
+static uint32_t firmwareWord(uint32_t offset) {
+  return((offset * 0x9E3779B9UL) ^ 0x5A5A5A5AUL);
+}
+
+// progress of the firmware update, as a device would save it to survive power loss
+struct FirmwareStream {
+  uint32_t failAt;
+  uint32_t written;
+};
+
+static int16_t firmwareRead(uint32_t offset, uint32_t* data, size_t len, void* ctx) {
+  FirmwareStream* stream = (FirmwareStream*)ctx;
+  if(offset + len > stream->failAt) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  for(size_t i = 0; i < len; i++) {
+    data[i] = firmwareWord(offset + i);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+static void firmwareProgress(uint32_t written, uint32_t size, void* ctx) {
+  (void)size;
+  ((FirmwareStream*)ctx)->written = written;
+}
+
+static FirmwareStream firmwareStream;
+
+// start an update and lose power half way through, leaving the device in bootloader
+static int16_t firmwareResumeSetup(SimEnv& env) {
+  int16_t state = env.lr1110.begin();
+  RADIOLIB_ASSERT(state);
+  firmwareStream = { SIM_FIRMWARE_SIZE / 2, 0 };
+  state = env.lr1110.updateFirmware(firmwareRead, SIM_FIRMWARE_SIZE, &firmwareStream, 0, firmwareProgress);
+  if(state == RADIOLIB_ERR_NONE) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  env.emuLR1110.powerCycle();
+  firmwareStream.failAt = UINT32_MAX;
+  return(RADIOLIB_ERR_NONE);
+}
+
+static int16_t firmwareRun(SimEnv& env) {
+  return(env.lr1110.updateFirmware(firmwareRead, SIM_FIRMWARE_SIZE, &firmwareStream, firmwareStream.written, firmwareProgress));
+}
+
+// the flash has to contain the whole image in big endian, and the new firmware has to be running
+static int16_t firmwareCheck(SimEnv& env) {
+  for(uint32_t i = 0; i < SIM_FIRMWARE_SIZE; i++) {
+    uint32_t word = firmwareWord(i);
+    const uint8_t* raw = &env.emuLR1110.flash[i*sizeof(uint32_t)];
+    if((raw[0] != (uint8_t)(word >> 24)) || (raw[1] != (uint8_t)(word >> 16)) || (raw[2] != (uint8_t)(word >> 8)) || (raw[3] != (uint8_t)word)) {
+      return(RADIOLIB_ERR_UNKNOWN);
+    }
+  }
+  LR11x0VersionInfo_t info;
+  int16_t state = env.lr1110.getVersionInfo(&info);
+  RADIOLIB_ASSERT(state);
+  return((info.device == RADIOLIB_LR11X0_DEVICE_LR1110) ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_CHIP_NOT_FOUND);
+}
+
+static LR11x0WifiResult_t wifiResults[SIM_WIFI_RESULTS];
+static uint8_t wifiCount = 0;
+
+// scan results with various types, channels and signal strengths
+static int16_t wifiSetup(SimEnv& env) {
+  int16_t state = env.lr1110.begin();
+  RADIOLIB_ASSERT(state);
+  env.emuLR1110.wifiResults.clear();
+  for(uint8_t i = 0; i < SIM_WIFI_RESULTS; i++) {
+    uint8_t mac = ((i % SIM_WIFI_REPEAT) == (SIM_WIFI_REPEAT - 1)) ? (i - 1) : i;
+    env.emuLR1110.wifiResults.push_back({
+      (uint8_t)((i % 3 + 1) | ((i % 8) << 2)), (uint8_t)(0x40 | (i % 13 + 1)), (uint8_t)(40 + (i*7) % 60),
+      0x02, 0x00, 0x5E, 0x10, 0x00, mac
+    });
+  }
+  memset(wifiResults, 0x00, sizeof(wifiResults));
+  wifiCount = 0;
+  return(RADIOLIB_ERR_NONE);
+}
+
+static int16_t wifiSingleRun(SimEnv& env) {
+  int16_t state = env.lr1110.getWifiScanResultsCount(&wifiCount);
+  RADIOLIB_ASSERT(state);
+  for(uint8_t i = 0; (i < wifiCount) && (i < SIM_WIFI_RESULTS); i++) {
+    state = env.lr1110.getWifiScanResult(&wifiResults[i], i, true);
+    RADIOLIB_ASSERT(state);
+  }
+  return(state);
+}
+
+static int16_t wifiBulkRun(SimEnv& env, bool dedup) {
+  wifiCount = SIM_WIFI_RESULTS;
+  return(env.lr1110.getWifiScanResults(wifiResults, &wifiCount, dedup));
+}
+
+// the bulk readout has to decode to the same results as reading them one by one
+static int16_t wifiBulkCheck(SimEnv& env) {
+  if(wifiCount != SIM_WIFI_RESULTS) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  for(uint8_t i = 0; i < wifiCount; i++) {
+    LR11x0WifiResult_t single;
+    memset(&single, 0x00, sizeof(single));
+    int16_t state = env.lr1110.getWifiScanResult(&single, i, true);
+    RADIOLIB_ASSERT(state);
+    if(memcmp(&single, &wifiResults[i], sizeof(single)) != 0) {
+      return(RADIOLIB_ERR_UNKNOWN);
+    }
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+// each MAC address once, with the strongest signal that was received from it
+static int16_t wifiDedupCheck(SimEnv& env) {
+  if(wifiCount != SIM_WIFI_RESULTS - SIM_WIFI_RESULTS / SIM_WIFI_REPEAT) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  for(uint8_t i = 0; i < wifiCount; i++) {
+    float rssi = 0;
+    for(const auto& raw : env.emuLR1110.wifiResults) {
+      if(memcmp(&raw[3], wifiResults[i].mac, RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN) == 0) {
+        rssi = (rssi == 0) ? (raw[2] / -2.0f) : RADIOLIB_MAX(rssi, raw[2] / -2.0f);
+      }
+    }
+    for(uint8_t j = 0; j < i; j++) {
+      if(memcmp(wifiResults[j].mac, wifiResults[i].mac, RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN) == 0) {
+        return(RADIOLIB_ERR_UNKNOWN);
+      }
+    }
+    if(wifiResults[i].rssi != rssi) {
+      return(RADIOLIB_ERR_UNKNOWN);
+    }
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+// text sent in the RTTY benchmarks, 9 symbols per character with 7-bit ASCII and 1 stop bit
+static const char rttyText[] = "HELLO WORLD";
+
+static std::unique_ptr<RTTYClient> rtty;
+
+static int16_t rttySetup(PhysicalLayer* radio) {
+  rtty.reset(new RTTYClient(radio));
+  return(rtty->begin(434.0, 183, 45));
+}
+
+// queue the whole text and wait until the last symbol is sent
+static int16_t rttyRun(SimEnv& env) {
+  (void)env;
+  if(rtty->print(rttyText) != strlen(rttyText)) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  return(rtty->standby());
+}
+
+// Martin 1 test image line, a gradient of all brightness levels in each color
+static uint32_t sstvLine[320];
+static std::unique_ptr<SSTVClient> sstv;
+
+static int16_t sstvSetup(SimEnv& env) {
+  int16_t state = env.sx1276.beginFSK();
+  RADIOLIB_ASSERT(state);
+  sstv.reset(new SSTVClient(&env.sx1276));
+  state = sstv->begin(434.0, Martin1);
+  RADIOLIB_ASSERT(state);
+  for(size_t i = 0; i < sizeof(sstvLine) / sizeof(sstvLine[0]); i++) {
+    uint8_t val = (i * 255) / (sizeof(sstvLine) / sizeof(sstvLine[0]) - 1);
+    sstvLine[i] = ((uint32_t)val << 16) | ((uint32_t)(255 - val) << 8) | val;
+  }
+  sstv->sendHeader();
+  return(RADIOLIB_ERR_NONE);
+}
+
+static int16_t sstvRun(SimEnv& env) {
+  (void)env;
+  sstv->sendLine(sstvLine);
+  return(RADIOLIB_ERR_NONE);
+}
+
+// tones are timed from the start of the line, so the line must end on time within one pixel
+static int16_t sstvCheck(SimEnv& env) {
+  (void)env;
+  int32_t err = sstv->getLineTimingError();
+  if((err < 0) || (err > SIM_SSTV_MAX_ERROR_US)) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+static const std::vector<Benchmark> benchmarks = {
+  { "sx1262_begin", nullptr,
+    [](SimEnv& env) -> int16_t { return(env.sx1262.begin()); }, nullptr },
+  { "sx1276_begin", nullptr,
+    [](SimEnv& env) -> int16_t { return(env.sx1276.begin()); }, nullptr },
+  { "sx1262_transmit",
+    [](SimEnv& env) -> int16_t { int16_t state = beginBoth(env); RADIOLIB_ASSERT(state); return(env.sx1276.startReceive()); },
+    [](SimEnv& env) -> int16_t { return(env.sx1262.transmit(payload, sizeof(payload))); },
+    [](SimEnv& env) -> int16_t { return(checkPayload(env.sx1276)); } },
+  { "sx1276_transmit",
+    [](SimEnv& env) -> int16_t { int16_t state = beginBoth(env); RADIOLIB_ASSERT(state); return(env.sx1262.startReceive()); },
+    [](SimEnv& env) -> int16_t { return(env.sx1276.transmit(payload, sizeof(payload))); },
+    [](SimEnv& env) -> int16_t { return(checkPayload(env.sx1262)); } },
+  { "sx1262_receive", receiveSetup,
+    [](SimEnv& env) -> int16_t { return(receiveRun(env.sx1262)); }, nullptr },
+  { "sx1276_receive", receiveSetup,
+    [](SimEnv& env) -> int16_t { return(receiveRun(env.sx1276)); }, nullptr },
+  { "sx1262_lorawan_join",
+    [](SimEnv& env) -> int16_t { int16_t state = env.sx1262.begin(); RADIOLIB_ASSERT(state); return(joinSetup(env, &env.sx1262, SIM_DEV_EUI_SX1262)); },
+    joinRun, nullptr },
+  { "sx1276_lorawan_join",
+    [](SimEnv& env) -> int16_t { int16_t state = env.sx1276.begin(); RADIOLIB_ASSERT(state); return(joinSetup(env, &env.sx1276, SIM_DEV_EUI_SX1276)); },
+    joinRun, nullptr },
+  { "sx1262_lorawan_uplink",
+    [](SimEnv& env) -> int16_t { int16_t state = env.sx1262.begin(); RADIOLIB_ASSERT(state); return(uplinkSetup(env, env.sx1262, SIM_DEV_EUI_SX1262)); },
+    uplinkRun, nullptr },
+  { "sx1276_lorawan_uplink",
+    [](SimEnv& env) -> int16_t { int16_t state = env.sx1276.begin(); RADIOLIB_ASSERT(state); return(uplinkSetup(env, env.sx1276, SIM_DEV_EUI_SX1276)); },
+    uplinkRun, nullptr },
+  { "sx1262_lorawan_restore_replay",
+    [](SimEnv& env) -> int16_t { return(restoreSetup(env, false)); },
+    restoreRun, uplinkRun },
+  { "sx1262_lorawan_restore_snapshot",
+    [](SimEnv& env) -> int16_t { return(restoreSetup(env, true)); },
+    restoreRun, uplinkRun },
+  { "lr1110_firmware_update",
+    [](SimEnv& env) -> int16_t { firmwareStream = { UINT32_MAX, 0 }; return(env.lr1110.begin()); },
+    firmwareRun, firmwareCheck },
+  { "lr1110_firmware_resume", firmwareResumeSetup, firmwareRun, firmwareCheck },
+  { "lr1110_wifi_results_single", wifiSetup, wifiSingleRun, nullptr },
+  { "lr1110_wifi_results_bulk", wifiSetup,
+    [](SimEnv& env) -> int16_t { return(wifiBulkRun(env, false)); },
+    wifiBulkCheck },
+  { "lr1110_wifi_results_dedup", wifiSetup,
+    [](SimEnv& env) -> int16_t { return(wifiBulkRun(env, true)); },
+    wifiDedupCheck },
+  { "sx1262_rtty",
+    [](SimEnv& env) -> int16_t { int16_t state = env.sx1262.beginFSK(); RADIOLIB_ASSERT(state); return(rttySetup(&env.sx1262)); },
+    rttyRun, nullptr },
+  { "sx1276_rtty",
+    [](SimEnv& env) -> int16_t { int16_t state = env.sx1276.beginFSK(); RADIOLIB_ASSERT(state); return(rttySetup(&env.sx1276)); },
+    rttyRun, nullptr },
+  { "sx1276_sstv_line", sstvSetup, sstvRun, sstvCheck },
+};
+
+// cache statistics of all modules, always 0 unless RADIOLIB_SPI_CACHE is enabled
+static uint64_t cacheHits(SimEnv& env) {
+  return(env.modSX1262.getCacheHits() + env.modSX1276.getCacheHits() + env.modLR1110.getCacheHits());
+}
+
+static uint64_t cacheMisses(SimEnv& env) {
+  return(env.modSX1262.getCacheMisses() + env.modSX1276.getCacheMisses() + env.modLR1110.getCacheMisses());
+}
+
+// SPI metrics of each module have to add up to what its emulator saw on the bus, only checked if RADIOLIB_SPI_METRICS is enabled
+static int16_t checkMetrics(SimEnv& env) {
+  #if RADIOLIB_SPI_METRICS
+  const struct { const char* name; Module* mod; SimRadio* emu; } radios[] = {
+    { "SX1262", &env.modSX1262, &env.emuSX1262 },
+    { "SX1276", &env.modSX1276, &env.emuSX1276 },
+    { "LR1110", &env.modLR1110, &env.emuLR1110 },
+  };
+  int16_t state = RADIOLIB_ERR_NONE;
+  for(const auto& radio : radios) {
+    Module::SPIMetrics_t total = radio.mod->getSPIMetrics();
+    uint64_t bytes = (uint64_t)total.bytesOut + total.bytesIn;
+    if((total.transactions != radio.emu->stats.transactions) || (bytes != radio.emu->stats.bytes) ||
+       (total.heapAllocs != radio.mod->getHeapAllocCount())) {
+      fprintf(stderr, "FAILED: %s metrics report %lu transactions, %llu bytes and %lu heap allocations, ",
+        radio.name, (unsigned long)total.transactions, (unsigned long long)bytes, (unsigned long)total.heapAllocs);
+      fprintf(stderr, "the bus saw %llu transactions and %llu bytes, the module counted %lu heap allocations\n",
+        (unsigned long long)radio.emu->stats.transactions, (unsigned long long)radio.emu->stats.bytes,
+        (unsigned long)radio.mod->getHeapAllocCount());
+      state = RADIOLIB_ERR_UNKNOWN;
+    }
+  }
+  return(state);
+  #else
+  (void)env;
+  return(RADIOLIB_ERR_NONE);
+  #endif
+}
+
+static Result runBenchmark(const Benchmark& bench) {
+  Result res = { bench.name, 0, 0, 0, 0, RADIOLIB_ERR_NONE, 0, 0 };
+  std::unique_ptr<SimEnv> env(new SimEnv());
+  if(bench.setup) {
+    res.state = bench.setup(*env);
+    if(res.state != RADIOLIB_ERR_NONE) {
+      return(res);
+    }
+  }
+
+  SimStats statsStart = env->hal.stats;
+  uint64_t hitsStart = cacheHits(*env);
+  uint64_t missesStart = cacheMisses(*env);
+  uint64_t virtualStart = env->hal.now();
+  auto wallStart = std::chrono::steady_clock::now();
+  res.state = bench.run(*env);
+  auto wallEnd = std::chrono::steady_clock::now();
+  res.transactions = env->hal.stats.transactions - statsStart.transactions;
+  res.bytes = env->hal.stats.bytes - statsStart.bytes;
+  res.virtualUs = env->hal.now() - virtualStart;
+  res.wallUs = std::chrono::duration_cast<std::chrono::microseconds>(wallEnd - wallStart).count();
+  res.cacheHits = cacheHits(*env) - hitsStart;
+  res.cacheMisses = cacheMisses(*env) - missesStart;
+
+  if((res.state == RADIOLIB_ERR_NONE) && bench.check) {
+    res.state = bench.check(*env);
+  }
+  if(res.state == RADIOLIB_ERR_NONE) {
+    res.state = checkMetrics(*env);
+  }
+  return(res);
+}
+
+static bool readBaseline(const char* path, std::vector<Result>& baseline) {
+  FILE* f = fopen(path, "r");
+  if(!f) {
+    return(false);
+  }
+
+  char line[256];
+  while(fgets(line, sizeof(line), f)) {
+    char name[64];
+    unsigned long long tr, by, vt, wt;
+    int st;
+    if(sscanf(line, "%63[^,],%llu,%llu,%llu,%llu,%d", name, &tr, &by, &vt, &wt, &st) == 6) {
+      baseline.push_back({ name, tr, by, vt, wt, (int16_t)st, 0, 0 });
+    }
+  }
+  fclose(f);
+  return(true);
+}
+
+static void printCsv(FILE* f, const std::vector<Result>& results) {
+  fprintf(f, "name,spi_transactions,spi_bytes,virtual_us,wall_us,state\n");
+  for(const Result& res : results) {
+    fprintf(f, "%s,%llu,%llu,%llu,%llu,%d\n", res.name.c_str(),
+      (unsigned long long)res.transactions, (unsigned long long)res.bytes,
+      (unsigned long long)res.virtualUs, (unsigned long long)res.wallUs, res.state);
+  }
+}
+
+int main(int argc, char** argv) {
+  bool csv = false;
+  const char* baselinePath = nullptr;
+  const char* writePath = nullptr;
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if((strcmp(argv[i], "--baseline") == 0) && (i + 1 < argc)) {
+      baselinePath = argv[++i];
+    } else if((strcmp(argv[i], "--write-baseline") == 0) && (i + 1 < argc)) {
+      writePath = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--csv] [--baseline <file>] [--write-baseline <file>]\n", argv[0]);
+      return(2);
+    }
+  }
+
+  std::vector<Result> results;
+  for(const Benchmark& bench : benchmarks) {
+    results.push_back(runBenchmark(bench));
+  }
+
+  if(csv) {
+    printCsv(stdout, results);
+  } else {
+    printf("%-32s %12s %12s %14s %10s %6s\n", "benchmark", "SPI trans.", "SPI bytes", "virtual [us]", "wall [us]", "state");
+    for(const Result& res : results) {
+      printf("%-32s %12llu %12llu %14llu %10llu %6d\n", res.name.c_str(),
+        (unsigned long long)res.transactions, (unsigned long long)res.bytes,
+        (unsigned long long)res.virtualUs, (unsigned long long)res.wallUs, res.state);
+    }
+  }
+
+  int ret = 0;
+  for(const Result& res : results) {
+    if(res.state != RADIOLIB_ERR_NONE) {
+      fprintf(stderr, "FAILED: %s returned %d\n", res.name.c_str(), res.state);
+      ret = 1;
+    }
+  }
+
+  if(writePath) {
+    FILE* f = fopen(writePath, "w");
+    if(!f) {
+      fprintf(stderr, "Failed to open %s\n", writePath);
+      return(1);
+    }
+    printCsv(f, results);
+    fclose(f);
+  }
+
+  if(baselinePath) {
+    std::vector<Result> baseline;
+    if(!readBaseline(baselinePath, baseline)) {
+      fprintf(stderr, "Failed to read baseline %s\n", baselinePath);
+      return(1);
+    }
+
+    // wall time is not compared, it depends on the machine
+    for(const Result& res : results) {
+      for(const Result& base : baseline) {
+        if(res.name != base.name) {
+          continue;
+        }
+        if((res.transactions > base.transactions) || (res.bytes > base.bytes) || (res.virtualUs > base.virtualUs)) {
+          fprintf(stderr, "REGRESSION: %s: %llu/%llu/%llu (transactions/bytes/virtual us), baseline %llu/%llu/%llu\n", res.name.c_str(),
+            (unsigned long long)res.transactions, (unsigned long long)res.bytes, (unsigned long long)res.virtualUs,
+            (unsigned long long)base.transactions, (unsigned long long)base.bytes, (unsigned long long)base.virtualUs);
+          ret = 1;
+        }
+      }
+    }
+
+    #if RADIOLIB_SPI_CACHE
+    // the baseline comes from the uncached build, so the difference is what the cache saved
+    printf("\n%-32s %10s %10s %9s %24s %24s\n", "benchmark", "hits", "misses", "hit rate", "SPI trans. (uncached)", "SPI bytes (uncached)");
+    for(const Result& res : results) {
+      for(const Result& base : baseline) {
+        if(res.name != base.name) {
+          continue;
+        }
+        uint64_t lookups = res.cacheHits + res.cacheMisses;
+        char rate[16] = "-";
+        if(lookups > 0) {
+          snprintf(rate, sizeof(rate), "%.1f%%", 100.0 * (double)res.cacheHits / (double)lookups);
+        }
+        printf("%-32s %10llu %10llu %9s %11llu (%10llu) %11llu (%10llu)\n", res.name.c_str(),
+          (unsigned long long)res.cacheHits, (unsigned long long)res.cacheMisses, rate,
+          (unsigned long long)res.transactions, (unsigned long long)base.transactions,
+          (unsigned long long)res.bytes, (unsigned long long)base.bytes);
+      }
+    }
+    #endif
+  }
+
+  return(ret);
+}
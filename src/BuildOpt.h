@@ -106,6 +106,89 @@
   #define RADIOLIB_STATIC_ARRAY_SIZE   (256)
 #endif
 
+/*
+ * Enable shadow register cache for register-access modules (SX127x, RF69, CC1101, Si443x, nRF24).
+ * Read-modify-write updates by SPIsetRegValue will take the current register value from the cache
+ * instead of reading it over SPI, unless the driver marked the register as volatile.
+ * Note: Disabled by default.
+ */
+#if !defined(RADIOLIB_SPI_CACHE)
+  #define RADIOLIB_SPI_CACHE  (0)
+#endif
+
+// set the number of register addresses covered by the shadow register cache
+#if !defined(RADIOLIB_SPI_CACHE_SIZE)
+  #define RADIOLIB_SPI_CACHE_SIZE   (128)
+#endif
+
+/*
+ * Enable SPI metrics in every Module instance: counters of transactions, bytes, BUSY wait time,
+ * verification retries and heap allocations, both in total and broken down by command/register,
+ * and a trace of the most recent transactions. Unlike RADIOLIB_DEBUG_SPI, this does not print anything,
+ * so it can be left enabled without affecting timing. The data can be retrieved by Module::getSPIMetrics.
+ * Note: Disabled by default.
+ */
+#if !defined(RADIOLIB_SPI_METRICS)
+  #define RADIOLIB_SPI_METRICS  (0)
+#endif
+
+// set the number of commands/registers for which SPI metrics are tracked separately
+#if !defined(RADIOLIB_SPI_METRICS_SIZE)
+  #define RADIOLIB_SPI_METRICS_SIZE   (16)
+#endif
+
+// set the number of most recent SPI transactions kept in the SPI trace
+#if !defined(RADIOLIB_SPI_TRACE_SIZE)
+  #define RADIOLIB_SPI_TRACE_SIZE   (16)
+#endif
+
+/*
+ * Number of symbols that can be queued in RadioLibSymbolScheduler, used by RTTY, FSK4 and Pager.
+ * When the HAL implements a timer, the protocols only wait when the queue is full,
+ * so a larger queue gives the main loop more time between writes, at the cost of RAM.
+ */
+#if !defined(RADIOLIB_SYMBOL_QUEUE_SIZE)
+  #define RADIOLIB_SYMBOL_QUEUE_SIZE   (16)
+#endif
+
+/*
+ * Number of 256-entry lookup tables used by RadioLibCRC, each table takes 1 kB of Flash.
+ * 0 disables the lookup tables (bitwise calculation only), 1 processes one byte per lookup,
+ * 4 or 8 enable slice-by-4/slice-by-8, which is only worth it on hosts with spare Flash.
+ * The tables are generated at compile time for the polynomial and size set below,
+ * CRCs with other polynomials or sizes fall back to bitwise calculation.
+ */
+#if !defined(RADIOLIB_CRC_TABLE_SLICES)
+  #define RADIOLIB_CRC_TABLE_SLICES   (1)
+#endif
+
+// set the CRC polynomial and size (in bits) for which the lookup tables are generated, default is CCITT used by AX.25
+#if !defined(RADIOLIB_CRC_TABLE_POLY)
+  #define RADIOLIB_CRC_TABLE_POLY   (0x1021)
+#endif
+
+#if !defined(RADIOLIB_CRC_TABLE_SIZE)
+  #define RADIOLIB_CRC_TABLE_SIZE   (16)
+#endif
+
+/*
+ * Enable T-table AES-128 encryption: SubBytes, ShiftRows and MixColumns are merged into
+ * a single 1 kB lookup table generated at compile time. Speeds up LoRaWAN encryption and MIC calculation.
+ * Note: Disabled by default to save Flash.
+ */
+#if !defined(RADIOLIB_AES_TTABLES)
+  #define RADIOLIB_AES_TTABLES  (0)
+#endif
+
+/*
+ * Enable AES-NI instructions for AES-128 on x86 hosts (GCC or Clang only).
+ * Support is checked at runtime, CPUs without AES-NI fall back to the software implementation.
+ * Note: Disabled by default.
+ */
+#if !defined(RADIOLIB_AES_NI)
+  #define RADIOLIB_AES_NI  (0)
+#endif
+
 /*
  * Uncomment on boards whose clock runs too slow or too fast
  * Set the value according to the following scheme:
@@ -453,6 +536,70 @@
   #define RADIOLIB_EXCLUDE_STM32WLX (1)
 #endif
 
+/*
+ * Size of the SPI scratch buffers allocated in every Module instance, in bytes.
+ * All SPI transfers are assembled in these buffers, so the default is large enough for the largest FIFO
+ * of all supported modules (256 bytes), plus command, address and status bytes.
+ * Transfers that do not fit will use a temporary heap buffer, or will be rejected in static-only mode.
+ * On low-end platforms, only short transfers fit by default, unless in static-only mode.
+ */
+#if !defined(RADIOLIB_SPI_BUFFER_SIZE)
+  #if defined(RADIOLIB_LOWEND_PLATFORM) && !RADIOLIB_STATIC_ONLY
+    #define RADIOLIB_SPI_BUFFER_SIZE   (64 + 8)
+  #else
+    #define RADIOLIB_SPI_BUFFER_SIZE   (256 + 8)
+  #endif
+#endif
+
+/*
+ * Number of commands for which the typical BUSY duration is tracked by each Module instance.
+ * When the HAL does not implement waitForPin, the typical duration is slept through
+ * before polling the BUSY pin, instead of spinning on it for the whole time. 0 disables the tracking.
+ * Disabled by default on low-end platforms.
+ */
+#if !defined(RADIOLIB_SPI_BUSY_PROFILE_SIZE)
+  #if defined(RADIOLIB_LOWEND_PLATFORM)
+    #define RADIOLIB_SPI_BUSY_PROFILE_SIZE   (0)
+  #else
+    #define RADIOLIB_SPI_BUSY_PROFILE_SIZE   (8)
+  #endif
+#endif
+
+// set the maximum number of register writes that can be queued in a single SPI batch
+#if !defined(RADIOLIB_SPI_BATCH_SIZE)
+  #if defined(RADIOLIB_LOWEND_PLATFORM)
+    #define RADIOLIB_SPI_BATCH_SIZE   (4)
+  #else
+    #define RADIOLIB_SPI_BATCH_SIZE   (16)
+  #endif
+#endif
+
+/*
+ * Precompute the LoRaWAN keystream for the next uplink while waiting for the Rx windows of the previous uplink.
+ * The payload then only has to be XORed with the keystream when the uplink is sent.
+ * Note: Costs 256 bytes of RAM per LoRaWANNode. Enabled by default, except on low-end platforms.
+ */
+#if !defined(RADIOLIB_LORAWAN_KEYSTREAM)
+  #if defined(RADIOLIB_LOWEND_PLATFORM)
+    #define RADIOLIB_LORAWAN_KEYSTREAM  (0)
+  #else
+    #define RADIOLIB_LORAWAN_KEYSTREAM  (1)
+  #endif
+#endif
+
+/*
+ * Precalculate the tones of all 256 SSTV brightness levels when SSTVClient::begin is called.
+ * Note: Costs 512 bytes of RAM per SSTVClient. Enabled by default, except on low-end platforms,
+ * where the tones are interpolated from the lowest and highest brightness while sending.
+ */
+#if !defined(RADIOLIB_SSTV_BRIGHTNESS_TABLE)
+  #if defined(RADIOLIB_LOWEND_PLATFORM)
+    #define RADIOLIB_SSTV_BRIGHTNESS_TABLE  (0)
+  #else
+    #define RADIOLIB_SSTV_BRIGHTNESS_TABLE  (1)
+  #endif
+#endif
+
 // set the global debug mode flag
 #if RADIOLIB_DEBUG_BASIC || RADIOLIB_DEBUG_PROTOCOL || RADIOLIB_DEBUG_SPI
   #define RADIOLIB_DEBUG  (1)
@@ -568,6 +715,24 @@
 #define RADIOLIB_MAX(a,b)				((a)>(b)?(a):(b))
 #define RADIOLIB_ABS(x)         ((x)>0?(x):-(x))
 
+/*!
+  \brief Macros for variables shared between interrupt and main context (e.g. ring buffer indexes).
+  Loads have acquire and stores have release semantics. Only variables that the platform can access
+  in a single instruction (e.g. uint8_t on 8-bit MCUs) are actually atomic. Test-and-set sets a bool flag
+  and returns its previous value, the fence orders a store before a subsequent load of a different variable.
+*/
+#if defined(__GNUC__)
+  #define RADIOLIB_ATOMIC_LOAD(VAR)         __atomic_load_n(&(VAR), __ATOMIC_ACQUIRE)
+  #define RADIOLIB_ATOMIC_STORE(VAR, VAL)   __atomic_store_n(&(VAR), (VAL), __ATOMIC_RELEASE)
+  #define RADIOLIB_ATOMIC_TEST_AND_SET(VAR) __atomic_exchange_n(&(VAR), true, __ATOMIC_SEQ_CST)
+  #define RADIOLIB_ATOMIC_FENCE()           __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+  #define RADIOLIB_ATOMIC_LOAD(VAR)         (VAR)
+  #define RADIOLIB_ATOMIC_STORE(VAR, VAL)   { (VAR) = (VAL); }
+  #define RADIOLIB_ATOMIC_TEST_AND_SET(VAR) ((VAR) ? true : ((VAR) = true, false))
+  #define RADIOLIB_ATOMIC_FENCE()           {}
+#endif
+
 // version definitions
 #define RADIOLIB_VERSION_MAJOR  6
 #define RADIOLIB_VERSION_MINOR  6
@@ -1,5 +1,7 @@
 #include "Hal.h"
 
+#include <string.h>
+
 RadioLibHal::RadioLibHal(const uint32_t input, const uint32_t output, const uint32_t low, const uint32_t high, const uint32_t rising, const uint32_t falling)
     : GpioModeInput(input),
       GpioModeOutput(output),
@@ -33,3 +35,100 @@ void RadioLibHal::yield() {
 uint32_t RadioLibHal::pinToInterrupt(uint32_t pin) {
   return(pin);
 }
+
+int16_t RadioLibHal::waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) {
+  (void)pin;
+  (void)level;
+  (void)timeout;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
+int16_t RadioLibHal::timerStart(RadioLibTime_t us, void (*cb)(void)) {
+  (void)us;
+  (void)cb;
+  return(RADIOLIB_ERR_UNSUPPORTED);
+}
+
+void RadioLibHal::timerStop() {
+
+}
+
+void RadioLibHal::spiLock() {
+
+}
+
+bool RadioLibHal::spiTryLock() {
+  return(true);
+}
+
+void RadioLibHal::spiUnlock() {
+
+}
+
+uint8_t RadioLibHal::spiAcquire() {
+  #if RADIOLIB_SPI_METRICS
+  // only measure the wait when some other thread holds the bus
+  if(!this->spiTryLock()) {
+    RadioLibTime_t start = this->micros();
+    this->spiLock();
+    uint32_t wait = this->micros() - start;
+    this->spiBusMetrics.contended++;
+    this->spiBusMetrics.waitTime += wait;
+    if(wait > this->spiBusMetrics.waitMax) {
+      this->spiBusMetrics.waitMax = wait;
+    }
+  }
+  #else
+  this->spiLock();
+  #endif
+
+  if(this->spiDepth++ == 0) {
+    #if RADIOLIB_SPI_METRICS
+    this->spiBusMetrics.acquisitions++;
+    this->spiHoldStart = this->micros();
+    #endif
+  }
+  return(this->spiDepth);
+}
+
+void RadioLibHal::spiRelease() {
+  if(--this->spiDepth == 0) {
+    #if RADIOLIB_SPI_METRICS
+    this->spiBusMetrics.holdTime += this->micros() - this->spiHoldStart;
+    #endif
+  }
+  this->spiUnlock();
+}
+
+void RadioLibHal::spiTransaction(uint32_t cs, uint8_t* out, size_t len, uint8_t* in) {
+  this->spiAcquire();
+  this->spiBeginTransaction();
+  this->digitalWrite(cs, this->GpioLevelLow);
+  this->spiTransfer(out, len, in);
+  this->digitalWrite(cs, this->GpioLevelHigh);
+  this->spiEndTransaction();
+  #if RADIOLIB_SPI_METRICS
+  this->spiBusMetrics.transactions++;
+  this->spiBusMetrics.bytes += len;
+  #endif
+  this->spiRelease();
+}
+
+RadioLibHal::SPIBusMetrics_t RadioLibHal::getSPIBusMetrics() {
+  SPIBusMetrics_t metrics = { 0, 0, 0, 0, 0, 0, 0 };
+  #if RADIOLIB_SPI_METRICS
+  // copy under the lock, so that the counters are consistent with each other
+  this->spiLock();
+  metrics = this->spiBusMetrics;
+  this->spiUnlock();
+  #endif
+  return(metrics);
+}
+
+void RadioLibHal::resetSPIBusMetrics() {
+  #if RADIOLIB_SPI_METRICS
+  this->spiLock();
+  memset(&this->spiBusMetrics, 0x00, sizeof(this->spiBusMetrics));
+  this->spiUnlock();
+  #endif
+}
@@ -57,6 +57,72 @@ class RadioLibHal {
     */
     RadioLibHal(const uint32_t input, const uint32_t output, const uint32_t low, const uint32_t high, const uint32_t rising, const uint32_t falling);
 
+    // SPI bus arbitration - all modules using the same HAL instance share one SPI bus
+
+    /*!
+      \struct SPIBusMetrics_t
+      \brief Usage and contention counters of the SPI bus shared by all modules using this HAL.
+    */
+    struct SPIBusMetrics_t {
+      /*! \brief Number of times the bus was acquired, nested acquisitions are not counted. */
+      uint32_t acquisitions;
+
+      /*! \brief Number of acquisitions that had to wait for another thread to release the bus. */
+      uint32_t contended;
+
+      /*! \brief Total time spent waiting for the bus, in microseconds. */
+      uint32_t waitTime;
+
+      /*! \brief Longest single wait for the bus, in microseconds. */
+      uint32_t waitMax;
+
+      /*! \brief Total time the bus was held, in microseconds. */
+      uint32_t holdTime;
+
+      /*! \brief Number of SPI transactions. */
+      uint32_t transactions;
+
+      /*! \brief Number of bytes transferred, each byte is sent and received at the same time. */
+      uint32_t bytes;
+    };
+
+    /*!
+      \brief Acquire the SPI bus for the calling thread, waiting for other threads to release it.
+      The bus may be acquired repeatedly by the same thread, it is released only once spiRelease was called
+      the same number of times. Module acquires the bus for each SPI operation, sequences of operations
+      on a single module can be made atomic by acquiring the bus around them. While a module waits for its BUSY pin,
+      the bus is released completely so that other modules can use it. If another thread accessed the same module
+      in the meantime, the sequence fails with RADIOLIB_ERR_SPI_INTERRUPTED.
+      \returns Nesting depth of this acquisition, 1 for the outermost one.
+    */
+    uint8_t spiAcquire();
+
+    /*!
+      \brief Release the SPI bus acquired by spiAcquire.
+    */
+    void spiRelease();
+
+    /*!
+      \brief Perform a single complete SPI transaction with the device selected by the given chip select pin.
+      The bus is held from chip select going low until it goes high again.
+      \param cs Chip select pin of the device.
+      \param out Data that will be transferred from master to slave.
+      \param len Number of bytes to transfer.
+      \param in Data that was transferred from slave to master.
+    */
+    void spiTransaction(uint32_t cs, uint8_t* out, size_t len, uint8_t* in);
+
+    /*!
+      \brief Get SPI bus metrics accumulated since this instance was created or since the last call to resetSPIBusMetrics.
+      \returns SPI bus metrics, all counters are zero if RADIOLIB_SPI_METRICS is disabled.
+    */
+    SPIBusMetrics_t getSPIBusMetrics();
+
+    /*!
+      \brief Clear all SPI bus metrics.
+    */
+    void resetSPIBusMetrics();
+
     // pure virtual methods - these must be implemented by the hardware abstraction for RadioLib to function
 
     /*!
@@ -207,6 +273,67 @@ class RadioLibHal {
       \returns The interrupt number of a given pin.
     */
     virtual uint32_t pinToInterrupt(uint32_t pin);
+
+    /*!
+      \brief Wait for a GPIO pin to reach a given level without polling it in a loop.
+      Platforms with GPIO edge events (e.g. Linux) can implement this so that the CPU sleeps
+      while the radio is busy. The default implementation does nothing and returns RADIOLIB_ERR_UNSUPPORTED,
+      in which case the pin will be polled with digitalRead.
+      \param pin Pin to wait on.
+      \param level Level to wait for (GpioLevelLow or GpioLevelHigh).
+      \param timeout Maximum time to wait in microseconds.
+      \returns RADIOLIB_ERR_NONE when the level was reached, RADIOLIB_ERR_SPI_CMD_TIMEOUT on timeout,
+      or RADIOLIB_ERR_UNSUPPORTED if not implemented on this platform.
+    */
+    virtual int16_t waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout);
+
+    /*!
+      \brief Start a one-shot timer that calls the provided callback once the given time has elapsed.
+      Used to pace symbols of direct mode protocols without busy waiting, see RadioLibSymbolScheduler.
+      Calling this method while the timer is running restarts it. The callback may be called
+      from an interrupt or another thread and may perform SPI transfers. The default implementation
+      does nothing and returns RADIOLIB_ERR_UNSUPPORTED, in which case symbols are paced by polling micros.
+      \param us Time until the callback, in microseconds.
+      \param cb Callback to call.
+      \returns RADIOLIB_ERR_NONE when the timer was started, or RADIOLIB_ERR_UNSUPPORTED if not implemented on this platform.
+    */
+    virtual int16_t timerStart(RadioLibTime_t us, void (*cb)(void));
+
+    /*!
+      \brief Stop the timer started by timerStart, if it is running.
+    */
+    virtual void timerStop();
+
+    /*!
+      \brief Lock the SPI bus, blocking until it is available. Multi-threaded platforms
+      (e.g. Linux with several radios on one SPI controller, or timer callbacks that perform SPI transfers)
+      should implement this with a recursive mutex, i.e. the thread holding the lock must be able to lock it again.
+      The default implementation does nothing, which is sufficient when the bus is only used from one thread.
+    */
+    virtual void spiLock();
+
+    /*!
+      \brief Try to lock the SPI bus without blocking, with the same semantics as spiLock.
+      Only used to count contended acquisitions, the default implementation always succeeds.
+      \returns Whether the lock was acquired.
+    */
+    virtual bool spiTryLock();
+
+    /*!
+      \brief Unlock the SPI bus locked by spiLock or spiTryLock.
+    */
+    virtual void spiUnlock();
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    // nesting depth of the current bus acquisition, only changed by the thread holding the bus
+    uint8_t spiDepth = 0;
+
+    #if RADIOLIB_SPI_METRICS
+    SPIBusMetrics_t spiBusMetrics = { 0, 0, 0, 0, 0, 0, 0 };
+    RadioLibTime_t spiHoldStart = 0;
+    #endif
 };
 
 #endif
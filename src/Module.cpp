@@ -44,6 +44,7 @@ void Module::init() {
   this->hal->init();
   this->hal->pinMode(csPin, this->hal->GpioModeOutput);
   this->hal->digitalWrite(csPin, this->hal->GpioLevelHigh);
+  SPIcacheInvalidate();
   RADIOLIB_DEBUG_BASIC_PRINTLN(RADIOLIB_INFO);
 }
 
@@ -58,6 +59,17 @@ int16_t Module::SPIgetRegValue(uint32_t reg, uint8_t msb, uint8_t lsb) {
   }
 
   uint8_t rawValue = SPIreadRegister(reg);
+
+  // apply pending writes to this register
+  if(this->spiBatchDepth > 0) {
+    for(size_t i = 0; i < this->spiBatchLen; i++) {
+      if(this->spiBatch[i].reg == reg) {
+        rawValue = (rawValue & ~this->spiBatch[i].mask) | this->spiBatch[i].value;
+        break;
+      }
+    }
+  }
+
   uint8_t maskedValue = rawValue & ((0b11111111 << lsb) & (0b11111111 >> (7 - msb)));
   return(maskedValue);
 }
@@ -67,8 +79,15 @@ int16_t Module::SPIsetRegValue(uint32_t reg, uint8_t value, uint8_t msb, uint8_t
     return(RADIOLIB_ERR_INVALID_BIT_RANGE);
   }
 
-  uint8_t currentValue = SPIreadRegister(reg);
   uint8_t mask = ~((0b11111111 << (msb + 1)) | (0b11111111 >> (8 - lsb)));
+  if(this->spiBatchDepth > 0) {
+    return(SPIbatchQueue(reg, value, mask, checkInterval, checkMask));
+  }
+
+  uint8_t currentValue = 0;
+  if(!SPIcacheRead(reg, &currentValue)) {
+    currentValue = SPIreadRegister(reg);
+  }
   uint8_t newValue = (currentValue & ~mask) | (value & mask);
   SPIwriteRegister(reg, newValue);
 
@@ -85,6 +104,7 @@ int16_t Module::SPIsetRegValue(uint32_t reg, uint8_t value, uint8_t msb, uint8_t
         // check passed, we can stop the loop
         return(RADIOLIB_ERR_NONE);
       }
+      SPImetricsRetry(reg);
       #if RADIOLIB_DEBUG_SPI
       readValue = val;
       #endif
@@ -106,9 +126,237 @@ int16_t Module::SPIsetRegValue(uint32_t reg, uint8_t value, uint8_t msb, uint8_t
   #endif
 }
 
+void Module::SPIbatchBegin() {
+  // batching relies on register address auto-increment, which stream-type modules do not have
+  if(this->spiConfig.stream) {
+    return;
+  }
+
+  // batches may be nested, only the outermost one is actually applied
+  if(this->spiBatchDepth++ == 0) {
+    this->spiBatchLen = 0;
+    this->spiBatchState = RADIOLIB_ERR_NONE;
+  }
+}
+
+int16_t Module::SPIbatchFlush() {
+  if(this->spiBatchDepth == 0) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  if(--this->spiBatchDepth > 0) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  int16_t state = SPIbatchApply();
+  if(this->spiBatchState != RADIOLIB_ERR_NONE) {
+    return(this->spiBatchState);
+  }
+  return(state);
+}
+
+int16_t Module::SPIbatchQueue(uint32_t reg, uint8_t value, uint8_t mask, uint8_t checkInterval, uint8_t checkMask) {
+  // find the position of this register in the sorted queue
+  size_t pos = 0;
+  while((pos < this->spiBatchLen) && (this->spiBatch[pos].reg < reg)) {
+    pos++;
+  }
+
+  // merge with a write already queued for the same register
+  if((pos < this->spiBatchLen) && (this->spiBatch[pos].reg == reg)) {
+    SPIBatchOp_t* op = &this->spiBatch[pos];
+    op->value = (op->value & ~mask) | (value & mask);
+    op->mask |= mask;
+    op->checkMask = (op->checkMask & ~mask) | (checkMask & mask);
+    op->checkInterval = RADIOLIB_MAX(op->checkInterval, checkInterval);
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // make room in the queue, errors will be reported when the batch is flushed
+  if(this->spiBatchLen >= RADIOLIB_SPI_BATCH_SIZE) {
+    int16_t state = SPIbatchApply();
+    if(state != RADIOLIB_ERR_NONE) {
+      this->spiBatchState = state;
+    }
+    pos = 0;
+  }
+  for(size_t i = this->spiBatchLen; i > pos; i--) {
+    this->spiBatch[i] = this->spiBatch[i - 1];
+  }
+
+  this->spiBatch[pos].reg = reg;
+  this->spiBatch[pos].value = value & mask;
+  this->spiBatch[pos].mask = mask;
+  this->spiBatch[pos].checkMask = checkMask & mask;
+  this->spiBatch[pos].checkInterval = checkInterval;
+  this->spiBatchLen++;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t Module::SPIbatchApply() {
+  int16_t state = RADIOLIB_ERR_NONE;
+  uint8_t values[RADIOLIB_SPI_BATCH_SIZE];
+  size_t start = 0;
+  while(start < this->spiBatchLen) {
+    // find the run of consecutive register addresses
+    size_t runLen = 1;
+    bool partial = (this->spiBatch[start].mask != 0xFF);
+    while((start + runLen < this->spiBatchLen) && (this->spiBatch[start + runLen].reg == this->spiBatch[start + runLen - 1].reg + 1)) {
+      partial |= (this->spiBatch[start + runLen].mask != 0xFF);
+      runLen++;
+    }
+    SPIBatchOp_t* run = &this->spiBatch[start];
+
+    // read the current values only if some bits have to be preserved and they are not cached
+    if(partial) {
+      bool cached = true;
+      for(size_t i = 0; i < runLen; i++) {
+        if(!SPIcacheRead(run[i].reg, &values[i])) {
+          cached = false;
+          break;
+        }
+      }
+      if(!cached) {
+        SPIreadRegisterBurst(run[0].reg, runLen, values);
+      }
+    }
+
+    // write the whole run at once
+    for(size_t i = 0; i < runLen; i++) {
+      values[i] = partial ? ((values[i] & ~run[i].mask) | run[i].value) : run[i].value;
+    }
+    SPIwriteRegisterBurst(run[0].reg, values, runLen);
+
+    #if RADIOLIB_SPI_PARANOID
+      // verify the whole run at once
+      uint8_t checkInterval = 0;
+      for(size_t i = 0; i < runLen; i++) {
+        checkInterval = RADIOLIB_MAX(checkInterval, run[i].checkInterval);
+      }
+      uint8_t readValues[RADIOLIB_SPI_BATCH_SIZE];
+      bool passed = false;
+      RadioLibTime_t startTime = this->hal->micros();
+      while(!passed && (this->hal->micros() - startTime < (checkInterval * 1000))) {
+        SPIreadRegisterBurst(run[0].reg, runLen, readValues);
+        passed = true;
+        for(size_t i = 0; i < runLen; i++) {
+          if((readValues[i] & run[i].checkMask) != (values[i] & run[i].checkMask)) {
+            SPImetricsRetry(run[i].reg);
+            passed = false;
+            break;
+          }
+        }
+      }
+
+      if(!passed) {
+        RADIOLIB_DEBUG_SPI_PRINTLN("batch verification failed at address 0x%X, length %d", run[0].reg, runLen);
+        state = RADIOLIB_ERR_SPI_WRITE_FAILED;
+      }
+    #endif
+
+    start += runLen;
+  }
+
+  this->spiBatchLen = 0;
+  return(state);
+}
+
+void Module::SPIcacheSetVolatile(const uint8_t* regs, size_t num) {
+  #if RADIOLIB_SPI_CACHE
+    memset(this->spiCacheVolatile, 0, sizeof(this->spiCacheVolatile));
+    for(size_t i = 0; i < num; i++) {
+      if(regs[i] < RADIOLIB_SPI_CACHE_SIZE) {
+        this->spiCacheVolatile[regs[i] / 8] |= (1 << (regs[i] % 8));
+      }
+    }
+    SPIcacheInvalidate();
+  #else
+    (void)regs;
+    (void)num;
+  #endif
+}
+
+void Module::SPIcacheSetAddressMask(uint8_t mask) {
+  #if RADIOLIB_SPI_CACHE
+    this->spiCacheAddrMask = mask;
+    SPIcacheInvalidate();
+  #else
+    (void)mask;
+  #endif
+}
+
+void Module::SPIcacheInvalidate() {
+  #if RADIOLIB_SPI_CACHE
+    memset(this->spiCacheValid, 0, sizeof(this->spiCacheValid));
+  #endif
+}
+
+uint32_t Module::getCacheHits() const {
+  #if RADIOLIB_SPI_CACHE
+    return(this->spiCacheHits);
+  #else
+    return(0);
+  #endif
+}
+
+uint32_t Module::getCacheMisses() const {
+  #if RADIOLIB_SPI_CACHE
+    return(this->spiCacheMisses);
+  #else
+    return(0);
+  #endif
+}
+
+bool Module::SPIcacheRead(uint32_t reg, uint8_t* value) {
+  #if RADIOLIB_SPI_CACHE
+    reg &= this->spiCacheAddrMask;
+    if(this->spiConfig.stream || (reg >= RADIOLIB_SPI_CACHE_SIZE)) {
+      return(false);
+    }
+
+    uint8_t bit = (1 << (reg % 8));
+    if(!(this->spiCacheValid[reg / 8] & bit) || (this->spiCacheVolatile[reg / 8] & bit)) {
+      this->spiCacheMisses++;
+      return(false);
+    }
+
+    *value = this->spiCache[reg];
+    this->spiCacheHits++;
+    return(true);
+  #else
+    (void)reg;
+    (void)value;
+    return(false);
+  #endif
+}
+
+void Module::SPIcacheUpdate(uint32_t reg, const uint8_t* values, size_t num) {
+  #if RADIOLIB_SPI_CACHE
+    // burst access to a volatile register (e.g. FIFO) does not auto-increment the address
+    reg &= this->spiCacheAddrMask;
+    if(this->spiConfig.stream || (reg >= RADIOLIB_SPI_CACHE_SIZE) || (this->spiCacheVolatile[reg / 8] & (1 << (reg % 8)))) {
+      return;
+    }
+
+    for(size_t i = 0; (i < num) && (reg + i < RADIOLIB_SPI_CACHE_SIZE); i++) {
+      uint32_t addr = reg + i;
+      uint8_t bit = (1 << (addr % 8));
+      if(this->spiCacheVolatile[addr / 8] & bit) {
+        continue;
+      }
+      this->spiCache[addr] = values[i];
+      this->spiCacheValid[addr / 8] |= bit;
+    }
+  #else
+    (void)reg;
+    (void)values;
+    (void)num;
+  #endif
+}
+
 void Module::SPIreadRegisterBurst(uint32_t reg, size_t numBytes, uint8_t* inBytes) {
   if(!this->spiConfig.stream) {
     SPItransfer(this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ], reg, NULL, inBytes, numBytes);
+    SPIcacheUpdate(reg, inBytes, numBytes);
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -126,6 +374,7 @@ uint8_t Module::SPIreadRegister(uint32_t reg) {
   uint8_t resp = 0;
   if(!spiConfig.stream) {
     SPItransfer(this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ], reg, NULL, &resp, 1);
+    SPIcacheUpdate(reg, &resp, 1);
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -143,6 +392,7 @@ uint8_t Module::SPIreadRegister(uint32_t reg) {
 void Module::SPIwriteRegisterBurst(uint32_t reg, uint8_t* data, size_t numBytes) {
   if(!spiConfig.stream) {
     SPItransfer(spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE], reg, data, NULL, numBytes);
+    SPIcacheUpdate(reg, data, numBytes);
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -159,6 +409,7 @@ void Module::SPIwriteRegisterBurst(uint32_t reg, uint8_t* data, size_t numBytes)
 void Module::SPIwriteRegister(uint32_t reg, uint8_t data) {
   if(!spiConfig.stream) {
     SPItransfer(spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE], reg, &data, NULL, 1);
+    SPIcacheUpdate(reg, &data, 1);
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -173,15 +424,22 @@ void Module::SPIwriteRegister(uint32_t reg, uint8_t data) {
 }
 
 void Module::SPItransfer(uint16_t cmd, uint32_t reg, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes) {
+  // the scratch buffers are shared by all threads using this module, so the bus is held while they are in use
+  this->hal->spiAcquire();
+
+  #if RADIOLIB_SPI_METRICS
+  RadioLibTime_t metricsStart = this->hal->micros();
+  uint32_t allocStart = this->heapAllocCount;
+  #endif
+
   // prepare the buffers
   size_t buffLen = this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8 + this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR]/8 + numBytes;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffOut[RADIOLIB_STATIC_ARRAY_SIZE];
-    uint8_t buffIn[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* buffOut = new uint8_t[buffLen];
-    uint8_t* buffIn = new uint8_t[buffLen];
-  #endif
+  uint8_t* buffOut = NULL;
+  uint8_t* buffIn = NULL;
+  if(!SPIgetBuffers(buffLen, &buffOut, &buffIn)) {
+    this->hal->spiRelease();
+    return;
+  }
   uint8_t* buffOutPtr = buffOut;
 
   // copy the command
@@ -201,17 +459,18 @@ void Module::SPItransfer(uint16_t cmd, uint32_t reg, uint8_t* dataOut, uint8_t*
   }
 
   // do the transfer
-  this->hal->spiBeginTransaction();
-  this->hal->digitalWrite(this->csPin, this->hal->GpioLevelLow);
-  this->hal->spiTransfer(buffOut, buffLen, buffIn);
-  this->hal->digitalWrite(this->csPin, this->hal->GpioLevelHigh);
-  this->hal->spiEndTransaction();
+  this->hal->spiTransaction(this->csPin, buffOut, buffLen, buffIn);
   
   // copy the data
   if(cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ]) {
     memcpy(dataIn, &buffIn[this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR]/8], numBytes);
   }
 
+  #if RADIOLIB_SPI_METRICS
+  bool write = (cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE]);
+  SPImetricsTransfer(reg, write, buffLen, write ? buffLen : buffLen - numBytes, write ? 0 : numBytes, metricsStart, this->heapAllocCount - allocStart);
+  #endif
+
   // print debug information
   #if RADIOLIB_DEBUG_SPI
     uint8_t* debugBuffPtr = NULL;
@@ -228,62 +487,68 @@ void Module::SPItransfer(uint16_t cmd, uint32_t reg, uint8_t* dataOut, uint8_t*
     RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG();
   #endif
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] buffOut;
-    delete[] buffIn;
-  #endif
+  SPIreleaseBuffers(buffOut, buffIn);
+  this->hal->spiRelease();
 }
 
 int16_t Module::SPIreadStream(uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
+  return(this->SPIreadStream(this->spiConfig, cmd, data, numBytes, waitForGpio, verify));
+}
+
+int16_t Module::SPIreadStream(const SPIConfig_t& config, uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
   uint8_t cmdBuf[2];
   uint8_t* cmdPtr = cmdBuf;
-  for(int8_t i = (int8_t)this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8 - 1; i >= 0; i--) {
+  for(int8_t i = (int8_t)config.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8 - 1; i >= 0; i--) {
     *(cmdPtr++) = (cmd >> 8*i) & 0xFF;
   }
-  return(this->SPIreadStream(cmdBuf, this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8, data, numBytes, waitForGpio, verify));
+
+  return(this->SPItransferStreamVerify(config, cmdBuf, config.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8, false, NULL, data, numBytes, waitForGpio, verify));
 }
 
 int16_t Module::SPIreadStream(uint8_t* cmd, uint8_t cmdLen, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
-  // send the command
-  int16_t state = this->SPItransferStream(cmd, cmdLen, false, NULL, data, numBytes, waitForGpio);
-  RADIOLIB_ASSERT(state);
-
-  #if !RADIOLIB_SPI_PARANOID
-  (void)verify;
-  return(RADIOLIB_ERR_NONE);
-  #else
-
-  // check the status
-  if(verify && (this->spiConfig.checkStatusCb != nullptr)) {
-    state = this->spiConfig.checkStatusCb(this);
-  }
-
-  return(state);
-  #endif
+  return(this->SPItransferStreamVerify(this->spiConfig, cmd, cmdLen, false, NULL, data, numBytes, waitForGpio, verify));
 }
 
 int16_t Module::SPIwriteStream(uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
+  return(this->SPIwriteStream(this->spiConfig, cmd, data, numBytes, waitForGpio, verify));
+}
+
+int16_t Module::SPIwriteStream(const SPIConfig_t& config, uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
   uint8_t cmdBuf[2];
   uint8_t* cmdPtr = cmdBuf;
-  for(int8_t i = (int8_t)this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8 - 1; i >= 0; i--) {
+  for(int8_t i = (int8_t)config.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8 - 1; i >= 0; i--) {
     *(cmdPtr++) = (cmd >> 8*i) & 0xFF;
   }
-  return(this->SPIwriteStream(cmdBuf, this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8, data, numBytes, waitForGpio, verify));
+
+  return(this->SPItransferStreamVerify(config, cmdBuf, config.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8, true, data, NULL, numBytes, waitForGpio, verify));
 }
 
 int16_t Module::SPIwriteStream(uint8_t* cmd, uint8_t cmdLen, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
-  // send the command
-  int16_t state = this->SPItransferStream(cmd, cmdLen, true, data, NULL, numBytes, waitForGpio);
-  RADIOLIB_ASSERT(state);
+  return(this->SPItransferStreamVerify(this->spiConfig, cmd, cmdLen, true, data, NULL, numBytes, waitForGpio, verify));
+}
 
+int16_t Module::SPItransferStreamVerify(const SPIConfig_t& config, const uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio, bool verify) {
   #if !RADIOLIB_SPI_PARANOID
   (void)verify;
-  return(RADIOLIB_ERR_NONE);
+  return(this->SPItransferStream(config, cmd, cmdLen, write, dataOut, dataIn, numBytes, waitForGpio));
   #else
 
+  // the status check must follow the command without any other transfer to this module in between,
+  // the bus is only released while the module is busy, which is detected by SPItransferStream
+  verify = verify && (config.checkStatusCb != nullptr);
+  if(verify) {
+    this->hal->spiAcquire();
+  }
+
+  // send the command
+  int16_t state = this->SPItransferStream(config, cmd, cmdLen, write, dataOut, dataIn, numBytes, waitForGpio);
+
   // check the status
-  if(verify && (this->spiConfig.checkStatusCb != nullptr)) {
-    state = this->spiConfig.checkStatusCb(this);
+  if(verify) {
+    if(state == RADIOLIB_ERR_NONE) {
+      state = config.checkStatusCb(this);
+    }
+    this->hal->spiRelease();
   }
 
   return(state);
@@ -314,92 +579,66 @@ int16_t Module::SPIcheckStream() {
 }
 
 int16_t Module::SPItransferStream(const uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio) {
+  return(this->SPItransferStream(this->spiConfig, cmd, cmdLen, write, dataOut, dataIn, numBytes, waitForGpio));
+}
+
+int16_t Module::SPItransferStream(const SPIConfig_t& config, const uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio) {
+  // commands are identified by their opcode, without any address bytes
+  // status reads on some modules are sent without any command at all
+  uint16_t busyCmd = (cmdLen > 0) ? cmd[0] : 0;
+  if((config.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD] > 8) && (cmdLen > 1)) {
+    busyCmd = ((uint16_t)cmd[0] << 8) | cmd[1];
+  }
+
+  // the scratch buffers are shared by all threads using this module, so the bus is held while they are in use
+  // nested acquisitions mean the caller needs a sequence of transfers without interruption,
+  // the bus is still released while the module is busy and the sequence fails if another thread used the module meanwhile
+  uint8_t depth = this->hal->spiAcquire();
+
+  // ensure GPIO is low
+  int16_t state = SPIwaitReady(busyCmd, config.timeout, depth);
+  if(state != RADIOLIB_ERR_NONE) {
+    this->hal->spiRelease();
+    return(state);
+  }
+
+  // the wait above is already counted as busy time, so the transaction starts only now
+  #if RADIOLIB_SPI_METRICS
+  RadioLibTime_t metricsStart = this->hal->micros();
+  uint32_t allocStart = this->heapAllocCount;
+  #endif
+
   // prepare the output buffer
   size_t buffLen = cmdLen + numBytes;
   if(!write) {
-    buffLen += (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8);
+    buffLen += (config.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8);
   }
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffOut[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* buffOut = new uint8_t[buffLen];
-  #endif
-  uint8_t* buffOutPtr = buffOut;
-
-  // copy the command
-  for(uint8_t n = 0; n < cmdLen; n++) {
-    *(buffOutPtr++) = cmd[n];
+  uint8_t* buffOut = NULL;
+  uint8_t* buffIn = NULL;
+  if(!SPIgetBuffers(buffLen, &buffOut, &buffIn)) {
+    this->hal->spiRelease();
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
   }
 
-  // copy the data
+  // copy the data first, it may have been prepared in the scratch buffer itself
   if(write) {
-    memcpy(buffOutPtr, dataOut, numBytes);
+    memmove(&buffOut[cmdLen], dataOut, numBytes);
   } else {
-    memset(buffOutPtr, this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], numBytes + (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8));
+    memset(&buffOut[cmdLen], config.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], numBytes + (config.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8));
   }
 
-  // ensure GPIO is low
-  if(this->gpioPin == RADIOLIB_NC) {
-    this->hal->delay(50);
-  } else {
-    RadioLibTime_t start = this->hal->millis();
-    while(this->hal->digitalRead(this->gpioPin)) {
-      this->hal->yield();
-      if(this->hal->millis() - start >= this->spiConfig.timeout) {
-        RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO pre-transfer timeout, is it connected?");
-        #if !RADIOLIB_STATIC_ONLY
-          delete[] buffOut;
-        #endif
-        return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
-      }
-    }
+  // copy the command
+  for(uint8_t n = 0; n < cmdLen; n++) {
+    buffOut[n] = cmd[n];
   }
 
-  // prepare the input buffer
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffIn[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* buffIn = new uint8_t[buffLen];
-  #endif
-
   // do the transfer
-  this->hal->spiBeginTransaction();
-  this->hal->digitalWrite(this->csPin, this->hal->GpioLevelLow);
-  this->hal->spiTransfer(buffOut, buffLen, buffIn);
-  this->hal->digitalWrite(this->csPin, this->hal->GpioLevelHigh);
-  this->hal->spiEndTransaction();
-
-  // wait for GPIO to go high and then low
-  if(waitForGpio) {
-    if(this->gpioPin == RADIOLIB_NC) {
-      this->hal->delay(1);
-    } else {
-      this->hal->delayMicroseconds(1);
-      RadioLibTime_t start = this->hal->millis();
-      while(this->hal->digitalRead(this->gpioPin)) {
-        this->hal->yield();
-        if(this->hal->millis() - start >= this->spiConfig.timeout) {
-          RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO post-transfer timeout, is it connected?");
-          #if !RADIOLIB_STATIC_ONLY
-            delete[] buffOut;
-            delete[] buffIn;
-          #endif
-          return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
-        }
-      }
-    }
-  }
+  this->hal->spiTransaction(this->csPin, buffOut, buffLen, buffIn);
+  uint32_t sequence = ++this->spiSequence;
 
   // parse status
-  int16_t state = RADIOLIB_ERR_NONE;
-  if((this->spiConfig.parseStatusCb != nullptr) && (numBytes > 0)) {
-    state = this->spiConfig.parseStatusCb(buffIn[this->spiConfig.statusPos]);
-  }
-  
-  // copy the data
-  if(!write) {
-    // skip the status bytes if present
-    memcpy(dataIn, &buffIn[cmdLen + (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8)], numBytes);
+  if((config.parseStatusCb != nullptr) && (numBytes > 0)) {
+    state = config.parseStatusCb(buffIn[config.statusPos]);
   }
 
   // print debug information
@@ -433,14 +672,347 @@ int16_t Module::SPItransferStream(const uint8_t* cmd, uint8_t cmdLen, bool write
     RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG();
   #endif
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] buffOut;
-    delete[] buffIn;
+  // copy the data, the destination may be the scratch buffer itself
+  if(!write) {
+    // skip the status bytes if present
+    memmove(dataIn, &buffIn[cmdLen + (config.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8)], numBytes);
+  }
+
+  // the scratch buffers are no longer needed, other threads may use the bus while the module is busy
+  SPIreleaseBuffers(buffOut, buffIn);
+
+  // wait for GPIO to go high and then low
+  if(waitForGpio) {
+    if(this->gpioPin == RADIOLIB_NC) {
+      SPIreleaseBus(depth);
+      this->hal->delay(1);
+      SPIacquireBus(depth);
+      this->spiLastTransfer = this->hal->millis();
+      SPImetricsBusy(busyCmd, 1000);
+    } else {
+      this->hal->delayMicroseconds(1);
+      if(SPIwaitForGpio(busyCmd, true, config.timeout, depth) != RADIOLIB_ERR_NONE) {
+        RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO post-transfer timeout, is it connected?");
+        state = RADIOLIB_ERR_SPI_CMD_TIMEOUT;
+      }
+    }
+
+    // the caller expects the next transfer to follow this one
+    if((state == RADIOLIB_ERR_NONE) && (depth > 1) && (this->spiSequence != sequence)) {
+      RADIOLIB_DEBUG_BASIC_PRINTLN("Module accessed by another thread while busy");
+      state = RADIOLIB_ERR_SPI_INTERRUPTED;
+    }
+  }
+
+  #if RADIOLIB_SPI_METRICS
+  SPImetricsTransfer(busyCmd, write, buffLen, write ? buffLen : cmdLen, write ? 0 : buffLen - cmdLen, metricsStart, this->heapAllocCount - allocStart);
   #endif
 
+  this->hal->spiRelease();
   return(state);
 }
 
+int16_t Module::SPIwaitReady(uint16_t cmd, RadioLibTime_t timeoutMs, uint8_t depth) {
+  uint32_t sequence = this->spiSequence;
+  while(true) {
+    if(this->gpioPin == RADIOLIB_NC) {
+      // no way to check, so only wait for whatever is left of 50 ms since the previous command
+      RadioLibTime_t elapsed = this->hal->millis() - this->spiLastTransfer;
+      if(elapsed >= 50) {
+        break;
+      }
+      SPIreleaseBus(depth);
+      this->hal->delay(50 - elapsed);
+      SPIacquireBus(depth);
+      SPImetricsBusy(cmd, (50 - elapsed) * 1000UL);
+
+    } else {
+      // the pin is checked while holding the bus, nobody else can make the module busy after that
+      if(!this->hal->digitalRead(this->gpioPin)) {
+        break;
+      }
+      if(SPIwaitForGpio(cmd, false, timeoutMs, depth) != RADIOLIB_ERR_NONE) {
+        RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO pre-transfer timeout, is it connected?");
+        return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
+      }
+
+    }
+
+    // a sequence of transfers cannot continue if another thread used the module while the bus was released
+    if((depth > 1) && (this->spiSequence != sequence)) {
+      RADIOLIB_DEBUG_BASIC_PRINTLN("Module accessed by another thread while busy");
+      return(RADIOLIB_ERR_SPI_INTERRUPTED);
+    }
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+void Module::SPIreleaseBus(uint8_t depth) {
+  for(uint8_t i = 0; i < depth; i++) {
+    this->hal->spiRelease();
+  }
+}
+
+void Module::SPIacquireBus(uint8_t depth) {
+  for(uint8_t i = 0; i < depth; i++) {
+    this->hal->spiAcquire();
+  }
+}
+
+int16_t Module::SPIwaitForGpio(uint16_t cmd, bool measure, RadioLibTime_t timeoutMs, uint8_t depth) {
+  RadioLibTime_t start = this->hal->micros();
+  RadioLibTime_t timeout = timeoutMs * 1000UL;
+
+  // other modules can use the bus while this one is busy
+  SPIreleaseBus(depth);
+
+  // let the HAL sleep until the pin goes low, if it can
+  int16_t state = RADIOLIB_ERR_UNSUPPORTED;
+  if(this->spiPinWait) {
+    state = this->hal->waitForPin(this->gpioPin, this->hal->GpioLevelLow, timeout);
+    if(state == RADIOLIB_ERR_UNSUPPORTED) {
+      this->spiPinWait = false;
+    }
+  }
+
+  // otherwise poll the pin
+  if(state == RADIOLIB_ERR_UNSUPPORTED) {
+    // sleep through most of the typical duration of this command first,
+    // short waits are not worth it and are polled right away
+    uint16_t typical = measure ? SPIbusyEstimate(cmd) : 0;
+    if((typical >= 100) && this->hal->digitalRead(this->gpioPin)) {
+      RadioLibTime_t sleep = typical - typical/4;
+      this->hal->delay(sleep / 1000);
+      this->hal->delayMicroseconds(sleep % 1000);
+    }
+
+    state = RADIOLIB_ERR_NONE;
+    while(this->hal->digitalRead(this->gpioPin)) {
+      this->hal->yield();
+      if(this->hal->micros() - start >= timeout) {
+        state = RADIOLIB_ERR_SPI_CMD_TIMEOUT;
+        break;
+      }
+    }
+  }
+
+  SPIacquireBus(depth);
+
+  #if RADIOLIB_SPI_METRICS
+  SPImetricsBusy(cmd, this->hal->micros() - start);
+  #endif
+
+  if(measure && (state == RADIOLIB_ERR_NONE)) {
+    SPIbusyUpdate(cmd, this->hal->micros() - start);
+  }
+  return(state);
+}
+
+uint16_t Module::SPIbusyEstimate(uint16_t cmd) {
+  #if RADIOLIB_SPI_BUSY_PROFILE_SIZE
+  SPIBusyProfile_t* entry = &this->spiBusyProfile[(cmd ^ (cmd >> 8)) % RADIOLIB_SPI_BUSY_PROFILE_SIZE];
+  if(entry->cmd == cmd) {
+    return(entry->duration);
+  }
+  #else
+  (void)cmd;
+  #endif
+  return(0);
+}
+
+void Module::SPIbusyUpdate(uint16_t cmd, RadioLibTime_t duration) {
+  #if RADIOLIB_SPI_BUSY_PROFILE_SIZE
+  // zero is reserved for unknown duration
+  if(duration < 1) {
+    duration = 1;
+  } else if(duration > 0xFFFF) {
+    duration = 0xFFFF;
+  }
+
+  // the table is direct-mapped, a different command in the same slot is simply replaced
+  SPIBusyProfile_t* entry = &this->spiBusyProfile[(cmd ^ (cmd >> 8)) % RADIOLIB_SPI_BUSY_PROFILE_SIZE];
+  if((entry->cmd != cmd) || (entry->duration == 0)) {
+    entry->cmd = cmd;
+    entry->duration = duration;
+    return;
+  }
+
+  // exponential moving average, weight of the new sample is 1/4
+  entry->duration = (3*(uint32_t)entry->duration + duration) / 4;
+  #else
+  (void)cmd;
+  (void)duration;
+  #endif
+}
+
+Module::SPIMetrics_t Module::getSPIMetrics() const {
+  #if RADIOLIB_SPI_METRICS
+    return(this->spiMetricsTotal);
+  #else
+    SPIMetrics_t metrics = {};
+    metrics.key = RADIOLIB_MODULE_SPI_METRICS_TOTAL;
+    return(metrics);
+  #endif
+}
+
+size_t Module::getSPIMetrics(SPIMetrics_t* metrics, size_t num) const {
+  #if RADIOLIB_SPI_METRICS
+    size_t len = RADIOLIB_MIN(num, this->spiMetricsLen);
+    memcpy(metrics, this->spiMetrics, len * sizeof(SPIMetrics_t));
+    return(len);
+  #else
+    (void)metrics;
+    (void)num;
+    return(0);
+  #endif
+}
+
+size_t Module::getSPITrace(SPITrace_t* trace, size_t num) const {
+  #if RADIOLIB_SPI_METRICS
+    // skip the oldest entries that do not fit
+    size_t len = RADIOLIB_MIN(num, this->spiTraceLen);
+    size_t pos = (this->spiTraceHead + RADIOLIB_SPI_TRACE_SIZE - len) % RADIOLIB_SPI_TRACE_SIZE;
+    for(size_t i = 0; i < len; i++) {
+      trace[i] = this->spiTrace[pos];
+      pos = (pos + 1) % RADIOLIB_SPI_TRACE_SIZE;
+    }
+    return(len);
+  #else
+    (void)trace;
+    (void)num;
+    return(0);
+  #endif
+}
+
+void Module::resetSPIMetrics() {
+  #if RADIOLIB_SPI_METRICS
+    memset(&this->spiMetricsTotal, 0, sizeof(this->spiMetricsTotal));
+    this->spiMetricsTotal.key = RADIOLIB_MODULE_SPI_METRICS_TOTAL;
+    this->spiMetricsLen = 0;
+    this->spiTraceHead = 0;
+    this->spiTraceLen = 0;
+  #endif
+}
+
+Module::SPIMetrics_t* Module::SPImetricsFind(uint16_t key) {
+  #if RADIOLIB_SPI_METRICS
+    for(size_t i = 0; i < this->spiMetricsLen; i++) {
+      if(this->spiMetrics[i].key == key) {
+        return(&this->spiMetrics[i]);
+      }
+    }
+
+    // once the table is full, new keys are only counted in the total
+    if(this->spiMetricsLen >= RADIOLIB_SPI_METRICS_SIZE) {
+      return(nullptr);
+    }
+    SPIMetrics_t* entry = &this->spiMetrics[this->spiMetricsLen++];
+    memset(entry, 0, sizeof(SPIMetrics_t));
+    entry->key = key;
+    return(entry);
+  #else
+    (void)key;
+    return(nullptr);
+  #endif
+}
+
+void Module::SPImetricsTransfer(uint16_t key, bool write, size_t len, size_t bytesOut, size_t bytesIn, RadioLibTime_t start, uint32_t allocs) {
+  #if RADIOLIB_SPI_METRICS
+    SPIMetrics_t* entries[2] = { &this->spiMetricsTotal, SPImetricsFind(key) };
+    for(size_t i = 0; i < 2; i++) {
+      if(entries[i]) {
+        entries[i]->transactions++;
+        entries[i]->bytesOut += bytesOut;
+        entries[i]->bytesIn += bytesIn;
+      }
+    }
+
+    // the total was already updated by SPIgetBuffers, which also counts buffers taken by drivers
+    if(entries[1]) {
+      entries[1]->heapAllocs += allocs;
+    }
+
+    SPITrace_t* trace = &this->spiTrace[this->spiTraceHead];
+    trace->timestamp = start;
+    trace->duration = this->hal->micros() - start;
+    trace->key = key;
+    trace->len = len;
+    trace->write = write;
+    this->spiTraceHead = (this->spiTraceHead + 1) % RADIOLIB_SPI_TRACE_SIZE;
+    if(this->spiTraceLen < RADIOLIB_SPI_TRACE_SIZE) {
+      this->spiTraceLen++;
+    }
+  #else
+    (void)key;
+    (void)write;
+    (void)len;
+    (void)bytesOut;
+    (void)bytesIn;
+    (void)start;
+    (void)allocs;
+  #endif
+}
+
+void Module::SPImetricsBusy(uint16_t key, RadioLibTime_t duration) {
+  #if RADIOLIB_SPI_METRICS
+    this->spiMetricsTotal.busyTime += duration;
+    SPIMetrics_t* entry = SPImetricsFind(key);
+    if(entry) {
+      entry->busyTime += duration;
+    }
+  #else
+    (void)key;
+    (void)duration;
+  #endif
+}
+
+void Module::SPImetricsRetry(uint16_t key) {
+  #if RADIOLIB_SPI_METRICS
+    this->spiMetricsTotal.verifyRetries++;
+    SPIMetrics_t* entry = SPImetricsFind(key);
+    if(entry) {
+      entry->verifyRetries++;
+    }
+  #else
+    (void)key;
+  #endif
+}
+
+bool Module::SPIgetBuffers(size_t len, uint8_t** buffOut, uint8_t** buffIn) {
+  // use the preallocated buffers whenever possible
+  if(len <= RADIOLIB_SPI_BUFFER_SIZE) {
+    *buffOut = this->spiBuffOut;
+    *buffIn = this->spiBuffIn;
+    return(true);
+  }
+
+  #if RADIOLIB_STATIC_ONLY
+    RADIOLIB_DEBUG_BASIC_PRINTLN("SPI transfer of %lu bytes exceeds scratch buffer size", (unsigned long)len);
+    return(false);
+  #else
+    *buffOut = new uint8_t[len];
+    *buffIn = new uint8_t[len];
+    this->heapAllocCount += 2;
+    #if RADIOLIB_SPI_METRICS
+    this->spiMetricsTotal.heapAllocs += 2;
+    #endif
+    return(true);
+  #endif
+}
+
+void Module::SPIreleaseBuffers(uint8_t* buffOut, uint8_t* buffIn) {
+  #if RADIOLIB_STATIC_ONLY
+    (void)buffOut;
+    (void)buffIn;
+  #else
+    if(buffOut != this->spiBuffOut) {
+      delete[] buffOut;
+      delete[] buffIn;
+    }
+  #endif
+}
+
 void Module::waitForMicroseconds(RadioLibTime_t start, RadioLibTime_t len) {
   #if RADIOLIB_INTERRUPT_TIMING
   (void)start;
@@ -527,6 +1099,7 @@ void Module::regdump(const char* level, uint16_t start, size_t len) {
     uint8_t buff[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
     uint8_t* buff = new uint8_t[len];
+    this->heapAllocCount++;
   #endif
   SPIreadRegisterBurst(start, len, buff);
   hexdump(level, buff, len, start);
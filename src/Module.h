@@ -57,6 +57,11 @@
   \}
 */
 
+/*!
+  \def RADIOLIB_MODULE_SPI_METRICS_TOTAL Key used in Module::SPIMetrics_t to indicate metrics of all commands/registers.
+*/
+#define RADIOLIB_MODULE_SPI_METRICS_TOTAL                       (0xFFFF)
+
 /*!
   \class Module
   \brief Implements all common low-level methods to control the wireless module.
@@ -268,6 +273,61 @@ class Module {
     */
     int16_t SPIsetRegValue(uint32_t reg, uint8_t value, uint8_t msb = 7, uint8_t lsb = 0, uint8_t checkInterval = 2, uint8_t checkMask = 0xFF);
 
+    /*!
+      \brief Start a batch of register writes. While the batch is open, SPIsetRegValue only queues the write
+      and returns immediately. Queued writes are applied by SPIbatchFlush, with consecutive register addresses
+      coalesced into a single burst transfer. Multiple writes to the same register are merged into one,
+      and registers are written in ascending address order, so writes that must be performed in a specific
+      sequence (e.g. switching the active modem) should not be batched. SPIgetRegValue will return register
+      values with pending writes already applied. Batching is only supported for register-access modules
+      with address auto-increment (e.g. SX127x, RF69), for all other modules, SPIsetRegValue is executed immediately.
+      Batches may be nested, in which case only the outermost SPIbatchFlush call applies the queued writes.
+    */
+    void SPIbatchBegin();
+
+    /*!
+      \brief Apply all queued register writes and close the batch started by SPIbatchBegin.
+      Must be called after every SPIbatchBegin call, SPIsetRegValue will not report errors while the batch is open.
+      \returns \ref status_codes
+    */
+    int16_t SPIbatchFlush();
+
+    /*!
+      \brief Set registers that must never be served from the shadow register cache,
+      e.g. because they can be changed by the module itself (IRQ flags, FIFO, RSSI etc.).
+      Also invalidates all cached values. Has no effect if RADIOLIB_SPI_CACHE is disabled.
+      \param regs Array of volatile register addresses.
+      \param num Number of register addresses in the array.
+    */
+    void SPIcacheSetVolatile(const uint8_t* regs, size_t num);
+
+    /*!
+      \brief Set which bits of the register address select the register in the shadow register cache.
+      Other bits (e.g. burst or status access flags) are ignored, so that all aliases of a register share one entry.
+      Has no effect if RADIOLIB_SPI_CACHE is disabled.
+      \param mask Register address mask, defaults to 0xFF.
+    */
+    void SPIcacheSetAddressMask(uint8_t mask);
+
+    /*!
+      \brief Invalidate all values in the shadow register cache. Must be called whenever the module
+      may have changed its register contents, e.g. after reset. Has no effect if RADIOLIB_SPI_CACHE is disabled.
+    */
+    void SPIcacheInvalidate();
+
+    /*!
+      \brief Get the number of read-modify-write updates that were served from the shadow register cache.
+      \returns Number of cache hits, or 0 if RADIOLIB_SPI_CACHE is disabled.
+    */
+    uint32_t getCacheHits() const;
+
+    /*!
+      \brief Get the number of read-modify-write updates that required a register read over SPI.
+      Together with getCacheHits, this can be used to calculate cache hit rate.
+      \returns Number of cache misses, or 0 if RADIOLIB_SPI_CACHE is disabled.
+    */
+    uint32_t getCacheMisses() const;
+
     /*!
       \brief SPI burst read method.
       \param reg Address of SPI register to read.
@@ -324,6 +384,18 @@ class Module {
       \returns \ref status_codes
     */
     int16_t SPIreadStream(uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio = true, bool verify = true);
+
+    /*!
+      \brief Method to perform a read transaction with SPI stream, using the given SPI configuration instead of spiConfig.
+      \param config SPI configuration for this transaction.
+      \param cmd SPI operation command.
+      \param data Data that will be transferred from slave to master.
+      \param numBytes Number of bytes to transfer.
+      \param waitForGpio Whether to wait for some GPIO at the end of transfer (e.g. BUSY line on SX126x/SX128x).
+      \param verify Whether to verify the result of the transaction after it is finished.
+      \returns \ref status_codes
+    */
+    int16_t SPIreadStream(const SPIConfig_t& config, uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio = true, bool verify = true);
     
     /*!
       \brief Method to perform a read transaction with SPI stream.
@@ -348,6 +420,18 @@ class Module {
     */
     int16_t SPIwriteStream(uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio = true, bool verify = true);
 
+    /*!
+      \brief Method to perform a write transaction with SPI stream, using the given SPI configuration instead of spiConfig.
+      \param config SPI configuration for this transaction.
+      \param cmd SPI operation command.
+      \param data Data that will be transferred from master to slave.
+      \param numBytes Number of bytes to transfer.
+      \param waitForGpio Whether to wait for some GPIO at the end of transfer (e.g. BUSY line on SX126x/SX128x).
+      \param verify Whether to verify the result of the transaction after it is finished.
+      \returns \ref status_codes
+    */
+    int16_t SPIwriteStream(const SPIConfig_t& config, uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio = true, bool verify = true);
+
     /*!
       \brief Method to perform a write transaction with SPI stream.
       \param cmd SPI operation command.
@@ -373,6 +457,135 @@ class Module {
     */
     int16_t SPItransferStream(const uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio);
 
+    /*!
+      \brief SPI single transfer method for modules with stream-type SPI interface, using the given SPI configuration
+      instead of spiConfig. Drivers should use this for transactions that differ from the usual ones (e.g. status reads
+      without a command, or longer timeouts) rather than temporarily changing spiConfig,
+      which may be in use by another thread at the same time.
+      \param config SPI configuration for this transaction.
+      \param cmd SPI operation command.
+      \param cmdLen SPI command length in bytes.
+      \param write Set to true for write commands, false for read commands.
+      \param dataOut Data that will be transferred from master to slave.
+      \param dataIn Data that was transferred from slave to master.
+      \param numBytes Number of bytes to transfer.
+      \param waitForGpio Whether to wait for some GPIO at the end of transfer (e.g. BUSY line on SX126x/SX128x).
+      \returns \ref status_codes
+    */
+    int16_t SPItransferStream(const SPIConfig_t& config, const uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio);
+
+    /*!
+      \brief Get SPI scratch buffers for a transfer. The preallocated buffers of this instance are returned
+      if the transfer fits into them, otherwise temporary buffers are allocated (unless in static-only mode).
+      Buffers obtained by this method must be released by calling SPIreleaseBuffers. Drivers may also use them
+      to prepare data for a stream transfer, which accepts the output buffer as its data to send and the input
+      buffer as the destination of received data. The bus must be held by RadioLibHal::spiAcquire until the transfer is done.
+      If the module is busy, the bus is released while waiting for it and the transfer fails with RADIOLIB_ERR_SPI_INTERRUPTED
+      when another thread used the module in the meantime.
+      \param len Total number of bytes in the transfer.
+      \param buffOut Will be set to the output buffer.
+      \param buffIn Will be set to the input buffer.
+      \returns Whether the buffers were obtained successfully.
+    */
+    bool SPIgetBuffers(size_t len, uint8_t** buffOut, uint8_t** buffIn);
+
+    /*!
+      \brief Release SPI scratch buffers obtained from SPIgetBuffers.
+      \param buffOut Output buffer to release.
+      \param buffIn Input buffer to release.
+    */
+    void SPIreleaseBuffers(uint8_t* buffOut, uint8_t* buffIn);
+
+    /*!
+      \brief Get the number of heap allocations performed by the SPI layer, including buffers drivers obtained
+      from SPIgetBuffers. With the default RADIOLIB_SPI_BUFFER_SIZE, this should remain zero, since all transfers
+      are assembled in the buffers preallocated in this Module instance. On low-end platforms, the buffers are smaller
+      and transfers of long packets are counted here.
+      \returns Number of heap allocations since this instance was created.
+    */
+    uint32_t getHeapAllocCount() const { return(heapAllocCount); }
+
+    /*!
+      \struct SPIMetrics_t
+      \brief SPI bus usage counters, either in total or for a single command/register.
+    */
+    struct SPIMetrics_t {
+      /*! \brief Command opcode for stream-type modules, register address for register-access modules. */
+      uint16_t key;
+
+      /*! \brief Number of SPI transactions. */
+      uint32_t transactions;
+
+      /*! \brief Number of bytes sent to the module, not including padding clocked out during reads. */
+      uint32_t bytesOut;
+
+      /*! \brief Number of bytes received from the module during reads, including status bytes.
+        Together with bytesOut, this adds up to all bytes clocked over the bus. */
+      uint32_t bytesIn;
+
+      /*! \brief Total time spent waiting for the module to become ready (e.g. BUSY pin), in microseconds. */
+      uint32_t busyTime;
+
+      /*! \brief Number of failed register write verifications that had to be repeated (only with RADIOLIB_SPI_PARANOID). */
+      uint32_t verifyRetries;
+
+      /*! \brief Number of heap allocations made for transfers that did not fit into the scratch buffers.
+        The total also includes buffers drivers obtained from SPIgetBuffers outside of a single transfer. */
+      uint32_t heapAllocs;
+    };
+
+    /*!
+      \struct SPITrace_t
+      \brief Single entry of the SPI transaction trace.
+    */
+    struct SPITrace_t {
+      /*! \brief Timestamp of the start of the transaction, in microseconds. */
+      RadioLibTime_t timestamp;
+
+      /*! \brief Duration of the transaction in microseconds, from the moment the module was ready to accept it,
+        including waiting for the module to process it. */
+      uint32_t duration;
+
+      /*! \brief Command opcode for stream-type modules, register address for register-access modules. */
+      uint16_t key;
+
+      /*! \brief Number of bytes transferred, including command, address and status bytes. */
+      uint16_t len;
+
+      /*! \brief Whether this was a write transaction. */
+      bool write;
+    };
+
+    /*!
+      \brief Get SPI metrics accumulated since this instance was created or since the last call to resetSPIMetrics.
+      \returns Total SPI metrics of this module, the key field is set to RADIOLIB_MODULE_SPI_METRICS_TOTAL.
+      All counters are zero if RADIOLIB_SPI_METRICS is disabled.
+    */
+    SPIMetrics_t getSPIMetrics() const;
+
+    /*!
+      \brief Get SPI metrics broken down by command/register. Up to RADIOLIB_SPI_METRICS_SIZE commands/registers
+      are tracked, in the order they were first used. Transactions of any further commands/registers
+      are only included in the total metrics.
+      \param metrics Array that will be filled with the metrics.
+      \param num Size of the array.
+      \returns Number of entries written into the array, or 0 if RADIOLIB_SPI_METRICS is disabled.
+    */
+    size_t getSPIMetrics(SPIMetrics_t* metrics, size_t num) const;
+
+    /*!
+      \brief Get the most recent SPI transactions, up to RADIOLIB_SPI_TRACE_SIZE of them.
+      \param trace Array that will be filled with the trace entries, the oldest transaction first.
+      \param num Size of the array. If the trace contains more entries, only the most recent ones are returned.
+      \returns Number of entries written into the array, or 0 if RADIOLIB_SPI_METRICS is disabled.
+    */
+    size_t getSPITrace(SPITrace_t* trace, size_t num) const;
+
+    /*!
+      \brief Clear all SPI metrics and the transaction trace.
+    */
+    void resetSPIMetrics();
+
     // pin number access methods
 
     /*!
@@ -552,6 +765,81 @@ class Module {
     #if RADIOLIB_INTERRUPT_TIMING
     uint32_t prevTimingLen = 0;
     #endif
+
+    // SPI scratch buffers, preallocated to avoid heap allocation on every transfer
+    uint8_t spiBuffOut[RADIOLIB_SPI_BUFFER_SIZE] = { 0 };
+    uint8_t spiBuffIn[RADIOLIB_SPI_BUFFER_SIZE] = { 0 };
+    uint32_t heapAllocCount = 0;
+
+    // queued register writes, kept sorted by register address
+    struct SPIBatchOp_t {
+      uint16_t reg;
+      uint8_t value;
+      uint8_t mask;
+      uint8_t checkMask;
+      uint8_t checkInterval;
+    };
+    SPIBatchOp_t spiBatch[RADIOLIB_SPI_BATCH_SIZE];
+    size_t spiBatchLen = 0;
+    uint8_t spiBatchDepth = 0;
+    int16_t spiBatchState = RADIOLIB_ERR_NONE;
+
+    #if RADIOLIB_SPI_CACHE
+    // shadow register cache with validity and volatility bitmaps
+    uint8_t spiCache[RADIOLIB_SPI_CACHE_SIZE] = { 0 };
+    uint8_t spiCacheValid[(RADIOLIB_SPI_CACHE_SIZE + 7) / 8] = { 0 };
+    uint8_t spiCacheVolatile[(RADIOLIB_SPI_CACHE_SIZE + 7) / 8] = { 0 };
+    uint8_t spiCacheAddrMask = 0xFF;
+    uint32_t spiCacheHits = 0;
+    uint32_t spiCacheMisses = 0;
+    #endif
+
+    // typical BUSY duration of recently used commands, in microseconds (0 means unknown)
+    #if RADIOLIB_SPI_BUSY_PROFILE_SIZE
+    struct SPIBusyProfile_t {
+      uint16_t cmd;
+      uint16_t duration;
+    };
+    SPIBusyProfile_t spiBusyProfile[RADIOLIB_SPI_BUSY_PROFILE_SIZE] = {};
+    #endif
+
+    // timestamp of the last command, used when BUSY is not connected
+    RadioLibTime_t spiLastTransfer = 0;
+
+    // whether the HAL implements waitForPin, cleared the first time it reports otherwise
+    bool spiPinWait = true;
+
+    // number of stream transfers to this module, to detect other threads using it while the bus was released
+    uint32_t spiSequence = 0;
+
+    #if RADIOLIB_SPI_METRICS
+    // total and per-command metrics, and a ring buffer of the most recent transactions
+    SPIMetrics_t spiMetricsTotal = { RADIOLIB_MODULE_SPI_METRICS_TOTAL, 0, 0, 0, 0, 0, 0 };
+    SPIMetrics_t spiMetrics[RADIOLIB_SPI_METRICS_SIZE] = {};
+    size_t spiMetricsLen = 0;
+    SPITrace_t spiTrace[RADIOLIB_SPI_TRACE_SIZE] = {};
+    size_t spiTraceHead = 0;
+    size_t spiTraceLen = 0;
+    #endif
+
+    SPIMetrics_t* SPImetricsFind(uint16_t key);
+    void SPImetricsTransfer(uint16_t key, bool write, size_t len, size_t bytesOut, size_t bytesIn, RadioLibTime_t start, uint32_t allocs);
+    void SPImetricsBusy(uint16_t key, RadioLibTime_t duration);
+    void SPImetricsRetry(uint16_t key);
+
+    int16_t SPIwaitReady(uint16_t cmd, RadioLibTime_t timeoutMs, uint8_t depth);
+    int16_t SPIwaitForGpio(uint16_t cmd, bool measure, RadioLibTime_t timeoutMs, uint8_t depth);
+    void SPIreleaseBus(uint8_t depth);
+    void SPIacquireBus(uint8_t depth);
+    int16_t SPItransferStreamVerify(const SPIConfig_t& config, const uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio, bool verify);
+    uint16_t SPIbusyEstimate(uint16_t cmd);
+    void SPIbusyUpdate(uint16_t cmd, RadioLibTime_t duration);
+
+    bool SPIcacheRead(uint32_t reg, uint8_t* value);
+    void SPIcacheUpdate(uint32_t reg, const uint8_t* values, size_t num);
+
+    int16_t SPIbatchQueue(uint32_t reg, uint8_t value, uint8_t mask, uint8_t checkInterval, uint8_t checkMask);
+    int16_t SPIbatchApply();
 };
 
 #endif
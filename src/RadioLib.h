@@ -113,6 +113,8 @@
 // utilities
 #include "utils/CRC.h"
 #include "utils/Cryptography.h"
+#include "utils/SymbolScheduler.h"
+#include "utils/TimeOnAir.h"
 
 // only create Radio class when using RadioShield
 #if RADIOLIB_RADIOSHIELD
@@ -250,6 +250,12 @@
 */
 #define RADIOLIB_ERR_NULL_POINTER                              (-28)
 
+/*!
+  \brief A sequence of SPI transfers that must not be interrupted was interrupted,
+  because another thread accessed the same module while it was busy.
+*/
+#define RADIOLIB_ERR_SPI_INTERRUPTED                           (-29)
+
 // RF69-specific status codes
 
 /*!
@@ -579,7 +585,8 @@
 #define RADIOLIB_LORAWAN_NONCES_DISCARDED                       (-1119)
 
 /*!
-  \brief The supplied Session buffer is discarded as it doesn't match the Nonces.
+  \brief The supplied Session buffer is discarded as it doesn't match the Nonces,
+  or because it was saved with a different layout of the buffer.
 */
 #define RADIOLIB_LORAWAN_SESSION_DISCARDED                       (-1120)
 
@@ -588,6 +595,11 @@
 */
 #define RADIOLIB_LORAWAN_INVALID_MODE                            (-1121)
 
+/*!
+  \brief A non-blocking uplink sequence is still in progress, LoRaWANNode::tick must be called again.
+*/
+#define RADIOLIB_LORAWAN_BUSY                                    (-1122)
+
 // LR11x0-specific status codes
 
 /*!
@@ -13,6 +13,21 @@ int16_t CC1101::begin(float freq, float br, float freqDev, float rxBw, int8_t pw
   this->mod->init();
   this->mod->hal->pinMode(this->mod->getIrq(), this->mod->hal->GpioModeInput);
 
+  // burst and status register accesses set extra address bits, cache them under the register address
+  this->mod->SPIcacheSetAddressMask(RADIOLIB_CC1101_CMD_ADDRESS_MASK);
+
+  // registers that can be changed by the module itself, including all status registers
+  static const uint8_t volatileRegs[] = {
+    RADIOLIB_CC1101_REG_FSCAL3, RADIOLIB_CC1101_REG_FSCAL2, RADIOLIB_CC1101_REG_FSCAL1,
+    RADIOLIB_CC1101_REG_PARTNUM, RADIOLIB_CC1101_REG_VERSION, RADIOLIB_CC1101_REG_FREQEST,
+    RADIOLIB_CC1101_REG_LQI, RADIOLIB_CC1101_REG_RSSI, RADIOLIB_CC1101_REG_MARCSTATE,
+    RADIOLIB_CC1101_REG_WORTIME1, RADIOLIB_CC1101_REG_WORTIME0, RADIOLIB_CC1101_REG_PKTSTATUS,
+    RADIOLIB_CC1101_REG_VCO_VC_DAC, RADIOLIB_CC1101_REG_TXBYTES, RADIOLIB_CC1101_REG_RXBYTES,
+    RADIOLIB_CC1101_REG_RCCTRL1_STATUS, RADIOLIB_CC1101_REG_RCCTRL0_STATUS,
+    RADIOLIB_CC1101_REG_PATABLE, RADIOLIB_CC1101_REG_FIFO,
+  };
+  this->mod->SPIcacheSetVolatile(volatileRegs, sizeof(volatileRegs));
+
   // try to find the CC1101 chip
   uint8_t i = 0;
   bool flagFound = false;
@@ -96,6 +111,7 @@ void CC1101::reset() {
   this->mod->hal->digitalWrite(this->mod->getCs(), this->mod->hal->GpioLevelLow);
   this->mod->hal->delay(10);
   SPIsendCommand(RADIOLIB_CC1101_CMD_RESET);
+  this->mod->SPIcacheInvalidate();
 }
 
 int16_t CC1101::transmit(uint8_t* data, size_t len, uint8_t addr) {
@@ -199,6 +215,12 @@ int16_t CC1101::transmitDirectAsync(uint32_t frf) {
   return transmitDirect(false, frf);
 }
 
+int16_t CC1101::setDirectFrequency(uint32_t frf) {
+  uint8_t data[] = { (uint8_t)((frf & 0xFF0000) >> 16), (uint8_t)((frf & 0x00FF00) >> 8), (uint8_t)(frf & 0x0000FF) };
+  SPIwriteRegisterBurst(RADIOLIB_CC1101_REG_FREQ2, data, 3);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t CC1101::transmitDirect(bool sync, uint32_t frf) {
   // set RF switch (if present)
   this->mod->setRfSwitchState(Module::MODE_TX);
@@ -1138,19 +1160,9 @@ void CC1101::SPIwriteRegisterBurst(uint8_t reg, uint8_t* data, size_t len) {
 }
 
 void CC1101::SPIsendCommand(uint8_t cmd) {
-  // pull NSS low
-  this->mod->hal->digitalWrite(this->mod->getCs(), this->mod->hal->GpioLevelLow);
-
-  // start transfer
-  this->mod->hal->spiBeginTransaction();
-
   // send the command byte
   uint8_t status = 0;
-  this->mod->hal->spiTransfer(&cmd, 1, &status);
-
-  // stop transfer
-  this->mod->hal->spiEndTransaction();
-  this->mod->hal->digitalWrite(this->mod->getCs(), this->mod->hal->GpioLevelHigh);
+  this->mod->hal->spiTransaction(this->mod->getCs(), &cmd, 1, &status);
   RADIOLIB_DEBUG_SPI_PRINTLN("CMD\tW\t%02X\t%02X", cmd, status);
   (void)status;
 }
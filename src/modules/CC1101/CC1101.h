@@ -17,6 +17,7 @@
 #define RADIOLIB_CC1101_CMD_WRITE                               0b00000000
 #define RADIOLIB_CC1101_CMD_BURST                               0b01000000
 #define RADIOLIB_CC1101_CMD_ACCESS_STATUS_REG                   0b01000000
+#define RADIOLIB_CC1101_CMD_ADDRESS_MASK                        0b00111111
 #define RADIOLIB_CC1101_CMD_FIFO_RX                             0b10000000
 #define RADIOLIB_CC1101_CMD_FIFO_TX                             0b00000000
 #define RADIOLIB_CC1101_CMD_RESET                               0x30
@@ -606,6 +607,14 @@ class CC1101: public PhysicalLayer {
     */
     int16_t transmitDirect(uint32_t frf = 0) override;
 
+    /*!
+      \brief Change frequency of an ongoing direct mode transmission with a single burst write.
+      No strobe is sent, so this can only be called after transmitDirect or transmitDirectAsync.
+      \param frf Raw RF frequency value.
+      \returns \ref status_codes
+    */
+    int16_t setDirectFrequency(uint32_t frf) override;
+
     /*!
       \brief Starts synchronous direct mode reception.
       \returns \ref status_codes
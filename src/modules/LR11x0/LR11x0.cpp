@@ -497,9 +497,9 @@ int16_t LR11x0::startReceive(uint32_t timeout, uint32_t irqFlags, uint32_t irqMa
 uint32_t LR11x0::getIrqStatus() {
   // there is no dedicated "get IRQ" command, the IRQ bits are sent after the status bytes
   uint8_t buff[6] = { 0 };
-  this->mod->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] = Module::BITS_0;
-  mod->SPItransferStream(NULL, 0, false, NULL, buff, sizeof(buff), true);
-  this->mod->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] = Module::BITS_8;
+  Module::SPIConfig_t config = this->mod->spiConfig;
+  config.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] = Module::BITS_0;
+  this->mod->SPItransferStream(config, NULL, 0, false, NULL, buff, sizeof(buff), true);
   uint32_t irq = ((uint32_t)(buff[2]) << 24) | ((uint32_t)(buff[3]) << 16) | ((uint32_t)(buff[4]) << 8) | (uint32_t)buff[5];
   return(irq);
 }
@@ -1085,6 +1085,7 @@ int16_t LR11x0::checkDataRate(DataRate_t dr) {
 }
 
 int16_t LR11x0::setPreambleLength(size_t preambleLength) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
   int16_t state = getPacketType(&type);
@@ -1157,6 +1158,7 @@ int16_t LR11x0::setTCXO(float voltage, uint32_t delay) {
 }
 
 int16_t LR11x0::setCRC(uint8_t len, uint32_t initial, uint32_t polynomial, bool inverted) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
   int16_t state = getPacketType(&type);
@@ -1268,71 +1270,43 @@ size_t LR11x0::getPacketLength(bool update, uint8_t* offset) {
 }
 
 RadioLibTime_t LR11x0::getTimeOnAir(size_t len) {
-  // check active modem
-  uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
-  (void)getPacketType(&type);
-  if(type == RADIOLIB_LR11X0_PACKET_TYPE_LORA) {
-    // calculate number of symbols
-    float N_symbol = 0;
-    if(this->codingRate <= RADIOLIB_LR11X0_LORA_CR_4_8_SHORT) {
-      // legacy coding rate - nice and simple
-
-      // get SF coefficients
-      float coeff1 = 0;
-      int16_t coeff2 = 0;
-      int16_t coeff3 = 0;
-      if(this->spreadingFactor < 7) {
-        // SF5, SF6
-        coeff1 = 6.25;
-        coeff2 = 4*this->spreadingFactor;
-        coeff3 = 4*this->spreadingFactor;
-      } else if(this->spreadingFactor < 11) {
-        // SF7. SF8, SF9, SF10
-        coeff1 = 4.25;
-        coeff2 = 4*this->spreadingFactor + 8;
-        coeff3 = 4*this->spreadingFactor;
-      } else {
-        // SF11, SF12
-        coeff1 = 4.25;
-        coeff2 = 4*this->spreadingFactor + 8;
-        coeff3 = 4*(this->spreadingFactor - 2);
-      }
-
-      // get CRC length
-      int16_t N_bitCRC = 16;
-      if(this->crcTypeLoRa == RADIOLIB_LR11X0_LORA_CRC_DISABLED) {
-        N_bitCRC = 0;
+  // packet type is only read from the chip after the configuration has changed
+  if(!this->timeOnAir.isValid()) {
+    uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
+    (void)getPacketType(&type);
+    if(type == RADIOLIB_LR11X0_PACKET_TYPE_LORA) {
+      // long interleaving - abandon hope all ye who enter here
+      /// \todo implement this mess - SX1280 datasheet v3.0 section 7.4.4.2
+      // until then, it is approximated by the short interleaver with the same coding rate
+      uint8_t cr = this->codingRate + 4;
+      if(this->codingRate == RADIOLIB_LR11X0_LORA_CR_4_5_LONG) {
+        cr = 5;
+      } else if(this->codingRate == RADIOLIB_LR11X0_LORA_CR_4_6_LONG) {
+        cr = 6;
+      } else if(this->codingRate == RADIOLIB_LR11X0_LORA_CR_4_8_LONG) {
+        cr = 8;
       }
 
-      // get header length
-      int16_t N_symbolHeader = 20;
-      if(this->headerType == RADIOLIB_LR11X0_LORA_HEADER_IMPLICIT) {
-        N_symbolHeader = 0;
-      }
+      this->timeOnAir.setLoRa(this->spreadingFactor, this->bandwidthKhz, cr, this->preambleLengthLoRa,
+                              this->headerType == RADIOLIB_LR11X0_LORA_HEADER_EXPLICIT, this->crcTypeLoRa != RADIOLIB_LR11X0_LORA_CRC_DISABLED,
+                              this->ldrOptimize == RADIOLIB_LR11X0_LORA_LDRO_ENABLED);
 
-      // calculate number of LoRa preamble symbols
-      uint32_t N_symbolPreamble = (this->preambleLengthLoRa & 0x0F) * (uint32_t(1) << ((this->preambleLengthLoRa & 0xF0) >> 4));
+    } else if(type == RADIOLIB_LR11X0_PACKET_TYPE_GFSK) {
+      this->timeOnAir.setBitRate(1000000.0f / (float)this->bitRate);
 
-      // calculate the number of symbols
-      N_symbol = (float)N_symbolPreamble + coeff1 + 8.0 + ceil(RADIOLIB_MAX((int16_t)(8 * len + N_bitCRC - coeff2 + N_symbolHeader), (int16_t)0) / (float)coeff3) * (float)(this->codingRate + 4);
+    } else if(type == RADIOLIB_LR11X0_PACKET_TYPE_LR_FHSS) {
+      // coding rates as numerator and denominator, indexed by RADIOLIB_LR11X0_LR_FHSS_CR_*
+      const uint8_t crNum[] = { 5, 2, 1, 1 };
+      const uint8_t crDen[] = { 6, 3, 2, 3 };
+      uint8_t cr = (this->lrFhssCr <= RADIOLIB_LR11X0_LR_FHSS_CR_1_3) ? this->lrFhssCr : RADIOLIB_LR11X0_LR_FHSS_CR_1_3;
+      this->timeOnAir.setLRFHSS(this->lrFhssHdrCount, crNum[cr], crDen[cr]);
 
     } else {
-      // long interleaving - abandon hope all ye who enter here
-      /// \todo implement this mess - SX1280 datasheet v3.0 section 7.4.4.2
-
+      return(0);
     }
-
-    // get time-on-air in us
-    return(((uint32_t(1) << this->spreadingFactor) / this->bandwidthKhz) * N_symbol * 1000.0);
-
-  } else if(type == RADIOLIB_LR11X0_PACKET_TYPE_GFSK) {
-    return(((uint32_t)len * 8 * 1000000UL) / this->bitRate);
-  
-  } else if(type == RADIOLIB_LR11X0_PACKET_TYPE_LR_FHSS) {
-    return(((uint32_t)len * 8 * 1000000UL) / RADIOLIB_LR11X0_LR_FHSS_BIT_RATE);
   }
 
-  return(0);
+  return(this->timeOnAir.get(len));
 }
 
 RadioLibTime_t LR11x0::calculateRxTimeout(RadioLibTime_t timeoutUs) {
@@ -1408,6 +1382,7 @@ void LR11x0::setRfSwitchTable(const uint32_t (&pins)[Module::RFSWITCH_MAX_PINS],
 }
 
 int16_t LR11x0::setLrFhssConfig(uint8_t bw, uint8_t cr, uint8_t hdrCount, uint16_t hopSeed) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
   int16_t state = getPacketType(&type);
@@ -1495,27 +1470,11 @@ int16_t LR11x0::getWifiScanResult(LR11x0WifiResult_t* result, uint8_t index, boo
   // read a single result
   uint8_t format = brief ? RADIOLIB_LR11X0_WIFI_RESULT_TYPE_BASIC : RADIOLIB_LR11X0_WIFI_RESULT_TYPE_COMPLETE;
   uint8_t raw[RADIOLIB_LR11X0_WIFI_RESULT_MAX_LEN] = { 0 };
-  int16_t state = wifiReadResults(index, 1, format, raw);
+  int16_t state = wifiReadResults(index, 1, format, raw, RADIOLIB_LR11X0_WIFI_RESULT_MAX_LEN);
   RADIOLIB_ASSERT(state);
 
   // parse the information
-  switch(raw[0] & 0x03) {
-    case(RADIOLIB_LR11X0_WIFI_SCAN_802_11_B):
-      result->type = 'b';
-      break;
-    case(RADIOLIB_LR11X0_WIFI_SCAN_802_11_G):
-      result->type = 'g';
-      break;
-    case(RADIOLIB_LR11X0_WIFI_SCAN_802_11_N):
-      result->type = 'n';
-      break;
-  }
-  result->dataRateId = (raw[0] & 0xFC) >> 2;
-  result->channelFreq = 2407 + (raw[1] & 0x0F)*5;
-  result->origin = (raw[1] & 0x30) >> 4;
-  result->ap = (raw[1] & 0x40) != 0;
-  result->rssi = (float)raw[2] / -2.0f;;
-  memcpy(result->mac, &raw[3], RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN);
+  parseWifiResult(result, raw);
 
   if(!brief) {
     if(this->wifiScanMode == RADIOLIB_LR11X0_WIFI_ACQ_MODE_FULL_BEACON) {
@@ -1563,6 +1522,60 @@ int16_t LR11x0::getWifiScanResult(LR11x0WifiResult_t* result, uint8_t index, boo
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t LR11x0::getWifiScanResults(LR11x0WifiResult_t* results, uint8_t* count, bool dedup) {
+  if(!results || !count) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
+
+  uint8_t capacity = *count;
+  *count = 0;
+  uint8_t available = 0;
+  int16_t state = getWifiScanResultsCount(&available);
+  RADIOLIB_ASSERT(state);
+
+  // without deduplication, there is no point in reading more results than fit into the array
+  if(!dedup && (available > capacity)) {
+    available = capacity;
+  }
+
+  // read as many results per transaction as the SPI buffer allows
+  const uint8_t maxPerRead = RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN / RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN;
+  uint8_t raw[maxPerRead * RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN];
+  for(size_t index = 0; index < available; index += maxPerRead) {
+    uint8_t num = RADIOLIB_MIN(maxPerRead, available - index);
+    state = wifiReadResults((uint8_t)index, num, RADIOLIB_LR11X0_WIFI_RESULT_TYPE_BASIC, raw, num * RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN);
+    RADIOLIB_ASSERT(state);
+
+    for(uint8_t i = 0; i < num; i++) {
+      LR11x0WifiResult_t result;
+      memset(&result, 0, sizeof(result));
+      parseWifiResult(&result, &raw[i * RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN]);
+
+      // look for the same MAC address, only the strongest signal is kept
+      uint8_t pos = *count;
+      if(dedup) {
+        for(pos = 0; pos < *count; pos++) {
+          if(memcmp(results[pos].mac, result.mac, RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN) == 0) {
+            break;
+          }
+        }
+        if(pos < *count) {
+          if(result.rssi > results[pos].rssi) {
+            results[pos] = result;
+          }
+          continue;
+        }
+      }
+
+      if(*count < capacity) {
+        results[(*count)++] = result;
+      }
+    }
+  }
+
+  return(state);
+}
+
 int16_t LR11x0::wifiScan(uint8_t wifiType, uint8_t* count, uint8_t mode, uint16_t chanMask, uint8_t numScans, uint16_t timeout) {
   if(!count) {
     return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
@@ -1602,49 +1615,108 @@ int16_t LR11x0::getVersionInfo(LR11x0VersionInfo_t* info) {
   return(this->gnssReadVersion(&info->fwGNSS, &info->almanacGNSS));
 }
 
+// image stored in memory of the host, used to stream it to the device
+struct LR11x0FirmwareImage_t {
+  const uint32_t* image;
+  bool nonvolatile;
+};
+
+static int16_t LR11x0ReadFirmwareImage(uint32_t offset, uint32_t* data, size_t len, void* ctx) {
+  LR11x0FirmwareImage_t* img = (LR11x0FirmwareImage_t*)ctx;
+  if(!img->nonvolatile) {
+    memcpy(data, &img->image[offset], len*sizeof(uint32_t));
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  for(size_t i = 0; i < len; i++) {
+    data[i] = RADIOLIB_NONVOLATILE_READ_DWORD(&img->image[offset + i]);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t LR11x0::updateFirmware(const uint32_t* image, size_t size, bool nonvolatile) {
   if(!image) {
     return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
   }
 
-  // put the device to bootloader mode
-  int16_t state = this->reboot(true);
-  RADIOLIB_ASSERT(state);
-  this->mod->hal->delay(500);
+  LR11x0FirmwareImage_t img = { image, nonvolatile };
+  return(this->updateFirmware(LR11x0ReadFirmwareImage, size, &img));
+}
 
-  // check we're in bootloader
+int16_t LR11x0::updateFirmware(FirmwareReadCb_t readCb, size_t size, void* ctx, uint32_t start, FirmwareProgressCb_t progressCb) {
+  if(!readCb) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
+  if(start >= size) {
+    start = 0;
+  }
+
+  // resuming is only possible when the previous update left the device in bootloader
   uint8_t device = 0xFF;
-  state = this->getVersion(NULL, &device, NULL, NULL);
-  RADIOLIB_ASSERT(state);
-  if(device != RADIOLIB_LR11X0_DEVICE_BOOT) {
-    RADIOLIB_DEBUG_BASIC_PRINTLN("Failed to put device to bootloader mode, %02x != %02x", (unsigned int)device, (unsigned int)RADIOLIB_LR11X0_DEVICE_BOOT);
-    return(RADIOLIB_ERR_CHIP_NOT_FOUND);
+  int16_t state = RADIOLIB_ERR_NONE;
+  if(start > 0) {
+    state = this->getVersion(NULL, &device, NULL, NULL);
+    RADIOLIB_ASSERT(state);
+    if(device != RADIOLIB_LR11X0_DEVICE_BOOT) {
+      RADIOLIB_DEBUG_BASIC_PRINTLN("Device not in bootloader, restarting update from the beginning");
+      start = 0;
+    }
   }
 
-  // erase the image
-  state = this->bootEraseFlash();
-  RADIOLIB_ASSERT(state);
+  if(start == 0) {
+    // put the device to bootloader mode
+    state = this->reboot(true);
+    RADIOLIB_ASSERT(state);
+    this->mod->hal->delay(500);
 
-  // wait for BUSY to go low
-  RadioLibTime_t start = this->mod->hal->millis();
-  while(this->mod->hal->digitalRead(this->mod->getGpio())) {
-    this->mod->hal->yield();
-    if(this->mod->hal->millis() - start >= 3000) {
-      RADIOLIB_DEBUG_BASIC_PRINTLN("BUSY pin timeout after erase!");
-      return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
+    // check we're in bootloader
+    state = this->getVersion(NULL, &device, NULL, NULL);
+    RADIOLIB_ASSERT(state);
+    if(device != RADIOLIB_LR11X0_DEVICE_BOOT) {
+      RADIOLIB_DEBUG_BASIC_PRINTLN("Failed to put device to bootloader mode, %02x != %02x", (unsigned int)device, (unsigned int)RADIOLIB_LR11X0_DEVICE_BOOT);
+      return(RADIOLIB_ERR_CHIP_NOT_FOUND);
+    }
+
+    // erase the image, this returns only after BUSY went low again
+    state = this->bootEraseFlash();
+    if(state != RADIOLIB_ERR_NONE) {
+      RADIOLIB_DEBUG_BASIC_PRINTLN("Failed to erase flash (%d)", state);
+      return(state);
+    }
+  }
+
+  // upload the new image in the largest chunks allowed by the bootloader
+  // the first word of the buffer is the flash offset, the image is read right behind it,
+  // so each chunk is converted in place and sent without any further copies
+  const size_t maxLen = RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN/sizeof(uint32_t);
+  uint32_t buff[1 + maxLen];
+  RADIOLIB_DEBUG_BASIC_PRINTLN("Writing image of %lu words from offset %lu", (unsigned long)size, (unsigned long)start);
+  for(uint32_t offset = start; offset < size; offset += maxLen) {
+    size_t len = RADIOLIB_MIN(maxLen, size - offset);
+    state = readCb(offset, &buff[1], len, ctx);
+    RADIOLIB_ASSERT(state);
+
+    // the bootloader expects big endian words
+    buff[0] = offset*sizeof(uint32_t);
+    LR11x0::swapWords(buff, 1 + len);
+
+    // status of each write is reported in the next one
+    state = this->mod->SPIwriteStream(RADIOLIB_LR11X0_CMD_BOOT_WRITE_FLASH_ENCRYPTED, (uint8_t*)buff, (1 + len)*sizeof(uint32_t), true, false);
+    if(state != RADIOLIB_ERR_NONE) {
+      RADIOLIB_DEBUG_BASIC_PRINTLN("Failed to write chunk at offset %08lx (%d)", (unsigned long)offset, state);
+      return(state);
+    }
+
+    if(progressCb) {
+      progressCb(offset, size, ctx);
     }
   }
 
-  // upload the new image
-  const size_t maxLen = 64;
-  size_t rem = size % maxLen;
-  size_t numWrites = (rem == 0) ? (size / maxLen) : ((size / maxLen) + 1);
-  RADIOLIB_DEBUG_BASIC_PRINTLN("Writing image in %lu chunks, last chunk size is %lu words", (unsigned long)numWrites, (unsigned long)rem);
-  for(size_t i = 0; i < numWrites; i ++) {
-    uint32_t offset = i * maxLen;
-    uint32_t len = (i == (numWrites - 1)) ? rem : maxLen;
-    RADIOLIB_DEBUG_BASIC_PRINTLN("Writing chunk %d at offset %08lx (%u words)", (int)i, (unsigned long)offset, (unsigned int)len);
-    this->bootWriteFlashEncrypted(offset*sizeof(uint32_t), (uint32_t*)&image[offset], len, nonvolatile);
+  // verify the last write
+  state = LR11x0::SPIcheckStatus(this->mod);
+  RADIOLIB_ASSERT(state);
+  if(progressCb) {
+    progressCb(size, size, ctx);
   }
 
   // kick the device from bootloader
@@ -1700,6 +1772,48 @@ int16_t LR11x0::modSetup(float tcxoVoltage, uint8_t modem) {
   return(config(modem));
 }
 
+void LR11x0::swapWords(uint32_t* data, size_t len) {
+  // convert host byte order to big endian in place
+  #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    (void)data;
+    (void)len;
+  #elif defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    for(size_t i = 0; i < len; i++) {
+      data[i] = __builtin_bswap32(data[i]);
+    }
+  #else
+    for(size_t i = 0; i < len; i++) {
+      uint32_t bin = data[i];
+      uint8_t* raw = (uint8_t*)&data[i];
+      raw[0] = (uint8_t)((bin >> 24) & 0xFF);
+      raw[1] = (uint8_t)((bin >> 16) & 0xFF);
+      raw[2] = (uint8_t)((bin >> 8) & 0xFF);
+      raw[3] = (uint8_t)(bin & 0xFF);
+    }
+  #endif
+}
+
+void LR11x0::parseWifiResult(LR11x0WifiResult_t* result, const uint8_t* raw) {
+  // the first bytes are the same in all result formats
+  switch(raw[0] & 0x03) {
+    case(RADIOLIB_LR11X0_WIFI_SCAN_802_11_B):
+      result->type = 'b';
+      break;
+    case(RADIOLIB_LR11X0_WIFI_SCAN_802_11_G):
+      result->type = 'g';
+      break;
+    case(RADIOLIB_LR11X0_WIFI_SCAN_802_11_N):
+      result->type = 'n';
+      break;
+  }
+  result->dataRateId = (raw[0] & 0xFC) >> 2;
+  result->channelFreq = 2407 + (raw[1] & 0x0F)*5;
+  result->origin = (raw[1] & 0x30) >> 4;
+  result->ap = (raw[1] & 0x40) != 0;
+  result->rssi = (float)raw[2] / -2.0f;
+  memcpy(result->mac, &raw[3], RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN);
+}
+
 int16_t LR11x0::SPIparseStatus(uint8_t in) {
   if((in & 0b00001110) == RADIOLIB_LR11X0_STAT_1_CMD_PERR) {
     return(RADIOLIB_ERR_SPI_CMD_INVALID);
@@ -1716,9 +1830,9 @@ int16_t LR11x0::SPIcheckStatus(Module* mod) {
   // but only as the first byte (as with any other command), hence LR11x0::SPIcommand can't be used
   // it also seems to ignore the actual command, and just sending in bunch of NOPs will work 
   uint8_t buff[6] = { 0 };
-  mod->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] = Module::BITS_0;
-  int16_t state = mod->SPItransferStream(NULL, 0, false, NULL, buff, sizeof(buff), true);
-  mod->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] = Module::BITS_8;
+  Module::SPIConfig_t config = mod->spiConfig;
+  config.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] = Module::BITS_0;
+  int16_t state = mod->SPItransferStream(config, NULL, 0, false, NULL, buff, sizeof(buff), true);
   RADIOLIB_ASSERT(state);
   return(LR11x0::SPIparseStatus(buff[0]));
 }
@@ -1727,14 +1841,19 @@ int16_t LR11x0::SPIcommand(uint16_t cmd, bool write, uint8_t* data, size_t len,
   int16_t state = RADIOLIB_ERR_UNKNOWN;
   if(!write) {
     // the SPI interface of LR11x0 requires two separate transactions for reading
+    // hold the bus for both, otherwise another thread could read the response in between
+    // the bus is only released while the module is busy, the read then fails if another thread used the module
+    this->mod->hal->spiAcquire();
+
     // send the 16-bit command
     state = this->mod->SPIwriteStream(cmd, out, outLen, true, false);
-    RADIOLIB_ASSERT(state);
-
-    // read the result without command
-    this->mod->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD] = Module::BITS_0;
-    state = this->mod->SPIreadStream(RADIOLIB_LR11X0_CMD_NOP, data, len, true, false);
-    this->mod->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD] = Module::BITS_16;
+    if(state == RADIOLIB_ERR_NONE) {
+      // read the result without command
+      Module::SPIConfig_t config = this->mod->spiConfig;
+      config.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD] = Module::BITS_0;
+      state = this->mod->SPIreadStream(config, RADIOLIB_LR11X0_CMD_NOP, data, len, true, false);
+    }
+    this->mod->hal->spiRelease();
 
   } else {
     // write is just a single transaction
@@ -1864,6 +1983,7 @@ int16_t LR11x0::startCad(uint8_t symbolNum, uint8_t detPeak, uint8_t detMin) {
 }
 
 int16_t LR11x0::setHeaderType(uint8_t hdrType, size_t len) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t type = RADIOLIB_LR11X0_PACKET_TYPE_NONE;
   int16_t state = getPacketType(&type);
@@ -1910,11 +2030,11 @@ int16_t LR11x0::readRegMem32(uint32_t addr, uint32_t* data, size_t len) {
 
   // build buffers - later we need to ensure endians are correct, 
   // so there is probably no way to do this without copying buffers and iterating
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t rplBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* rplBuff = new uint8_t[len*sizeof(uint32_t)];
-  #endif
+  uint8_t* reqScratch = NULL;
+  uint8_t* rplBuff = NULL;
+  if(!this->getBuffers(len*sizeof(uint32_t), &reqScratch, &rplBuff)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_READ_REG_MEM, false, rplBuff, len*sizeof(uint32_t), reqBuff, sizeof(reqBuff));
 
@@ -1925,10 +2045,7 @@ int16_t LR11x0::readRegMem32(uint32_t addr, uint32_t* data, size_t len) {
     }
   }
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] rplBuff;
-  #endif
-  
+  this->releaseBuffers(reqScratch, rplBuff);
   return(state);
 }
 
@@ -1948,11 +2065,11 @@ int16_t LR11x0::readBuffer8(uint8_t* data, size_t len, size_t offset) {
 
   // build buffers
   size_t reqLen = 2*sizeof(uint8_t) + len;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t reqBuff[sizeof(uint32_t) + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* reqBuff = new uint8_t[reqLen];
-  #endif
+  uint8_t* reqBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(reqLen, &reqBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   // set the offset and length
   reqBuff[0] = (uint8_t)offset;
@@ -1960,9 +2077,7 @@ int16_t LR11x0::readBuffer8(uint8_t* data, size_t len, size_t offset) {
 
   // send the request
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_READ_BUFFER, false, data, len, reqBuff, reqLen);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] reqBuff;
-  #endif
+  this->releaseBuffers(reqBuff, rplScratch);
   return(state);
 }
 
@@ -2126,11 +2241,11 @@ int16_t LR11x0::writeInfoPage(uint16_t addr, const uint32_t* data, size_t len) {
   // build buffers - later we need to ensure endians are correct, 
   // so there is probably no way to do this without copying buffers and iterating
   size_t buffLen = sizeof(uint8_t) + sizeof(uint16_t) + len*sizeof(uint32_t);
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t dataBuff[sizeof(uint8_t) + sizeof(uint16_t) + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* dataBuff = new uint8_t[buffLen];
-  #endif
+  uint8_t* dataBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(buffLen, &dataBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   // set the address
   dataBuff[0] = RADIOLIB_LR11X0_INFO_PAGE;
@@ -2146,9 +2261,7 @@ int16_t LR11x0::writeInfoPage(uint16_t addr, const uint32_t* data, size_t len) {
   }
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_WRITE_INFO_PAGE, true, dataBuff, buffLen);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] dataBuff;
-  #endif
+  this->releaseBuffers(dataBuff, rplScratch);
   return(state);
 }
 
@@ -2167,11 +2280,11 @@ int16_t LR11x0::readInfoPage(uint16_t addr, uint32_t* data, size_t len) {
 
   // build buffers - later we need to ensure endians are correct, 
   // so there is probably no way to do this without copying buffers and iterating
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t rplBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* rplBuff = new uint8_t[len*sizeof(uint32_t)];
-  #endif
+  uint8_t* reqScratch = NULL;
+  uint8_t* rplBuff = NULL;
+  if(!this->getBuffers(len*sizeof(uint32_t), &reqScratch, &rplBuff)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_READ_INFO_PAGE, false, rplBuff, len*sizeof(uint32_t), reqBuff, sizeof(reqBuff));
 
@@ -2182,10 +2295,7 @@ int16_t LR11x0::readInfoPage(uint16_t addr, uint32_t* data, size_t len) {
     }
   }
   
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] rplBuff;
-  #endif
-  
+  this->releaseBuffers(reqScratch, rplBuff);
   return(state);
 }
 
@@ -2352,16 +2462,19 @@ int16_t LR11x0::setCadParams(uint8_t symNum, uint8_t detPeak, uint8_t detMin, ui
 }
 
 int16_t LR11x0::setPacketType(uint8_t type) {
+  this->timeOnAir.invalidate();
   uint8_t buff[1] = { type };
   return(this->SPIcommand(RADIOLIB_LR11X0_CMD_SET_PACKET_TYPE, true, buff, sizeof(buff)));
 }
 
 int16_t LR11x0::setModulationParamsLoRa(uint8_t sf, uint8_t bw, uint8_t cr, uint8_t ldro) {
+  this->timeOnAir.invalidate();
   uint8_t buff[4] = { sf, bw, cr, ldro };
   return(this->SPIcommand(RADIOLIB_LR11X0_CMD_SET_MODULATION_PARAMS, true, buff, sizeof(buff)));
 }
 
 int16_t LR11x0::setModulationParamsGFSK(uint32_t br, uint8_t sh, uint8_t rxBw, uint32_t freqDev) {
+  this->timeOnAir.invalidate();
   uint8_t buff[10] = { 
     (uint8_t)((br >> 24) & 0xFF), (uint8_t)((br >> 16) & 0xFF),
     (uint8_t)((br >> 8) & 0xFF), (uint8_t)(br & 0xFF), sh, rxBw,
@@ -2372,6 +2485,7 @@ int16_t LR11x0::setModulationParamsGFSK(uint32_t br, uint8_t sh, uint8_t rxBw, u
 }
 
 int16_t LR11x0::setModulationParamsLrFhss(uint32_t br, uint8_t sh) {
+  this->timeOnAir.invalidate();
   uint8_t buff[5] = { 
     (uint8_t)((br >> 24) & 0xFF), (uint8_t)((br >> 16) & 0xFF),
     (uint8_t)((br >> 8) & 0xFF), (uint8_t)(br & 0xFF), sh
@@ -2561,11 +2675,11 @@ int16_t LR11x0::lrFhssBuildFrame(uint8_t hdrCount, uint8_t cr, uint8_t grid, boo
 
   // build buffers
   size_t buffLen = 9 + len;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t dataBuff[9 + 190];
-  #else
-    uint8_t* dataBuff = new uint8_t[buffLen];
-  #endif
+  uint8_t* dataBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(buffLen, &dataBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   // set properties of the packet
   dataBuff[0] = hdrCount;
@@ -2580,9 +2694,7 @@ int16_t LR11x0::lrFhssBuildFrame(uint8_t hdrCount, uint8_t cr, uint8_t grid, boo
   memcpy(&dataBuff[9], payload, len);
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_LR_FHSS_BUILD_FRAME, true, dataBuff, buffLen);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] dataBuff;
-  #endif
+  this->releaseBuffers(dataBuff, rplScratch);
   return(state);
 }
 
@@ -2620,20 +2732,18 @@ int16_t LR11x0::bleBeaconCommon(uint16_t cmd, uint8_t chan, uint8_t* payload, si
   }
 
   // build buffers
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t dataBuff[sizeof(uint8_t) + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* dataBuff = new uint8_t[sizeof(uint8_t) + len];
-  #endif
+  uint8_t* dataBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(sizeof(uint8_t) + len, &dataBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   // set the channel
   dataBuff[0] = chan;
   memcpy(&dataBuff[1], payload, len);
 
   int16_t state = this->SPIcommand(cmd, true, dataBuff, sizeof(uint8_t) + len);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] dataBuff;
-  #endif
+  this->releaseBuffers(dataBuff, rplScratch);
   return(state);
 }
 
@@ -2679,9 +2789,9 @@ int16_t LR11x0::wifiCountryCodeTimeLimit(uint16_t mask, uint8_t nbMaxRes, uint16
   return(this->SPIcommand(RADIOLIB_LR11X0_CMD_WIFI_COUNTRY_CODE_TIME_LIMIT, true, buff, sizeof(buff)));
 }
 
-int16_t LR11x0::wifiReadResults(uint8_t index, uint8_t nbResults, uint8_t format, uint8_t* results) {
+int16_t LR11x0::wifiReadResults(uint8_t index, uint8_t nbResults, uint8_t format, uint8_t* results, size_t len) {
   uint8_t buff[3] = { index, nbResults, format };
-  return(this->SPIcommand(RADIOLIB_LR11X0_CMD_WIFI_READ_RESULTS, false, results, RADIOLIB_LR11X0_WIFI_RESULT_MAX_LEN, buff, sizeof(buff)));
+  return(this->SPIcommand(RADIOLIB_LR11X0_CMD_WIFI_READ_RESULTS, false, results, len, buff, sizeof(buff)));
 }
 
 int16_t LR11x0::wifiResetCumulTimings(void) {
@@ -2881,11 +2991,11 @@ int16_t LR11x0::gnssGetSvDetected(uint8_t* svId, uint8_t* snr, uint16_t* doppler
 
   // build buffers
   size_t buffLen = nbSv*sizeof(uint32_t);
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t dataBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* dataBuff = new uint8_t[buffLen];
-  #endif
+  uint8_t* reqScratch = NULL;
+  uint8_t* dataBuff = NULL;
+  if(!this->getBuffers(buffLen, &reqScratch, &dataBuff)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_GNSS_GET_SV_DETECTED, false, dataBuff, buffLen);
   if(state == RADIOLIB_ERR_NONE) {
@@ -2896,9 +3006,7 @@ int16_t LR11x0::gnssGetSvDetected(uint8_t* svId, uint8_t* snr, uint16_t* doppler
     }
   }
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] dataBuff;
-  #endif
+  this->releaseBuffers(reqScratch, dataBuff);
   return(state);
 }
 
@@ -3180,13 +3288,11 @@ int16_t LR11x0::cryptoProcessJoinAccept(uint8_t decKeyId, uint8_t verKeyId, uint
   size_t rplLen = sizeof(uint8_t) + len;
 
   // build buffers
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t reqBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-    uint8_t rplBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* reqBuff = new uint8_t[reqLen];
-    uint8_t* rplBuff = new uint8_t[rplLen];
-  #endif
+  uint8_t* reqBuff = NULL;
+  uint8_t* rplBuff = NULL;
+  if(!this->getBuffers(RADIOLIB_MAX(reqLen, rplLen), &reqBuff, &rplBuff)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
   
   // set the request fields
   reqBuff[0] = decKeyId;
@@ -3196,43 +3302,35 @@ int16_t LR11x0::cryptoProcessJoinAccept(uint8_t decKeyId, uint8_t verKeyId, uint
   memcpy(&reqBuff[3 + headerLen], dataIn, len);
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_CRYPTO_PROCESS_JOIN_ACCEPT, false, rplBuff, rplLen, reqBuff, reqLen);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] reqBuff;
-  #endif
-  if(state != RADIOLIB_ERR_NONE) {
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] rplBuff;
-    #endif
-    return(state);
-  }
 
   // check the crypto engine state
-  if(rplBuff[0] != RADIOLIB_LR11X0_CRYPTO_STATUS_SUCCESS) {
+  if((state == RADIOLIB_ERR_NONE) && (rplBuff[0] != RADIOLIB_LR11X0_CRYPTO_STATUS_SUCCESS)) {
     RADIOLIB_DEBUG_BASIC_PRINTLN("Crypto Engine error: %02x", rplBuff[0]);
-    return(RADIOLIB_ERR_SPI_CMD_FAILED);
+    state = RADIOLIB_ERR_SPI_CMD_FAILED;
   }
 
   // pass the data
-  memcpy(dataOut, &rplBuff[1], len);
+  if(state == RADIOLIB_ERR_NONE) {
+    memcpy(dataOut, &rplBuff[1], len);
+  }
+  this->releaseBuffers(reqBuff, rplBuff);
   return(state);
 }
 
 int16_t LR11x0::cryptoComputeAesCmac(uint8_t keyId, uint8_t* data, size_t len, uint32_t* mic) {
   size_t reqLen = sizeof(uint8_t) + len;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t reqBuff[sizeof(uint8_t) + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* reqBuff = new uint8_t[reqLen];
-  #endif
+  uint8_t* reqBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(reqLen, &reqBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
   uint8_t rplBuff[5] = { 0 };
   
   reqBuff[0] = keyId;
   memcpy(&reqBuff[1], data, len);
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_CRYPTO_COMPUTE_AES_CMAC, false, rplBuff, sizeof(rplBuff), reqBuff, reqLen);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] reqBuff;
-  #endif
+  this->releaseBuffers(reqBuff, rplScratch);
 
   // check the crypto engine state
   if(rplBuff[0] != RADIOLIB_LR11X0_CRYPTO_STATUS_SUCCESS) {
@@ -3246,11 +3344,11 @@ int16_t LR11x0::cryptoComputeAesCmac(uint8_t keyId, uint8_t* data, size_t len, u
 
 int16_t LR11x0::cryptoVerifyAesCmac(uint8_t keyId, uint32_t micExp, uint8_t* data, size_t len, bool* result) {
    size_t reqLen = sizeof(uint8_t) + sizeof(uint32_t) + len;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t reqBuff[sizeof(uint8_t) + sizeof(uint32_t) + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* reqBuff = new uint8_t[reqLen];
-  #endif
+  uint8_t* reqBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(reqLen, &reqBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
   uint8_t rplBuff[1] = { 0 };
   
   reqBuff[0] = keyId;
@@ -3261,9 +3359,7 @@ int16_t LR11x0::cryptoVerifyAesCmac(uint8_t keyId, uint32_t micExp, uint8_t* dat
   memcpy(&reqBuff[5], data, len);
 
   int16_t state = this->SPIcommand(RADIOLIB_LR11X0_CMD_CRYPTO_VERIFY_AES_CMAC, false, rplBuff, sizeof(rplBuff), reqBuff, reqLen);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] reqBuff;
-  #endif
+  this->releaseBuffers(reqBuff, rplScratch);
 
   // check the crypto engine state
   if(rplBuff[0] != RADIOLIB_LR11X0_CRYPTO_STATUS_SUCCESS) {
@@ -3332,12 +3428,10 @@ int16_t LR11x0::cryptoCheckEncryptedFirmwareImageResult(bool* result) {
 }
 
 int16_t LR11x0::bootEraseFlash(void) {
-  // erasing flash takes about 2.5 seconds, temporarily tset SPI timeout to 3 seconds
-  RadioLibTime_t timeout = this->mod->spiConfig.timeout;
-  this->mod->spiConfig.timeout = 3000;
-  int16_t state = this->mod->SPIwriteStream(RADIOLIB_LR11X0_CMD_BOOT_ERASE_FLASH, NULL, 0, false, false);
-  this->mod->spiConfig.timeout = timeout;
-  return(state);
+  // erasing flash takes about 2.5 seconds, use SPI timeout of 3 seconds
+  Module::SPIConfig_t config = this->mod->spiConfig;
+  config.timeout = 3000;
+  return(this->mod->SPIwriteStream(config, RADIOLIB_LR11X0_CMD_BOOT_ERASE_FLASH, NULL, 0, true, false));
 }
 
 int16_t LR11x0::bootWriteFlashEncrypted(uint32_t offset, uint32_t* data, size_t len, bool nonvolatile) {
@@ -3378,11 +3472,11 @@ int16_t LR11x0::writeCommon(uint16_t cmd, uint32_t addrOffset, const uint32_t* d
   // build buffers - later we need to ensure endians are correct, 
   // so there is probably no way to do this without copying buffers and iterating
   size_t buffLen = sizeof(uint32_t) + len*sizeof(uint32_t);
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t dataBuff[sizeof(uint32_t) + RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* dataBuff = new uint8_t[buffLen];
-  #endif
+  uint8_t* dataBuff = NULL;
+  uint8_t* rplScratch = NULL;
+  if(!this->getBuffers(buffLen, &dataBuff, &rplScratch)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
 
   // set the address or offset
   dataBuff[0] = (uint8_t)((addrOffset >> 24) & 0xFF);
@@ -3405,46 +3499,50 @@ int16_t LR11x0::writeCommon(uint16_t cmd, uint32_t addrOffset, const uint32_t* d
   }
 
   int16_t state = this->mod->SPIwriteStream(cmd, dataBuff, buffLen, true, false);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] dataBuff;
-  #endif
+  this->releaseBuffers(dataBuff, rplScratch);
   return(state);
 }
 
 int16_t LR11x0::cryptoCommon(uint16_t cmd, uint8_t keyId, uint8_t* dataIn, size_t len, uint8_t* dataOut) {
   // build buffers
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t reqBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-    uint8_t rplBuff[RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN];
-  #else
-    uint8_t* reqBuff = new uint8_t[sizeof(uint8_t) + len];
-    uint8_t* rplBuff = new uint8_t[sizeof(uint8_t) + len];
-  #endif
+  uint8_t* reqBuff = NULL;
+  uint8_t* rplBuff = NULL;
+  if(!this->getBuffers(sizeof(uint8_t) + len, &reqBuff, &rplBuff)) {
+    return(RADIOLIB_ERR_MEMORY_ALLOCATION_FAILED);
+  }
   
   // set the request fields
   reqBuff[0] = keyId;
   memcpy(&reqBuff[1], dataIn, len);
 
   int16_t state = this->SPIcommand(cmd, false, rplBuff, sizeof(uint8_t) + len, reqBuff, sizeof(uint8_t) + len);
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] reqBuff;
-  #endif
-  if(state != RADIOLIB_ERR_NONE) {
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] rplBuff;
-    #endif
-    return(state);
-  }
 
   // check the crypto engine state
-  if(rplBuff[0] != RADIOLIB_LR11X0_CRYPTO_STATUS_SUCCESS) {
+  if((state == RADIOLIB_ERR_NONE) && (rplBuff[0] != RADIOLIB_LR11X0_CRYPTO_STATUS_SUCCESS)) {
     RADIOLIB_DEBUG_BASIC_PRINTLN("Crypto Engine error: %02x", rplBuff[0]);
-    return(RADIOLIB_ERR_SPI_CMD_FAILED);
+    state = RADIOLIB_ERR_SPI_CMD_FAILED;
   }
 
   // pass the data
-  memcpy(dataOut, &rplBuff[1], len);
+  if(state == RADIOLIB_ERR_NONE) {
+    memcpy(dataOut, &rplBuff[1], len);
+  }
+  this->releaseBuffers(reqBuff, rplBuff);
   return(state);
 }
 
+bool LR11x0::getBuffers(size_t len, uint8_t** req, uint8_t** rpl) {
+  this->mod->hal->spiAcquire();
+  if(!this->mod->SPIgetBuffers(len, req, rpl)) {
+    this->mod->hal->spiRelease();
+    return(false);
+  }
+  return(true);
+}
+
+void LR11x0::releaseBuffers(uint8_t* req, uint8_t* rpl) {
+  this->mod->SPIreleaseBuffers(req, rpl);
+  this->mod->hal->spiRelease();
+}
+
 #endif
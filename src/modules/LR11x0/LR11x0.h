@@ -8,6 +8,7 @@
 #include "../../Module.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 // LR11X0 physical layer properties
 #define RADIOLIB_LR11X0_FREQUENCY_STEP_SIZE                     1.0
@@ -506,6 +507,7 @@
 #define RADIOLIB_LR11X0_WIFI_RESULT_TYPE_COMPLETE               (0x01UL << 0)   //  7     0     Wi-Fi scan result type: complete
 #define RADIOLIB_LR11X0_WIFI_RESULT_TYPE_BASIC                  (0x04UL << 0)   //  7     0                             basic
 #define RADIOLIB_LR11X0_WIFI_RESULT_MAX_LEN                     (79)            //  7     0     maximum possible Wi-Fi scan size
+#define RADIOLIB_LR11X0_WIFI_RESULT_BASIC_LEN                   (9)             //  7     0     size of Wi-Fi scan result in basic format
 #define RADIOLIB_LR11X0_WIFI_RESULT_MAC_LEN                     (6)             //  7     0     MAC address length in bytes
 #define RADIOLIB_LR11X0_WIFI_RESULT_SSID_LEN                    (32)            //  7     0     SSID length in bytes
 
@@ -738,6 +740,25 @@ class LR11x0: public PhysicalLayer {
         MODE_WIFI,
     };
 
+    /*!
+      \brief Callback to read part of a firmware image, used by the streaming firmware update.
+      \param offset Offset of the first word to read from the start of the image, in 32-bit words.
+      \param data Buffer to save the words to, in host byte order.
+      \param len Number of words to read.
+      \param ctx User context passed to LR11x0::updateFirmware.
+      \returns \ref status_codes, any error aborts the update.
+    */
+    typedef int16_t (*FirmwareReadCb_t)(uint32_t offset, uint32_t* data, size_t len, void* ctx);
+
+    /*!
+      \brief Callback to report progress of the firmware update.
+      \param written Number of words from the start of the image that were acknowledged by the device.
+      Saving this value allows to resume the update after power loss.
+      \param size Size of the image in 32-bit words.
+      \param ctx User context passed to LR11x0::updateFirmware.
+    */
+    typedef void (*FirmwareProgressCb_t)(uint32_t written, uint32_t size, void* ctx);
+
     /*!
       \brief Whether the module has an XTAL (true) or TCXO (false). Defaults to false.
     */
@@ -1351,6 +1372,18 @@ class LR11x0: public PhysicalLayer {
       \returns \ref status_codes
     */
     int16_t getWifiScanResult(LR11x0WifiResult_t* result, uint8_t index, bool brief = false);
+
+    /*!
+      \brief Retrieve all passive WiFi scan results at once, in brief format (only information in LR11x0WifiResult_t).
+      Results are read in as few SPI transactions as possible, which is much faster than calling getWifiScanResult
+      for each of them.
+      \param results Pointer to array to hold the results.
+      \param count Pointer to a variable that holds the number of elements in the results array,
+      will be set to the number of results that were actually retrieved.
+      \param dedup Whether to only keep a single result for each MAC address. If enabled, the result with the highest RSSI is kept.
+      \returns \ref status_codes
+    */
+    int16_t getWifiScanResults(LR11x0WifiResult_t* results, uint8_t* count, bool dedup = false);
     
     /*!
       \brief Blocking WiFi scan method. Performs a full passive WiFi scan.
@@ -1388,7 +1421,23 @@ class LR11x0: public PhysicalLayer {
       \returns \ref status_codes
     */
     int16_t updateFirmware(const uint32_t* image, size_t size, bool nonvolatile = true);
-    
+
+    /*!
+      \brief Method to upload new firmware image to the device, with the image streamed from a callback
+      (e.g. when it is read from a file, external flash or received over network).
+      The image is written in the largest chunks the bootloader accepts, progress is reported
+      after each chunk. If the update is interrupted (e.g. by power loss), the device stays in bootloader,
+      and the update can be resumed by calling this method again with the last reported progress as the start offset.
+      \param readCb Callback to read the image.
+      \param size Size of the image in 32-bit words.
+      \param ctx User context passed to the callbacks.
+      \param start Offset to resume the update from in 32-bit words, 0 to start a new update.
+      Resuming is only possible when the device is still in bootloader, otherwise the whole image is written again.
+      \param progressCb Callback to report progress, or NULL to not report progress.
+      \returns \ref status_codes
+    */
+    int16_t updateFirmware(FirmwareReadCb_t readCb, size_t size, void* ctx, uint32_t start = 0, FirmwareProgressCb_t progressCb = NULL);
+
 #if !RADIOLIB_GODMODE && !RADIOLIB_LOW_LEVEL
   protected:
 #endif
@@ -1480,7 +1529,7 @@ class LR11x0: public PhysicalLayer {
     int16_t wifiCountryCode(uint16_t mask, uint8_t nbMaxRes, uint8_t nbScanPerChan, uint16_t timeout, uint8_t abortOnTimeout);
     int16_t wifiCountryCodeTimeLimit(uint16_t mask, uint8_t nbMaxRes, uint16_t timePerChan, uint16_t timeout);
     int16_t wifiGetNbResults(uint8_t* nbResults);
-    int16_t wifiReadResults(uint8_t index, uint8_t nbResults, uint8_t format, uint8_t* results);
+    int16_t wifiReadResults(uint8_t index, uint8_t nbResults, uint8_t format, uint8_t* results, size_t len);
     int16_t wifiResetCumulTimings(void);
     int16_t wifiReadCumulTimings(uint32_t* detection, uint32_t* capture, uint32_t* demodulation);
     int16_t wifiGetNbCountryCodeResults(uint8_t* nbResults);
@@ -1582,11 +1631,16 @@ class LR11x0: public PhysicalLayer {
     uint8_t lrFhssCr = 0, lrFhssBw = 0, lrFhssHdrCount = 0;
     uint16_t lrFhssHopSeq = 0;
 
+    // invalidated whenever packet type, modulation or packet parameters are set
+    RadioLibTimeOnAir timeOnAir;
+
     float dataRateMeasured = 0;
 
     uint8_t wifiScanMode = 0;
 
     int16_t modSetup(float tcxoVoltage, uint8_t modem);
+    static void parseWifiResult(LR11x0WifiResult_t* result, const uint8_t* raw);
+    static void swapWords(uint32_t* data, size_t len);
     static int16_t SPIparseStatus(uint8_t in);
     static int16_t SPIcheckStatus(Module* mod);
     bool findChip(uint8_t ver);
@@ -1599,6 +1653,11 @@ class LR11x0: public PhysicalLayer {
     int16_t bleBeaconCommon(uint16_t cmd, uint8_t chan, uint8_t* payload, size_t len);
     int16_t writeCommon(uint16_t cmd, uint32_t addrOffset, const uint32_t* data, size_t len, bool nonvolatile);
     int16_t cryptoCommon(uint16_t cmd, uint8_t keyId, uint8_t* dataIn, size_t len, uint8_t* dataOut);
+
+    // requests and replies are prepared in the Module scratch buffers, the bus is held until they are released
+    // (except while the module is busy)
+    bool getBuffers(size_t len, uint8_t** req, uint8_t** rpl);
+    void releaseBuffers(uint8_t* req, uint8_t* rpl);
 };
 
 #endif
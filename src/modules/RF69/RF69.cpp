@@ -11,6 +11,15 @@ int16_t RF69::begin(float freq, float br, float freqDev, float rxBw, int8_t pwr,
   this->mod->init();
   this->mod->hal->pinMode(this->mod->getIrq(), this->mod->hal->GpioModeInput);
 
+  // registers that can be changed by the module itself
+  static const uint8_t volatileRegs[] = {
+    RADIOLIB_RF69_REG_FIFO, RADIOLIB_RF69_REG_OP_MODE, RADIOLIB_RF69_REG_OSC_1, RADIOLIB_RF69_REG_AFC_FEI,
+    RADIOLIB_RF69_REG_AFC_MSB, RADIOLIB_RF69_REG_AFC_LSB, RADIOLIB_RF69_REG_FEI_MSB, RADIOLIB_RF69_REG_FEI_LSB,
+    RADIOLIB_RF69_REG_RSSI_CONFIG, RADIOLIB_RF69_REG_RSSI_VALUE, RADIOLIB_RF69_REG_IRQ_FLAGS_1,
+    RADIOLIB_RF69_REG_IRQ_FLAGS_2, RADIOLIB_RF69_REG_TEMP_1, RADIOLIB_RF69_REG_TEMP_2,
+  };
+  this->mod->SPIcacheSetVolatile(volatileRegs, sizeof(volatileRegs));
+
   // try to find the RF69 chip
   uint8_t i = 0;
   bool flagFound = false;
@@ -96,6 +105,7 @@ void RF69::reset() {
   this->mod->hal->delay(1);
   this->mod->hal->digitalWrite(this->mod->getRst(), this->mod->hal->GpioLevelLow);
   this->mod->hal->delay(10);
+  this->mod->SPIcacheInvalidate();
 }
 
 int16_t RF69::transmit(uint8_t* data, size_t len, uint8_t addr) {
@@ -186,6 +196,13 @@ int16_t RF69::transmitDirect(uint32_t frf) {
   return(setMode(RADIOLIB_RF69_TX));
 }
 
+int16_t RF69::setDirectFrequency(uint32_t frf) {
+  // the new frequency is applied once the LSB is written, no mode change is needed
+  uint8_t data[] = { (uint8_t)((frf & 0xFF0000) >> 16), (uint8_t)((frf & 0x00FF00) >> 8), (uint8_t)(frf & 0x0000FF) };
+  this->mod->SPIwriteRegisterBurst(RADIOLIB_RF69_REG_FRF_MSB, data, 3);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t RF69::receiveDirect() {
   // set RF switch (if present)
   this->mod->setRfSwitchState(Module::MODE_RX);
@@ -993,53 +1010,47 @@ int16_t RF69::config() {
   state = setMode(RADIOLIB_RF69_STANDBY);
   RADIOLIB_ASSERT(state);
 
+  // reset FIFO flag
+  this->mod->SPIwriteRegister(RADIOLIB_RF69_REG_IRQ_FLAGS_2, RADIOLIB_RF69_IRQ_FIFO_OVERRUN);
+
+  // the rest of the configuration is applied in a single batch
+  this->mod->SPIbatchBegin();
+
   // set operation modes
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_OP_MODE, RADIOLIB_RF69_SEQUENCER_ON | RADIOLIB_RF69_LISTEN_OFF, 7, 6);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_OP_MODE, RADIOLIB_RF69_SEQUENCER_ON | RADIOLIB_RF69_LISTEN_OFF, 7, 6);
 
   // enable over-current protection
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_OCP, RADIOLIB_RF69_OCP_ON, 4, 4);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_OCP, RADIOLIB_RF69_OCP_ON, 4, 4);
 
   // set data mode, modulation type and shaping
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_DATA_MODUL, RADIOLIB_RF69_PACKET_MODE | RADIOLIB_RF69_FSK, 6, 3);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_DATA_MODUL, RADIOLIB_RF69_FSK_GAUSSIAN_0_3, 1, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_DATA_MODUL, RADIOLIB_RF69_PACKET_MODE | RADIOLIB_RF69_FSK, 6, 3);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_DATA_MODUL, RADIOLIB_RF69_FSK_GAUSSIAN_0_3, 1, 0);
 
   // set RSSI threshold
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_RSSI_THRESH, RADIOLIB_RF69_RSSI_THRESHOLD, 7, 0);
-  RADIOLIB_ASSERT(state);
-
-  // reset FIFO flag
-  this->mod->SPIwriteRegister(RADIOLIB_RF69_REG_IRQ_FLAGS_2, RADIOLIB_RF69_IRQ_FIFO_OVERRUN);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_RSSI_THRESH, RADIOLIB_RF69_RSSI_THRESHOLD, 7, 0);
 
   // disable ClkOut on DIO5
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_DIO_MAPPING_2, RADIOLIB_RF69_CLK_OUT_OFF, 2, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_DIO_MAPPING_2, RADIOLIB_RF69_CLK_OUT_OFF, 2, 0);
 
   // set packet configuration and disable encryption
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PACKET_CONFIG_1, RADIOLIB_RF69_PACKET_FORMAT_VARIABLE | RADIOLIB_RF69_DC_FREE_NONE | RADIOLIB_RF69_CRC_ON | RADIOLIB_RF69_CRC_AUTOCLEAR_ON | RADIOLIB_RF69_ADDRESS_FILTERING_OFF, 7, 1);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PACKET_CONFIG_2, RADIOLIB_RF69_INTER_PACKET_RX_DELAY, 7, 4);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PACKET_CONFIG_2, RADIOLIB_RF69_AUTO_RX_RESTART_ON | RADIOLIB_RF69_AES_OFF, 1, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PACKET_CONFIG_1, RADIOLIB_RF69_PACKET_FORMAT_VARIABLE | RADIOLIB_RF69_DC_FREE_NONE | RADIOLIB_RF69_CRC_ON | RADIOLIB_RF69_CRC_AUTOCLEAR_ON | RADIOLIB_RF69_ADDRESS_FILTERING_OFF, 7, 1);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PACKET_CONFIG_2, RADIOLIB_RF69_INTER_PACKET_RX_DELAY, 7, 4);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PACKET_CONFIG_2, RADIOLIB_RF69_AUTO_RX_RESTART_ON | RADIOLIB_RF69_AES_OFF, 1, 0);
 
   // set payload length
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PAYLOAD_LENGTH, RADIOLIB_RF69_PAYLOAD_LENGTH, 7, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_PAYLOAD_LENGTH, RADIOLIB_RF69_PAYLOAD_LENGTH, 7, 0);
 
   // set FIFO threshold
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_FIFO_THRESH, RADIOLIB_RF69_TX_START_CONDITION_FIFO_NOT_EMPTY | RADIOLIB_RF69_FIFO_THRESH, 7, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_FIFO_THRESH, RADIOLIB_RF69_TX_START_CONDITION_FIFO_NOT_EMPTY | RADIOLIB_RF69_FIFO_THRESH, 7, 0);
 
   // set Rx timeouts
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_RX_TIMEOUT_1, RADIOLIB_RF69_TIMEOUT_RX_START, 7, 0);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_RX_TIMEOUT_2, RADIOLIB_RF69_TIMEOUT_RSSI_THRESH, 7, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_RX_TIMEOUT_1, RADIOLIB_RF69_TIMEOUT_RX_START, 7, 0);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_RX_TIMEOUT_2, RADIOLIB_RF69_TIMEOUT_RSSI_THRESH, 7, 0);
 
   // enable improved fading margin
-  state = this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_TEST_DAGC, RADIOLIB_RF69_CONTINUOUS_DAGC_LOW_BETA_OFF, 7, 0);
+  this->mod->SPIsetRegValue(RADIOLIB_RF69_REG_TEST_DAGC, RADIOLIB_RF69_CONTINUOUS_DAGC_LOW_BETA_OFF, 7, 0);
 
-  return(state);
+  return(this->mod->SPIbatchFlush());
 }
 
 int16_t RF69::setPacketMode(uint8_t mode, uint8_t len) {
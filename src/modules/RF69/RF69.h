@@ -560,6 +560,14 @@ class RF69: public PhysicalLayer {
     */
     int16_t transmitDirect(uint32_t frf = 0) override;
 
+    /*!
+      \brief Change frequency of an ongoing direct mode transmission with a single burst write.
+      The module is not switched to transmit mode, so this can only be called after transmitDirect.
+      \param frf Raw RF frequency value.
+      \returns \ref status_codes
+    */
+    int16_t setDirectFrequency(uint32_t frf) override;
+
     /*!
       \brief Starts direct mode reception.
       \returns \ref status_codes
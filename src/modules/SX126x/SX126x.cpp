@@ -350,6 +350,12 @@ int16_t SX126x::transmitDirect(uint32_t frf) {
   return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_TX_CONTINUOUS_WAVE, data, 1));
 }
 
+int16_t SX126x::setDirectFrequency(uint32_t frf) {
+  // the module keeps transmitting, skip status verification to keep frequency shifts short
+  uint8_t data[] = { (uint8_t)((frf >> 24) & 0xFF), (uint8_t)((frf >> 16) & 0xFF), (uint8_t)((frf >> 8) & 0xFF), (uint8_t)(frf & 0xFF) };
+  return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY, data, 4, true, false));
+}
+
 int16_t SX126x::receiveDirect() {
   // set RF switch (if present)
   this->mod->setRfSwitchState(Module::MODE_RX);
@@ -898,6 +904,7 @@ int16_t SX126x::setPreambleLength(size_t preambleLength) {
   uint8_t modem = getPacketType();
   if(modem == RADIOLIB_SX126X_PACKET_TYPE_LORA) {
     this->preambleLengthLoRa = preambleLength;
+    this->timeOnAir.invalidate();
     return(setPacketParams(this->preambleLengthLoRa, this->crcTypeLoRa, this->implicitLen, this->headerType, this->invertIQEnabled));
   } else if(modem == RADIOLIB_SX126X_PACKET_TYPE_GFSK) {
     this->preambleLengthFSK = preambleLength;
@@ -1279,6 +1286,7 @@ int16_t SX126x::setCRC(uint8_t len, uint16_t initial, uint16_t polynomial, bool
     } else {
       this->crcTypeLoRa = RADIOLIB_SX126X_LORA_CRC_OFF;
     }
+    this->timeOnAir.invalidate();
 
     return(setPacketParams(this->preambleLengthLoRa, this->crcTypeLoRa, this->implicitLen, this->headerType, this->invertIQEnabled));
   }
@@ -1412,38 +1420,17 @@ int16_t SX126x::variablePacketLengthMode(uint8_t maxLen) {
 }
 
 RadioLibTime_t SX126x::getTimeOnAir(size_t len) {
-  // everything is in microseconds to allow integer arithmetic
-  // some constants have .25, these are multiplied by 4, and have _x4 postfix to indicate that fact
-  if(getPacketType() == RADIOLIB_SX126X_PACKET_TYPE_LORA) {
-    uint32_t symbolLength_us = ((uint32_t)(1000 * 10) << this->spreadingFactor) / (this->bandwidthKhz * 10) ;
-    uint8_t sfCoeff1_x4 = 17; // (4.25 * 4)
-    uint8_t sfCoeff2 = 8;
-    if(this->spreadingFactor == 5 || this->spreadingFactor == 6) {
-      sfCoeff1_x4 = 25; // 6.25 * 4
-      sfCoeff2 = 0;
-    }
-    uint8_t sfDivisor = 4*this->spreadingFactor;
-    if(symbolLength_us >= 16000) {
-      sfDivisor = 4*(this->spreadingFactor - 2);
-    }
-    const int8_t bitsPerCrc = 16;
-    const int8_t N_symbol_header = this->headerType == RADIOLIB_SX126X_LORA_HEADER_EXPLICIT ? 20 : 0;
-
-    // numerator of equation in section 6.1.4 of SX1268 datasheet v1.1 (might not actually be bitcount, but it has len * 8)
-    int16_t bitCount = (int16_t) 8 * len + this->crcTypeLoRa * bitsPerCrc - 4 * this->spreadingFactor  + sfCoeff2 + N_symbol_header;
-    if(bitCount < 0) {
-      bitCount = 0;
+  // packet type is only read from the chip after the configuration has changed
+  if(!this->timeOnAir.isValid()) {
+    if(getPacketType() == RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+      this->timeOnAir.setLoRa(this->spreadingFactor, this->bandwidthKhz, this->codingRate + 4, this->preambleLengthLoRa,
+                              this->headerType == RADIOLIB_SX126X_LORA_HEADER_EXPLICIT, this->crcTypeLoRa == RADIOLIB_SX126X_LORA_CRC_ON,
+                              this->ldrOptimize == RADIOLIB_SX126X_LORA_LOW_DATA_RATE_OPTIMIZE_ON);
+    } else {
+      this->timeOnAir.setBitRate((float)this->bitRate / (RADIOLIB_SX126X_CRYSTAL_FREQ * 32.0f));
     }
-    // add (sfDivisor) - 1 to the numerator to give integer CEIL(...)
-    uint16_t nPreCodedSymbols = (bitCount + (sfDivisor - 1)) / (sfDivisor);
-
-    // preamble can be 65k, therefore nSymbol_x4 needs to be 32 bit
-    uint32_t nSymbol_x4 = (this->preambleLengthLoRa + 8) * 4 + sfCoeff1_x4 + nPreCodedSymbols * (this->codingRate + 4) * 4;
-
-    return((symbolLength_us * nSymbol_x4) / 4);
-  } else {
-    return(((uint32_t)len * 8 * this->bitRate) / (RADIOLIB_SX126X_CRYSTAL_FREQ * 32));
   }
+  return(this->timeOnAir.get(len));
 }
 
 RadioLibTime_t SX126x::calculateRxTimeout(RadioLibTime_t timeoutUs) {
@@ -1643,9 +1630,11 @@ int16_t SX126x::spectralScanGetStatus() {
 }
 
 int16_t SX126x::spectralScanGetResult(uint16_t* results) {
-  // read the raw results
+  // read the raw results, the status sent along with them is checked without an extra transaction
   uint8_t data[2*RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE];
-  this->mod->SPIreadRegisterBurst(RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT, 2*RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE, data);
+  uint8_t cmd[] = { RADIOLIB_SX126X_CMD_READ_REGISTER, (uint8_t)((RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT >> 8) & 0xFF), (uint8_t)(RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT & 0xFF) };
+  int16_t state = this->mod->SPIreadStream(cmd, 3, data, sizeof(data), true, false);
+  RADIOLIB_ASSERT(state);
 
   // convert it
   for(uint8_t i = 0; i < RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE; i++) {
@@ -1654,6 +1643,162 @@ int16_t SX126x::spectralScanGetResult(uint16_t* results) {
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t SX126x::spectralScanSweepStart(float freqStart, float freqEnd, float freqStep, SX126xSpectralScanRecord_t* records, size_t numRecords, uint16_t numSamples, uint8_t window, uint8_t interval) {
+  // check the parameters
+  if(records == NULL) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  if((numRecords < 2) || (numSamples == 0)) {
+    return(RADIOLIB_ERR_INVALID_NUM_SAMPLES);
+  }
+  RADIOLIB_CHECK_RANGE(freqStart, 150.0f, 960.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  RADIOLIB_CHECK_RANGE(freqEnd, freqStart, 960.0f, RADIOLIB_ERR_INVALID_FREQUENCY);
+  if((freqStep <= 0) || (((freqEnd - freqStart) / freqStep) >= 65535.0f)) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+
+  // calibrate image rejection once for the whole range, so that each step only has to retune
+  int16_t state = standby();
+  RADIOLIB_ASSERT(state);
+  state = calibrateImageRejection(freqStart, freqEnd);
+  RADIOLIB_ASSERT(state);
+
+  // precalculate raw frequencies
+  this->sweepFrfStart = (freqStart * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ;
+  this->sweepFreqStep = freqStep;
+  this->sweepSteps = (uint16_t)((freqEnd - freqStart) / freqStep + 0.001f) + 1;
+  state = setRfFrequency(this->sweepFrfStart);
+  RADIOLIB_ASSERT(state);
+
+  // scan duration, so that the status is not polled too early
+  const float intervals[] = { 7.68f, 8.20f, 8.68f };
+  this->sweepScanLen = 0;
+  if((interval >= RADIOLIB_SX126X_SCAN_INTERVAL_7_68_US) && (interval <= RADIOLIB_SX126X_SCAN_INTERVAL_8_68_US)) {
+    this->sweepScanLen = (RadioLibTime_t)((float)numSamples * intervals[interval - RADIOLIB_SX126X_SCAN_INTERVAL_7_68_US]);
+  }
+
+  // reset the sweep
+  this->sweepRecords = records;
+  this->sweepSize = numRecords;
+  RADIOLIB_ATOMIC_STORE(this->sweepHead, 0);
+  RADIOLIB_ATOMIC_STORE(this->sweepTail, 0);
+  this->sweepStep = 0;
+  this->sweepCount = 0;
+  this->sweepSamples = numSamples;
+  this->sweepWindow = window;
+  this->sweepInterval = interval;
+  this->sweepLines = 0;
+  this->sweepOverflows = 0;
+  this->sweepElapsed = 0;
+
+  // start the first scan
+  this->sweepStartTime = this->mod->hal->micros();
+  this->sweepScanStart = this->sweepStartTime;
+  state = spectralScanStart(numSamples, window, interval);
+  RADIOLIB_ASSERT(state);
+  this->sweepActive = true;
+  return(state);
+}
+
+int16_t SX126x::spectralScanSweepProcess() {
+  if(!this->sweepActive) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // the scan cannot be finished yet, don't waste SPI transactions on the status
+  if(this->mod->hal->micros() - this->sweepScanStart < this->sweepScanLen) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  if(spectralScanGetStatus() != RADIOLIB_ERR_NONE) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // retune to the next step first, the PLL can settle while the result is being read out
+  uint16_t step = this->sweepStep;
+  uint16_t sweep = this->sweepCount;
+  this->sweepStep++;
+  if(this->sweepStep >= this->sweepSteps) {
+    this->sweepStep = 0;
+    this->sweepCount++;
+  }
+  int16_t state = RADIOLIB_ERR_NONE;
+  if(this->sweepSteps > 1) {
+    // offset of each step is converted on its own, so that rounding does not accumulate over the range
+    float offset = (float)this->sweepStep * this->sweepFreqStep;
+    state = setRfFrequency(this->sweepFrfStart + (uint32_t)((offset * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ + 0.5f));
+    RADIOLIB_ASSERT(state);
+  }
+
+  // read the result directly into the buffer, or drop it if the buffer is full
+  size_t head = RADIOLIB_ATOMIC_LOAD(this->sweepHead);
+  size_t next = (head + 1) % this->sweepSize;
+  if(next == RADIOLIB_ATOMIC_LOAD(this->sweepTail)) {
+    this->sweepOverflows++;
+  } else {
+    SX126xSpectralScanRecord_t* rec = &this->sweepRecords[head];
+    rec->step = step;
+    rec->sweep = sweep;
+    state = spectralScanGetResult(rec->bins);
+    if(state == RADIOLIB_ERR_NONE) {
+      RADIOLIB_ATOMIC_STORE(this->sweepHead, next);
+    }
+  }
+  this->sweepLines++;
+
+  // start the next scan even if the result was dropped, so that the sweep goes on
+  this->sweepScanStart = this->mod->hal->micros();
+  int16_t scanState = spectralScanStart(this->sweepSamples, this->sweepWindow, this->sweepInterval);
+  RADIOLIB_ASSERT(state);
+  return(scanState);
+}
+
+int16_t SX126x::spectralScanSweepStop() {
+  if(!this->sweepActive) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  this->sweepActive = false;
+  this->sweepElapsed = this->mod->hal->micros() - this->sweepStartTime;
+  spectralScanAbort();
+  return(standby());
+}
+
+size_t SX126x::spectralScanSweepAvailable() {
+  if(this->sweepSize == 0) {
+    return(0);
+  }
+  size_t head = RADIOLIB_ATOMIC_LOAD(this->sweepHead);
+  size_t tail = RADIOLIB_ATOMIC_LOAD(this->sweepTail);
+  return((head + this->sweepSize - tail) % this->sweepSize);
+}
+
+int16_t SX126x::spectralScanSweepRead(SX126xSpectralScanRecord_t* record) {
+  if(record == NULL) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  size_t tail = RADIOLIB_ATOMIC_LOAD(this->sweepTail);
+  if((this->sweepSize == 0) || (tail == RADIOLIB_ATOMIC_LOAD(this->sweepHead))) {
+    return(RADIOLIB_ERR_RX_TIMEOUT);
+  }
+  memcpy(record, &this->sweepRecords[tail], sizeof(SX126xSpectralScanRecord_t));
+  RADIOLIB_ATOMIC_STORE(this->sweepTail, (tail + 1) % this->sweepSize);
+  return(RADIOLIB_ERR_NONE);
+}
+
+uint32_t SX126x::spectralScanSweepGetOverflows() {
+  return(this->sweepOverflows);
+}
+
+float SX126x::spectralScanSweepGetBinRate() {
+  RadioLibTime_t elapsed = this->sweepElapsed;
+  if(this->sweepActive) {
+    elapsed = this->mod->hal->micros() - this->sweepStartTime;
+  }
+  if(elapsed == 0) {
+    return(0);
+  }
+  return((float)this->sweepLines * RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE * 1000000.0f / (float)elapsed);
+}
+
 int16_t SX126x::setTCXO(float voltage, uint32_t delay) {
   // check if TCXO is enabled at all
   if(this->XTAL) {
@@ -1915,6 +2060,7 @@ int16_t SX126x::setHeaderType(uint8_t hdrType, size_t len) {
   // update cached value
   this->headerType = hdrType;
   this->implicitLen = len;
+  this->timeOnAir.invalidate();
 
   return(state);
 }
@@ -1934,6 +2080,7 @@ int16_t SX126x::setModulationParams(uint8_t sf, uint8_t bw, uint8_t cr, uint8_t
   // 500/9/8  - 0x09 0x04 0x03 0x00 - SF9, BW125, 4/8
   // 500/11/8 - 0x0B 0x04 0x03 0x00 - SF11 BW125, 4/7
   uint8_t data[4] = {sf, bw, cr, this->ldrOptimize};
+  this->timeOnAir.invalidate();
   return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, 4));
 }
 
@@ -1941,6 +2088,7 @@ int16_t SX126x::setModulationParamsFSK(uint32_t br, uint8_t sh, uint8_t rxBw, ui
   uint8_t data[8] = {(uint8_t)((br >> 16) & 0xFF), (uint8_t)((br >> 8) & 0xFF), (uint8_t)(br & 0xFF),
                      sh, rxBw,
                      (uint8_t)((freqDev >> 16) & 0xFF), (uint8_t)((freqDev >> 8) & 0xFF), (uint8_t)(freqDev & 0xFF)};
+  this->timeOnAir.invalidate();
   return(this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS, data, 8));
 }
 
@@ -2090,6 +2238,7 @@ int16_t SX126x::config(uint8_t modem) {
   // set modem
   uint8_t data[7];
   data[0] = modem;
+  this->timeOnAir.invalidate();
   state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_TYPE, data, 1);
   RADIOLIB_ASSERT(state);
 
@@ -8,6 +8,7 @@
 #include "../../Module.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 // SX126X physical layer properties
 #define RADIOLIB_SX126X_FREQUENCY_STEP_SIZE                     0.9536743164
@@ -435,6 +436,22 @@
 // size of the spectral scan result
 #define RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE                  (33)
 
+/*!
+  \struct SX126xSpectralScanRecord_t
+  \brief Single scanline produced by spectral scan sweep. The record has no padding,
+  so it can be sent to the host as-is (in host byte order).
+*/
+struct SX126xSpectralScanRecord_t {
+  /*! \brief Index of the frequency step within the sweep, the frequency is start + step*stepSize. */
+  uint16_t step;
+
+  /*! \brief Sweep counter, incremented every time the sweep wraps back to the start frequency. */
+  uint16_t sweep;
+
+  /*! \brief Power bins, number of samples received at each power level. */
+  uint16_t bins[RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE];
+};
+
 /*!
   \class SX126x
   \brief Base class for %SX126x series. All derived classes for %SX126x (e.g. SX1262 or SX1268) inherit from this base class.
@@ -524,6 +541,14 @@ class SX126x: public PhysicalLayer {
     */
     int16_t transmitDirect(uint32_t frf = 0) override;
 
+    /*!
+      \brief Change frequency of an ongoing direct mode transmission. Only the frequency command is sent,
+      without switching the module to transmit mode again, so this can only be called after transmitDirect.
+      \param frf Raw RF frequency value.
+      \returns \ref status_codes
+    */
+    int16_t setDirectFrequency(uint32_t frf) override;
+
     /*!
       \brief Starts direct mode reception. Only implemented for PhysicalLayer compatibility, as %SX126x series does not support direct mode reception.
       Will always return RADIOLIB_ERR_UNKNOWN.
@@ -1108,6 +1133,64 @@ class SX126x: public PhysicalLayer {
     */
     int16_t spectralScanGetResult(uint16_t* results);
 
+    /*!
+      \brief Start continuous spectral scan sweep over a frequency range. Requires binary patch to be uploaded.
+      Image calibration is done once for the whole range, the sweep then only retunes between the steps.
+      Scanlines are stored in a ring buffer provided by the user, spectralScanSweepProcess must be called
+      periodically to advance the sweep. When the buffer is full, new scanlines are dropped and counted.
+      The module stays tuned to the last scanned frequency after the sweep is stopped.
+      \param freqStart Start frequency in MHz.
+      \param freqEnd End frequency in MHz, inclusive.
+      \param freqStep Frequency step in MHz. Should be the same or slightly smaller than the Rx bandwidth.
+      \param records Ring buffer for the scanlines.
+      \param numRecords Number of scanlines the buffer can hold, one slot is always kept free.
+      \param numSamples Number of samples for each scan. Fewer samples = faster sweep.
+      \param window RSSI averaging window size.
+      \param interval Scan interval length, one of RADIOLIB_SX126X_SCAN_INTERVAL_* macros.
+      \returns \ref status_codes
+    */
+    int16_t spectralScanSweepStart(float freqStart, float freqEnd, float freqStep, SX126xSpectralScanRecord_t* records, size_t numRecords, uint16_t numSamples = 2048, uint8_t window = RADIOLIB_SX126X_SPECTRAL_SCAN_WINDOW_DEFAULT, uint8_t interval = RADIOLIB_SX126X_SCAN_INTERVAL_8_20_US);
+
+    /*!
+      \brief Advance spectral scan sweep. Does not access the module until the current scan can be finished.
+      Once it is, the module is retuned to the next step before the result is read out,
+      and the next scan is started right after that. If the result cannot be read out,
+      the scanline is dropped and the error is returned, the sweep continues with the next step.
+      \returns \ref status_codes
+    */
+    int16_t spectralScanSweepProcess();
+
+    /*!
+      \brief Stop spectral scan sweep and put the module to standby. Scanlines already in the buffer can still be read.
+      \returns \ref status_codes
+    */
+    int16_t spectralScanSweepStop();
+
+    /*!
+      \brief Get the number of scanlines waiting in the sweep buffer.
+      \returns Number of scanlines available to read.
+    */
+    size_t spectralScanSweepAvailable();
+
+    /*!
+      \brief Read the oldest scanline from the sweep buffer.
+      \param record Pointer to which the scanline will be copied.
+      \returns \ref status_codes, RADIOLIB_ERR_RX_TIMEOUT when the buffer is empty.
+    */
+    int16_t spectralScanSweepRead(SX126xSpectralScanRecord_t* record);
+
+    /*!
+      \brief Get the number of scanlines dropped because the sweep buffer was full.
+      \returns Number of dropped scanlines since the sweep was started.
+    */
+    uint32_t spectralScanSweepGetOverflows();
+
+    /*!
+      \brief Get sweep throughput since it was started, including dropped scanlines.
+      \returns Number of power bins scanned per second.
+    */
+    float spectralScanSweepGetBinRate();
+
     /*!
       \brief Set the PA configuration. Allows user to optimize PA for a specific output power
       and matching network. Any calls to this method must be done after calling begin/beginFSK and/or setOutputPower.
@@ -1205,6 +1288,23 @@ class SX126x: public PhysicalLayer {
     size_t implicitLen = 0;
     uint8_t invertIQEnabled = RADIOLIB_SX126X_LORA_IQ_STANDARD;
 
+    // invalidated whenever packet type, modulation or packet parameters are set
+    RadioLibTimeOnAir timeOnAir;
+
+    // spectral scan sweep, scanlines are produced by spectralScanSweepProcess and consumed by spectralScanSweepRead
+    SX126xSpectralScanRecord_t* sweepRecords = NULL;
+    size_t sweepSize = 0;
+    volatile size_t sweepHead = 0;
+    volatile size_t sweepTail = 0;
+    uint32_t sweepFrfStart = 0;
+    float sweepFreqStep = 0;
+    uint16_t sweepSteps = 0, sweepStep = 0, sweepCount = 0;
+    uint16_t sweepSamples = 0;
+    uint8_t sweepWindow = 0, sweepInterval = 0;
+    bool sweepActive = false;
+    RadioLibTime_t sweepStartTime = 0, sweepScanStart = 0, sweepScanLen = 0, sweepElapsed = 0;
+    uint32_t sweepLines = 0, sweepOverflows = 0;
+
     int16_t config(uint8_t modem);
     bool findChip(const char* verStr);
     int16_t startReceiveCommon(uint32_t timeout = RADIOLIB_SX126X_RX_TIMEOUT_INF, uint16_t irqFlags = RADIOLIB_SX126X_IRQ_RX_DEFAULT, uint16_t irqMask = RADIOLIB_SX126X_IRQ_RX_DONE);
@@ -80,6 +80,7 @@ void SX1272::reset() {
   mod->hal->delay(1);
   mod->hal->digitalWrite(mod->getRst(), mod->hal->GpioLevelLow);
   mod->hal->delay(5);
+  mod->SPIcacheInvalidate();
 }
 
 int16_t SX1272::setFrequency(float freq) {
@@ -121,7 +122,8 @@ int16_t SX1272::setBandwidth(float bw) {
     if(this->ldroAuto) {
       float symbolLength = (float)(uint32_t(1) << SX127x::spreadingFactor) / (float)SX127x::bandwidth;
       Module* mod = this->getMod();
-      if(symbolLength >= 16.0) {
+      SX127x::ldroEnabled = (symbolLength >= 16.0);
+      if(SX127x::ldroEnabled) {
         state = mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_LOW_DATA_RATE_OPT_ON, 0, 0);
       } else {
         state = mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_LOW_DATA_RATE_OPT_OFF, 0, 0);
@@ -175,7 +177,8 @@ int16_t SX1272::setSpreadingFactor(uint8_t sf) {
     if(this->ldroAuto) {
       float symbolLength = (float)(uint32_t(1) << SX127x::spreadingFactor) / (float)SX127x::bandwidth;
       Module* mod = this->getMod();
-      if(symbolLength >= 16.0) {
+      SX127x::ldroEnabled = (symbolLength >= 16.0);
+      if(SX127x::ldroEnabled) {
         state = mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_LOW_DATA_RATE_OPT_ON, 0, 0);
       } else {
         state = mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_LOW_DATA_RATE_OPT_OFF, 0, 0);
@@ -237,16 +240,26 @@ int16_t SX1272::setDataRate(DataRate_t dr) {
     state = this->setFrequencyDeviation(dr.fsk.freqDev);
 
   } else if(modem == RADIOLIB_SX127X_LORA) {
+    // all three parameters share modem configuration registers, so apply them in a single batch
+    Module* mod = this->getMod();
+    mod->SPIbatchBegin();
+
     // set the spreading factor
     state = this->setSpreadingFactor(dr.lora.spreadingFactor);
-    RADIOLIB_ASSERT(state);
 
     // set the bandwidth
-    state = this->setBandwidth(dr.lora.bandwidth);
-    RADIOLIB_ASSERT(state);
+    if(state == RADIOLIB_ERR_NONE) {
+      state = this->setBandwidth(dr.lora.bandwidth);
+    }
 
     // set the coding rate
-    state = this->setCodingRate(dr.lora.codingRate);
+    if(state == RADIOLIB_ERR_NONE) {
+      state = this->setCodingRate(dr.lora.codingRate);
+    }
+
+    int16_t flushState = mod->SPIbatchFlush();
+    RADIOLIB_ASSERT(state);
+    state = flushState;
   }
 
   return(state);
@@ -445,6 +458,7 @@ float SX1272::getRSSI(bool packet, bool skipReceive) {
 }
 
 int16_t SX1272::setCRC(bool enable, bool mode) {
+  this->timeOnAir.invalidate();
   Module* mod = this->getMod();
   if(getActiveModem() == RADIOLIB_SX127X_LORA) {
     // set LoRa CRC
@@ -479,6 +493,8 @@ int16_t SX1272::forceLDRO(bool enable) {
   }
 
   this->ldroAuto = false;
+  this->ldroEnabled = enable;
+  this->timeOnAir.invalidate();
   Module* mod = this->getMod();
   if(enable) {
     return(mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_LOW_DATA_RATE_OPT_ON, 0, 0));
@@ -505,6 +521,7 @@ int16_t SX1272::explicitHeader() {
 }
 
 int16_t SX1272::setBandwidthRaw(uint8_t newBandwidth) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = SX127x::standby();
 
@@ -515,26 +532,30 @@ int16_t SX1272::setBandwidthRaw(uint8_t newBandwidth) {
 }
 
 int16_t SX1272::setSpreadingFactorRaw(uint8_t newSpreadingFactor) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = SX127x::standby();
 
   // write registers
   Module* mod = this->getMod();
+  mod->SPIbatchBegin();
   if(newSpreadingFactor == RADIOLIB_SX127X_SF_6) {
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_HEADER_IMPL_MODE | (SX127x::crcEnabled ? RADIOLIB_SX1272_RX_CRC_MODE_ON : RADIOLIB_SX1272_RX_CRC_MODE_OFF), 2, 1);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, RADIOLIB_SX127X_SF_6 | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_6, 2, 0);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_6);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_HEADER_IMPL_MODE | (SX127x::crcEnabled ? RADIOLIB_SX1272_RX_CRC_MODE_ON : RADIOLIB_SX1272_RX_CRC_MODE_OFF), 2, 1);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, RADIOLIB_SX127X_SF_6 | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_6, 2, 0);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_6);
   } else {
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_HEADER_EXPL_MODE | (SX127x::crcEnabled ? RADIOLIB_SX1272_RX_CRC_MODE_ON : RADIOLIB_SX1272_RX_CRC_MODE_OFF),  2, 1);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, newSpreadingFactor | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_7_12, 2, 0);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_7_12);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1272_HEADER_EXPL_MODE | (SX127x::crcEnabled ? RADIOLIB_SX1272_RX_CRC_MODE_ON : RADIOLIB_SX1272_RX_CRC_MODE_OFF),  2, 1);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, newSpreadingFactor | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_7_12, 2, 0);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_7_12);
   }
+  state |= mod->SPIbatchFlush();
   return(state);
 }
 
 int16_t SX1272::setCodingRateRaw(uint8_t newCodingRate) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = SX127x::standby();
 
@@ -545,6 +566,7 @@ int16_t SX1272::setCodingRateRaw(uint8_t newCodingRate) {
 }
 
 int16_t SX1272::setHeaderType(uint8_t headerType, size_t len) {
+  this->timeOnAir.invalidate();
   // check active modem
   if(getActiveModem() != RADIOLIB_SX127X_LORA) {
     return(RADIOLIB_ERR_WRONG_MODEM);
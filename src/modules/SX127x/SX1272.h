@@ -317,7 +317,6 @@ class SX1272: public SX127x {
   private:
 #endif
     bool ldroAuto = true;
-    bool ldroEnabled = false;
 
 };
 
@@ -80,6 +80,7 @@ void SX1278::reset() {
   mod->hal->delay(1);
   mod->hal->digitalWrite(mod->getRst(), mod->hal->GpioLevelHigh);
   mod->hal->delay(5);
+  mod->SPIcacheInvalidate();
 }
 
 int16_t SX1278::setFrequency(float freq) {
@@ -135,7 +136,8 @@ int16_t SX1278::setBandwidth(float bw) {
     if(this->ldroAuto) {
       float symbolLength = (float)(uint32_t(1) << SX127x::spreadingFactor) / (float)SX127x::bandwidth;
       Module* mod = this->getMod();
-      if(symbolLength >= 16.0) {
+      SX127x::ldroEnabled = (symbolLength >= 16.0);
+      if(SX127x::ldroEnabled) {
         state = mod->SPIsetRegValue(RADIOLIB_SX1278_REG_MODEM_CONFIG_3, RADIOLIB_SX1278_LOW_DATA_RATE_OPT_ON, 3, 3);
       } else {
         state = mod->SPIsetRegValue(RADIOLIB_SX1278_REG_MODEM_CONFIG_3, RADIOLIB_SX1278_LOW_DATA_RATE_OPT_OFF, 3, 3);
@@ -189,7 +191,8 @@ int16_t SX1278::setSpreadingFactor(uint8_t sf) {
     if(this->ldroAuto) {
       float symbolLength = (float)(uint32_t(1) << SX127x::spreadingFactor) / (float)SX127x::bandwidth;
       Module* mod = this->getMod();
-      if(symbolLength >= 16.0) {
+      SX127x::ldroEnabled = (symbolLength >= 16.0);
+      if(SX127x::ldroEnabled) {
         state = mod->SPIsetRegValue(RADIOLIB_SX1278_REG_MODEM_CONFIG_3, RADIOLIB_SX1278_LOW_DATA_RATE_OPT_ON, 3, 3);
       } else {
         state = mod->SPIsetRegValue(RADIOLIB_SX1278_REG_MODEM_CONFIG_3, RADIOLIB_SX1278_LOW_DATA_RATE_OPT_OFF, 3, 3);
@@ -251,16 +254,26 @@ int16_t SX1278::setDataRate(DataRate_t dr) {
     state = this->setFrequencyDeviation(dr.fsk.freqDev);
 
   } else if(modem == RADIOLIB_SX127X_LORA) {
+    // all three parameters share modem configuration registers, so apply them in a single batch
+    Module* mod = this->getMod();
+    mod->SPIbatchBegin();
+
     // set the spreading factor
     state = this->setSpreadingFactor(dr.lora.spreadingFactor);
-    RADIOLIB_ASSERT(state);
 
     // set the bandwidth
-    state = this->setBandwidth(dr.lora.bandwidth);
-    RADIOLIB_ASSERT(state);
+    if(state == RADIOLIB_ERR_NONE) {
+      state = this->setBandwidth(dr.lora.bandwidth);
+    }
 
     // set the coding rate
-    state = this->setCodingRate(dr.lora.codingRate);
+    if(state == RADIOLIB_ERR_NONE) {
+      state = this->setCodingRate(dr.lora.codingRate);
+    }
+
+    int16_t flushState = mod->SPIbatchFlush();
+    RADIOLIB_ASSERT(state);
+    state = flushState;
   }
 
   return(state);
@@ -482,6 +495,7 @@ float SX1278::getRSSI(bool packet, bool skipReceive) {
 }
 
 int16_t SX1278::setCRC(bool enable, bool mode) {
+  this->timeOnAir.invalidate();
   Module* mod = this->getMod();
   if(getActiveModem() == RADIOLIB_SX127X_LORA) {
     // set LoRa CRC
@@ -517,6 +531,8 @@ int16_t SX1278::forceLDRO(bool enable) {
 
   Module* mod = this->getMod();
   this->ldroAuto = false;
+  this->ldroEnabled = enable;
+  this->timeOnAir.invalidate();
   if(enable) {
     return(mod->SPIsetRegValue(RADIOLIB_SX1278_REG_MODEM_CONFIG_3, RADIOLIB_SX1278_LOW_DATA_RATE_OPT_ON, 3, 3));
   } else {
@@ -542,6 +558,7 @@ int16_t SX1278::explicitHeader() {
 }
 
 int16_t SX1278::setBandwidthRaw(uint8_t newBandwidth) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = SX127x::standby();
 
@@ -552,26 +569,30 @@ int16_t SX1278::setBandwidthRaw(uint8_t newBandwidth) {
 }
 
 int16_t SX1278::setSpreadingFactorRaw(uint8_t newSpreadingFactor) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = SX127x::standby();
 
   // write registers
   Module* mod = this->getMod();
+  mod->SPIbatchBegin();
   if(newSpreadingFactor == RADIOLIB_SX127X_SF_6) {
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1278_HEADER_IMPL_MODE, 0, 0);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, RADIOLIB_SX127X_SF_6 | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_6, 2, 0);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_6);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1278_HEADER_IMPL_MODE, 0, 0);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, RADIOLIB_SX127X_SF_6 | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_6, 2, 0);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_6);
   } else {
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1278_HEADER_EXPL_MODE, 0, 0);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, newSpreadingFactor | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_7_12, 2, 0);
-    state |= mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_7_12);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, RADIOLIB_SX1278_HEADER_EXPL_MODE, 0, 0);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, newSpreadingFactor | RADIOLIB_SX127X_TX_MODE_SINGLE, 7, 3);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_7_12, 2, 0);
+    mod->SPIsetRegValue(RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_7_12);
   }
+  state |= mod->SPIbatchFlush();
   return(state);
 }
 
 int16_t SX1278::setCodingRateRaw(uint8_t newCodingRate) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = SX127x::standby();
 
@@ -582,6 +603,7 @@ int16_t SX1278::setCodingRateRaw(uint8_t newCodingRate) {
 }
 
 int16_t SX1278::setHeaderType(uint8_t headerType, size_t len) {
+  this->timeOnAir.invalidate();
   // check active modem
   if(getActiveModem() != RADIOLIB_SX127X_LORA) {
     return(RADIOLIB_ERR_WRONG_MODEM);
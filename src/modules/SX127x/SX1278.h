@@ -329,7 +329,6 @@ class SX1278: public SX127x {
   private:
 #endif
     bool ldroAuto = true;
-    bool ldroEnabled = false;
 
 };
 
@@ -20,6 +20,9 @@ int16_t SX127x::begin(uint8_t* chipVersions, uint8_t numVersions, uint8_t syncWo
   }
   RADIOLIB_DEBUG_BASIC_PRINTLN("M\tSX127x");
 
+  // set volatile registers for the currently active modem
+  setCacheVolatile(getActiveModem());
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -71,6 +74,9 @@ int16_t SX127x::beginFSK(uint8_t* chipVersions, uint8_t numVersions, float freqD
   }
   RADIOLIB_DEBUG_BASIC_PRINTLN("M\tSX127x");
 
+  // set volatile registers for the currently active modem
+  setCacheVolatile(getActiveModem());
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -315,6 +321,13 @@ int16_t SX127x::transmitDirect(uint32_t frf) {
   return(setMode(RADIOLIB_SX127X_TX));
 }
 
+int16_t SX127x::setDirectFrequency(uint32_t frf) {
+  // the new frequency is applied once the LSB is written, no mode change is needed
+  uint8_t data[] = { (uint8_t)((frf & 0xFF0000) >> 16), (uint8_t)((frf & 0x00FF00) >> 8), (uint8_t)(frf & 0x0000FF) };
+  this->mod->SPIwriteRegisterBurst(RADIOLIB_SX127X_REG_FRF_MSB, data, 3);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t SX127x::receiveDirect() {
   // check modem
   if(getActiveModem() != RADIOLIB_SX127X_FSK_OOK) {
@@ -755,6 +768,7 @@ int16_t SX127x::setCurrentLimit(uint8_t currentLimit) {
 }
 
 int16_t SX127x::setPreambleLength(size_t preambleLength) {
+  this->timeOnAir.invalidate();
   // set mode to standby
   int16_t state = setMode(RADIOLIB_SX127X_STANDBY);
   RADIOLIB_ASSERT(state);
@@ -768,16 +782,18 @@ int16_t SX127x::setPreambleLength(size_t preambleLength) {
     }
 
     // set preamble length
-    state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB, (uint8_t)((preambleLength >> 8) & 0xFF));
-    state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB, (uint8_t)(preambleLength & 0xFF));
-    return(state);
+    this->mod->SPIbatchBegin();
+    this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB, (uint8_t)((preambleLength >> 8) & 0xFF));
+    this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB, (uint8_t)(preambleLength & 0xFF));
+    return(this->mod->SPIbatchFlush());
 
   } else if(modem == RADIOLIB_SX127X_FSK_OOK) {
     // set preamble length (in bytes)
     uint16_t numBytes = preambleLength / 8;
-    state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB_FSK, (uint8_t)((numBytes >> 8) & 0xFF));
-    state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB_FSK, (uint8_t)(numBytes & 0xFF));
-    return(state);
+    this->mod->SPIbatchBegin();
+    this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB_FSK, (uint8_t)((numBytes >> 8) & 0xFF));
+    this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB_FSK, (uint8_t)(numBytes & 0xFF));
+    return(this->mod->SPIbatchFlush());
   }
 
   return(RADIOLIB_ERR_UNKNOWN);
@@ -887,6 +903,7 @@ float SX127x::getDataRate() const {
 }
 
 int16_t SX127x::setBitRateCommon(float br, uint8_t fracRegAddr) {
+  this->timeOnAir.invalidate();
   // check active modem
   if(getActiveModem() != RADIOLIB_SX127X_FSK_OOK) {
     return(RADIOLIB_ERR_WRONG_MODEM);
@@ -906,15 +923,17 @@ int16_t SX127x::setBitRateCommon(float br, uint8_t fracRegAddr) {
 
   // set bit rate
   uint16_t bitRateRaw = (RADIOLIB_SX127X_CRYSTAL_FREQ * 1000.0) / br;
-  state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_BITRATE_MSB, (bitRateRaw & 0xFF00) >> 8, 7, 0);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_BITRATE_LSB, bitRateRaw & 0x00FF, 7, 0);
+  this->mod->SPIbatchBegin();
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_BITRATE_MSB, (bitRateRaw & 0xFF00) >> 8, 7, 0);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_BITRATE_LSB, bitRateRaw & 0x00FF, 7, 0);
 
   // set fractional part of bit rate
   if(!ookEnabled) {
     float bitRateRem = ((RADIOLIB_SX127X_CRYSTAL_FREQ * 1000.0) / (float)br) - (float)bitRateRaw;
     uint8_t bitRateFrac = bitRateRem * 16;
-    state |= this->mod->SPIsetRegValue(fracRegAddr, bitRateFrac, 7, 0);
+    this->mod->SPIsetRegValue(fracRegAddr, bitRateFrac, 7, 0);
   }
+  state = this->mod->SPIbatchFlush();
 
   if(state == RADIOLIB_ERR_NONE) {
     this->bitRate = br;
@@ -946,9 +965,10 @@ int16_t SX127x::setFrequencyDeviation(float freqDev) {
   // set allowed frequency deviation
   uint32_t base = 1;
   uint32_t FDEV = (newFreqDev * (base << 19)) / 32000;
-  state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FDEV_MSB, (FDEV & 0xFF00) >> 8, 5, 0);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FDEV_LSB, FDEV & 0x00FF, 7, 0);
-  return(state);
+  this->mod->SPIbatchBegin();
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FDEV_MSB, (FDEV & 0xFF00) >> 8, 5, 0);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FDEV_LSB, FDEV & 0x00FF, 7, 0);
+  return(this->mod->SPIbatchFlush());
 }
 
 uint8_t SX127x::calculateBWManExp(float bandwidth)
@@ -1016,6 +1036,7 @@ int16_t SX127x::setAFCAGCTrigger(uint8_t trigger) {
 }
 
 int16_t SX127x::setSyncWord(uint8_t* syncWord, size_t len) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t modem = getActiveModem();
   if(modem == RADIOLIB_SX127X_FSK_OOK) {
@@ -1176,9 +1197,11 @@ int16_t SX127x::setFrequencyRaw(float newFreq) {
   uint32_t FRF = (newFreq * (uint32_t(1) << RADIOLIB_SX127X_DIV_EXPONENT)) / RADIOLIB_SX127X_CRYSTAL_FREQ;
 
   // write registers
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FRF_MSB, (FRF & 0xFF0000) >> 16);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FRF_MID, (FRF & 0x00FF00) >> 8);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FRF_LSB, FRF & 0x0000FF);
+  this->mod->SPIbatchBegin();
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FRF_MSB, (FRF & 0xFF0000) >> 16);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FRF_MID, (FRF & 0x00FF00) >> 8);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FRF_LSB, FRF & 0x0000FF);
+  state |= this->mod->SPIbatchFlush();
   return(state);
 }
 
@@ -1245,39 +1268,34 @@ float SX127x::getNumSymbols(size_t len) {
 }
 
 RadioLibTime_t SX127x::getTimeOnAir(size_t len) {
-  // check active modem
-  uint8_t modem = getActiveModem();
-  if (modem == RADIOLIB_SX127X_LORA) {
-    // get symbol length in us
-    float symbolLength = (float) (uint32_t(1) << this->spreadingFactor) / (float) this->bandwidth;
-
-    // get number of symbols
-    float n_sym = getNumSymbols(len);
-
-    // get time-on-air in us
-    return ceil((double)symbolLength * (double)n_sym) * 1000;
+  // the configuration is only read back from the chip after it has changed
+  if(!this->timeOnAir.isValid()) {
+    // check active modem
+    uint8_t modem = getActiveModem();
+    if(modem == RADIOLIB_SX127X_LORA) {
+      bool ih = this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_1, 0, 0);
+      bool crc = this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_MODEM_CONFIG_2, 2, 2);
+      uint16_t n_pre = (this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB) << 8) | this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB);
+      this->timeOnAir.setLoRa(this->spreadingFactor, this->bandwidth, this->codingRate, n_pre, !ih, crc, this->ldroEnabled, false);
 
-  } else if(modem == RADIOLIB_SX127X_FSK_OOK) {
-    // get number of bits preamble
-    float n_pre = (float) ((this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB_FSK) << 8) | this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB_FSK)) * 8;
-    // get the number of bits of the sync word
-    float n_syncWord = (float) (this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_SYNC_CONFIG, 2, 0) + 1) * 8;
-    // get CRC bits
-    float crc = (this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PACKET_CONFIG_1, 4, 4) == RADIOLIB_SX127X_CRC_ON) * 16;
-
-    if (this->packetLengthConfig == RADIOLIB_SX127X_PACKET_FIXED) {
-      // if packet size fixed -> len = fixed packet length
-      len = this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PAYLOAD_LENGTH_FSK);
     } else {
-      // if packet variable -> Add 1 extra byte for payload length
-      len += 1;
+      // preamble, sync word and CRC bits
+      uint32_t n_pre = ((this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_MSB_FSK) << 8) | this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_LSB_FSK)) * 8;
+      uint32_t n_syncWord = (this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_SYNC_CONFIG, 2, 0) + 1) * 8;
+      uint32_t crc = (this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PACKET_CONFIG_1, 4, 4) == RADIOLIB_SX127X_CRC_ON) * 16;
+
+      if(this->packetLengthConfig == RADIOLIB_SX127X_PACKET_FIXED) {
+        // if packet size fixed -> len = fixed packet length
+        size_t fixedLen = this->mod->SPIgetRegValue(RADIOLIB_SX127X_REG_PAYLOAD_LENGTH_FSK);
+        this->timeOnAir.setBitRate(1000.0f / this->bitRate, n_pre + n_syncWord + crc, fixedLen);
+      } else {
+        // if packet variable -> Add 1 extra byte for payload length
+        this->timeOnAir.setBitRate(1000.0f / this->bitRate, n_pre + n_syncWord + crc + 8);
+      }
     }
-
-    // calculate time-on-air in us {[(length in bytes) * (8 bits / 1 byte)] / [(Bit Rate in kbps) * (1000 bps / 1 kbps)]} * (1000000 us in 1 sec)
-    return((uint32_t) (((crc + n_syncWord + n_pre + (float) (len * 8)) / (this->bitRate * 1000.0)) * 1000000.0));
   }
-  
-  return(RADIOLIB_ERR_UNKNOWN);
+
+  return(this->timeOnAir.get(len));
 }
 
 RadioLibTime_t SX127x::calculateRxTimeout(RadioLibTime_t timeoutUs) {
@@ -1303,6 +1321,7 @@ bool SX127x::isRxTimeout() {
 }
 
 int16_t SX127x::setCrcFiltering(bool enable) {
+  this->timeOnAir.invalidate();
   this->crcOn = enable;
 
   if (enable == true) {
@@ -1498,29 +1517,30 @@ int16_t SX127x::configFSK() {
   // reset FIFO flag
   this->mod->SPIwriteRegister(RADIOLIB_SX127X_REG_IRQ_FLAGS_2, RADIOLIB_SX127X_FLAG_FIFO_OVERRUN);
 
+  // the rest of the configuration is applied in a single batch
+  this->mod->SPIbatchBegin();
+
   // set packet configuration
-  state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PACKET_CONFIG_1, RADIOLIB_SX127X_PACKET_VARIABLE | RADIOLIB_SX127X_DC_FREE_NONE | RADIOLIB_SX127X_CRC_ON | RADIOLIB_SX127X_CRC_AUTOCLEAR_ON | RADIOLIB_SX127X_ADDRESS_FILTERING_OFF | RADIOLIB_SX127X_CRC_WHITENING_TYPE_CCITT, 7, 0);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PACKET_CONFIG_2, RADIOLIB_SX127X_DATA_MODE_PACKET | RADIOLIB_SX127X_IO_HOME_OFF, 6, 5);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PACKET_CONFIG_1, RADIOLIB_SX127X_PACKET_VARIABLE | RADIOLIB_SX127X_DC_FREE_NONE | RADIOLIB_SX127X_CRC_ON | RADIOLIB_SX127X_CRC_AUTOCLEAR_ON | RADIOLIB_SX127X_ADDRESS_FILTERING_OFF | RADIOLIB_SX127X_CRC_WHITENING_TYPE_CCITT, 7, 0);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PACKET_CONFIG_2, RADIOLIB_SX127X_DATA_MODE_PACKET | RADIOLIB_SX127X_IO_HOME_OFF, 6, 5);
 
   // set FIFO threshold
-  state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FIFO_THRESH, RADIOLIB_SX127X_TX_START_FIFO_NOT_EMPTY, 7, 7);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FIFO_THRESH, RADIOLIB_SX127X_FIFO_THRESH, 5, 0);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FIFO_THRESH, RADIOLIB_SX127X_TX_START_FIFO_NOT_EMPTY, 7, 7);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_FIFO_THRESH, RADIOLIB_SX127X_FIFO_THRESH, 5, 0);
 
   // disable Rx timeouts
-  state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_RX_TIMEOUT_1, RADIOLIB_SX127X_TIMEOUT_RX_RSSI_OFF);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_RX_TIMEOUT_2, RADIOLIB_SX127X_TIMEOUT_RX_PREAMBLE_OFF);
-  state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_RX_TIMEOUT_3, RADIOLIB_SX127X_TIMEOUT_SIGNAL_SYNC_OFF);
-  RADIOLIB_ASSERT(state);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_RX_TIMEOUT_1, RADIOLIB_SX127X_TIMEOUT_RX_RSSI_OFF);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_RX_TIMEOUT_2, RADIOLIB_SX127X_TIMEOUT_RX_PREAMBLE_OFF);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_RX_TIMEOUT_3, RADIOLIB_SX127X_TIMEOUT_SIGNAL_SYNC_OFF);
 
   // enable preamble detector
-  state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_DETECT, RADIOLIB_SX127X_PREAMBLE_DETECTOR_ON | RADIOLIB_SX127X_PREAMBLE_DETECTOR_2_BYTE | RADIOLIB_SX127X_PREAMBLE_DETECTOR_TOL);
+  this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_PREAMBLE_DETECT, RADIOLIB_SX127X_PREAMBLE_DETECTOR_ON | RADIOLIB_SX127X_PREAMBLE_DETECTOR_2_BYTE | RADIOLIB_SX127X_PREAMBLE_DETECTOR_TOL);
 
-  return(state);
+  return(this->mod->SPIbatchFlush());
 }
 
 int16_t SX127x::setPacketMode(uint8_t mode, uint8_t len) {
+  this->timeOnAir.invalidate();
   // check packet length
   if(len > RADIOLIB_SX127X_MAX_PACKET_LENGTH_FSK) {
     return(RADIOLIB_ERR_PACKET_TOO_LONG);
@@ -1544,6 +1564,32 @@ int16_t SX127x::setPacketMode(uint8_t mode, uint8_t len) {
   return(state);
 }
 
+void SX127x::setCacheVolatile(int16_t modem) {
+  // registers that can be changed by the module itself
+  static const uint8_t volatileLoRa[] = {
+    RADIOLIB_SX127X_REG_FIFO, RADIOLIB_SX127X_REG_OP_MODE, RADIOLIB_SX127X_REG_FIFO_ADDR_PTR,
+    RADIOLIB_SX127X_REG_FIFO_RX_CURRENT_ADDR, RADIOLIB_SX127X_REG_IRQ_FLAGS, RADIOLIB_SX127X_REG_RX_NB_BYTES,
+    RADIOLIB_SX127X_REG_RX_HEADER_CNT_VALUE_MSB, RADIOLIB_SX127X_REG_RX_HEADER_CNT_VALUE_LSB,
+    RADIOLIB_SX127X_REG_RX_PACKET_CNT_VALUE_MSB, RADIOLIB_SX127X_REG_RX_PACKET_CNT_VALUE_LSB,
+    RADIOLIB_SX127X_REG_MODEM_STAT, RADIOLIB_SX127X_REG_PKT_SNR_VALUE, RADIOLIB_SX127X_REG_PKT_RSSI_VALUE,
+    RADIOLIB_SX127X_REG_RSSI_VALUE, RADIOLIB_SX127X_REG_HOP_CHANNEL, RADIOLIB_SX127X_REG_FIFO_RX_BYTE_ADDR,
+    RADIOLIB_SX127X_REG_FEI_MSB, RADIOLIB_SX127X_REG_FEI_MID, RADIOLIB_SX127X_REG_FEI_LSB,
+    RADIOLIB_SX127X_REG_RSSI_WIDEBAND, RADIOLIB_SX127X_REG_IMAGE_CAL, RADIOLIB_SX127X_REG_TEMP,
+  };
+  static const uint8_t volatileFSK[] = {
+    RADIOLIB_SX127X_REG_FIFO, RADIOLIB_SX127X_REG_OP_MODE, RADIOLIB_SX127X_REG_RSSI_VALUE_FSK,
+    RADIOLIB_SX127X_REG_AFC_MSB, RADIOLIB_SX127X_REG_AFC_LSB, RADIOLIB_SX127X_REG_FEI_MSB_FSK,
+    RADIOLIB_SX127X_REG_FEI_LSB_FSK, RADIOLIB_SX127X_REG_IMAGE_CAL, RADIOLIB_SX127X_REG_TEMP,
+    RADIOLIB_SX127X_REG_IRQ_FLAGS_1, RADIOLIB_SX127X_REG_IRQ_FLAGS_2,
+  };
+
+  if(modem == RADIOLIB_SX127X_LORA) {
+    this->mod->SPIcacheSetVolatile(volatileLoRa, sizeof(volatileLoRa));
+  } else {
+    this->mod->SPIcacheSetVolatile(volatileFSK, sizeof(volatileFSK));
+  }
+}
+
 bool SX127x::findChip(const uint8_t* vers, uint8_t num) {
   uint8_t i = 0;
   bool flagFound = false;
@@ -1591,6 +1637,10 @@ int16_t SX127x::setActiveModem(uint8_t modem) {
   // set modem
   state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_OP_MODE, modem, 7, 7, 5);
 
+  // LoRa and FSK/OOK modems have different register maps, drop all cached values
+  setCacheVolatile(modem);
+  this->timeOnAir.invalidate();
+
   // set mode to STANDBY
   state |= setMode(RADIOLIB_SX127X_STANDBY);
   return(state);
@@ -8,6 +8,7 @@
 #include "../../Module.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 // SX127x physical layer properties
 #define RADIOLIB_SX127X_FREQUENCY_STEP_SIZE                     61.03515625
@@ -678,6 +679,14 @@ class SX127x: public PhysicalLayer {
     */
     int16_t transmitDirect(uint32_t frf = 0) override;
 
+    /*!
+      \brief Change frequency of an ongoing direct mode transmission with a single burst write.
+      The module is not switched to transmit mode, so this can only be called after transmitDirect.
+      \param frf 24-bit raw frequency value to transmit at.
+      \returns \ref status_codes
+    */
+    int16_t setDirectFrequency(uint32_t frf) override;
+
     /*!
       \brief Enables direct reception mode on pins DIO1 (clock) and DIO2 (data).
       While in direct mode, the module will not be able to transmit or receive packets. Can only be activated in FSK mode.
@@ -1233,6 +1242,10 @@ class SX127x: public PhysicalLayer {
     uint8_t codingRate = 0;
     bool crcEnabled = false;
     bool ookEnabled = false;
+    bool ldroEnabled = false;
+
+    // invalidated whenever modem, modulation or packet parameters are set
+    RadioLibTimeOnAir timeOnAir;
 
     int16_t configFSK();
     int16_t getActiveModem();
@@ -1257,6 +1270,7 @@ class SX127x: public PhysicalLayer {
     bool findChip(const uint8_t* vers, uint8_t num);
     int16_t setMode(uint8_t mode);
     int16_t setActiveModem(uint8_t modem);
+    void setCacheVolatile(int16_t modem);
     void clearIRQFlags();
     void clearFIFO(size_t count); // used mostly to clear remaining bytes in FIFO after a packet read
 
@@ -801,6 +801,7 @@ int16_t SX128x::checkOutputPower(int8_t pwr, int8_t* clipped) {
 }
 
 int16_t SX128x::setPreambleLength(uint32_t preambleLength) {
+  this->timeOnAir.invalidate();
   uint8_t modem = getPacketType();
   if((modem == RADIOLIB_SX128X_PACKET_TYPE_LORA) || (modem == RADIOLIB_SX128X_PACKET_TYPE_RANGING)) {
     // LoRa or ranging
@@ -1028,6 +1029,7 @@ int16_t SX128x::setSyncWord(uint8_t syncWord, uint8_t controlBits) {
 }
 
 int16_t SX128x::setCRC(uint8_t len, uint32_t initial, uint16_t polynomial) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t modem = getPacketType();
 
@@ -1266,67 +1268,41 @@ size_t SX128x::getPacketLength(bool update) {
 }
 
 RadioLibTime_t SX128x::getTimeOnAir(size_t len) {
-  // check active modem
-  uint8_t modem = getPacketType();
-  if(modem == RADIOLIB_SX128X_PACKET_TYPE_LORA) {
-    // calculate number of symbols
-    float N_symbol = 0;
-    uint8_t sf = this->spreadingFactor >> 4;
-    if(this->codingRateLoRa <= RADIOLIB_SX128X_LORA_CR_4_8) {
-      // legacy coding rate - nice and simple
-
-      // get SF coefficients
-      float coeff1 = 0;
-      int16_t coeff2 = 0;
-      int16_t coeff3 = 0;
-      if(sf < 7) {
-        // SF5, SF6
-        coeff1 = 6.25;
-        coeff2 = 4*sf;
-        coeff3 = 4*sf;
-      } else if(sf < 11) {
-        // SF7. SF8, SF9, SF10
-        coeff1 = 4.25;
-        coeff2 = 4*sf + 8;
-        coeff3 = 4*sf;
-      } else {
-        // SF11, SF12
-        coeff1 = 4.25;
-        coeff2 = 4*sf + 8;
-        coeff3 = 4*(sf - 2);
-      }
-
-      // get CRC length
-      int16_t N_bitCRC = 16;
-      if(this->crcLoRa == RADIOLIB_SX128X_LORA_CRC_OFF) {
-        N_bitCRC = 0;
-      }
-
-      // get header length
-      int16_t N_symbolHeader = 20;
-      if(this->headerType == RADIOLIB_SX128X_LORA_HEADER_IMPLICIT) {
-        N_symbolHeader = 0;
-      }
-
+  // packet type is only read from the chip after the configuration has changed
+  if(!this->timeOnAir.isValid()) {
+    uint8_t modem = getPacketType();
+    if(modem == RADIOLIB_SX128X_PACKET_TYPE_LORA) {
       // calculate number of LoRa preamble symbols
       uint32_t N_symbolPreamble = (this->preambleLengthLoRa & 0x0F) * (uint32_t(1) << ((this->preambleLengthLoRa & 0xF0) >> 4));
 
-      // calculate the number of symbols
-      N_symbol = (float)N_symbolPreamble + coeff1 + 8.0 + ceil(RADIOLIB_MAX((int16_t)(8 * len + N_bitCRC - coeff2 + N_symbolHeader), (int16_t)0) / (float)coeff3) * (float)(this->codingRateLoRa + 4);
-
-    } else {
       // long interleaving - abandon hope all ye who enter here
       /// \todo implement this mess - SX1280 datasheet v3.0 section 7.4.4.2
+      // until then, it is approximated by the legacy coding rate with the same redundancy
+      uint8_t cr = this->codingRateLoRa;
+      if(cr <= RADIOLIB_SX128X_LORA_CR_4_8) {
+        cr += 4;
+      }
 
-    }
-
-    // get time-on-air in us
-    return(((uint32_t(1) << sf) / this->bandwidthKhz) * N_symbol * 1000.0);
+      uint8_t sf = this->spreadingFactor >> 4;
+      this->timeOnAir.setLoRa(sf, this->bandwidthKhz, cr, N_symbolPreamble, this->headerType == RADIOLIB_SX128X_LORA_HEADER_EXPLICIT,
+                              this->crcLoRa != RADIOLIB_SX128X_LORA_CRC_OFF, sf >= 11);
+
+    } else if(modem == RADIOLIB_SX128X_PACKET_TYPE_FLRC) {
+      // FLRC coding adds redundancy on top of the raw bit rate
+      float bitLength = 1000.0f / (float)this->bitRateKbps;
+      if(this->codingRateFLRC == RADIOLIB_SX128X_FLRC_CR_1_2) {
+        bitLength *= 2.0f;
+      } else if(this->codingRateFLRC == RADIOLIB_SX128X_FLRC_CR_3_4) {
+        bitLength *= 4.0f / 3.0f;
+      }
+      this->timeOnAir.setBitRate(bitLength);
 
-  } else {
-    return(((uint32_t)len * 8 * 1000) / this->bitRateKbps);
+    } else {
+      this->timeOnAir.setBitRate(1000.0f / (float)this->bitRateKbps);
+    }
   }
 
+  return(this->timeOnAir.get(len));
 }
 
 int16_t SX128x::implicitHeader(size_t len) {
@@ -1453,6 +1429,7 @@ int16_t SX128x::setBufferBaseAddress(uint8_t txBaseAddress, uint8_t rxBaseAddres
 }
 
 int16_t SX128x::setModulationParams(uint8_t modParam1, uint8_t modParam2, uint8_t modParam3) {
+  this->timeOnAir.invalidate();
   uint8_t data[] = { modParam1, modParam2, modParam3 };
   return(this->mod->SPIwriteStream(RADIOLIB_SX128X_CMD_SET_MODULATION_PARAMS, data, 3));
 }
@@ -1497,11 +1474,13 @@ int16_t SX128x::setRangingRole(uint8_t role) {
 }
 
 int16_t SX128x::setPacketType(uint8_t type) {
+  this->timeOnAir.invalidate();
   uint8_t data[] = { type };
   return(this->mod->SPIwriteStream(RADIOLIB_SX128X_CMD_SET_PACKET_TYPE, data, 1));
 }
 
 int16_t SX128x::setHeaderType(uint8_t hdrType, size_t len) {
+  this->timeOnAir.invalidate();
   // check active modem
   uint8_t modem = getPacketType();
   if(!((modem == RADIOLIB_SX128X_PACKET_TYPE_LORA) || (modem == RADIOLIB_SX128X_PACKET_TYPE_RANGING))) {
@@ -1522,6 +1501,7 @@ int16_t SX128x::config(uint8_t modem) {
   // set modem
   uint8_t data[1];
   data[0] = modem;
+  this->timeOnAir.invalidate();
   state = this->mod->SPIwriteStream(RADIOLIB_SX128X_CMD_SET_PACKET_TYPE, data, 1);
   RADIOLIB_ASSERT(state);
 
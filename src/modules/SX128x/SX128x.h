@@ -8,6 +8,7 @@
 #include "../../Module.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../utils/TimeOnAir.h"
 
 // SX128X physical layer properties
 #define RADIOLIB_SX128X_FREQUENCY_STEP_SIZE                     198.3642578
@@ -863,6 +864,9 @@ class SX128x: public PhysicalLayer {
     // cached BLE parameters
     uint8_t connectionState = 0, crcBLE = 0, bleTestPayload = 0;
 
+    // invalidated whenever packet type, modulation or packet parameters are set
+    RadioLibTimeOnAir timeOnAir;
+
     int16_t config(uint8_t modem);
     int16_t setHeaderType(uint8_t hdrType, size_t len = 0xFF);
 };
@@ -10,6 +10,18 @@ int16_t Si443x::begin(float br, float freqDev, float rxBw, uint8_t preambleLen)
   // set module properties
   this->mod->init();
   this->mod->hal->pinMode(this->mod->getIrq(), this->mod->hal->GpioModeInput);
+
+  // registers that can be changed by the module itself
+  static const uint8_t volatileRegs[] = {
+    RADIOLIB_SI443X_REG_DEVICE_STATUS, RADIOLIB_SI443X_REG_INTERRUPT_STATUS_1, RADIOLIB_SI443X_REG_INTERRUPT_STATUS_2,
+    RADIOLIB_SI443X_REG_OP_FUNC_CONTROL_1, RADIOLIB_SI443X_REG_OP_FUNC_CONTROL_2, RADIOLIB_SI443X_REG_ADC_CONFIG,
+    RADIOLIB_SI443X_REG_ADC_VALUE, RADIOLIB_SI443X_REG_WAKEUP_TIMER_VALUE_1, RADIOLIB_SI443X_REG_WAKEUP_TIMER_VALUE_2,
+    RADIOLIB_SI443X_REG_BATT_VOLTAGE_LEVEL, RADIOLIB_SI443X_REG_RSSI, RADIOLIB_SI443X_REG_AFC_CORRECTION,
+    RADIOLIB_SI443X_REG_EZMAC_STATUS, RADIOLIB_SI443X_REG_RECEIVED_HEADER_3, RADIOLIB_SI443X_REG_RECEIVED_HEADER_2,
+    RADIOLIB_SI443X_REG_RECEIVED_HEADER_1, RADIOLIB_SI443X_REG_RECEIVED_HEADER_0,
+    RADIOLIB_SI443X_REG_RECEIVED_PACKET_LENGTH, RADIOLIB_SI443X_REG_FIFO_ACCESS,
+  };
+  this->mod->SPIcacheSetVolatile(volatileRegs, sizeof(volatileRegs));
   this->mod->hal->pinMode(this->mod->getRst(), this->mod->hal->GpioModeOutput);
   this->mod->hal->digitalWrite(this->mod->getRst(), this->mod->hal->GpioLevelLow);
 
@@ -24,6 +36,7 @@ int16_t Si443x::begin(float br, float freqDev, float rxBw, uint8_t preambleLen)
 
   // reset the device
   this->mod->SPIwriteRegister(RADIOLIB_SI443X_REG_OP_FUNC_CONTROL_1, RADIOLIB_SI443X_SOFTWARE_RESET);
+  this->mod->SPIcacheInvalidate();
 
   // clear POR interrupt
   clearIRQFlags();
@@ -69,6 +82,7 @@ void Si443x::reset() {
   this->mod->hal->delay(1);
   this->mod->hal->digitalWrite(this->mod->getRst(), this->mod->hal->GpioLevelLow);
   this->mod->hal->delay(100);
+  this->mod->SPIcacheInvalidate();
 }
 
 int16_t Si443x::transmit(uint8_t* data, size_t len, uint8_t addr) {
@@ -146,25 +160,7 @@ int16_t Si443x::transmitDirect(uint32_t frf) {
 
   // user requested to start transmitting immediately (required for RTTY)
   if(frf != 0) {
-    // convert the 24-bit frequency to the format accepted by the module
-    /// \todo integers only
-    float newFreq = frf / 6400.0;
-
-    // check high/low band
-    uint8_t bandSelect = RADIOLIB_SI443X_BAND_SELECT_LOW;
-    uint8_t freqBand = (newFreq / 10) - 24;
-    if(newFreq >= 480.0) {
-      bandSelect = RADIOLIB_SI443X_BAND_SELECT_HIGH;
-      freqBand = (newFreq / 20) - 24;
-    }
-
-    // calculate register values
-    uint16_t freqCarrier = ((newFreq / (10 * ((bandSelect >> 5) + 1))) - freqBand - 24) * (uint32_t)64000;
-
-    // update registers
-    this->mod->SPIwriteRegister(RADIOLIB_SI443X_REG_FREQUENCY_BAND_SELECT, RADIOLIB_SI443X_SIDE_BAND_SELECT_LOW | bandSelect | freqBand);
-    this->mod->SPIwriteRegister(RADIOLIB_SI443X_REG_NOM_CARRIER_FREQUENCY_1, (uint8_t)((freqCarrier & 0xFF00) >> 8));
-    this->mod->SPIwriteRegister(RADIOLIB_SI443X_REG_NOM_CARRIER_FREQUENCY_0, (uint8_t)(freqCarrier & 0xFF));
+    setDirectFrequency(frf);
 
     // start direct transmission
     directMode();
@@ -182,6 +178,23 @@ int16_t Si443x::transmitDirect(uint32_t frf) {
   return(state);
 }
 
+int16_t Si443x::setDirectFrequency(uint32_t frf) {
+  // the 24-bit frequency is in units of 156.25 Hz, each band is 10 MHz wide (20 MHz in high band)
+  uint8_t bandSelect = RADIOLIB_SI443X_BAND_SELECT_LOW;
+  uint32_t bandWidth = 64000;
+  if(frf >= (uint32_t)480 * 6400) {
+    bandSelect = RADIOLIB_SI443X_BAND_SELECT_HIGH;
+    bandWidth = 128000;
+  }
+  uint8_t freqBand = (frf / bandWidth) - 24;
+  uint16_t freqCarrier = (frf % bandWidth) / (bandWidth / 64000);
+
+  // band select and carrier registers are adjacent, so they can be written at once
+  uint8_t data[] = { (uint8_t)(RADIOLIB_SI443X_SIDE_BAND_SELECT_LOW | bandSelect | freqBand), (uint8_t)((freqCarrier & 0xFF00) >> 8), (uint8_t)(freqCarrier & 0xFF) };
+  this->mod->SPIwriteRegisterBurst(RADIOLIB_SI443X_REG_FREQUENCY_BAND_SELECT, data, 3);
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t Si443x::receiveDirect() {
   // set RF switch (if present)
   this->mod->setRfSwitchState(Module::MODE_RX);
@@ -629,6 +629,14 @@ class Si443x: public PhysicalLayer {
     */
     int16_t transmitDirect(uint32_t frf = 0) override;
 
+    /*!
+      \brief Change frequency of an ongoing direct mode transmission with a single burst write.
+      The module is not switched to transmit mode, so this can only be called after transmitDirect.
+      \param frf 24-bit raw frequency value to transmit at.
+      \returns \ref status_codes
+    */
+    int16_t setDirectFrequency(uint32_t frf) override;
+
     /*!
       \brief Enables direct reception mode. While in direct mode, the module will not be able to transmit or receive packets.
       \returns \ref status_codes
@@ -13,6 +13,12 @@ int16_t nRF24::begin(int16_t freq, int16_t dr, int8_t pwr, uint8_t addrWidth) {
   this->mod->init();
   this->mod->hal->pinMode(this->mod->getIrq(), this->mod->hal->GpioModeInput);
 
+  // registers that can be changed by the module itself
+  static const uint8_t volatileRegs[] = {
+    RADIOLIB_NRF24_REG_STATUS, RADIOLIB_NRF24_REG_OBSERVE_TX, RADIOLIB_NRF24_REG_RPD, RADIOLIB_NRF24_REG_FIFO_STATUS,
+  };
+  this->mod->SPIcacheSetVolatile(volatileRegs, sizeof(volatileRegs));
+
   // set pin mode on RST (connected to nRF24 CE pin)
   this->mod->hal->pinMode(this->mod->getRst(), this->mod->hal->GpioModeOutput);
   this->mod->hal->digitalWrite(this->mod->getRst(), this->mod->hal->GpioLevelLow);
@@ -617,13 +623,11 @@ void nRF24::SPIwriteTxPayload(uint8_t* data, uint8_t numBytes) {
 void nRF24::SPItransfer(uint8_t cmd, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes) {
   // prepare the buffers
   size_t buffLen = 1 + numBytes;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffOut[RADIOLIB_STATIC_ARRAY_SIZE];
-    uint8_t buffIn[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* buffOut = new uint8_t[buffLen];
-    uint8_t* buffIn = new uint8_t[buffLen];
-  #endif
+  uint8_t* buffOut = NULL;
+  uint8_t* buffIn = NULL;
+  if(!this->mod->SPIgetBuffers(buffLen, &buffOut, &buffIn)) {
+    return;
+  }
   uint8_t* buffOutPtr = buffOut;
 
   // copy the command
@@ -637,21 +641,14 @@ void nRF24::SPItransfer(uint8_t cmd, bool write, uint8_t* dataOut, uint8_t* data
   }
 
   // do the transfer
-  this->mod->hal->digitalWrite(this->mod->getCs(), this->mod->hal->GpioLevelLow);
-  this->mod->hal->spiBeginTransaction();
-  this->mod->hal->spiTransfer(buffOut, buffLen, buffIn);
-  this->mod->hal->spiEndTransaction();
-  this->mod->hal->digitalWrite(this->mod->getCs(), this->mod->hal->GpioLevelHigh);
+  this->mod->hal->spiTransaction(this->mod->getCs(), buffOut, buffLen, buffIn);
   
   // copy the data
   if(!write) {
     memcpy(dataIn, &buffIn[1], numBytes);
   }
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] buffOut;
-    delete[] buffIn;
-  #endif
+  this->mod->SPIreleaseBuffers(buffOut, buffIn);
 }
 
 #endif
@@ -2,7 +2,7 @@
 #include <math.h>
 #if !RADIOLIB_EXCLUDE_FSK4
 
-FSK4Client::FSK4Client(PhysicalLayer* phy) {
+FSK4Client::FSK4Client(PhysicalLayer* phy) : scheduler(phy) {
   phyLayer = phy;
   #if !RADIOLIB_EXCLUDE_AFSK
   audioClient = nullptr;
@@ -10,7 +10,7 @@ FSK4Client::FSK4Client(PhysicalLayer* phy) {
 }
 
 #if !RADIOLIB_EXCLUDE_AFSK
- FSK4Client::FSK4Client(AFSKClient* audio) {
+ FSK4Client::FSK4Client(AFSKClient* audio) : scheduler(audio->phyLayer) {
    phyLayer = audio->phyLayer;
    audioClient = audio;
  }
@@ -37,10 +37,15 @@ int16_t FSK4Client::begin(float base, uint32_t shift, uint16_t rate) {
   baseFreq = (base * 1000000.0) / phyLayer->getFreqStep();
 
   // configure for direct mode
+  scheduler.stop();
   return(phyLayer->startDirect());
 }
 
 void FSK4Client::idle() {
+  // (re)start the transmission, the module may have been switched to a different mode since
+  scheduler.flush();
+  scheduler.stop();
+
   // Idle at Tone 0.
   tone(0);
 }
@@ -80,22 +85,27 @@ size_t FSK4Client::write(uint8_t b) {
 }
 
 void FSK4Client::tone(uint8_t i) {
-  Module* mod = phyLayer->getMod();
-  RadioLibTime_t start = mod->hal->micros();
   transmitDirect(baseFreq + tones[i], baseFreqHz + tonesHz[i]);
-  mod->waitForMicroseconds(start, bitDuration);
 }
 
 int16_t FSK4Client::transmitDirect(uint32_t freq, uint32_t freqHz) {
   #if !RADIOLIB_EXCLUDE_AFSK
   if(audioClient != nullptr) {
-    return(audioClient->tone(freqHz));
+    Module* mod = phyLayer->getMod();
+    RadioLibTime_t start = mod->hal->micros();
+    int16_t state = audioClient->tone(freqHz);
+    mod->waitForMicroseconds(start, bitDuration);
+    return(state);
   }
   #endif
-  return(phyLayer->transmitDirect(freq));
+  return(scheduler.push(freq, bitDuration));
 }
 
 int16_t FSK4Client::standby() {
+  // let the queued symbols go out first
+  scheduler.flush();
+  scheduler.stop();
+
   // ensure everything is stopped in interrupt timing mode
   Module* mod = phyLayer->getMod();
   mod->waitForMicroseconds(0, 0);
@@ -7,6 +7,7 @@
 
 #include "../PhysicalLayer/PhysicalLayer.h"
 #include "../AFSK/AFSK.h"
+#include "../../utils/SymbolScheduler.h"
 
 /*!
   \class FSK4Client
@@ -69,7 +70,7 @@ class FSK4Client {
     size_t write(uint8_t b);
 
     /*!
-      \brief Stop transmitting.
+      \brief Stop transmitting, after all queued symbols have been sent.
       \returns \ref status_codes
     */
     int16_t standby();
@@ -88,6 +89,8 @@ class FSK4Client {
     uint32_t tones[4] = { 0 };
     uint32_t tonesHz[4] = { 0 };
 
+    RadioLibSymbolScheduler scheduler;
+
     void tone(uint8_t i);
 
     int16_t transmitDirect(uint32_t freq = 0, uint32_t freqHz = 0);
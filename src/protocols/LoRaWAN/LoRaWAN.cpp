@@ -1,22 +1,8 @@
 #include "LoRaWAN.h"
 #include <string.h>
-#if defined(ESP_PLATFORM)
-#include "esp_attr.h"
-#endif
 
 #if !RADIOLIB_EXCLUDE_LORAWAN
 
-// flag to indicate whether there was some action during Rx mode (timeout or downlink)
-static volatile bool downlinkAction = false;
-
-// interrupt service routine to handle downlinks automatically
-#if defined(ESP8266) || defined(ESP32)
-  IRAM_ATTR
-#endif
-static void LoRaWANNodeOnDownlinkAction(void) {
-  downlinkAction = true;
-}
-
 uint8_t getDownlinkDataRate(uint8_t uplink, uint8_t offset, uint8_t base, uint8_t min, uint8_t max) {
   int8_t dr = uplink - offset + base;
   if(dr < min) {
@@ -37,6 +23,10 @@ LoRaWANNode::LoRaWANNode(PhysicalLayer* phy, const LoRaWANBand_t* band, uint8_t
   this->backoffMax = 6;
   this->enableCSMA = false;
   memset(this->availableChannels, 0, sizeof(this->availableChannels));
+
+  // nothing was saved yet, so the whole buffers have to be written the first time
+  LoRaWANNode::loadBuffer(this->bufferNonces, &this->noncesTracker, NULL, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  LoRaWANNode::loadBuffer(this->bufferSession, &this->sessionTracker, NULL, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
 }
 
 void LoRaWANNode::setCSMA(uint8_t backoffMax, uint8_t difsSlots, bool enableCSMA) {
@@ -47,29 +37,37 @@ void LoRaWANNode::setCSMA(uint8_t backoffMax, uint8_t difsSlots, bool enableCSMA
 
 void LoRaWANNode::clearNonces() {
   // clear & set all the device credentials
-  memset(this->bufferNonces, 0, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  LoRaWANNode::loadBuffer(this->bufferNonces, &this->noncesTracker, NULL, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
   this->keyCheckSum = 0;
   this->devNonce = 0;
   this->joinNonce = 0;
   this->isActive = false;
+  this->isRestored = false;
 }
 
 void LoRaWANNode::clearSession() {
-  memset(this->bufferSession, 0, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  LoRaWANNode::loadBuffer(this->bufferSession, &this->sessionTracker, NULL, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
   memset(&(this->commandsUp), 0, sizeof(LoRaWANMacCommandQueue_t));
   memset(&(this->commandsDown), 0, sizeof(LoRaWANMacCommandQueue_t));
-  this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE] = (uint8_t)false;
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_ACTIVE, (uint8_t)false);
   this->isActive = false;
+  this->isRestored = false;
+  #if RADIOLIB_LORAWAN_KEYSTREAM
+  this->keystreamLen = 0;
+  #endif
 }
 
 uint8_t* LoRaWANNode::getBufferNonces() {
-  // generate the signature of the Nonces buffer, and store it in the last two bytes of the Nonces buffer
-  uint16_t signature = LoRaWANNode::checkSum16(this->bufferNonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE - 2);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_SIGNATURE], signature);
+  // store the signature of the Nonces buffer in its last two bytes, the checksum is kept up to date on every write
+  LoRaWANNode::signBuffer(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
 
   return(this->bufferNonces);
 }
 
+uint8_t LoRaWANNode::getBufferNoncesChanges(LoRaWANBufferSpan_t* spans) {
+  return(LoRaWANNode::takeBufferChanges(&this->noncesTracker, spans));
+}
+
 int16_t LoRaWANNode::setBufferNonces(uint8_t* persistentBuffer) {
   if(this->isActivated()) {
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Did not update buffer: session already active");
@@ -94,37 +92,44 @@ int16_t LoRaWANNode::setBufferNonces(uint8_t* persistentBuffer) {
   }
 
   // copy the whole buffer over
-  memcpy(this->bufferNonces, persistentBuffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  LoRaWANNode::loadBuffer(this->bufferNonces, &this->noncesTracker, persistentBuffer, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
 
   this->devNonce  = LoRaWANNode::ntoh<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_DEV_NONCE]);
   this->joinNonce = LoRaWANNode::ntoh<uint32_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_JOIN_NONCE], 3);
 
-  // revert to inactive as long as no session is restored
-  this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE] = (uint8_t)false;
+  // inactive as long as no session is restored, the saved flag is kept so that restoring the session
+  // does not change the buffer (and it does not have to be written again)
   this->isActive = false;
+  this->isRestored = false;
 
   return(state);
 }
 
 uint8_t* LoRaWANNode::getBufferSession() {
   // store all frame counters
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_A_FCNT_DOWN], this->aFCntDown);
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_N_FCNT_DOWN], this->nFCntDown);
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_CONF_FCNT_UP], this->confFCntUp);
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_CONF_FCNT_DOWN], this->confFCntDown);
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_ADR_FCNT], this->adrFCnt);
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_FCNT_UP], this->fCntUp);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_A_FCNT_DOWN, this->aFCntDown);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_N_FCNT_DOWN, this->nFCntDown);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_CONF_FCNT_UP, this->confFCntUp);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_CONF_FCNT_DOWN, this->confFCntDown);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_ADR_FCNT, this->adrFCnt);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_FCNT_UP, this->fCntUp);
 
   // save the current uplink MAC command queue
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_MAC_QUEUE_UL], &this->commandsUp, sizeof(LoRaWANMacCommandQueue_t));
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_MAC_QUEUE_UL, (uint8_t*)&this->commandsUp, sizeof(LoRaWANMacCommandQueue_t));
+
+  // save the MAC state, so that it can be restored without replaying all MAC commands
+  this->saveSessionState();
 
-  // generate the signature of the Session buffer, and store it in the last two bytes of the Session buffer
-  uint16_t signature = LoRaWANNode::checkSum16(this->bufferSession, RADIOLIB_LORAWAN_SESSION_BUF_SIZE - 2);
-  LoRaWANNode::hton<uint16_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_SIGNATURE], signature);
+  // store the signature of the Session buffer in its last two bytes, the checksum is kept up to date on every write
+  LoRaWANNode::signBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
   
   return(this->bufferSession);
 }
 
+uint8_t LoRaWANNode::getBufferSessionChanges(LoRaWANBufferSpan_t* spans) {
+  return(LoRaWANNode::takeBufferChanges(&this->sessionTracker, spans));
+}
+
 int16_t LoRaWANNode::setBufferSession(uint8_t* persistentBuffer) {
   if(this->isActivated()) {
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Did not update buffer: session already active");
@@ -142,8 +147,18 @@ int16_t LoRaWANNode::setBufferSession(uint8_t* persistentBuffer) {
     return(RADIOLIB_LORAWAN_SESSION_DISCARDED);
   }
 
+  // the fields of a buffer saved with a different layout cannot be interpreted
+  uint16_t layout = LoRaWANNode::ntoh<uint16_t>(&persistentBuffer[RADIOLIB_LORAWAN_SESSION_LAYOUT]);
+  if(layout != RADIOLIB_LORAWAN_SESSION_LAYOUT_VAL) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("The supplied session buffer has layout %d, expected %d", layout, RADIOLIB_LORAWAN_SESSION_LAYOUT_VAL);
+    return(RADIOLIB_LORAWAN_SESSION_DISCARDED);
+  }
+
   // copy the whole buffer over
-  memcpy(this->bufferSession, persistentBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  LoRaWANNode::loadBuffer(this->bufferSession, &this->sessionTracker, persistentBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  #if RADIOLIB_LORAWAN_KEYSTREAM
+  this->keystreamLen = 0;
+  #endif
 
   //// this code can be used in case breaking chances must be caught:
   // uint8_t nvm_table_version = this->bufferNonces[RADIOLIB_LORAWAN_NONCES_VERSION];
@@ -169,7 +184,155 @@ int16_t LoRaWANNode::setBufferSession(uint8_t* persistentBuffer) {
   this->adrFCnt      = LoRaWANNode::ntoh<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_ADR_FCNT]);
   this->fCntUp       = LoRaWANNode::ntoh<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_FCNT_UP]);
   
-  // restore the complete MAC state
+  // restore the complete MAC state, directly from the snapshot if possible
+  state = this->restoreSessionState();
+  if(state != RADIOLIB_ERR_NONE) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("MAC state snapshot not usable (%d), replaying MAC commands", state);
+    state = this->replaySessionState();
+    RADIOLIB_ASSERT(state);
+  }
+
+  // copy uplink MAC command queue back in place
+  memcpy(&this->commandsUp, &this->bufferSession[RADIOLIB_LORAWAN_SESSION_MAC_QUEUE_UL], sizeof(LoRaWANMacCommandQueue_t));
+
+  // as both the Nonces and session are restored, revert to active session
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_ACTIVE, (uint8_t)true);
+  this->isRestored = true;
+
+  return(state);
+}
+
+void LoRaWANNode::saveChannel(uint8_t* buff, const LoRaWANChannel_t* chan) {
+  buff[0] = (uint8_t)chan->enabled;
+  buff[1] = chan->idx;
+  // frequency is stored in 100 Hz steps, the same as in MAC commands, independent of the float format of the host
+  LoRaWANNode::hton<uint32_t>(&buff[2], (uint32_t)(chan->freq*10000.0 + 0.5));
+  buff[6] = chan->drMin;
+  buff[7] = chan->drMax;
+}
+
+bool LoRaWANNode::restoreChannel(uint8_t* buff, LoRaWANChannel_t* chan) {
+  // datarates are 4-bit values in all bands
+  if((buff[0] > 1) || (buff[6] > 0x0F) || (buff[7] > 0x0F)) {
+    return(false);
+  }
+  chan->enabled = (bool)buff[0];
+  chan->idx = buff[1];
+  chan->freq = (float)LoRaWANNode::ntoh<uint32_t>(&buff[2])/10000.0;
+  chan->drMin = buff[6];
+  chan->drMax = buff[7];
+  return(true);
+}
+
+static uint16_t sessionStateCrc(const uint8_t* buff) {
+  RadioLibCRCInstance.size = 16;
+  RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
+  RadioLibCRCInstance.init = RADIOLIB_CRC_CCITT_INIT;
+  RadioLibCRCInstance.out = RADIOLIB_CRC_CCITT_OUT;
+  RadioLibCRCInstance.refIn = false;
+  RadioLibCRCInstance.refOut = false;
+  return(RadioLibCRCInstance.checksum(&buff[RADIOLIB_LORAWAN_SESSION_STATE_VERSION],
+                                      RADIOLIB_LORAWAN_SESSION_STATE_CRC - RADIOLIB_LORAWAN_SESSION_STATE_VERSION));
+}
+
+void LoRaWANNode::saveSessionState() {
+  uint8_t* buff = this->bufferSession;
+  LoRaWANBufferTracker_t* tracker = &this->sessionTracker;
+
+  // without a joined or restored session, there is no state to save and the snapshot is left empty
+  if(!this->isActive && !this->isRestored) {
+    LoRaWANNode::writeBuffer(buff, tracker, RADIOLIB_LORAWAN_SESSION_STATE_VERSION, NULL, RADIOLIB_LORAWAN_SESSION_LAYOUT - RADIOLIB_LORAWAN_SESSION_STATE_VERSION);
+    return;
+  }
+
+  // only fields that differ are written, the CRC is only recalculated if any of them did
+  bool changed = LoRaWANNode::writeBufferValue<uint8_t>(buff, tracker, RADIOLIB_LORAWAN_SESSION_STATE_VERSION, RADIOLIB_LORAWAN_SESSION_STATE_VERSION_VAL);
+  uint8_t chan[RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN];
+  uint16_t offset = RADIOLIB_LORAWAN_SESSION_STATE_CHANNELS;
+  for(uint8_t dir = 0; dir < 2; dir++) {
+    for(uint8_t i = 0; i < RADIOLIB_LORAWAN_NUM_AVAILABLE_CHANNELS; i++) {
+      saveChannel(chan, &this->availableChannels[dir][i]);
+      changed |= LoRaWANNode::writeBuffer(buff, tracker, offset, chan, RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN);
+      offset += RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN;
+    }
+  }
+  saveChannel(chan, &this->rx2);
+  changed |= LoRaWANNode::writeBuffer(buff, tracker, RADIOLIB_LORAWAN_SESSION_STATE_RX2, chan, RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN);
+
+  // the remaining fields are all next to each other
+  uint8_t params[RADIOLIB_LORAWAN_SESSION_STATE_CRC - RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES];
+  const uint16_t base = RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES;
+  params[RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES - base] = this->dataRates[RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK];
+  params[RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES + 1 - base] = this->dataRates[RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK];
+  params[RADIOLIB_LORAWAN_SESSION_STATE_TX_POWER - base] = this->txPowerSteps;
+  params[RADIOLIB_LORAWAN_SESSION_STATE_TX_POWER + 1 - base] = this->txPowerMax;
+  params[RADIOLIB_LORAWAN_SESSION_STATE_NB_TRANS - base] = this->nbTrans;
+  params[RADIOLIB_LORAWAN_SESSION_STATE_RX1_DR_OFFSET - base] = this->rx1DrOffset;
+  params[RADIOLIB_LORAWAN_SESSION_STATE_ADR_PARAMS - base] = this->adrLimitExp;
+  params[RADIOLIB_LORAWAN_SESSION_STATE_ADR_PARAMS + 1 - base] = this->adrDelayExp;
+  LoRaWANNode::hton<uint32_t>(&params[RADIOLIB_LORAWAN_SESSION_STATE_DUTY_CYCLE - base], this->dutyCycle);
+  params[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME - base] = ((uint8_t)this->dwellTimeEnabledDn << 1) | (uint8_t)this->dwellTimeEnabledUp;
+  LoRaWANNode::hton<uint16_t>(&params[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME + 1 - base], this->dwellTimeUp);
+  LoRaWANNode::hton<uint16_t>(&params[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME + 3 - base], this->dwellTimeDn);
+  LoRaWANNode::hton<uint32_t>(&params[RADIOLIB_LORAWAN_SESSION_STATE_RX_DELAYS - base], this->rxDelays[0]);
+  LoRaWANNode::hton<uint32_t>(&params[RADIOLIB_LORAWAN_SESSION_STATE_RX_DELAYS + 4 - base], this->rxDelays[1]);
+  changed |= LoRaWANNode::writeBuffer(buff, tracker, RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES, params, sizeof(params));
+
+  if(changed) {
+    LoRaWANNode::writeBufferValue<uint16_t>(buff, tracker, RADIOLIB_LORAWAN_SESSION_STATE_CRC, sessionStateCrc(buff));
+  }
+}
+
+int16_t LoRaWANNode::restoreSessionState() {
+  uint8_t* buff = this->bufferSession;
+
+  // validate everything first, so that a bad snapshot leaves the current state untouched
+  if(buff[RADIOLIB_LORAWAN_SESSION_STATE_VERSION] != RADIOLIB_LORAWAN_SESSION_STATE_VERSION_VAL) {
+    return(RADIOLIB_ERR_INVALID_REVISION);
+  }
+  if(LoRaWANNode::ntoh<uint16_t>(&buff[RADIOLIB_LORAWAN_SESSION_STATE_CRC]) != sessionStateCrc(buff)) {
+    return(RADIOLIB_ERR_CHECKSUM_MISMATCH);
+  }
+
+  LoRaWANChannel_t chans[2][RADIOLIB_LORAWAN_NUM_AVAILABLE_CHANNELS];
+  LoRaWANChannel_t chanRx2;
+  uint8_t* chanPtr = &buff[RADIOLIB_LORAWAN_SESSION_STATE_CHANNELS];
+  for(uint8_t dir = 0; dir < 2; dir++) {
+    for(uint8_t i = 0; i < RADIOLIB_LORAWAN_NUM_AVAILABLE_CHANNELS; i++) {
+      if(!restoreChannel(chanPtr, &chans[dir][i])) {
+        return(RADIOLIB_ERR_INVALID_DATA_RATE);
+      }
+      chanPtr += RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN;
+    }
+  }
+  if(!restoreChannel(&buff[RADIOLIB_LORAWAN_SESSION_STATE_RX2], &chanRx2)) {
+    return(RADIOLIB_ERR_INVALID_DATA_RATE);
+  }
+
+  // the snapshot is good, apply it
+  memcpy(this->availableChannels, chans, sizeof(chans));
+  this->rx2 = chanRx2;
+  this->dataRates[RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK] = buff[RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES];
+  this->dataRates[RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK] = buff[RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES + 1];
+  this->txPowerSteps = buff[RADIOLIB_LORAWAN_SESSION_STATE_TX_POWER];
+  this->txPowerMax = buff[RADIOLIB_LORAWAN_SESSION_STATE_TX_POWER + 1];
+  this->nbTrans = buff[RADIOLIB_LORAWAN_SESSION_STATE_NB_TRANS];
+  this->rx1DrOffset = buff[RADIOLIB_LORAWAN_SESSION_STATE_RX1_DR_OFFSET];
+  this->adrLimitExp = buff[RADIOLIB_LORAWAN_SESSION_STATE_ADR_PARAMS];
+  this->adrDelayExp = buff[RADIOLIB_LORAWAN_SESSION_STATE_ADR_PARAMS + 1];
+  this->dutyCycle = LoRaWANNode::ntoh<uint32_t>(&buff[RADIOLIB_LORAWAN_SESSION_STATE_DUTY_CYCLE]);
+  this->dwellTimeEnabledUp = buff[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME] & 0x01;
+  this->dwellTimeEnabledDn = (buff[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME] >> 1) & 0x01;
+  this->dwellTimeUp = LoRaWANNode::ntoh<uint16_t>(&buff[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME + 1]);
+  this->dwellTimeDn = LoRaWANNode::ntoh<uint16_t>(&buff[RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME + 3]);
+  this->rxDelays[0] = LoRaWANNode::ntoh<uint32_t>(&buff[RADIOLIB_LORAWAN_SESSION_STATE_RX_DELAYS]);
+  this->rxDelays[1] = LoRaWANNode::ntoh<uint32_t>(&buff[RADIOLIB_LORAWAN_SESSION_STATE_RX_DELAYS + 4]);
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::replaySessionState() {
+  int16_t state = RADIOLIB_ERR_NONE;
 
   // all-zero buffer used for checking if MAC commands are set
   uint8_t bufferZeroes[RADIOLIB_LORAWAN_MAX_MAC_COMMAND_LEN_DOWN] = { 0 };
@@ -272,12 +435,6 @@ int16_t LoRaWANNode::setBufferSession(uint8_t* persistentBuffer) {
   memcpy(cmd.payload, &this->bufferSession[RADIOLIB_LORAWAN_SESSION_REJOIN_PARAM_SETUP], cmd.len);
   (void)execMacCommand(&cmd);
 
-  // copy uplink MAC command queue back in place
-  memcpy(&this->commandsUp, &this->bufferSession[RADIOLIB_LORAWAN_SESSION_MAC_QUEUE_UL], sizeof(LoRaWANMacCommandQueue_t));
-
-  // as both the Nonces and session are restored, revert to active session
-  this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE] = (uint8_t)true;
-
   return(state);
 }
 
@@ -465,7 +622,7 @@ int16_t LoRaWANNode::activateOTAA(uint8_t joinDr, LoRaWANJoinEvent_t *joinEvent)
     // already activated, don't do anything
     return(RADIOLIB_ERR_NONE);
   }
-  if(this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE]) {
+  if(this->isRestored) {
     // session restored but not yet activated - do so now
     this->isActive = true;
     return(RADIOLIB_LORAWAN_SESSION_RESTORED);
@@ -532,7 +689,7 @@ int16_t LoRaWANNode::activateOTAA(uint8_t joinDr, LoRaWANJoinEvent_t *joinEvent)
 
   // join-request successfully sent, so increase & save devNonce
   this->devNonce += 1;
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_DEV_NONCE], this->devNonce);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_DEV_NONCE, this->devNonce);
 
   // configure Rx delay for join-accept message - these are re-configured once a valid join-request is received
   this->rxDelays[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_DELAY_1_MS;
@@ -606,14 +763,13 @@ int16_t LoRaWANNode::activateOTAA(uint8_t joinDr, LoRaWANJoinEvent_t *joinEvent)
     RadioLibAES128Instance.init(this->nwkKey);
     RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->jSIntKey);
 
-    // prepare the buffer for MIC calculation
-    uint8_t micBuff[3*RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
-    micBuff[0] = RADIOLIB_LORAWAN_JOIN_REQUEST_TYPE;
-    LoRaWANNode::hton<uint64_t>(&micBuff[1], this->joinEUI);
-    LoRaWANNode::hton<uint16_t>(&micBuff[9], devNonceUsed);
-    memcpy(&micBuff[11], joinAcceptMsg, lenRx);
+    // prepare the header that precedes the join accept in MIC calculation
+    uint8_t micHdr[11] = { 0 };
+    micHdr[0] = RADIOLIB_LORAWAN_JOIN_REQUEST_TYPE;
+    LoRaWANNode::hton<uint64_t>(&micHdr[1], this->joinEUI);
+    LoRaWANNode::hton<uint16_t>(&micHdr[9], devNonceUsed);
     
-    if(!verifyMIC(micBuff, lenRx + 11, this->jSIntKey)) {
+    if(!verifyMIC(micHdr, sizeof(micHdr), joinAcceptMsg, lenRx, this->jSIntKey)) {
       return(RADIOLIB_ERR_CRC_MISMATCH);
     }
   
@@ -715,32 +871,33 @@ int16_t LoRaWANNode::activateOTAA(uint8_t joinDr, LoRaWANJoinEvent_t *joinEvent)
   this->adrFCnt = 0;
 
   // save the activation keys checksum, device address & keys as well as JoinAccept values; these are only ever set when joining
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_VERSION], RADIOLIB_LORAWAN_NONCES_VERSION_VAL);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_MODE], RADIOLIB_LORAWAN_MODE_OTAA);
-  LoRaWANNode::hton<uint8_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_CLASS], RADIOLIB_LORAWAN_CLASS_A);
-  LoRaWANNode::hton<uint8_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_PLAN], this->band->bandNum);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_CHECKSUM], this->keyCheckSum);
-  LoRaWANNode::hton<uint32_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_JOIN_NONCE], this->joinNonce, 3);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_VERSION, RADIOLIB_LORAWAN_NONCES_VERSION_VAL);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_MODE, RADIOLIB_LORAWAN_MODE_OTAA);
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_CLASS, RADIOLIB_LORAWAN_CLASS_A);
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_PLAN, this->band->bandNum);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_CHECKSUM, this->keyCheckSum);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_JOIN_NONCE, this->joinNonce, 3);
 
-  this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE] = (uint8_t)true;
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_ACTIVE, (uint8_t)true);
 
-  // generate the signature of the Nonces buffer, and store it in the last two bytes of the Nonces buffer
-  uint16_t signature = LoRaWANNode::checkSum16(this->bufferNonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE - 2);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_SIGNATURE], signature);
+  // store the signature of the Nonces buffer in the last two bytes of the Nonces buffer
+  LoRaWANNode::signBuffer(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  uint16_t signature = this->noncesTracker.signature;
 
   // store DevAddr and all keys
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_DEV_ADDR], this->devAddr);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_APP_SKEY], this->appSKey, RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_NWK_SENC_KEY], this->nwkSEncKey, RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_FNWK_SINT_KEY], this->fNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_SNWK_SINT_KEY], this->sNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_DEV_ADDR, this->devAddr);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_APP_SKEY, this->appSKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_NWK_SENC_KEY, this->nwkSEncKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_FNWK_SINT_KEY, this->fNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_SNWK_SINT_KEY, this->sNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
   
   // set the signature of the Nonces buffer in the Session buffer
-  LoRaWANNode::hton<uint16_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_NONCES_SIGNATURE], signature);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_NONCES_SIGNATURE, signature);
 
   // store network parameters
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_HOMENET_ID], this->homeNetId);
-  LoRaWANNode::hton<uint8_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_VERSION], this->rev);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_HOMENET_ID, this->homeNetId);
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_VERSION, this->rev);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_LAYOUT, RADIOLIB_LORAWAN_SESSION_LAYOUT_VAL);
 
   this->isActive = true;
 
@@ -785,7 +942,7 @@ int16_t LoRaWANNode::activateABP(uint8_t initialDr) {
     // already activated, don't do anything
     return(RADIOLIB_ERR_NONE);
   }
-  if(this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE]) {
+  if(this->isRestored) {
     // session restored but not yet activated - do so now
     this->isActive = true;
     return(RADIOLIB_LORAWAN_SESSION_RESTORED);
@@ -813,32 +970,33 @@ int16_t LoRaWANNode::activateABP(uint8_t initialDr) {
   this->adrFCnt = 0;
 
   // save the activation keys checksum, mode, class, frequency plan
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_VERSION], RADIOLIB_LORAWAN_NONCES_VERSION_VAL);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_MODE], RADIOLIB_LORAWAN_MODE_ABP);
-  LoRaWANNode::hton<uint8_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_CLASS], RADIOLIB_LORAWAN_CLASS_A);
-  LoRaWANNode::hton<uint8_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_PLAN], this->band->bandNum);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_CHECKSUM], this->keyCheckSum);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_VERSION, RADIOLIB_LORAWAN_NONCES_VERSION_VAL);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_MODE, RADIOLIB_LORAWAN_MODE_ABP);
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_CLASS, RADIOLIB_LORAWAN_CLASS_A);
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_PLAN, this->band->bandNum);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_CHECKSUM, this->keyCheckSum);
 
   // new session all good, so set active-bit to true
-  this->bufferNonces[RADIOLIB_LORAWAN_NONCES_ACTIVE] = (uint8_t)true;
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_ACTIVE, (uint8_t)true);
 
-  // generate the signature of the Nonces buffer, and store it in the last two bytes of the Nonces buffer
-  uint16_t signature = LoRaWANNode::checkSum16(this->bufferNonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE - 2);
-  LoRaWANNode::hton<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_SIGNATURE], signature);
+  // store the signature of the Nonces buffer in the last two bytes of the Nonces buffer
+  LoRaWANNode::signBuffer(this->bufferNonces, &this->noncesTracker, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  uint16_t signature = this->noncesTracker.signature;
 
   // store DevAddr and all keys
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_DEV_ADDR], this->devAddr);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_APP_SKEY], this->appSKey, RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_NWK_SENC_KEY], this->nwkSEncKey, RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_FNWK_SINT_KEY], this->fNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_SNWK_SINT_KEY], this->sNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_DEV_ADDR, this->devAddr);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_APP_SKEY, this->appSKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_NWK_SENC_KEY, this->nwkSEncKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_FNWK_SINT_KEY, this->fNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
+  LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_SNWK_SINT_KEY, this->sNwkSIntKey, RADIOLIB_AES128_BLOCK_SIZE);
   
   // set the signature of the Nonces buffer in the Session buffer
-  LoRaWANNode::hton<uint16_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_NONCES_SIGNATURE], signature);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_NONCES_SIGNATURE, signature);
   
   // store network parameters
-  LoRaWANNode::hton<uint32_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_HOMENET_ID], this->homeNetId);
-  LoRaWANNode::hton<uint8_t>(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_VERSION], this->rev);
+  LoRaWANNode::writeBufferValue<uint32_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_HOMENET_ID, this->homeNetId);
+  LoRaWANNode::writeBufferValue<uint8_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_VERSION, this->rev);
+  LoRaWANNode::writeBufferValue<uint16_t>(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_LAYOUT, RADIOLIB_LORAWAN_SESSION_LAYOUT_VAL);
 
   this->isActive = true;
 
@@ -860,6 +1018,19 @@ int16_t LoRaWANNode::uplink(const char* str, uint8_t fPort, bool isConfirmed, Lo
 }
 
 int16_t LoRaWANNode::uplink(uint8_t* data, size_t len, uint8_t fPort, bool isConfirmed, LoRaWANEvent_t* event) {
+  // the non-blocking sequence owns the radio until it is finished
+  if(this->classAState != RADIOLIB_LORAWAN_CLASS_A_IDLE) {
+    return(RADIOLIB_ERR_UPLINK_UNAVAILABLE);
+  }
+
+  return(this->uplinkCommon(data, len, fPort, isConfirmed, event, true));
+}
+
+uint8_t* LoRaWANNode::getUplinkBuffer() {
+  return(&this->frameBuff[RADIOLIB_LORAWAN_FRAME_BUFF_PAYLOAD_POS]);
+}
+
+int16_t LoRaWANNode::uplinkCommon(uint8_t* data, size_t len, uint8_t fPort, bool isConfirmed, LoRaWANEvent_t* event, bool wait) {
   // if not joined, don't do anything
   if(!this->isActivated()) {
     return(RADIOLIB_ERR_NETWORK_NOT_JOINED);
@@ -985,14 +1156,11 @@ int16_t LoRaWANNode::uplink(uint8_t* data, size_t len, uint8_t fPort, bool isCon
     return(RADIOLIB_ERR_DWELL_TIME_EXCEEDED);
   }
 
-  // build the uplink message
+  // build the uplink message in the frame buffer
+  // the header is shifted by the FOpts length, so the payload always starts at RADIOLIB_LORAWAN_FRAME_BUFF_PAYLOAD_POS
   // the first 16 bytes are reserved for MIC calculation blocks
   size_t uplinkMsgLen = RADIOLIB_LORAWAN_FRAME_LEN(len, fOptsLen);
-  #if RADIOLIB_STATIC_ONLY
-  uint8_t uplinkMsg[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-  uint8_t* uplinkMsg = new uint8_t[uplinkMsgLen];
-  #endif
+  uint8_t* uplinkMsg = &this->frameBuff[RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN - fOptsLen];
   
   // set the packet fields
   if(isConfirmed) {
@@ -1064,7 +1232,7 @@ int16_t LoRaWANNode::uplink(uint8_t* data, size_t len, uint8_t fPort, bool isCon
     encKey = this->nwkSEncKey;
   }
 
-  // encrypt the frame payload
+  // encrypt the frame payload, in place if it was written into the frame buffer
   processAES(data, len, encKey, &uplinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(fOptsLen)], this->fCntUp, RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK, 0x00, true);
 
   // create blocks for MIC calculation
@@ -1087,11 +1255,11 @@ int16_t LoRaWANNode::uplink(uint8_t* data, size_t len, uint8_t fPort, bool isCon
 
   RADIOLIB_DEBUG_PROTOCOL_HEXDUMP(uplinkMsg, uplinkMsgLen);
 
-  // calculate authentication codes
-  memcpy(uplinkMsg, block1, RADIOLIB_AES128_BLOCK_SIZE);
-  uint32_t micS = this->generateMIC(uplinkMsg, uplinkMsgLen - sizeof(uint32_t), this->sNwkSIntKey);
-  memcpy(uplinkMsg, block0, RADIOLIB_AES128_BLOCK_SIZE);
-  uint32_t micF = this->generateMIC(uplinkMsg, uplinkMsgLen - sizeof(uint32_t), this->fNwkSIntKey);
+  // calculate authentication codes, the blocks are streamed in front of the message instead of being copied into it
+  uint8_t* micMsg = &uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS];
+  size_t micMsgLen = uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS - sizeof(uint32_t);
+  uint32_t micS = this->generateMIC(block1, RADIOLIB_AES128_BLOCK_SIZE, micMsg, micMsgLen, this->sNwkSIntKey);
+  uint32_t micF = this->generateMIC(block0, RADIOLIB_AES128_BLOCK_SIZE, micMsg, micMsgLen, this->fNwkSIntKey);
 
   // check LoRaWAN revision
   if(this->rev == 1) {
@@ -1107,18 +1275,19 @@ int16_t LoRaWANNode::uplink(uint8_t* data, size_t len, uint8_t fPort, bool isCon
   }
 
   // send it (without the MIC calculation blocks)
-  state = this->phyLayer->transmit(&uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS);
+  if(wait) {
+    state = this->phyLayer->transmit(&uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS);
+  } else {
+    state = this->phyLayer->startTransmit(&uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS);
+  }
 
   // set the timestamp so that we can measure when to start receiving
+  // when not waiting, this is the start of the transmission and tick() will move it to the end
   this->rxDelayStart = mod->hal->millis();
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Uplink sent <-- Rx Delay start");
 
   // calculate Time on Air of this uplink in milliseconds
   this->lastToA = this->phyLayer->getTimeOnAir(uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS) / 1000;
-
-  #if !RADIOLIB_STATIC_ONLY
-  delete[] uplinkMsg;
-  #endif
   RADIOLIB_ASSERT(state);
   
   // the downlink confirmation was acknowledged, so clear the counter value
@@ -1147,7 +1316,7 @@ int16_t LoRaWANNode::downlinkCommon() {
 
   // according to the spec, the Rx window must be at least enough time to effectively detect a preamble
   // but we pad it a bit on both sides (start and end) to make sure it is wide enough
-  const RadioLibTime_t scanGuard = 10;      // Rx window padding in milliseconds
+  const RadioLibTime_t scanGuard = RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS;
 
   // check if there are any upcoming Rx windows
   // if the Rx1 window has already started, you're too late, because most downlinks happen in Rx1
@@ -1171,12 +1340,11 @@ int16_t LoRaWANNode::downlinkCommon() {
   uint32_t irqMask = 0;
   this->phyLayer->irqRxDoneRxTimeout(irqFlags, irqMask);
 
-  this->phyLayer->setPacketReceivedAction(LoRaWANNodeOnDownlinkAction);
+  // there is plenty of time before Rx1 opens, use it to get the next uplink ready
+  this->prepareKeystream();
 
   // perform listening in the two Rx windows
   for(uint8_t i = 0; i < 2; i++) {
-    downlinkAction = false;
-
     // calculate the Rx timeout
     RadioLibTime_t timeoutHost = this->phyLayer->getTimeOnAir(0) + 2*scanGuard*1000;
     RadioLibTime_t timeoutMod  = this->phyLayer->calculateRxTimeout(timeoutHost);
@@ -1235,9 +1403,10 @@ int16_t LoRaWANNode::downlinkCommon() {
   }
 
   // wait for the DIO to fire indicating a downlink is received
+  // the pin is polled rather than using an interrupt flag, so that multiple nodes do not share any state
   now = mod->hal->millis();
   bool downlinkComplete = true;
-  while(!downlinkAction) {
+  while(!mod->hal->digitalRead(mod->getIrq())) {
     mod->hal->yield();
     // this should never happen, but if it does this would be an infinite loop
     if(mod->hal->millis() - now > 3000UL) {
@@ -1247,9 +1416,8 @@ int16_t LoRaWANNode::downlinkCommon() {
     }
   }
 
-  // we have a message, clear actions, go to standby and reset the IQ inversion
+  // we have a message, go to standby and reset the IQ inversion
   this->phyLayer->standby();  // TODO check: this should be done automagically due to RxSingle?
-  this->phyLayer->clearPacketReceivedAction();
   if(this->modulation == RADIOLIB_LORAWAN_MODULATION_LORA) {
     state = this->phyLayer->invertIQ(false);
     RADIOLIB_ASSERT(state);
@@ -1286,24 +1454,27 @@ int16_t LoRaWANNode::downlink(String& str, LoRaWANEvent_t* event) {
 #endif
 
 int16_t LoRaWANNode::downlink(LoRaWANEvent_t* event) {
-  int16_t state = RADIOLIB_ERR_UNKNOWN;
-
-  // build a temporary buffer
-  // LoRaWAN downlinks can have 250 bytes at most with 1 extra byte for NULL
+  // wait for downlink, the payload is discarded
   size_t length = 0;
-  uint8_t data[251];
-
-  // wait for downlink
-  state = this->downlink(data, &length, event);
-
-  return(state);
+  return(this->downlink(NULL, &length, event));
 }
 
 int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event) {
+  // the non-blocking sequence handles its own Rx windows
+  if(this->classAState != RADIOLIB_LORAWAN_CLASS_A_IDLE) {
+    return(RADIOLIB_ERR_NO_RX_WINDOW);
+  }
+
   // handle Rx1 and Rx2 windows - returns RADIOLIB_ERR_NONE if a downlink is received
   int16_t state = downlinkCommon();
   RADIOLIB_ASSERT(state);
 
+  return(this->processDownlink(data, len, event));
+}
+
+int16_t LoRaWANNode::processDownlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event) {
+  int16_t state = RADIOLIB_ERR_UNKNOWN;
+
   // get the packet length
   size_t downlinkMsgLen = this->phyLayer->getPacketLength();
 
@@ -1313,14 +1484,14 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink message too short (%lu bytes)", (unsigned long)downlinkMsgLen);
     return(RADIOLIB_ERR_DOWNLINK_MALFORMED);
   }
+  if(RADIOLIB_AES128_BLOCK_SIZE + downlinkMsgLen > RADIOLIB_LORAWAN_FRAME_BUFF_LEN) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink message too long (%lu bytes)", (unsigned long)downlinkMsgLen);
+    return(RADIOLIB_ERR_DOWNLINK_MALFORMED);
+  }
 
-  // build the buffer for the downlink message
+  // receive the downlink message into the frame buffer
   // the first 16 bytes are reserved for MIC calculation block
-  #if !RADIOLIB_STATIC_ONLY
-    uint8_t* downlinkMsg = new uint8_t[RADIOLIB_AES128_BLOCK_SIZE + downlinkMsgLen];
-  #else
-    uint8_t downlinkMsg[RADIOLIB_STATIC_ARRAY_SIZE];
-  #endif
+  uint8_t* downlinkMsg = this->frameBuff;
 
   // read the data
   state = this->phyLayer->readData(&downlinkMsg[RADIOLIB_AES128_BLOCK_SIZE], downlinkMsgLen);
@@ -1331,20 +1502,14 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
   }
   
   if(state != RADIOLIB_ERR_NONE) {
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] downlinkMsg;
-    #endif
     return(state);
   }
 
-  // check the address
+  // check the address, a frame for some other device in range is not a downlink for this one
   uint32_t addr = LoRaWANNode::ntoh<uint32_t>(&downlinkMsg[RADIOLIB_LORAWAN_FHDR_DEV_ADDR_POS]);
   if(addr != this->devAddr) {
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Device address mismatch, expected 0x%08X, got 0x%08X", this->devAddr, addr);
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] downlinkMsg;
-    #endif
-    return(RADIOLIB_ERR_DOWNLINK_MALFORMED);
+    return(RADIOLIB_LORAWAN_NO_DOWNLINK);
   }
 
   // calculate length of FOpts and payload
@@ -1377,9 +1542,6 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
  
   // check the MIC
   if(!verifyMIC(downlinkMsg, RADIOLIB_AES128_BLOCK_SIZE + downlinkMsgLen, this->sNwkSIntKey)) {
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] downlinkMsg;
-    #endif
     return(RADIOLIB_ERR_CRC_MISMATCH);
   }
 
@@ -1396,16 +1558,10 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
     // check if fPort value is actually allowed
     if(fPort > RADIOLIB_LORAWAN_FPORT_RESERVED) {
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Received downlink at FPort %d - rejected! This FPort is RFU!", fPort);
-      #if !RADIOLIB_STATIC_ONLY
-        delete[] downlinkMsg;
-      #endif
       return(RADIOLIB_ERR_INVALID_PORT);
     }
     if(fPort == RADIOLIB_LORAWAN_FPORT_TS009 && this->TS009 == false) {
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Received downlink at FPort %d - rejected! TS009 was not enabled.", fPort);
-      #if !RADIOLIB_STATIC_ONLY
-        delete[] downlinkMsg;
-      #endif
       return(RADIOLIB_ERR_INVALID_PORT);
     }
 
@@ -1433,9 +1589,6 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
   uint32_t fCnt32 = fCnt16;
   if(fCntDownPrev > 0) {
     if((fCnt16 <= fCntDownPrev) && ((0xFFFF - (uint16_t)fCntDownPrev + fCnt16) > RADIOLIB_LORAWAN_MAX_FCNT_GAP)) {
-      #if !RADIOLIB_STATIC_ONLY
-        delete[] downlinkMsg;
-      #endif
       if (isAppDownlink) {
         return(RADIOLIB_ERR_A_FCNT_DOWN_INVALID);
       } else {
@@ -1461,23 +1614,28 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
     isConfirmedDown = true;
   }
 
+  // decrypt Application payload first, the frame buffer may be reused by a MAC-only uplink below
+  if((fPort != RADIOLIB_LORAWAN_FPORT_MAC_COMMAND) && data) {
+    // TODO it COULD be the case that the assumed rollover is incorrect, then figure out a way to catch this and retry with just fCnt16
+    processAES(&downlinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(fOptsLen)], payLen, this->appSKey, data, fCnt32, RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK, 0x00, true);
+  }
+
   // process FOpts (if there are any)
   if(fOptsLen > 0) {
-    // there are some Fopts, decrypt them
-    #if !RADIOLIB_STATIC_ONLY
-      uint8_t* fOpts = new uint8_t[RADIOLIB_MAX(RADIOLIB_LORAWAN_FHDR_FOPTS_LEN_MASK, (int)fOptsLen)];
-    #else
-      uint8_t fOpts[RADIOLIB_STATIC_ARRAY_SIZE];
-    #endif
+    // there are some Fopts, decrypt them in place
+    uint8_t* fOpts = &downlinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(0)];
+    if(fOptsLen <= RADIOLIB_LORAWAN_FHDR_FOPTS_LEN_MASK) {
+      fOpts = &downlinkMsg[RADIOLIB_LORAWAN_FHDR_FOPTS_POS];
+    }
 
     // TODO it COULD be the case that the assumed FCnt rollover is incorrect, if possible figure out a way to catch this and retry with just fCnt16
     // if there are <= 15 bytes of FOpts, they are in the FHDR, otherwise they are in the payload
     // in case of the latter, process AES is if it were a normal payload but using the NwkSEncKey
     if(fOptsLen <= RADIOLIB_LORAWAN_FHDR_FOPTS_LEN_MASK) {
       uint8_t ctrId = 0x01 + isAppDownlink; // see LoRaWAN v1.1 errata
-      processAES(&downlinkMsg[RADIOLIB_LORAWAN_FHDR_FOPTS_POS], (size_t)fOptsLen, this->nwkSEncKey, fOpts, fCnt32, RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK, ctrId, true);
+      processAES(fOpts, (size_t)fOptsLen, this->nwkSEncKey, fOpts, fCnt32, RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK, ctrId, true);
     } else {
-      processAES(&downlinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(0)], (size_t)fOptsLen, this->nwkSEncKey, fOpts, fCnt32, RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK, 0x00, true);
+      processAES(fOpts, (size_t)fOptsLen, this->nwkSEncKey, fOpts, fCnt32, RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK, 0x00, true);
     }
 
     bool hasADR = false;
@@ -1525,18 +1683,11 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
       lastCID = cid;
     }
 
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] fOpts;
-    #endif
-
     // if fOptsLen for the next uplink is larger than can be piggybacked onto an uplink, send separate uplink
     if(this->commandsUp.len > RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN) {
+      // the replies are written directly into the payload of the next uplink frame
       size_t fOptsBufSize = this->commandsUp.len;
-      #if RADIOLIB_STATIC_ONLY
-        uint8_t fOptsBuff[RADIOLIB_STATIC_ARRAY_SIZE];
-      #else
-        uint8_t* fOptsBuff = new uint8_t[fOptsBufSize];
-      #endif
+      uint8_t* fOptsBuff = this->getUplinkBuffer();
       uint8_t* fOptsPtrUp = fOptsBuff;
       // append all MAC replies into fOpts buffer
       int16_t i = 0;
@@ -1565,23 +1716,13 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
       state = this->uplink(fOptsBuff, fOptsBufSize, RADIOLIB_LORAWAN_FPORT_MAC_COMMAND);
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN(" .. state: %d", state);
       this->dutyCycleEnabled = prevDC;
-      #if !RADIOLIB_STATIC_ONLY
-        delete[] fOptsBuff;
-      #endif
       RADIOLIB_ASSERT(state);
 
-      #if RADIOLIB_STATIC_ONLY
-        uint8_t strDown[RADIOLIB_STATIC_ARRAY_SIZE];
-      #else
-        uint8_t* strDown = new uint8_t[this->band->payloadLenMax[this->dataRates[RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK]]];
-      #endif
+      // any application payload of this downlink is discarded
       size_t lenDown = 0;
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Receiving after MAC-only uplink .. ");
-      state = this->downlink(strDown, &lenDown);
+      state = this->downlink(NULL, &lenDown);
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN(" .. state: %d", state);
-      #if !RADIOLIB_STATIC_ONLY
-        delete[] strDown;
-      #endif
       RADIOLIB_ASSERT(state);
     }
 
@@ -1606,23 +1747,13 @@ int16_t LoRaWANNode::downlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event)
   if(fPort == RADIOLIB_LORAWAN_FPORT_MAC_COMMAND) {
     // no payload
     *len = 0;
-    #if !RADIOLIB_STATIC_ONLY
-      delete[] downlinkMsg;
-    #endif
 
     return(RADIOLIB_ERR_NONE);
   }
 
-  // process Application payload
+  // Application payload was already decrypted
   *len = payLen;
 
-  // TODO it COULD be the case that the assumed rollover is incorrect, then figure out a way to catch this and retry with just fCnt16
-  processAES(&downlinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(fOptsLen)], payLen, this->appSKey, data, fCnt32, RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK, 0x00, true);
-  
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] downlinkMsg;
-  #endif
-
   return(RADIOLIB_ERR_NONE);
 }
 
@@ -1668,6 +1799,201 @@ int16_t LoRaWANNode::sendReceive(uint8_t* dataUp, size_t lenUp, uint8_t fPort, u
   return(state);
 }
 
+int16_t LoRaWANNode::startUplink(uint8_t* data, size_t len, uint8_t fPort, bool isConfirmed, LoRaWANEvent_t* event) {
+  if(this->classAState != RADIOLIB_LORAWAN_CLASS_A_IDLE) {
+    return(RADIOLIB_ERR_UPLINK_UNAVAILABLE);
+  }
+
+  int16_t state = this->uplinkCommon(data, len, fPort, isConfirmed, event, false);
+  RADIOLIB_ASSERT(state);
+
+  // give up on the transmission if it takes more than twice the expected time
+  this->classAState = RADIOLIB_LORAWAN_CLASS_A_TX;
+  this->classAWindow = 0;
+  this->classADeadline = this->rxDelayStart + 2*this->lastToA + RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MIN_MS;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::tick(LoRaWANEvent_t* eventDown) {
+  // LoRaWAN downlinks can have 250 bytes at most with 1 extra byte for NULL
+  size_t length = 0;
+  uint8_t data[251];
+  return(this->tick(data, &length, eventDown));
+}
+
+int16_t LoRaWANNode::tick(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown) {
+  Module* mod = this->phyLayer->getMod();
+  RadioLibTime_t now = mod->hal->millis();
+
+  // completion of transmission and reception is indicated on the IRQ pin, same as in blocking transmit
+  bool irq = mod->hal->digitalRead(mod->getIrq());
+  int16_t state = RADIOLIB_ERR_NONE;
+
+  switch(this->classAState) {
+    case(RADIOLIB_LORAWAN_CLASS_A_IDLE):
+      return(RADIOLIB_ERR_NO_RX_WINDOW);
+
+    case(RADIOLIB_LORAWAN_CLASS_A_TX):
+      if(!irq) {
+        if(now > this->classADeadline) {
+          this->phyLayer->finishTransmit();
+          return(this->classAFinish(RADIOLIB_ERR_TX_TIMEOUT));
+        }
+        return(RADIOLIB_LORAWAN_BUSY);
+      }
+
+      // the Rx delay is counted from the expected end of the uplink, so that it does not depend on how late tick() was called
+      if(now > this->rxDelayStart + this->lastToA) {
+        this->rxDelayStart += this->lastToA;
+      } else {
+        this->rxDelayStart = now;
+      }
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Uplink done <-- Rx Delay start");
+      state = this->phyLayer->finishTransmit();
+      if(state != RADIOLIB_ERR_NONE) {
+        return(this->classAFinish(state));
+      }
+
+      // set the physical layer configuration for downlink
+      state = this->setPhyProperties(RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK);
+      if(state != RADIOLIB_ERR_NONE) {
+        return(this->classAFinish(state));
+      }
+
+      // there is plenty of time before Rx1 opens, use it to get the next uplink ready
+      this->prepareKeystream();
+      this->classAState = RADIOLIB_LORAWAN_CLASS_A_RX_DELAY;
+      return(RADIOLIB_LORAWAN_BUSY);
+
+    case(RADIOLIB_LORAWAN_CLASS_A_RX_DELAY):
+      // the window is opened a bit early to cover any possible timing errors
+      if(now + RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS < this->rxDelayStart + this->rxDelays[this->classAWindow]) {
+        return(RADIOLIB_LORAWAN_BUSY);
+      }
+      state = this->classAOpenWindow();
+      if(state != RADIOLIB_ERR_NONE) {
+        return(this->classAFinish(state));
+      }
+      return(RADIOLIB_LORAWAN_BUSY);
+
+    case(RADIOLIB_LORAWAN_CLASS_A_RX_WINDOW):
+      if(!irq && (now < this->classADeadline)) {
+        return(RADIOLIB_LORAWAN_BUSY);
+      }
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Closing Rx%d window", this->classAWindow + 1);
+
+      // a reception is in progress or already done
+      if(!this->phyLayer->isRxTimeout()) {
+        this->classAState = RADIOLIB_LORAWAN_CLASS_A_RX_PENDING;
+        this->classADeadline = now + 3000UL;
+        return(this->tick(dataDown, lenDown, eventDown));
+      }
+
+      // nothing in the last window
+      if(this->classAWindow > 0) {
+        return(this->classAFinish(RADIOLIB_LORAWAN_NO_DOWNLINK));
+      }
+
+      // nothing in the first window, configure for the second
+      {
+        this->phyLayer->standby();
+        RADIOLIB_DEBUG_PROTOCOL_PRINTLN("PHY: Frequency %cL = %6.3f MHz", 'D', this->rx2.freq);
+        state = this->phyLayer->setFrequency(this->rx2.freq);
+        if(state != RADIOLIB_ERR_NONE) {
+          return(this->classAFinish(state));
+        }
+
+        DataRate_t dataRate;
+        state = findDataRate(this->rx2.drMax, &dataRate);
+        if(state == RADIOLIB_ERR_NONE) {
+          state = this->phyLayer->setDataRate(dataRate);
+        }
+        if(state != RADIOLIB_ERR_NONE) {
+          return(this->classAFinish(state));
+        }
+        this->classAWindow = 1;
+        this->classAState = RADIOLIB_LORAWAN_CLASS_A_RX_DELAY;
+      }
+      return(RADIOLIB_LORAWAN_BUSY);
+
+    case(RADIOLIB_LORAWAN_CLASS_A_RX_PENDING):
+      if(!irq) {
+        if(now > this->classADeadline) {
+          // this should never happen, the window did not time out but nothing was received
+          RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink missing!");
+          return(this->classAFinish(RADIOLIB_LORAWAN_NO_DOWNLINK));
+        }
+        return(RADIOLIB_LORAWAN_BUSY);
+      }
+
+      // we have a message, reset the radio before processing it, as that may send another uplink
+      state = this->classAFinish(RADIOLIB_ERR_NONE);
+      RADIOLIB_ASSERT(state);
+      return(this->processDownlink(dataDown, lenDown, eventDown));
+  }
+
+  return(RADIOLIB_ERR_UNKNOWN);
+}
+
+RadioLibTime_t LoRaWANNode::timeUntilTick() {
+  RadioLibTime_t now = this->phyLayer->getMod()->hal->millis();
+  RadioLibTime_t next = now;
+  switch(this->classAState) {
+    case(RADIOLIB_LORAWAN_CLASS_A_TX):
+      next = this->rxDelayStart + this->lastToA;
+      break;
+    case(RADIOLIB_LORAWAN_CLASS_A_RX_DELAY):
+      next = this->rxDelayStart + this->rxDelays[this->classAWindow] - RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS;
+      break;
+    case(RADIOLIB_LORAWAN_CLASS_A_RX_WINDOW):
+      next = this->classADeadline;
+      break;
+  }
+
+  if(next <= now) {
+    return(0);
+  }
+  return(next - now);
+}
+
+int16_t LoRaWANNode::classAOpenWindow() {
+  Module* mod = this->phyLayer->getMod();
+
+  // calculate the Rx timeout
+  RadioLibTime_t timeoutHost = this->phyLayer->getTimeOnAir(0) + 2*RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS*1000;
+  RadioLibTime_t timeoutMod  = this->phyLayer->calculateRxTimeout(timeoutHost);
+
+  // create the masks that are required for receiving downlinks
+  uint32_t irqFlags = 0;
+  uint32_t irqMask = 0;
+  this->phyLayer->irqRxDoneRxTimeout(irqFlags, irqMask);
+
+  // open Rx window by starting receive with specified timeout
+  int16_t state = this->phyLayer->startReceive(timeoutMod, irqFlags, irqMask, 0);
+  RADIOLIB_ASSERT(state);
+  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Opening Rx%d window (%d ms timeout)... <-- Rx Delay end ", this->classAWindow + 1, (int)(timeoutHost / 1000 + RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS / 2));
+
+  // the window is closed after the timeout and a small additional delay, unless the IRQ fires sooner
+  this->classAState = RADIOLIB_LORAWAN_CLASS_A_RX_WINDOW;
+  this->classADeadline = mod->hal->millis() + timeoutHost / 1000 + RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS / 2;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANNode::classAFinish(int16_t result) {
+  // Rx windows are now closed
+  this->classAState = RADIOLIB_LORAWAN_CLASS_A_IDLE;
+  this->rxDelayEnd = this->phyLayer->getMod()->hal->millis();
+
+  // stop ongoing activities and reset the IQ inversion
+  this->phyLayer->standby();
+  if(this->modulation == RADIOLIB_LORAWAN_MODULATION_LORA) {
+    int16_t state = this->phyLayer->invertIQ(false);
+    RADIOLIB_ASSERT(state);
+  }
+
+  return(result);
+}
+
 void LoRaWANNode::setDeviceStatus(uint8_t battLevel) {
   this->battLevel = battLevel;
 }
@@ -1698,13 +2024,27 @@ uint32_t LoRaWANNode::generateMIC(uint8_t* msg, size_t len, uint8_t* key) {
     return(0);
   }
 
+  return(generateMIC(NULL, 0, msg, len, key));
+}
+
+uint32_t LoRaWANNode::generateMIC(const uint8_t* hdr, size_t hdrLen, const uint8_t* msg, size_t len, uint8_t* key) {
   RadioLibAES128Instance.init(key);
+  RadioLibAES128Instance.initCMAC();
+  if(hdr != NULL) {
+    RadioLibAES128Instance.updateCMAC(hdr, hdrLen);
+  }
+  RadioLibAES128Instance.updateCMAC(msg, len);
+
   uint8_t cmac[RADIOLIB_AES128_BLOCK_SIZE];
-  RadioLibAES128Instance.generateCMAC(msg, len, cmac);
+  RadioLibAES128Instance.finalCMAC(cmac);
   return(((uint32_t)cmac[0]) | ((uint32_t)cmac[1] << 8) | ((uint32_t)cmac[2] << 16) | ((uint32_t)cmac[3]) << 24);
 }
 
 bool LoRaWANNode::verifyMIC(uint8_t* msg, size_t len, uint8_t* key) {
+  return(verifyMIC(NULL, 0, msg, len, key));
+}
+
+bool LoRaWANNode::verifyMIC(const uint8_t* hdr, size_t hdrLen, uint8_t* msg, size_t len, uint8_t* key) {
   if((msg == NULL) || (len < sizeof(uint32_t))) {
     return(0);
   }
@@ -1713,7 +2053,7 @@ bool LoRaWANNode::verifyMIC(uint8_t* msg, size_t len, uint8_t* key) {
   uint32_t micReceived = LoRaWANNode::ntoh<uint32_t>(&msg[len - sizeof(uint32_t)]);
 
   // calculate the expected value and compare
-  uint32_t micCalculated = generateMIC(msg, len - sizeof(uint32_t), key);
+  uint32_t micCalculated = generateMIC(hdr, hdrLen, msg, len - sizeof(uint32_t), key);
   if(micCalculated != micReceived) {
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("MIC mismatch, expected %08x, got %08x", micCalculated, micReceived);
     return(false);
@@ -2081,7 +2421,7 @@ uint8_t LoRaWANNode::maxPayloadDwellTime() {
   uint8_t payLen = (minPayLen + maxPayLen) / 2;
   // do some binary search to find maximum allowed payload length
   while(payLen != minPayLen && payLen != maxPayLen) {
-    if(this->phyLayer->getTimeOnAir(payLen) > this->dwellTimeUp) {
+    if(this->phyLayer->getTimeOnAir(payLen) / 1000 > this->dwellTimeUp) {
       maxPayLen = payLen;
     } else {
       minPayLen = payLen;
@@ -2352,7 +2692,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
               this->availableChannels[RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK][i] = RADIOLIB_LORAWAN_CHANNEL_NONE;
             }
             // clear all previous channel masks
-            memset(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_UL_CHANNELS], 0, 16*8);
+            LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_UL_CHANNELS, NULL, 16*8);
           } else {
             // if this is not the first ADR command, clear the ADR response that was in the queue
             (void)deleteMacCommand(RADIOLIB_LORAWAN_MAC_LINK_ADR, &this->commandsUp);
@@ -2391,7 +2731,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
         }
 
         // save to the single ADR MAC location
-        memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_LINK_ADR], &(cmd->payload[0]), cmd->len);
+        LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_LINK_ADR, &(cmd->payload[0]), cmd->len);
       
       } else {                // RADIOLIB_LORAWAN_BAND_FIXED
 
@@ -2399,14 +2739,14 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
         uint8_t bufTxDr[RADIOLIB_LORAWAN_MAX_MAC_COMMAND_LEN_DOWN] = { 0 };
         bufTxDr[0] = cmd->payload[0];
         bufTxDr[3] = 1 << 7;
-        memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_LINK_ADR], bufTxDr, cmd->len);
+        LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_LINK_ADR, bufTxDr, cmd->len);
         
         // if RFU bit is set, this is just a change in Datarate or TxPower, in which case we don't save the channel masks
         // if the RFU bit is not set, we must save this channel mask
         if(!isInternalTxDr) {
           // save the channel mask to the uplink channels position in session buffer, with Tx and DR set to 'same'
           cmd->payload[0] = 0xFF;
-          memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_UL_CHANNELS] + (cmd->repeat - 1) * cmd->len, cmd->payload, cmd->len);
+          LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_UL_CHANNELS + (cmd->repeat - 1) * cmd->len, cmd->payload, cmd->len);
           RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Saving mask to ULChannels[%d]:", (cmd->repeat - 1) * cmd->len);
           RADIOLIB_DEBUG_PROTOCOL_HEXDUMP(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_UL_CHANNELS] + (cmd->repeat - 1) * cmd->len, cmd->len);
         }
@@ -2430,7 +2770,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
         this->dutyCycle = (RadioLibTime_t)60 * (RadioLibTime_t)60 * (RadioLibTime_t)1000 / (RadioLibTime_t)(1UL << maxDutyCycle);
       }
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_DUTY_CYCLE], cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_DUTY_CYCLE, cmd->payload, cmd->len);
 
       cmd->len = 0;
       return(true);
@@ -2453,7 +2793,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
         this->phyLayer->setFrequency(this->currentChannels[RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK].freq);
       }
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_RX_PARAM_SETUP], cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_RX_PARAM_SETUP, cmd->payload, cmd->len);
 
       // TODO this should be sent repeatedly until the next downlink
       cmd->len = 1;
@@ -2516,7 +2856,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
                               this->availableChannels[RADIOLIB_LORAWAN_CHANNEL_DIR_DOWNLINK][chIndex].drMax
                             );
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_UL_CHANNELS] + chIndex * cmd->len, cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_UL_CHANNELS + chIndex * cmd->len, cmd->payload, cmd->len);
 
       // send the reply
       cmd->len = 1;
@@ -2552,7 +2892,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
         }
       }
       
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_DL_CHANNELS] + chIndex * cmd->len, cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_DL_CHANNELS + chIndex * cmd->len, cmd->payload, cmd->len);
 
       // TODO send this repeatedly until a downlink is received
       cmd->len = 1;
@@ -2574,7 +2914,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
       this->rxDelays[0] = delay * 1000;
       this->rxDelays[1] = this->rxDelays[0] + 1000;
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_RX_TIMING_SETUP], cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_RX_TIMING_SETUP, cmd->payload, cmd->len);
 
       // send the reply
       cmd->len = 0;
@@ -2599,7 +2939,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
       this->dwellTimeEnabledDn = dlDwell ? true : false;
       this->dwellTimeDn = dlDwell ? RADIOLIB_LORAWAN_DWELL_TIME : 0;
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_TX_PARAM_SETUP], cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_TX_PARAM_SETUP, cmd->payload, cmd->len);
 
       cmd->len = 0;
       return(true);
@@ -2621,7 +2961,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
       this->adrDelayExp = cmd->payload[0] & 0x0F;
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN("ADRParamSetupReq: limitExp = %d, delayExp = %d", this->adrLimitExp, this->adrDelayExp);
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_ADR_PARAM_SETUP], cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_ADR_PARAM_SETUP, cmd->payload, cmd->len);
 
       cmd->len = 0;
       return(true);
@@ -2658,7 +2998,7 @@ bool LoRaWANNode::execMacCommand(LoRaWANMacCommand_t* cmd) {
       uint8_t maxCount = cmd->payload[0] & 0x0F;
       RADIOLIB_DEBUG_PROTOCOL_PRINTLN("RejoinParamSetupReq: maxTime = %d, maxCount = %d", maxTime, maxCount);
 
-      memcpy(&this->bufferSession[RADIOLIB_LORAWAN_SESSION_REJOIN_PARAM_SETUP], cmd->payload, cmd->len);
+      LoRaWANNode::writeBuffer(this->bufferSession, &this->sessionTracker, RADIOLIB_LORAWAN_SESSION_REJOIN_PARAM_SETUP, cmd->payload, cmd->len);
 
       cmd->len = 0;
       cmd->payload[0] = (1 << 1) | 1;
@@ -2955,10 +3295,19 @@ bool LoRaWANNode::performCAD() {
 }
 
 void LoRaWANNode::processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter) {
-  // figure out how many encryption blocks are there
-  size_t numBlocks = len/RADIOLIB_AES128_BLOCK_SIZE;
-  if(len % RADIOLIB_AES128_BLOCK_SIZE) {
-    numBlocks++;
+  size_t offs = 0;
+
+  #if RADIOLIB_LORAWAN_KEYSTREAM
+  // use the precomputed keystream as far as it goes, it only covers the Application payload of the next uplink
+  if(counter && (this->keystreamLen > 0) && (key == this->appSKey) && (dir == RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK) &&
+     (ctrId == 0x00) && (fCnt == this->keystreamFCnt) && (this->devAddr == this->keystreamDevAddr)) {
+    offs = RADIOLIB_MIN(len, this->keystreamLen);
+    LoRaWANNode::xorBuffers(out, in, this->keystream, offs);
+  }
+  #endif
+
+  if(offs >= len) {
+    return;
   }
 
   // generate the encryption blocks
@@ -2970,28 +3319,48 @@ void LoRaWANNode::processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_
   LoRaWANNode::hton<uint32_t>(&encBlock[RADIOLIB_LORAWAN_BLOCK_DEV_ADDR_POS], this->devAddr);
   LoRaWANNode::hton<uint32_t>(&encBlock[RADIOLIB_LORAWAN_BLOCK_FCNT_POS], fCnt);
 
-  // now encrypt the input
+  // now encrypt the rest of the input, the key only has to be set once for all blocks
   // on downlink frames, this has a decryption effect because server actually "decrypts" the plaintext
-  size_t remLen = len;
-  for(size_t i = 0; i < numBlocks; i++) {
-
+  RadioLibAES128Instance.init(key);
+  for(size_t i = offs; i < len; i += RADIOLIB_AES128_BLOCK_SIZE) {
     if(counter) {
-      encBlock[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_POS] = i + 1;
+      encBlock[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_POS] = i / RADIOLIB_AES128_BLOCK_SIZE + 1;
     }
-
-    // encrypt the buffer
-    RadioLibAES128Instance.init(key);
     RadioLibAES128Instance.encryptECB(encBlock, RADIOLIB_AES128_BLOCK_SIZE, encBuffer);
+    LoRaWANNode::xorBuffers(&out[i], &in[i], encBuffer, RADIOLIB_MIN(len - i, (size_t)RADIOLIB_AES128_BLOCK_SIZE));
+  }
+}
 
-    // now xor the buffer with the input
-    size_t xorLen = remLen;
-    if(xorLen > RADIOLIB_AES128_BLOCK_SIZE) {
-      xorLen = RADIOLIB_AES128_BLOCK_SIZE;
-    }
-    for(uint8_t j = 0; j < xorLen; j++) {
-      out[i*RADIOLIB_AES128_BLOCK_SIZE + j] = in[i*RADIOLIB_AES128_BLOCK_SIZE + j] ^ encBuffer[j];
-    }
-    remLen -= xorLen;
+void LoRaWANNode::prepareKeystream() {
+  #if RADIOLIB_LORAWAN_KEYSTREAM
+  // only as much as the current uplink datarate allows, the rest is generated on the fly if the datarate changes
+  size_t len = this->band->payloadLenMax[this->dataRates[RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK]];
+  len = RADIOLIB_MIN(len, (size_t)RADIOLIB_LORAWAN_KEYSTREAM_LEN);
+
+  // encrypting zeroes yields the keystream itself
+  this->keystreamLen = 0;
+  memset(this->keystream, 0x00, len);
+  this->processAES(this->keystream, len, this->appSKey, this->keystream, this->fCntUp, RADIOLIB_LORAWAN_CHANNEL_DIR_UPLINK, 0x00, true);
+
+  // the keystream is stored in whole blocks, so that it can be continued with block-aligned counter
+  this->keystreamLen = len - (len % RADIOLIB_AES128_BLOCK_SIZE);
+  this->keystreamDevAddr = this->devAddr;
+  this->keystreamFCnt = this->fCntUp;
+  #endif
+}
+
+void LoRaWANNode::xorBuffers(uint8_t* out, const uint8_t* a, const uint8_t* b, size_t len) {
+  // memcpy keeps word access safe on unaligned buffers, compilers turn it into plain loads and stores
+  size_t i = 0;
+  for(; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+    uint32_t wa, wb;
+    memcpy(&wa, &a[i], sizeof(uint32_t));
+    memcpy(&wb, &b[i], sizeof(uint32_t));
+    wa ^= wb;
+    memcpy(&out[i], &wa, sizeof(uint32_t));
+  }
+  for(; i < len; i++) {
+    out[i] = a[i] ^ b[i];
   }
 }
 
@@ -3007,6 +3376,111 @@ uint16_t LoRaWANNode::checkSum16(uint8_t *key, uint16_t keyLen) {
   return(checkSum);
 }
 
+// add a span of changed bytes, merging it with any span it overlaps or touches
+static void addBufferSpan(LoRaWANBufferTracker_t* tracker, uint16_t offset, uint16_t len) {
+  uint16_t start = offset;
+  uint16_t end = offset + len;
+  uint8_t i = 0;
+  while(i < tracker->numSpans) {
+    uint16_t spanStart = tracker->spans[i].offset;
+    uint16_t spanEnd = spanStart + tracker->spans[i].len;
+    if((start <= spanEnd) && (end >= spanStart)) {
+      start = RADIOLIB_MIN(start, spanStart);
+      end = RADIOLIB_MAX(end, spanEnd);
+      tracker->spans[i] = tracker->spans[--tracker->numSpans];
+    } else {
+      i++;
+    }
+  }
+
+  // out of spans, so merge with the closest one - this may now overlap others, so add the result again
+  if(tracker->numSpans == RADIOLIB_LORAWAN_BUFFER_SPANS_MAX) {
+    uint8_t closest = 0;
+    uint16_t closestGap = 0xFFFF;
+    for(i = 0; i < tracker->numSpans; i++) {
+      uint16_t spanStart = tracker->spans[i].offset;
+      uint16_t spanEnd = spanStart + tracker->spans[i].len;
+      uint16_t gap = (spanStart > end) ? (spanStart - end) : (start - spanEnd);
+      if(gap < closestGap) {
+        closest = i;
+        closestGap = gap;
+      }
+    }
+    start = RADIOLIB_MIN(start, tracker->spans[closest].offset);
+    end = RADIOLIB_MAX(end, tracker->spans[closest].offset + tracker->spans[closest].len);
+    tracker->spans[closest] = tracker->spans[--tracker->numSpans];
+    addBufferSpan(tracker, start, end - start);
+    return;
+  }
+
+  tracker->spans[tracker->numSpans].offset = start;
+  tracker->spans[tracker->numSpans].len = end - start;
+  tracker->numSpans++;
+}
+
+bool LoRaWANNode::writeBuffer(uint8_t* buff, LoRaWANBufferTracker_t* tracker, uint16_t offset, const uint8_t* data, uint16_t len) {
+  uint16_t first = len;
+  uint16_t last = 0;
+  for(uint16_t i = 0; i < len; i++) {
+    uint8_t val = data ? data[i] : 0;
+    uint8_t diff = buff[offset + i] ^ val;
+    if(!diff) {
+      continue;
+    }
+
+    // checkSum16 XORs big-endian 16-bit words, so a changed byte changes either the high or the low byte of the checksum
+    tracker->signature ^= ((offset + i) % 2) ? (uint16_t)diff : ((uint16_t)diff << 8);
+    buff[offset + i] = val;
+    if(first == len) {
+      first = i;
+    }
+    last = i;
+  }
+
+  if(first == len) {
+    return(false);
+  }
+  addBufferSpan(tracker, offset + first, last - first + 1);
+  return(true);
+}
+
+template<typename T>
+bool LoRaWANNode::writeBufferValue(uint8_t* buff, LoRaWANBufferTracker_t* tracker, uint16_t offset, T val, size_t size) {
+  uint8_t bytes[sizeof(T)];
+  LoRaWANNode::hton<T>(bytes, val, size);
+  return(LoRaWANNode::writeBuffer(buff, tracker, offset, bytes, size ? size : sizeof(T)));
+}
+
+void LoRaWANNode::loadBuffer(uint8_t* buff, LoRaWANBufferTracker_t* tracker, const uint8_t* data, uint16_t size) {
+  tracker->numSpans = 0;
+  if(!data) {
+    memset(buff, 0, size);
+    tracker->signature = 0;
+    addBufferSpan(tracker, 0, size);
+    return;
+  }
+
+  // the buffer was already checked by checkBufferCommon, so its signature matches its contents
+  memcpy(buff, data, size);
+  tracker->signature = LoRaWANNode::ntoh<uint16_t>(&buff[size - 2]);
+}
+
+void LoRaWANNode::signBuffer(uint8_t* buff, LoRaWANBufferTracker_t* tracker, uint16_t size) {
+  // the signature is not part of the checksum, so it is written directly
+  if(LoRaWANNode::ntoh<uint16_t>(&buff[size - 2]) == tracker->signature) {
+    return;
+  }
+  LoRaWANNode::hton<uint16_t>(&buff[size - 2], tracker->signature);
+  addBufferSpan(tracker, size - 2, 2);
+}
+
+uint8_t LoRaWANNode::takeBufferChanges(LoRaWANBufferTracker_t* tracker, LoRaWANBufferSpan_t* spans) {
+  uint8_t num = tracker->numSpans;
+  memcpy(spans, tracker->spans, num * sizeof(LoRaWANBufferSpan_t));
+  tracker->numSpans = 0;
+  return(num);
+}
+
 template<typename T>
 T LoRaWANNode::ntoh(uint8_t* buff, size_t size) {
   uint8_t* buffPtr = buff;
@@ -4,6 +4,7 @@
 #include "../../TypeDef.h"
 #include "../PhysicalLayer/PhysicalLayer.h"
 #include "../../utils/Cryptography.h"
+#include "../../utils/CRC.h"
 
 // activation mode
 #define RADIOLIB_LORAWAN_MODE_OTAA                              (0x07AA)
@@ -91,6 +92,7 @@
 // recommended default settings
 #define RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS                     (1000)
 #define RADIOLIB_LORAWAN_RECEIVE_DELAY_2_MS                     ((RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS) + 1000)
+#define RADIOLIB_LORAWAN_RX_WINDOW_GUARD_MS                     (10)
 #define RADIOLIB_LORAWAN_RX1_DR_OFFSET                          (0)
 #define RADIOLIB_LORAWAN_JOIN_ACCEPT_DELAY_1_MS                 (5000)
 #define RADIOLIB_LORAWAN_JOIN_ACCEPT_DELAY_2_MS                 (6000)
@@ -148,6 +150,16 @@
 #define RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(FOPTS)               (RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS + 9 + (FOPTS))
 #define RADIOLIB_LORAWAN_FRAME_LEN(PAYLOAD, FOPTS)              (16 + 13 + (PAYLOAD) + (FOPTS))
 
+// maximum application payload length over all bands and data rates
+#define RADIOLIB_LORAWAN_MAX_PAYLOAD_LEN                        (250)
+
+// session frame buffer, uplink header is shifted by the FOpts length so that the payload position is fixed
+#define RADIOLIB_LORAWAN_FRAME_BUFF_LEN                         (RADIOLIB_LORAWAN_FRAME_LEN(RADIOLIB_LORAWAN_MAX_PAYLOAD_LEN, RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN))
+#define RADIOLIB_LORAWAN_FRAME_BUFF_PAYLOAD_POS                 (RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN))
+
+// precomputed keystream, long enough for the maximum payload
+#define RADIOLIB_LORAWAN_KEYSTREAM_LEN                          (((RADIOLIB_LORAWAN_MAX_PAYLOAD_LEN + RADIOLIB_AES128_BLOCK_SIZE - 1) / RADIOLIB_AES128_BLOCK_SIZE) * RADIOLIB_AES128_BLOCK_SIZE)
+
 // payload encryption/MIC blocks common layout
 #define RADIOLIB_LORAWAN_BLOCK_MAGIC_POS                        (0)
 #define RADIOLIB_LORAWAN_BLOCK_CONF_FCNT_POS                    (1)
@@ -172,6 +184,13 @@
 // unused frame counter value
 #define RADIOLIB_LORAWAN_FCNT_NONE                              (0xFFFFFFFF)
 
+// states of the non-blocking Class A sequence
+#define RADIOLIB_LORAWAN_CLASS_A_IDLE                           (0)
+#define RADIOLIB_LORAWAN_CLASS_A_TX                             (1)
+#define RADIOLIB_LORAWAN_CLASS_A_RX_DELAY                       (2)
+#define RADIOLIB_LORAWAN_CLASS_A_RX_WINDOW                      (3)
+#define RADIOLIB_LORAWAN_CLASS_A_RX_PENDING                     (4)
+
 // MAC commands
 #define RADIOLIB_LORAWAN_NUM_MAC_COMMANDS                       (16)
 
@@ -276,6 +295,19 @@ struct LoRaWANMacCommandQueue_t {
 
 #define RADIOLIB_LORAWAN_NONCES_VERSION_VAL (0x0001)
 
+// version of the MAC state snapshot in the Session buffer, to be incremented whenever its layout changes
+#define RADIOLIB_LORAWAN_SESSION_STATE_VERSION_VAL (0x02)
+
+// layout of the whole Session buffer, to be incremented whenever any field is moved or its encoding changes
+// Session buffers saved with a different layout are rejected
+#define RADIOLIB_LORAWAN_SESSION_LAYOUT_VAL (0x0001)
+
+// size of a single channel in the MAC state snapshot: enabled, index, frequency (4 bytes in 100 Hz steps), min and max datarate
+#define RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN (8)
+
+// maximum number of changed spans reported for each persistent buffer, closest spans are merged once it is reached
+#define RADIOLIB_LORAWAN_BUFFER_SPANS_MAX (4)
+
 enum LoRaWANSchemeBase_t {
   RADIOLIB_LORAWAN_NONCES_START       = 0x00,
   RADIOLIB_LORAWAN_NONCES_VERSION     = RADIOLIB_LORAWAN_NONCES_START,                        // 2 bytes
@@ -322,7 +354,20 @@ enum LoRaWANSchemeSession_t {
   RADIOLIB_LORAWAN_SESSION_ADR_FCNT           = RADIOLIB_LORAWAN_SESSION_N_FCNT_DOWN + sizeof(uint32_t),      // 4 bytes
   RADIOLIB_LORAWAN_SESSION_LINK_ADR           = RADIOLIB_LORAWAN_SESSION_ADR_FCNT + sizeof(uint32_t),         // 4 bytes
   RADIOLIB_LORAWAN_SESSION_FCNT_UP            = RADIOLIB_LORAWAN_SESSION_LINK_ADR + MacTable[RADIOLIB_LORAWAN_MAC_LINK_ADR].lenDn,  // 4 bytes
-  RADIOLIB_LORAWAN_SESSION_SIGNATURE          = RADIOLIB_LORAWAN_SESSION_FCNT_UP + sizeof(uint32_t),          // 2 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_VERSION      = RADIOLIB_LORAWAN_SESSION_FCNT_UP + sizeof(uint32_t),          // 1 byte
+  RADIOLIB_LORAWAN_SESSION_STATE_CHANNELS     = RADIOLIB_LORAWAN_SESSION_STATE_VERSION + sizeof(uint8_t),     // 2*16*8 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_RX2          = RADIOLIB_LORAWAN_SESSION_STATE_CHANNELS + 2*RADIOLIB_LORAWAN_NUM_AVAILABLE_CHANNELS*RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN,  // 8 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES   = RADIOLIB_LORAWAN_SESSION_STATE_RX2 + RADIOLIB_LORAWAN_SESSION_STATE_CHANNEL_LEN,  // 2 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_TX_POWER     = RADIOLIB_LORAWAN_SESSION_STATE_DATA_RATES + 2*sizeof(uint8_t),  // 2 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_NB_TRANS     = RADIOLIB_LORAWAN_SESSION_STATE_TX_POWER + 2*sizeof(uint8_t),  // 1 byte
+  RADIOLIB_LORAWAN_SESSION_STATE_RX1_DR_OFFSET = RADIOLIB_LORAWAN_SESSION_STATE_NB_TRANS + sizeof(uint8_t),   // 1 byte
+  RADIOLIB_LORAWAN_SESSION_STATE_ADR_PARAMS   = RADIOLIB_LORAWAN_SESSION_STATE_RX1_DR_OFFSET + sizeof(uint8_t), // 2 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_DUTY_CYCLE   = RADIOLIB_LORAWAN_SESSION_STATE_ADR_PARAMS + 2*sizeof(uint8_t),  // 4 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME   = RADIOLIB_LORAWAN_SESSION_STATE_DUTY_CYCLE + sizeof(uint32_t),   // 1+2*2 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_RX_DELAYS    = RADIOLIB_LORAWAN_SESSION_STATE_DWELL_TIME + sizeof(uint8_t) + 2*sizeof(uint16_t), // 2*4 bytes
+  RADIOLIB_LORAWAN_SESSION_STATE_CRC          = RADIOLIB_LORAWAN_SESSION_STATE_RX_DELAYS + 2*sizeof(uint32_t),  // 2 bytes
+  RADIOLIB_LORAWAN_SESSION_LAYOUT             = RADIOLIB_LORAWAN_SESSION_STATE_CRC + sizeof(uint16_t),        // 2 bytes
+  RADIOLIB_LORAWAN_SESSION_SIGNATURE          = RADIOLIB_LORAWAN_SESSION_LAYOUT + sizeof(uint16_t),           // 2 bytes
   RADIOLIB_LORAWAN_SESSION_BUF_SIZE           = RADIOLIB_LORAWAN_SESSION_SIGNATURE + sizeof(uint16_t)         // Session buffer size
 };
 
@@ -467,6 +512,33 @@ enum LoRaWANBandNum_t {
 // array of currently supported bands
 extern const LoRaWANBand_t* LoRaWANBands[];
 
+/*!
+  \struct LoRaWANBufferSpan_t
+  \brief Range of bytes in the Nonces or Session buffer that changed since it was last saved.
+*/
+struct LoRaWANBufferSpan_t {
+  /*! \brief Offset of the first changed byte */
+  uint16_t offset;
+
+  /*! \brief Number of changed bytes */
+  uint16_t len;
+};
+
+/*!
+  \struct LoRaWANBufferTracker_t
+  \brief Running signature of a persistent buffer and the spans that changed since it was last saved.
+*/
+struct LoRaWANBufferTracker_t {
+  /*! \brief Signature of the current buffer contents, updated with each write */
+  uint16_t signature;
+
+  /*! \brief Number of valid entries in spans */
+  uint8_t numSpans;
+
+  /*! \brief Changed spans, in no particular order */
+  LoRaWANBufferSpan_t spans[RADIOLIB_LORAWAN_BUFFER_SPANS_MAX];
+};
+
 /*!
   \struct LoRaWANJoinEvent_t
   \brief Structure to save extra information about activation event.
@@ -546,6 +618,15 @@ class LoRaWANNode {
     */
     int16_t setBufferNonces(uint8_t* persistentBuffer);
 
+    /*!
+      \brief Get the parts of the Nonces buffer that changed since the last call, so that only those
+      have to be written to persistent storage. Must be called after getBufferNonces, which updates the signature.
+      The changes are cleared afterwards, as the caller is expected to write them right away.
+      \param spans Array of at least RADIOLIB_LORAWAN_BUFFER_SPANS_MAX entries, filled with the changed spans
+      \returns Number of changed spans, 0 if nothing has to be written
+    */
+    uint8_t getBufferNoncesChanges(LoRaWANBufferSpan_t* spans);
+
     /*!
       \brief Returns the pointer to the internal buffer that holds the LW session parameters
       \returns Pointer to uint8_t array of size RADIOLIB_LORAWAN_SESSION_BUF_SIZE
@@ -553,12 +634,25 @@ class LoRaWANNode {
     uint8_t* getBufferSession();
 
     /*!
-      \brief Fill the internal buffer that holds the LW session parameters with a supplied buffer
+      \brief Fill the internal buffer that holds the LW session parameters with a supplied buffer.
+      The MAC state (channels, datarates, Rx2, Tx power etc.) is copied directly from the snapshot
+      saved by getBufferSession. Only if the snapshot is missing, of a different version or fails its CRC,
+      the state is rebuilt by replaying the saved MAC commands instead.
       \param persistentBuffer Buffer that should match the internal format (previously extracted using getBufferSession)
       \returns \ref status_codes
     */
     int16_t setBufferSession(uint8_t* persistentBuffer);
 
+    /*!
+      \brief Get the parts of the Session buffer that changed since the last call, so that only those
+      have to be written to persistent storage. Must be called after getBufferSession, which updates the buffer.
+      After a typical uplink, only the frame counters and the signature change.
+      The changes are cleared afterwards, as the caller is expected to write them right away.
+      \param spans Array of at least RADIOLIB_LORAWAN_BUFFER_SPANS_MAX entries, filled with the changed spans
+      \returns Number of changed spans, 0 if nothing has to be written
+    */
+    uint8_t getBufferSessionChanges(LoRaWANBufferSpan_t* spans);
+
     /*!
       \brief Set the device credentials and activation configuration
       \param joinEUI 8-byte application identifier.
@@ -651,6 +745,15 @@ class LoRaWANNode {
     */
     int16_t uplink(uint8_t* data, size_t len, uint8_t fPort, bool isConfirmed = false, LoRaWANEvent_t* event = NULL);
 
+    /*!
+      \brief Get the payload section of the frame buffer used for all uplinks and downlinks.
+      Payload written here and passed to uplink, startUplink or sendReceive is encrypted in place
+      instead of being copied. The buffer is overwritten by every uplink and downlink,
+      so it has to be filled again before each uplink, and it must not be used to receive downlink payload.
+      \returns Pointer to the payload buffer, RADIOLIB_LORAWAN_MAX_PAYLOAD_LEN bytes long.
+    */
+    uint8_t* getUplinkBuffer();
+
     #if defined(RADIOLIB_BUILD_ARDUINO)
     /*!
       \brief Wait for downlink from the server in either RX1 or RX2 window.
@@ -664,7 +767,7 @@ class LoRaWANNode {
 
     /*!
       \brief Wait for downlink from the server in either RX1 or RX2 window.
-      \param data Buffer to save received data into.
+      \param data Buffer to save received data into, or NULL to discard the application payload.
       \param len Pointer to variable that will be used to save the number of received bytes.
       \param event Pointer to a structure to store extra information about the event
       (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
@@ -741,6 +844,51 @@ class LoRaWANNode {
     */
     int16_t sendReceive(uint8_t* dataUp, size_t lenUp, uint8_t fPort = 1, bool isConfirmed = false, LoRaWANEvent_t* eventUp = NULL, LoRaWANEvent_t* eventDown = NULL);
 
+    /*!
+      \brief Start sending a message to the server without waiting for the transmission or the Rx windows.
+      The uplink is transmitted in the background, tick must then be called periodically
+      to open the Rx1 and Rx2 windows on time and to collect the downlink, if any.
+      \param data Data to send.
+      \param len Length of the data.
+      \param fPort Port number to send the message to.
+      \param isConfirmed Whether to send a confirmed uplink or not.
+      \param event Pointer to a structure to store extra information about the uplink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \returns \ref status_codes
+    */
+    int16_t startUplink(uint8_t* data, size_t len, uint8_t fPort, bool isConfirmed = false, LoRaWANEvent_t* event = NULL);
+
+    /*!
+      \brief Advance the uplink sequence started by startUplink. Never blocks, so it can be called
+      from the main loop of a single thread handling several nodes. The timing of the Rx windows
+      is tracked from the end of the uplink, but tick should be called at least every few milliseconds
+      around the time returned by timeUntilTick to open them on time.
+      \param dataDown Buffer to save received data into.
+      \param lenDown Pointer to variable that will be used to save the number of received bytes.
+      \param eventDown Pointer to a structure to store extra information about the downlink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \returns RADIOLIB_LORAWAN_BUSY while the sequence is in progress, RADIOLIB_ERR_NONE when a downlink was received,
+      RADIOLIB_LORAWAN_NO_DOWNLINK when both Rx windows passed without one, RADIOLIB_ERR_NO_RX_WINDOW if no sequence
+      was started, or any other \ref status_codes on failure.
+    */
+    int16_t tick(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventDown = NULL);
+
+    /*!
+      \brief Advance the uplink sequence started by startUplink, discarding any downlink payload.
+      \param eventDown Pointer to a structure to store extra information about the downlink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \returns \ref status_codes, see the other overload of this method.
+    */
+    int16_t tick(LoRaWANEvent_t* eventDown = NULL);
+
+    /*!
+      \brief Get the time until tick has something to do. Completion of the transmission or reception
+      is also signalled by the radio interrupt, so it may be useful to call tick earlier from the interrupt.
+      \returns Time in milliseconds until the next timed step of the uplink sequence,
+      0 if tick should be called right away or no sequence is in progress.
+    */
+    RadioLibTime_t timeUntilTick();
+
     /*!
       \brief Set device status.
       \param battLevel Battery level to set. 0 for external power source, 1 for lowest battery,
@@ -875,6 +1023,17 @@ class LoRaWANNode {
 
     static int16_t checkBufferCommon(uint8_t *buffer, uint16_t size);
 
+    // save the MAC state snapshot into the Session buffer, or restore it from there
+    void saveSessionState();
+    int16_t restoreSessionState();
+
+    // convert a single channel of the MAC state snapshot
+    static void saveChannel(uint8_t* buff, const LoRaWANChannel_t* chan);
+    static bool restoreChannel(uint8_t* buff, LoRaWANChannel_t* chan);
+
+    // rebuild the MAC state by replaying the MAC commands saved in the Session buffer
+    int16_t replaySessionState();
+
     void activateCommon(uint8_t initialDr);
 
     // a buffer that holds all LW base parameters that should persist at all times!
@@ -883,6 +1042,22 @@ class LoRaWANNode {
     // a buffer that holds all LW session parameters that preferably persist, but can be afforded to get lost
     uint8_t bufferSession[RADIOLIB_LORAWAN_SESSION_BUF_SIZE] = { 0 };
 
+    // signatures of both buffers and the spans that changed since they were last saved
+    // all writes to the buffers must go through writeBuffer or writeBufferValue to keep these up to date
+    LoRaWANBufferTracker_t noncesTracker = { 0, 0, {} };
+    LoRaWANBufferTracker_t sessionTracker = { 0, 0, {} };
+
+    // a buffer in which uplink frames are assembled and downlink frames are received, encrypted and decrypted in place
+    uint8_t frameBuff[RADIOLIB_LORAWAN_FRAME_BUFF_LEN] = { 0 };
+
+    #if RADIOLIB_LORAWAN_KEYSTREAM
+    // keystream for the Application payload of the next uplink, generated while waiting for the Rx windows
+    uint8_t keystream[RADIOLIB_LORAWAN_KEYSTREAM_LEN] = { 0 };
+    size_t keystreamLen = 0;
+    uint32_t keystreamDevAddr = 0;
+    uint32_t keystreamFCnt = 0;
+    #endif
+
     LoRaWANMacCommandQueue_t commandsUp = { 
       .numCommands = 0,
       .len = 0,
@@ -898,6 +1073,9 @@ class LoRaWANNode {
     uint8_t lwClass = RADIOLIB_LORAWAN_CLASS_A;
     bool isActive = false;
 
+    // a session was restored by setBufferSession, but not activated yet
+    bool isRestored = false;
+
     uint64_t joinEUI = 0;
     uint64_t devEUI = 0;
     uint8_t nwkKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
@@ -989,6 +1167,12 @@ class LoRaWANNode {
     // delays between the uplink and RX1/2 windows
     RadioLibTime_t rxDelays[2] = { RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS, RADIOLIB_LORAWAN_RECEIVE_DELAY_2_MS };
 
+    // state of the non-blocking Class A sequence, the Rx window that is next or in progress
+    // and the timestamp at which the current state times out
+    uint8_t classAState = RADIOLIB_LORAWAN_CLASS_A_IDLE;
+    uint8_t classAWindow = 0;
+    RadioLibTime_t classADeadline = 0;
+
     // device status - battery level
     uint8_t battLevel = 0xFF;
 
@@ -1001,16 +1185,36 @@ class LoRaWANNode {
     // this will reset the device credentials, so the device starts completely new
     void clearNonces();
 
+    // build and send an uplink, either waiting for the transmission to finish or just starting it
+    int16_t uplinkCommon(uint8_t* data, size_t len, uint8_t fPort, bool isConfirmed, LoRaWANEvent_t* event, bool wait);
+
     // wait for, open and listen during Rx1 and Rx2 windows; only performs listening
     int16_t downlinkCommon();
 
+    // read, check and decrypt the downlink that was just received
+    int16_t processDownlink(uint8_t* data, size_t* len, LoRaWANEvent_t* event);
+
+    // open the next Rx window of the non-blocking sequence
+    int16_t classAOpenWindow();
+
+    // end the non-blocking sequence and return the radio to its uplink configuration
+    int16_t classAFinish(int16_t result);
+
     // method to generate message integrity code
     uint32_t generateMIC(uint8_t* msg, size_t len, uint8_t* key);
 
+    // method to generate message integrity code over a header (e.g. MIC block) followed by the message
+    // the two are streamed into the CMAC calculation, so they do not have to be in a single buffer
+    uint32_t generateMIC(const uint8_t* hdr, size_t hdrLen, const uint8_t* msg, size_t len, uint8_t* key);
+
     // method to verify message integrity code
     // it assumes that the MIC is the last 4 bytes of the message
     bool verifyMIC(uint8_t* msg, size_t len, uint8_t* key);
 
+    // method to verify message integrity code of a header followed by the message
+    // it assumes that the MIC is the last 4 bytes of the message
+    bool verifyMIC(const uint8_t* hdr, size_t hdrLen, uint8_t* msg, size_t len, uint8_t* key);
+
     // configure the common physical layer properties (preamble, sync word etc.)
     // channels must be configured separately by setupChannelsDyn()!
     int16_t setPhyProperties(uint8_t dir);
@@ -1072,9 +1276,33 @@ class LoRaWANNode {
     // function to encrypt and decrypt payloads
     void processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter);
 
+    // generate keystream for the next uplink, called when there is time to spare
+    void prepareKeystream();
+
+    // XOR two buffers word by word, the output may be the same as either of the inputs
+    static void xorBuffers(uint8_t* out, const uint8_t* a, const uint8_t* b, size_t len);
+
     // 16-bit checksum method that takes a uint8_t array of even length and calculates the checksum
     static uint16_t checkSum16(uint8_t *key, uint16_t keyLen);
 
+    // write to a persistent buffer, updating its running checksum and changed spans, data set to NULL writes zeros
+    // returns whether any byte actually changed
+    static bool writeBuffer(uint8_t* buff, LoRaWANBufferTracker_t* tracker, uint16_t offset, const uint8_t* data, uint16_t len);
+
+    // same as writeBuffer, for values in network byte order
+    template<typename T>
+    static bool writeBufferValue(uint8_t* buff, LoRaWANBufferTracker_t* tracker, uint16_t offset, T val, size_t size = 0);
+
+    // replace the contents of a persistent buffer: by zeros when data is NULL (everything changed),
+    // or by a previously saved buffer (nothing changed)
+    static void loadBuffer(uint8_t* buff, LoRaWANBufferTracker_t* tracker, const uint8_t* data, uint16_t size);
+
+    // store the running checksum as the signature in the last two bytes of a persistent buffer
+    static void signBuffer(uint8_t* buff, LoRaWANBufferTracker_t* tracker, uint16_t size);
+
+    // copy the changed spans out and clear them
+    static uint8_t takeBufferChanges(LoRaWANBufferTracker_t* tracker, LoRaWANBufferSpan_t* spans);
+
     // network-to-host conversion method - takes data from network packet and converts it to the host endians
     template<typename T>
     static T ntoh(uint8_t* buff, size_t size = 0);
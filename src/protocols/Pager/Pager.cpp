@@ -23,7 +23,7 @@ static void PagerClientReadBit(void) {
 }
 #endif
 
-PagerClient::PagerClient(PhysicalLayer* phy) {
+PagerClient::PagerClient(PhysicalLayer* phy) : scheduler(phy) {
   phyLayer = phy;
   #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
   readBitInstance = phyLayer;
@@ -233,7 +233,9 @@ int16_t PagerClient::transmit(uint8_t* data, size_t len, uint32_t addr, uint8_t
     delete[] msg;
   #endif
 
-  // turn transmitter off
+  // wait for the last bits to go out, then turn transmitter off
+  scheduler.flush();
+  scheduler.stop();
   phyLayer->standby();
 
   return(RADIOLIB_ERR_NONE);
@@ -288,6 +290,10 @@ int16_t PagerClient::startReceiveCommon() {
     phyLayer->setDirectSyncWord(RADIOLIB_PAGER_FRAME_SYNC_CODE_WORD, 32);
   }
 
+  // reset error correction statistics
+  this->correctedWords = 0;
+  this->uncorrectableWords = 0;
+
   phyLayer->setDirectAction(PagerClientReadBit);
   phyLayer->receiveDirect();
 
@@ -298,6 +304,14 @@ size_t PagerClient::available() {
   return(phyLayer->available() + sizeof(uint32_t))/(sizeof(uint32_t) * (RADIOLIB_PAGER_BATCH_LEN + 1));
 }
 
+uint32_t PagerClient::getCorrectedWords() {
+  return(this->correctedWords);
+}
+
+uint32_t PagerClient::getUncorrectableWords() {
+  return(this->uncorrectableWords);
+}
+
 #if defined(RADIOLIB_BUILD_ARDUINO)
 int16_t PagerClient::readData(String& str, size_t len, uint32_t* addr) {
   int16_t state = RADIOLIB_ERR_NONE;
@@ -495,6 +509,9 @@ bool PagerClient::addressMatched(uint32_t addr) {
 }
 
 void PagerClient::write(uint32_t* data, size_t len) {
+  // the first bit starts the transmission, the rest only shift the frequency
+  scheduler.stop();
+
   // write code words from buffer
   for(size_t i = 0; i < len; i++) {
     PagerClient::write(data[i]);
@@ -503,10 +520,8 @@ void PagerClient::write(uint32_t* data, size_t len) {
 
 void PagerClient::write(uint32_t codeWord) {
   // write single code word
-  Module* mod = phyLayer->getMod();
   for(int8_t i = 31; i >= 0; i--) {
     uint32_t mask = (uint32_t)0x01 << i;
-    RadioLibTime_t start = mod->hal->micros();
 
     // figure out the shift direction - start by assuming the bit is 0
     int16_t change = shiftFreq;
@@ -521,26 +536,19 @@ void PagerClient::write(uint32_t codeWord) {
       change = -change;
     }
 
-    // now transmit the shifted frequency
-    phyLayer->transmitDirect(baseFreqRaw + change);
-
-    // this is pretty silly, while(mod->hal->micros() ... ) would be enough
-    // but for some reason, MegaCore throws a linker error on it
-    // "relocation truncated to fit: R_AVR_7_PCREL against `no symbol'"
-    RadioLibTime_t now = mod->hal->micros();
-    while(now - start < bitDuration) {
-      now = mod->hal->micros();
-    }
+    // now queue the shifted frequency
+    scheduler.push(baseFreqRaw + change, bitDuration);
   }
 }
 
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
 uint32_t PagerClient::read() {
+  // keep synchronization, so that reception continues across batches without waiting for the next sync word
   uint32_t codeWord = 0;
-  codeWord |= (uint32_t)phyLayer->read() << 24;
-  codeWord |= (uint32_t)phyLayer->read() << 16;
-  codeWord |= (uint32_t)phyLayer->read() << 8;
-  codeWord |= (uint32_t)phyLayer->read();
+  codeWord |= (uint32_t)phyLayer->read(false) << 24;
+  codeWord |= (uint32_t)phyLayer->read(false) << 16;
+  codeWord |= (uint32_t)phyLayer->read(false) << 8;
+  codeWord |= (uint32_t)phyLayer->read(false);
 
   // check if we need to invert bits
   // the logic here is inverted, because modules like SX1278
@@ -550,7 +558,18 @@ uint32_t PagerClient::read() {
   }
 
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%lX", (long unsigned int)codeWord);
-  // TODO BCH error correction here
+
+  // correct bit errors, uncorrectable code words are passed on unchanged
+  int8_t numErrors = RadioLibBCHInstance.decode(&codeWord);
+  if(numErrors > 0) {
+    this->correctedWords++;
+  } else if(numErrors < 0) {
+    // most likely end of transmission or lost bit alignment, wait for the next sync word
+    // bytes already received after this word would no longer be aligned to code words, so they are discarded
+    this->uncorrectableWords++;
+    phyLayer->dropSync(true);
+  }
+
   return(codeWord);
 }
 #endif
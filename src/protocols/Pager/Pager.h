@@ -4,6 +4,7 @@
 #include "../../TypeDef.h"
 #include "../PhysicalLayer/PhysicalLayer.h"
 #include "../../utils/FEC.h"
+#include "../../utils/SymbolScheduler.h"
 
 // frequency shift in Hz
 #define RADIOLIB_PAGER_FREQ_SHIFT_HZ                            (4500)
@@ -146,6 +147,19 @@ class PagerClient {
     */
     size_t available();
 
+    /*!
+      \brief Get the number of received code words in which bit errors were corrected since reception was started.
+      \returns Number of corrected code words.
+    */
+    uint32_t getCorrectedWords();
+
+    /*!
+      \brief Get the number of received code words that had too many bit errors to be corrected
+      since reception was started.
+      \returns Number of uncorrectable code words.
+    */
+    uint32_t getUncorrectableWords();
+
     #if defined(RADIOLIB_BUILD_ARDUINO)
     /*!
       \brief Reads data that was received after calling startReceive method.
@@ -189,6 +203,10 @@ class PagerClient {
     uint32_t *filterMasks = nullptr;
     size_t filterNumAddresses = 0;
     bool inv = false;
+    uint32_t correctedWords = 0;
+    uint32_t uncorrectableWords = 0;
+
+    RadioLibSymbolScheduler scheduler;
 
     void write(uint32_t* data, size_t len);
     void write(uint32_t codeWord);
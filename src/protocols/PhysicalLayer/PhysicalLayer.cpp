@@ -6,7 +6,8 @@ PhysicalLayer::PhysicalLayer(float step, size_t maxLen) {
   this->maxPacketLength = maxLen;
   #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
   this->bufferBitPos = 0;
-  this->bufferWritePos = 0;
+  this->bufferHead = 0;
+  this->bufferTail = 0;
   #endif
 }
 
@@ -217,6 +218,10 @@ int16_t PhysicalLayer::transmitDirect(uint32_t frf) {
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
 
+int16_t PhysicalLayer::setDirectFrequency(uint32_t frf) {
+  return(transmitDirect(frf));
+}
+
 int16_t PhysicalLayer::receiveDirect() {
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
@@ -379,22 +384,42 @@ int16_t PhysicalLayer::startDirect() {
 
 #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
 int16_t PhysicalLayer::available() {
-  return(this->bufferWritePos);
+  RadioLibDirectIndex_t head = RADIOLIB_ATOMIC_LOAD(this->bufferHead);
+  RadioLibDirectIndex_t tail = RADIOLIB_ATOMIC_LOAD(this->bufferTail);
+  return(((size_t)head + RADIOLIB_STATIC_ARRAY_SIZE - tail) % RADIOLIB_STATIC_ARRAY_SIZE);
+}
+
+uint32_t PhysicalLayer::getDirectOverflows() {
+  return(this->bufferOverflows);
 }
 
-void PhysicalLayer::dropSync() {
+void PhysicalLayer::dropSync(bool discard) {
   if(this->directSyncWordLen > 0) {
     this->gotSync = false;
     this->syncBuffer = 0;
   }
+
+  // only the reader moves the tail, so the bytes can be released without stopping the writer
+  if(discard) {
+    RADIOLIB_ATOMIC_STORE(this->bufferTail, RADIOLIB_ATOMIC_LOAD(this->bufferHead));
+  }
 }
 
 uint8_t PhysicalLayer::read(bool drop) {
   if(drop) {
     dropSync();
   }
-  this->bufferWritePos--;
-  return(this->buffer[this->bufferReadPos++]);
+
+  // nothing to read
+  RadioLibDirectIndex_t tail = RADIOLIB_ATOMIC_LOAD(this->bufferTail);
+  if(RADIOLIB_ATOMIC_LOAD(this->bufferHead) == tail) {
+    return(0);
+  }
+
+  // the byte must be read before the slot is released to the writer
+  uint8_t b = this->buffer[tail];
+  RADIOLIB_ATOMIC_STORE(this->bufferTail, (RadioLibDirectIndex_t)(((size_t)tail + 1) % RADIOLIB_STATIC_ARRAY_SIZE));
+  return(b);
 }
 
 int16_t PhysicalLayer::setDirectSyncWord(uint32_t syncWord, uint8_t len) {
@@ -422,28 +447,33 @@ void PhysicalLayer::updateDirectBuffer(uint8_t bit) {
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("S\t%lu", (long unsigned int)this->syncBuffer);
 
     if((this->syncBuffer & this->directSyncWordMask) == this->directSyncWord) {
+      // start a new byte, data that was not read yet is kept
       this->gotSync = true;
-      this->bufferWritePos = 0;
-      this->bufferReadPos = 0;
+      this->bufferShiftReg = 0;
       this->bufferBitPos = 0;
     }
 
   } else {
-    // save the bit
-    if(bit) {
-      this->buffer[this->bufferWritePos] |= 0x01 << this->bufferBitPos;
-    } else {
-      this->buffer[this->bufferWritePos] &= ~(0x01 << this->bufferBitPos);
-    }
+    // save the bit, first received bit ends up as the most significant one
+    this->bufferShiftReg = (this->bufferShiftReg << 1) | (bit & 0x01);
     this->bufferBitPos++;
 
     // check complete byte
     if(this->bufferBitPos == 8) {
-      this->buffer[this->bufferWritePos] = Module::reflect(this->buffer[this->bufferWritePos], 8);
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%X", this->buffer[this->bufferWritePos]);
-
-      this->bufferWritePos++;
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%X", this->bufferShiftReg);
       this->bufferBitPos = 0;
+
+      // drop the byte if the reader did not keep up
+      RadioLibDirectIndex_t head = RADIOLIB_ATOMIC_LOAD(this->bufferHead);
+      RadioLibDirectIndex_t next = ((size_t)head + 1) % RADIOLIB_STATIC_ARRAY_SIZE;
+      if(next == RADIOLIB_ATOMIC_LOAD(this->bufferTail)) {
+        this->bufferOverflows = this->bufferOverflows + 1;
+        return;
+      }
+
+      // the byte must be written before it is published to the reader
+      this->buffer[head] = this->bufferShiftReg;
+      RADIOLIB_ATOMIC_STORE(this->bufferHead, next);
     }
   }
 }
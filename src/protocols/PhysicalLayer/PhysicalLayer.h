@@ -43,6 +43,15 @@ union DataRate_t {
   FSKRate_t fsk;
 };
 
+#if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
+// direct mode buffer index, kept to a single byte where possible so that 8-bit MCUs can access it atomically
+#if RADIOLIB_STATIC_ARRAY_SIZE <= 256
+typedef uint8_t RadioLibDirectIndex_t;
+#else
+typedef size_t RadioLibDirectIndex_t;
+#endif
+#endif
+
 /*!
   \class PhysicalLayer
 
@@ -217,6 +226,15 @@ class PhysicalLayer {
     */
     virtual int16_t transmitDirect(uint32_t frf = 0);
 
+    /*!
+      \brief Change frequency of an ongoing direct mode transmission, using as few SPI transfers as possible.
+      Intended for protocols that shift frequency at symbol rate. Can only be called after transmitDirect.
+      Modules that do not implement a faster method fall back to transmitDirect.
+      \param frf 24-bit raw frequency value to transmit at.
+      \returns \ref status_codes
+    */
+    virtual int16_t setDirectFrequency(uint32_t frf);
+
     /*!
       \brief Enables direct reception mode on pins DIO1 (clock) and DIO2 (data). Must be implemented in module class.
       While in direct mode, the module will not be able to transmit or receive packets. Can only be activated in FSK mode.
@@ -445,8 +463,16 @@ class PhysicalLayer {
 
     /*!
       \brief Forcefully drop synchronization.
+      \param discard Also discard the received bytes that were not read yet, e.g. when they can no longer be aligned
+      to the protocol framing. Defaults to false.
     */
-    void dropSync();
+    void dropSync(bool discard = false);
+
+    /*!
+      \brief Get the number of bytes that were dropped because the direct mode buffer was full.
+      \returns Number of dropped bytes since the module was created.
+    */
+    uint32_t getDirectOverflows();
 
     /*!
       \brief Get data from direct mode buffer.
@@ -529,15 +555,22 @@ class PhysicalLayer {
     size_t maxPacketLength;
 
     #if !RADIOLIB_EXCLUDE_DIRECT_RECEIVE
-    uint8_t bufferBitPos = 0;
-    uint8_t bufferWritePos = 0;
-    uint8_t bufferReadPos = 0;
+    // single-producer single-consumer ring buffer - head is only written by updateDirectBuffer (interrupt context),
+    // tail only by read (main context); one slot is always kept free to tell a full buffer from an empty one
+    volatile RadioLibDirectIndex_t bufferHead = 0;
+    volatile RadioLibDirectIndex_t bufferTail = 0;
     uint8_t buffer[RADIOLIB_STATIC_ARRAY_SIZE] = { 0 };
+    volatile uint32_t bufferOverflows = 0;
+
+    // incoming bits are shifted in here until a whole byte is received
+    uint8_t bufferShiftReg = 0;
+    uint8_t bufferBitPos = 0;
+
     uint32_t syncBuffer = 0;
     uint32_t directSyncWord = 0;
     uint8_t directSyncWordLen = 0;
     uint32_t directSyncWordMask = 0;
-    bool gotSync = false;
+    volatile bool gotSync = false;
     #endif
 
     virtual Module* getMod() = 0;
@@ -554,6 +587,7 @@ class PhysicalLayer {
     friend class BellClient;
     friend class FT8Client;
     friend class LoRaWANNode;
+    friend class RadioLibSymbolScheduler;
 };
 
 #endif
@@ -4,7 +4,7 @@
 
 #if !RADIOLIB_EXCLUDE_RTTY
 
-RTTYClient::RTTYClient(PhysicalLayer* phy) {
+RTTYClient::RTTYClient(PhysicalLayer* phy) : scheduler(phy) {
   phyLayer = phy;
   lineFeed = "\r\n";
   #if !RADIOLIB_EXCLUDE_AFSK
@@ -13,7 +13,7 @@ RTTYClient::RTTYClient(PhysicalLayer* phy) {
 }
 
 #if !RADIOLIB_EXCLUDE_AFSK
-RTTYClient::RTTYClient(AFSKClient* audio) {
+RTTYClient::RTTYClient(AFSKClient* audio) : scheduler(audio->phyLayer) {
   phyLayer = audio->phyLayer;
   lineFeed = "\r\n";
   audioClient = audio;
@@ -49,10 +49,14 @@ int16_t RTTYClient::begin(float base, uint32_t shift, uint16_t rate, uint8_t enc
   baseFreq = (base * 1000000.0) / phyLayer->getFreqStep();
 
   // configure for direct mode
+  scheduler.stop();
   return(phyLayer->startDirect());
 }
 
 void RTTYClient::idle() {
+  // (re)start the transmission, the module may have been switched to a different mode since
+  scheduler.flush();
+  scheduler.stop();
   mark();
 }
 
@@ -90,29 +94,31 @@ size_t RTTYClient::write(uint8_t b) {
 }
 
 void RTTYClient::mark() {
-  Module* mod = phyLayer->getMod();
-  RadioLibTime_t start = mod->hal->micros();
   transmitDirect(baseFreq + shiftFreq, baseFreqHz + shiftFreqHz);
-  mod->waitForMicroseconds(start, bitDuration);
 }
 
 void RTTYClient::space() {
-  Module* mod = phyLayer->getMod();
-  RadioLibTime_t start = mod->hal->micros();
   transmitDirect(baseFreq, baseFreqHz);
-  mod->waitForMicroseconds(start, bitDuration);
 }
 
 int16_t RTTYClient::transmitDirect(uint32_t freq, uint32_t freqHz) {
   #if !RADIOLIB_EXCLUDE_AFSK
   if(audioClient != nullptr) {
-    return(audioClient->tone(freqHz));
+    Module* mod = phyLayer->getMod();
+    RadioLibTime_t start = mod->hal->micros();
+    int16_t state = audioClient->tone(freqHz);
+    mod->waitForMicroseconds(start, bitDuration);
+    return(state);
   }
   #endif
-  return(phyLayer->transmitDirect(freq));
+  return(scheduler.push(freq, bitDuration));
 }
 
 int16_t RTTYClient::standby() {
+  // let the queued bits go out first
+  scheduler.flush();
+  scheduler.stop();
+
   // ensure everything is stopped in interrupt timing mode
   Module* mod = phyLayer->getMod();
   mod->waitForMicroseconds(0, 0);
@@ -9,6 +9,7 @@
 #include "../AFSK/AFSK.h"
 #include "../Print/Print.h"
 #include "../Print/ITA2String.h"
+#include "../../utils/SymbolScheduler.h"
 
 /*!
   \class RTTYClient
@@ -49,7 +50,7 @@ class RTTYClient: public RadioLibPrint {
     void idle();
 
     /*!
-      \brief Stops transmitting.
+      \brief Stops transmitting, after all queued bits have been sent.
       \returns \ref status_codes
     */
     int16_t standby();
@@ -74,6 +75,8 @@ class RTTYClient: public RadioLibPrint {
     RadioLibTime_t bitDuration = 0;
     uint8_t stopBitsNum = 0;
 
+    RadioLibSymbolScheduler scheduler;
+
     void mark();
     void space();
 
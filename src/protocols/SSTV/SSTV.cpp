@@ -186,6 +186,16 @@ int16_t SSTVClient::begin(float base, const SSTVMode_t& mode) {
   // calculate 24-bit frequency
   baseFreq = (base * 1000000.0) / phyLayer->getFreqStep();
 
+  // precalculate brightness tones, so that no floating point math is needed while sending lines
+  #if RADIOLIB_SSTV_BRIGHTNESS_TABLE
+  for(uint16_t i = 0; i < 256; i++) {
+    brightnessTable[i] = toneOffset(RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN + ((float)i * 3.1372549));
+  }
+  #else
+  brightnessMin = toneOffset(RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN);
+  brightnessSpan = toneOffset(RADIOLIB_SSTV_TONE_BRIGHTNESS_MAX) - brightnessMin;
+  #endif
+
   // configure for direct mode
   return(phyLayer->startDirect());
 }
@@ -247,61 +257,99 @@ void SSTVClient::sendHeader() {
 }
 
 void SSTVClient::sendLine(const uint32_t* imgLine) {
+  Module* mod = phyLayer->getMod();
+  lineStart = mod->hal->micros();
+  lineLen = 0;
+
   // check first line flag in Scottie modes
   if(firstLine && ((txMode.visCode == RADIOLIB_SSTV_SCOTTIE_1) || (txMode.visCode == RADIOLIB_SSTV_SCOTTIE_2) || (txMode.visCode == RADIOLIB_SSTV_SCOTTIE_DX))) {
     firstLine = false;
 
     // send start sync tone
-    this->tone(RADIOLIB_SSTV_TONE_BREAK, 9000);
+    this->lineTone(toneOffset(RADIOLIB_SSTV_TONE_BREAK), 9000);
   }
 
   // send all tones in sequence
   for(uint8_t i = 0; i < txMode.numTones; i++) {
     if((txMode.tones[i].type == tone_t::GENERIC) && (txMode.tones[i].len > 0)) {
       // sync/porch tones
-      this->tone(txMode.tones[i].freq, txMode.tones[i].len);
+      this->lineTone(toneOffset(txMode.tones[i].freq), txMode.tones[i].len);
     } else {
       // scan lines
+      uint8_t shift = 0;
+      switch(txMode.tones[i].type) {
+        case(tone_t::SCAN_RED):
+          shift = 16;
+          break;
+        case(tone_t::SCAN_GREEN):
+          shift = 8;
+          break;
+        case(tone_t::SCAN_BLUE):
+        case(tone_t::GENERIC):
+          break;
+      }
       for(uint16_t j = 0; j < txMode.width; j++) {
-        uint32_t color = imgLine[j];
-        switch(txMode.tones[i].type) {
-          case(tone_t::SCAN_RED):
-            color &= 0x00FF0000;
-            color >>= 16;
-            break;
-          case(tone_t::SCAN_GREEN):
-            color &= 0x0000FF00;
-            color >>= 8;
-            break;
-          case(tone_t::SCAN_BLUE):
-            color &= 0x000000FF;
-            break;
-          case(tone_t::GENERIC):
-            break;
-        }
-        this->tone(RADIOLIB_SSTV_TONE_BRIGHTNESS_MIN + ((float)color * 3.1372549), txMode.scanPixelLen);
+        this->lineTone(brightnessOffset((imgLine[j] >> shift) & 0xFF), txMode.scanPixelLen);
       }
     }
   }
+
+  lineError = (int32_t)(mod->hal->micros() - lineStart) - (int32_t)lineLen;
 }
 
 uint16_t SSTVClient::getPictureHeight() const {
   return(txMode.height);
 }
 
+int32_t SSTVClient::getLineTimingError() const {
+  return(lineError);
+}
+
 void SSTVClient::tone(float freq, RadioLibTime_t len) {
   Module* mod = phyLayer->getMod();
   RadioLibTime_t start = mod->hal->micros();
+  this->setTone(toneOffset(freq));
+  mod->waitForMicroseconds(start, len);
+}
+
+uint16_t SSTVClient::toneOffset(float freq) {
   #if !RADIOLIB_EXCLUDE_AFSK
   if(audioClient != nullptr) {
-    audioClient->tone(freq, false);
-  } else {
-    phyLayer->transmitDirect(baseFreq + (freq / phyLayer->getFreqStep()));
+    return(freq);
   }
+  #endif
+  return(freq / phyLayer->getFreqStep());
+}
+
+uint16_t SSTVClient::brightnessOffset(uint8_t value) {
+  #if RADIOLIB_SSTV_BRIGHTNESS_TABLE
+  return(brightnessTable[value]);
   #else
-  phyLayer->transmitDirect(baseFreq + (freq / phyLayer->getFreqStep()));
+  // brightness tones are evenly spaced, so integer interpolation is enough
+  return(brightnessMin + (uint16_t)(((uint32_t)brightnessSpan * value + 127) / 255));
+  #endif
+}
+
+void SSTVClient::setTone(uint16_t offset) {
+  #if !RADIOLIB_EXCLUDE_AFSK
+  if(audioClient != nullptr) {
+    audioClient->tone(offset, false);
+    return;
+  }
+  #endif
+  phyLayer->setDirectFrequency(baseFreq + offset);
+}
+
+void SSTVClient::lineTone(uint16_t offset, RadioLibTime_t len) {
+  this->setTone(offset);
+  lineLen += len;
+  #if RADIOLIB_INTERRUPT_TIMING
+  // the timer interrupt can only measure length of each tone
+  phyLayer->getMod()->waitForMicroseconds(0, len);
+  #else
+  // wait until the end of this tone relative to line start, so that delays do not accumulate
+  phyLayer->getMod()->waitForMicroseconds(lineStart, lineLen);
   #endif
-  mod->waitForMicroseconds(start, len);
 }
 
 #endif
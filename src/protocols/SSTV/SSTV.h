@@ -182,6 +182,13 @@ class SSTVClient {
     */
     uint16_t getPictureHeight() const;
 
+    /*!
+      \brief Get timing error of the last line sent by sendLine. Tones within a line are timed
+      from the start of the line, so a positive value means the last tone of the line ended late.
+      \returns Difference between the actual and nominal line length in us.
+    */
+    int32_t getLineTimingError() const;
+
 #if !RADIOLIB_GODMODE
   private:
 #endif
@@ -194,7 +201,24 @@ class SSTVClient {
     SSTVMode_t txMode = Scottie1;
     bool firstLine = true;
 
+    // brightness tone offsets from baseFreq, in raw frequency units (or Hz in AFSK mode)
+    #if RADIOLIB_SSTV_BRIGHTNESS_TABLE
+    uint16_t brightnessTable[256] = { 0 };
+    #else
+    uint16_t brightnessMin = 0;
+    uint16_t brightnessSpan = 0;
+    #endif
+
+    // timing of the line currently being sent
+    RadioLibTime_t lineStart = 0;
+    RadioLibTime_t lineLen = 0;
+    int32_t lineError = 0;
+
     void tone(float freq, RadioLibTime_t len = 0);
+    uint16_t toneOffset(float freq);
+    uint16_t brightnessOffset(uint8_t value);
+    void setTone(uint16_t offset);
+    void lineTone(uint16_t offset, RadioLibTime_t len);
 };
 
 #endif
@@ -1,29 +1,72 @@
 #include "CRC.h"
 
+#if RADIOLIB_CRC_TABLE_SLICES
+#if (RADIOLIB_CRC_TABLE_SLICES != 1) && (RADIOLIB_CRC_TABLE_SLICES != 4) && (RADIOLIB_CRC_TABLE_SLICES != 8)
+  #error "Unsupported RADIOLIB_CRC_TABLE_SLICES, only 0, 1, 4 or 8 are allowed"
+#endif
+
+// all calculations are done with the CRC value aligned to the most significant bit
+#define RADIOLIB_CRC_TABLE_POLY_ALIGNED   ((uint32_t)(RADIOLIB_CRC_TABLE_POLY) << (32 - (RADIOLIB_CRC_TABLE_SIZE)))
+
+// shift the CRC by a number of zero bits, used to generate the tables at compile time
+static constexpr uint32_t RadioLibCRCShift(uint32_t crc, uint8_t bits) {
+  return((bits == 0) ? crc : RadioLibCRCShift((crc & 0x80000000UL) ? ((crc << 1) ^ RADIOLIB_CRC_TABLE_POLY_ALIGNED) : (crc << 1), bits - 1));
+}
+
+// entry i of table k is the CRC of byte i followed by k zero bytes
+#define RADIOLIB_CRC_ENTRY(k, i)    RadioLibCRCShift((uint32_t)(i) << 24, 8*((k) + 1))
+#define RADIOLIB_CRC_ROW_4(k, i)    RADIOLIB_CRC_ENTRY(k, i), RADIOLIB_CRC_ENTRY(k, i + 1), RADIOLIB_CRC_ENTRY(k, i + 2), RADIOLIB_CRC_ENTRY(k, i + 3)
+#define RADIOLIB_CRC_ROW_16(k, i)   RADIOLIB_CRC_ROW_4(k, i), RADIOLIB_CRC_ROW_4(k, i + 4), RADIOLIB_CRC_ROW_4(k, i + 8), RADIOLIB_CRC_ROW_4(k, i + 12)
+#define RADIOLIB_CRC_ROW_64(k, i)   RADIOLIB_CRC_ROW_16(k, i), RADIOLIB_CRC_ROW_16(k, i + 16), RADIOLIB_CRC_ROW_16(k, i + 32), RADIOLIB_CRC_ROW_16(k, i + 48)
+#define RADIOLIB_CRC_TABLE(k)       { RADIOLIB_CRC_ROW_64(k, 0), RADIOLIB_CRC_ROW_64(k, 64), RADIOLIB_CRC_ROW_64(k, 128), RADIOLIB_CRC_ROW_64(k, 192) }
+
+static const uint32_t RadioLibCRCTable[RADIOLIB_CRC_TABLE_SLICES][256] RADIOLIB_NONVOLATILE = {
+  RADIOLIB_CRC_TABLE(0),
+#if RADIOLIB_CRC_TABLE_SLICES >= 4
+  RADIOLIB_CRC_TABLE(1), RADIOLIB_CRC_TABLE(2), RADIOLIB_CRC_TABLE(3),
+#endif
+#if RADIOLIB_CRC_TABLE_SLICES >= 8
+  RADIOLIB_CRC_TABLE(4), RADIOLIB_CRC_TABLE(5), RADIOLIB_CRC_TABLE(6), RADIOLIB_CRC_TABLE(7),
+#endif
+};
+
+#define RADIOLIB_CRC_LOOKUP(k, i)   RADIOLIB_NONVOLATILE_READ_DWORD(&RadioLibCRCTable[k][i])
+#endif
+
+static inline uint8_t RadioLibCRCReflectByte(uint8_t b) {
+  b = ((b & 0xF0) >> 4) | ((b & 0x0F) << 4);
+  b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+  b = ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+  return(b);
+}
+
 RadioLibCRC::RadioLibCRC() {
 
 }
 
 uint32_t RadioLibCRC::checksum(const uint8_t* buff, size_t len) {
-  uint32_t crc = this->init;
-  size_t pos = 0;
-  for(size_t i = 0; i < 8*len; i++) {
-    if(i % 8 == 0) {
-      uint32_t in = buff[pos++];
-      if(this->refIn) {
-        in = Module::reflect(in, 8);
-      }
-      crc ^= (in << (this->size - 8));
-    }
+  this->start();
+  this->update(buff, len);
+  return(this->finish());
+}
 
-    if(crc & ((uint32_t)1 << (this->size - 1))) {
-      crc <<= (uint32_t)1;
-      crc ^= this->poly;
-    } else {
-      crc <<= (uint32_t)1;
-    }
+void RadioLibCRC::start() {
+  this->value = this->init << (32 - this->size);
+}
+
+void RadioLibCRC::update(const uint8_t* buff, size_t len) {
+  #if RADIOLIB_CRC_TABLE_SLICES
+  if((this->size == RADIOLIB_CRC_TABLE_SIZE) && (this->poly == RADIOLIB_CRC_TABLE_POLY)) {
+    this->updateTable(buff, len);
+    return;
   }
+  #endif
 
+  this->updateBitwise(buff, len);
+}
+
+uint32_t RadioLibCRC::finish() {
+  uint32_t crc = this->value >> (32 - this->size);
   crc ^= this->out;
   if(this->refOut) {
     crc = Module::reflect(crc, this->size);
@@ -32,4 +75,56 @@ uint32_t RadioLibCRC::checksum(const uint8_t* buff, size_t len) {
   return(crc);
 }
 
+void RadioLibCRC::updateBitwise(const uint8_t* buff, size_t len) {
+  uint32_t crc = this->value;
+  uint32_t polyAligned = this->poly << (32 - this->size);
+  for(size_t i = 0; i < len; i++) {
+    uint32_t in = this->refIn ? RadioLibCRCReflectByte(buff[i]) : buff[i];
+    crc ^= (in << 24);
+    for(uint8_t j = 0; j < 8; j++) {
+      if(crc & 0x80000000UL) {
+        crc = (crc << 1) ^ polyAligned;
+      } else {
+        crc <<= 1;
+      }
+    }
+  }
+  this->value = crc;
+}
+
+#if RADIOLIB_CRC_TABLE_SLICES
+void RadioLibCRC::updateTable(const uint8_t* buff, size_t len) {
+  uint32_t crc = this->value;
+  size_t pos = 0;
+
+  #if RADIOLIB_CRC_TABLE_SLICES >= 4
+  // process RADIOLIB_CRC_TABLE_SLICES bytes per iteration
+  uint8_t in[RADIOLIB_CRC_TABLE_SLICES];
+  while(len - pos >= RADIOLIB_CRC_TABLE_SLICES) {
+    for(uint8_t i = 0; i < RADIOLIB_CRC_TABLE_SLICES; i++) {
+      in[i] = this->refIn ? RadioLibCRCReflectByte(buff[pos + i]) : buff[pos + i];
+    }
+    crc ^= ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | (uint32_t)in[3];
+    crc = RADIOLIB_CRC_LOOKUP(RADIOLIB_CRC_TABLE_SLICES - 1, crc >> 24) ^
+          RADIOLIB_CRC_LOOKUP(RADIOLIB_CRC_TABLE_SLICES - 2, (crc >> 16) & 0xFF) ^
+          RADIOLIB_CRC_LOOKUP(RADIOLIB_CRC_TABLE_SLICES - 3, (crc >> 8) & 0xFF) ^
+          RADIOLIB_CRC_LOOKUP(RADIOLIB_CRC_TABLE_SLICES - 4, crc & 0xFF);
+    #if RADIOLIB_CRC_TABLE_SLICES >= 8
+    crc ^= RADIOLIB_CRC_LOOKUP(3, in[4]) ^ RADIOLIB_CRC_LOOKUP(2, in[5]) ^
+           RADIOLIB_CRC_LOOKUP(1, in[6]) ^ RADIOLIB_CRC_LOOKUP(0, in[7]);
+    #endif
+    pos += RADIOLIB_CRC_TABLE_SLICES;
+  }
+  #endif
+
+  // process the remaining bytes one at a time
+  for(; pos < len; pos++) {
+    uint8_t in = this->refIn ? RadioLibCRCReflectByte(buff[pos]) : buff[pos];
+    crc = (crc << 8) ^ RADIOLIB_CRC_LOOKUP(0, (crc >> 24) ^ in);
+  }
+
+  this->value = crc;
+}
+#endif
+
 RadioLibCRC RadioLibCRCInstance;
@@ -60,6 +60,37 @@ class RadioLibCRC {
       \returns The resulting checksum.
     */
     uint32_t checksum(const uint8_t* buff, size_t len);
+
+    /*!
+      \brief Start incremental checksum calculation. CRC properties must not be changed
+      until the calculation is finished.
+    */
+    void start();
+
+    /*!
+      \brief Add data to an incremental checksum calculation started by start().
+      Can be called any number of times, e.g. for each received chunk of a frame.
+      \param buff Buffer to add to the checksum.
+      \param len Size of the buffer in bytes.
+    */
+    void update(const uint8_t* buff, size_t len);
+
+    /*!
+      \brief Finish incremental checksum calculation.
+      \returns The resulting checksum.
+    */
+    uint32_t finish();
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    // intermediate CRC value, aligned to the most significant bit
+    uint32_t value = 0;
+
+    void updateBitwise(const uint8_t* buff, size_t len);
+#if RADIOLIB_CRC_TABLE_SLICES
+    void updateTable(const uint8_t* buff, size_t len);
+#endif
 };
 
 // the global singleton
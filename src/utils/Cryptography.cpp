@@ -1,6 +1,33 @@
 #include "Cryptography.h"
 
 #include <string.h>
+#if RADIOLIB_AES_NI_AVAILABLE
+#include <wmmintrin.h>
+#endif
+
+// multiplication by x in GF(2^8)
+static constexpr uint8_t aesXtime(uint8_t x) {
+  return((uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00)));
+}
+
+#if RADIOLIB_AES_TTABLES
+// T-table entry combines SubBytes and MixColumns for a byte in the first row of a column,
+// other rows are obtained by rotating the entry; first row is in the least significant byte
+static constexpr uint32_t aesTableEntry(uint8_t s) {
+  return((uint32_t)aesXtime(s) | ((uint32_t)s << 8) | ((uint32_t)s << 16) | ((uint32_t)(aesXtime(s) ^ s) << 24));
+}
+
+#define RADIOLIB_AES_TE_ROW_4(i)    aesTableEntry(aesSbox[i]), aesTableEntry(aesSbox[i + 1]), aesTableEntry(aesSbox[i + 2]), aesTableEntry(aesSbox[i + 3])
+#define RADIOLIB_AES_TE_ROW_16(i)   RADIOLIB_AES_TE_ROW_4(i), RADIOLIB_AES_TE_ROW_4(i + 4), RADIOLIB_AES_TE_ROW_4(i + 8), RADIOLIB_AES_TE_ROW_4(i + 12)
+#define RADIOLIB_AES_TE_ROW_64(i)   RADIOLIB_AES_TE_ROW_16(i), RADIOLIB_AES_TE_ROW_16(i + 16), RADIOLIB_AES_TE_ROW_16(i + 32), RADIOLIB_AES_TE_ROW_16(i + 48)
+
+static const uint32_t aesTe[256] RADIOLIB_NONVOLATILE = {
+  RADIOLIB_AES_TE_ROW_64(0), RADIOLIB_AES_TE_ROW_64(64), RADIOLIB_AES_TE_ROW_64(128), RADIOLIB_AES_TE_ROW_64(192)
+};
+
+#define RADIOLIB_AES_TE(i)          RADIOLIB_NONVOLATILE_READ_DWORD(&aesTe[i])
+#define RADIOLIB_AES_ROTL(x, n)     (((x) << (n)) | ((x) >> (32 - (n))))
+#endif
 
 RadioLibAES128::RadioLibAES128() {
 
@@ -8,7 +35,28 @@ RadioLibAES128::RadioLibAES128() {
 
 void RadioLibAES128::init(uint8_t* key) {
   this->keyPtr = key;
+
+  // the first round key is the key itself, so there is nothing to do when re-keying with the same key
+  if(this->keyCached && (memcmp(this->roundKey, key, RADIOLIB_AES128_KEY_SIZE) == 0)) {
+    return;
+  }
+
   this->keyExpansion(this->roundKey, key);
+  this->keyCached = true;
+  this->cmacSubkeysCached = false;
+
+  #if RADIOLIB_AES_TTABLES
+  for(size_t i = 0; i < RADIOLIB_AES128_N_B * (RADIOLIB_AES128_N_R + 1); i++) {
+    const uint8_t* w = &this->roundKey[4*i];
+    this->roundKeyWords[i] = (uint32_t)w[0] | ((uint32_t)w[1] << 8) | ((uint32_t)w[2] << 16) | ((uint32_t)w[3] << 24);
+  }
+  #endif
+
+  #if RADIOLIB_AES_NI_AVAILABLE
+  if(RadioLibAES128::hasAesNi()) {
+    this->keyExpansionNi();
+  }
+  #endif
 }
 
 size_t RadioLibAES128::encryptECB(uint8_t* in, size_t len, uint8_t* out) {
@@ -44,42 +92,54 @@ size_t RadioLibAES128::decryptECB(uint8_t* in, size_t len, uint8_t* out) {
 }
 
 void RadioLibAES128::generateCMAC(uint8_t* in, size_t len, uint8_t* cmac) {
-  uint8_t key1[RADIOLIB_AES128_BLOCK_SIZE];
-  uint8_t key2[RADIOLIB_AES128_BLOCK_SIZE];
-  this->generateSubkeys(key1, key2);
+  this->initCMAC();
+  this->updateCMAC(in, len);
+  this->finalCMAC(cmac);
+}
 
-  size_t num_blocks = len / RADIOLIB_AES128_BLOCK_SIZE;
-  bool flag = true;
-  if(len % RADIOLIB_AES128_BLOCK_SIZE) {
-    num_blocks++;
-    flag = false;
-  }
+void RadioLibAES128::initCMAC() {
+  memset(this->cmacX, 0x00, RADIOLIB_AES128_BLOCK_SIZE);
+  this->cmacBuffLen = 0;
+}
 
-  uint8_t* buff = new uint8_t[num_blocks * RADIOLIB_AES128_BLOCK_SIZE];
-  memset(buff, 0, num_blocks * RADIOLIB_AES128_BLOCK_SIZE);
-  memcpy(buff, in, len);
-  if (flag) {
-    this->blockXor(&buff[(num_blocks - 1)*RADIOLIB_AES128_BLOCK_SIZE], &buff[(num_blocks - 1)*RADIOLIB_AES128_BLOCK_SIZE], key1);
-  } else {
-    buff[len] = 0x80;
-    this->blockXor(&buff[(num_blocks - 1)*RADIOLIB_AES128_BLOCK_SIZE], &buff[(num_blocks - 1)*RADIOLIB_AES128_BLOCK_SIZE], key2);
+void RadioLibAES128::updateCMAC(const uint8_t* in, size_t len) {
+  while(len > 0) {
+    // the buffered block is only processed once we know it is not the last one
+    if(this->cmacBuffLen == RADIOLIB_AES128_BLOCK_SIZE) {
+      this->blockXor(this->cmacX, this->cmacBuff, this->cmacX);
+      this->cipher((state_t*)this->cmacX, this->roundKey);
+      this->cmacBuffLen = 0;
+    }
+
+    size_t num = RADIOLIB_AES128_BLOCK_SIZE - this->cmacBuffLen;
+    if(num > len) {
+      num = len;
+    }
+    memcpy(&this->cmacBuff[this->cmacBuffLen], in, num);
+    this->cmacBuffLen += num;
+    in += num;
+    len -= num;
   }
+}
 
-  uint8_t X[] = {
-    0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00
-  };
-  uint8_t Y[RADIOLIB_AES128_BLOCK_SIZE];
+void RadioLibAES128::finalCMAC(uint8_t* cmac) {
+  if(!this->cmacSubkeysCached) {
+    this->generateSubkeys(this->cmacKey1, this->cmacKey2);
+    this->cmacSubkeysCached = true;
+  }
 
-  for(size_t i = 0; i < num_blocks - 1; i++) {
-    this->blockXor(Y, &buff[i*RADIOLIB_AES128_BLOCK_SIZE], X);
-    this->encryptECB(Y, RADIOLIB_AES128_BLOCK_SIZE, X);
+  // complete last block is XORed with the first subkey, incomplete one is padded and XORed with the second subkey
+  if(this->cmacBuffLen == RADIOLIB_AES128_BLOCK_SIZE) {
+    this->blockXor(this->cmacBuff, this->cmacBuff, this->cmacKey1);
+  } else {
+    memset(&this->cmacBuff[this->cmacBuffLen], 0x00, RADIOLIB_AES128_BLOCK_SIZE - this->cmacBuffLen);
+    this->cmacBuff[this->cmacBuffLen] = 0x80;
+    this->blockXor(this->cmacBuff, this->cmacBuff, this->cmacKey2);
   }
-  this->blockXor(Y, &buff[(num_blocks - 1)*RADIOLIB_AES128_BLOCK_SIZE], X);
-  this->encryptECB(Y, RADIOLIB_AES128_BLOCK_SIZE, cmac);
-  delete[] buff;
+
+  this->blockXor(cmac, this->cmacBuff, this->cmacX);
+  this->cipher((state_t*)cmac, this->roundKey);
+  this->cmacBuffLen = 0;
 }
 
 bool RadioLibAES128::verifyCMAC(uint8_t* in, size_t len, const uint8_t* cmac) {
@@ -125,6 +185,17 @@ void RadioLibAES128::keyExpansion(uint8_t* roundKey, const uint8_t* key) {
 }
 
 void RadioLibAES128::cipher(state_t* state, uint8_t* roundKey) {
+  #if RADIOLIB_AES_NI_AVAILABLE
+  if(RadioLibAES128::hasAesNi()) {
+    this->cipherNi((uint8_t*)state);
+    return;
+  }
+  #endif
+
+  #if RADIOLIB_AES_TTABLES
+  (void)roundKey;
+  this->cipherTables((uint8_t*)state);
+  #else
   this->addRoundKey(0, state, roundKey);
   for(uint8_t round = 1; round < RADIOLIB_AES128_N_R; round++) {
     this->subBytes(state, aesSbox);
@@ -136,10 +207,17 @@ void RadioLibAES128::cipher(state_t* state, uint8_t* roundKey) {
   this->subBytes(state, aesSbox);
   this->shiftRows(state, false);
   this->addRoundKey(RADIOLIB_AES128_N_R, state, roundKey);
+  #endif
 }
 
-
 void RadioLibAES128::decipher(state_t* state, uint8_t* roundKey) {
+  #if RADIOLIB_AES_NI_AVAILABLE
+  if(RadioLibAES128::hasAesNi()) {
+    this->decipherNi((uint8_t*)state);
+    return;
+  }
+  #endif
+
   this->addRoundKey(RADIOLIB_AES128_N_R, state, roundKey);
   for(uint8_t round = RADIOLIB_AES128_N_R - 1; round > 0; --round) {
     this->shiftRows(state, true);
@@ -153,6 +231,83 @@ void RadioLibAES128::decipher(state_t* state, uint8_t* roundKey) {
   this->addRoundKey(0, state, roundKey);
 }
 
+#if RADIOLIB_AES_TTABLES
+void RadioLibAES128::cipherTables(uint8_t* block) {
+  const uint32_t* rk = this->roundKeyWords;
+  uint32_t s[4];
+  uint32_t t[4];
+  for(size_t c = 0; c < 4; c++) {
+    const uint8_t* w = &block[4*c];
+    s[c] = ((uint32_t)w[0] | ((uint32_t)w[1] << 8) | ((uint32_t)w[2] << 16) | ((uint32_t)w[3] << 24)) ^ rk[c];
+  }
+
+  // row r of each output column is taken from column (c + r) of the input, as per ShiftRows
+  for(uint8_t round = 1; round < RADIOLIB_AES128_N_R; round++) {
+    rk += RADIOLIB_AES128_N_B;
+    for(size_t c = 0; c < 4; c++) {
+      uint32_t t1 = RADIOLIB_AES_TE((s[(c + 1) % 4] >> 8) & 0xFF);
+      uint32_t t2 = RADIOLIB_AES_TE((s[(c + 2) % 4] >> 16) & 0xFF);
+      uint32_t t3 = RADIOLIB_AES_TE(s[(c + 3) % 4] >> 24);
+      t[c] = RADIOLIB_AES_TE(s[c] & 0xFF) ^ RADIOLIB_AES_ROTL(t1, 8) ^ RADIOLIB_AES_ROTL(t2, 16) ^ RADIOLIB_AES_ROTL(t3, 24) ^ rk[c];
+    }
+    memcpy(s, t, sizeof(s));
+  }
+
+  // the last round has no MixColumns
+  rk += RADIOLIB_AES128_N_B;
+  for(size_t c = 0; c < 4; c++) {
+    for(size_t r = 0; r < 4; r++) {
+      uint8_t b = (s[(c + r) % 4] >> (8*r)) & 0xFF;
+      block[4*c + r] = RADIOLIB_NONVOLATILE_READ_BYTE(&aesSbox[b]) ^ ((rk[c] >> (8*r)) & 0xFF);
+    }
+  }
+}
+#endif
+
+#if RADIOLIB_AES_NI_AVAILABLE
+bool RadioLibAES128::hasAesNi() {
+  static int8_t supported = -1;
+  if(supported < 0) {
+    __builtin_cpu_init();
+    supported = __builtin_cpu_supports("aes") ? 1 : 0;
+  }
+  return(supported == 1);
+}
+
+__attribute__((target("aes,sse2")))
+void RadioLibAES128::keyExpansionNi() {
+  // AESDEC uses the round keys in reverse order, with InvMixColumns applied to all but the first and last one
+  memcpy(this->roundKeyDec, &this->roundKey[RADIOLIB_AES128_N_R*RADIOLIB_AES128_BLOCK_SIZE], RADIOLIB_AES128_BLOCK_SIZE);
+  for(uint8_t i = 1; i < RADIOLIB_AES128_N_R; i++) {
+    __m128i k = _mm_loadu_si128((const __m128i*)&this->roundKey[(RADIOLIB_AES128_N_R - i)*RADIOLIB_AES128_BLOCK_SIZE]);
+    _mm_storeu_si128((__m128i*)&this->roundKeyDec[i*RADIOLIB_AES128_BLOCK_SIZE], _mm_aesimc_si128(k));
+  }
+  memcpy(&this->roundKeyDec[RADIOLIB_AES128_N_R*RADIOLIB_AES128_BLOCK_SIZE], this->roundKey, RADIOLIB_AES128_BLOCK_SIZE);
+}
+
+__attribute__((target("aes,sse2")))
+void RadioLibAES128::cipherNi(uint8_t* block) {
+  const __m128i* rk = (const __m128i*)this->roundKey;
+  __m128i m = _mm_xor_si128(_mm_loadu_si128((const __m128i*)block), _mm_loadu_si128(&rk[0]));
+  for(uint8_t round = 1; round < RADIOLIB_AES128_N_R; round++) {
+    m = _mm_aesenc_si128(m, _mm_loadu_si128(&rk[round]));
+  }
+  m = _mm_aesenclast_si128(m, _mm_loadu_si128(&rk[RADIOLIB_AES128_N_R]));
+  _mm_storeu_si128((__m128i*)block, m);
+}
+
+__attribute__((target("aes,sse2")))
+void RadioLibAES128::decipherNi(uint8_t* block) {
+  const __m128i* rk = (const __m128i*)this->roundKeyDec;
+  __m128i m = _mm_xor_si128(_mm_loadu_si128((const __m128i*)block), _mm_loadu_si128(&rk[0]));
+  for(uint8_t round = 1; round < RADIOLIB_AES128_N_R; round++) {
+    m = _mm_aesdec_si128(m, _mm_loadu_si128(&rk[round]));
+  }
+  m = _mm_aesdeclast_si128(m, _mm_loadu_si128(&rk[RADIOLIB_AES128_N_R]));
+  _mm_storeu_si128((__m128i*)block, m);
+}
+#endif
+
 void RadioLibAES128::subWord(uint8_t* word) {
   for(size_t i = 0; i < 4; i++) {
     word[i] = RADIOLIB_NONVOLATILE_READ_BYTE(&aesSbox[word[i]]);
@@ -243,52 +398,25 @@ void RadioLibAES128::shiftRows(state_t* state, bool inv) {
 }
 
 void RadioLibAES128::mixColumns(state_t* state, bool inv) {
-  uint8_t tmp[4];
-  uint8_t matmul[][4] = {
-    0x02, 0x03, 0x01, 0x01,
-    0x01, 0x02, 0x03, 0x01,
-    0x01, 0x01, 0x02, 0x03,
-    0x03, 0x01, 0x01, 0x02
-  };
-  if(inv) {
-    uint8_t matmul_inv[][4] = {
-      0x0e, 0x0b, 0x0d, 0x09,
-      0x09, 0x0e, 0x0b, 0x0d,
-      0x0d, 0x09, 0x0e, 0x0b,
-      0x0b, 0x0d, 0x09, 0x0e
-    };
-    memcpy(matmul, matmul_inv, sizeof(matmul_inv));
-  }
-
   for(size_t col = 0; col < 4; col++) {
-    for(size_t row = 0; row < 4; row++) {
-      tmp[row] = (*state)[col][row];
-    }
-    for(size_t i = 0; i < 4; i++) {
-      (*state)[col][i] = 0x00;
-      for(size_t j = 0; j < 4; j++) {
-        (*state)[col][i] ^= mul(matmul[i][j], tmp[j]);
-      }
+    uint8_t* c = (*state)[col];
+    if(inv) {
+      // InvMixColumns is MixColumns preceded by this step
+      uint8_t u = aesXtime(aesXtime(c[0] ^ c[2]));
+      uint8_t v = aesXtime(aesXtime(c[1] ^ c[3]));
+      c[0] ^= u;
+      c[1] ^= v;
+      c[2] ^= u;
+      c[3] ^= v;
     }
-  }
-}
 
-uint8_t RadioLibAES128::mul(uint8_t a, uint8_t b) {
-  uint8_t sb[4];
-  uint8_t out = 0;
-  sb[0] = b;
-  for(size_t i = 1; i < 4; i++) {
-    sb[i] = sb[i - 1] << 1;
-    if (sb[i - 1] & 0x80) {
-      sb[i] ^= 0x1b;
-    }
-  }
-  for(size_t i = 0; i < 4; i++) {
-    if(a >> i & 0x01) {
-      out ^= sb[i];
-    }
+    uint8_t t = c[0] ^ c[1] ^ c[2] ^ c[3];
+    uint8_t first = c[0];
+    c[0] ^= t ^ aesXtime(c[0] ^ c[1]);
+    c[1] ^= t ^ aesXtime(c[1] ^ c[2]);
+    c[2] ^= t ^ aesXtime(c[2] ^ c[3]);
+    c[3] ^= t ^ aesXtime(c[3] ^ first);
   }
-  return(out);
 }
 
 RadioLibAES128 RadioLibAES128Instance;
@@ -12,11 +12,18 @@
 #define RADIOLIB_AES128_N_R                                     (10)
 #define RADIOLIB_AES128_KEY_EXP_SIZE                            (176)
 
+// AES-NI can only be used on x86 with GCC-compatible compilers
+#if RADIOLIB_AES_NI && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  #define RADIOLIB_AES_NI_AVAILABLE                             (1)
+#else
+  #define RADIOLIB_AES_NI_AVAILABLE                             (0)
+#endif
+
 // helper type
 typedef uint8_t state_t[4][4];
 
 // AES lookup tables
-static const uint8_t aesSbox[] RADIOLIB_NONVOLATILE = {
+static constexpr uint8_t aesSbox[] RADIOLIB_NONVOLATILE = {
     0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5,
     0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
     0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
@@ -102,7 +109,8 @@ class RadioLibAES128 {
     RadioLibAES128();
 
     /*!
-      \brief Initialize the AES.
+      \brief Initialize the AES. The expanded key is cached,
+      so calling this repeatedly with the same key does not repeat the key expansion.
       \param key AES key to use.
     */
     void init(uint8_t* key);
@@ -135,6 +143,26 @@ class RadioLibAES128 {
     */
     void generateCMAC(uint8_t* in, size_t len, uint8_t* cmac);
 
+    /*!
+      \brief Start incremental calculation of message authentication code according to RFC4493,
+      using the key set by init(). The key must not be changed until the calculation is finished.
+    */
+    void initCMAC();
+
+    /*!
+      \brief Add data to an incremental CMAC calculation started by initCMAC().
+      Can be called any number of times, data is processed block by block as it arrives.
+      \param in Input data.
+      \param len Length of the input data.
+    */
+    void updateCMAC(const uint8_t* in, size_t len);
+
+    /*!
+      \brief Finish incremental CMAC calculation.
+      \param cmac Buffer to save the output MAC into. The buffer must be at least 16 bytes long!
+    */
+    void finalCMAC(uint8_t* cmac);
+
     /*!
       \brief Verify the received CMAC. This just calculates the CMAC again and compares the results.
       \param in Input data (unpadded).
@@ -146,11 +174,37 @@ class RadioLibAES128 {
   
   private:
     uint8_t* keyPtr = nullptr;
+    bool keyCached = false;
     uint8_t roundKey[RADIOLIB_AES128_KEY_EXP_SIZE] = { 0 };
+    #if RADIOLIB_AES_TTABLES
+    uint32_t roundKeyWords[RADIOLIB_AES128_N_B * (RADIOLIB_AES128_N_R + 1)] = { 0 };
+    #endif
+    #if RADIOLIB_AES_NI_AVAILABLE
+    uint8_t roundKeyDec[RADIOLIB_AES128_KEY_EXP_SIZE] = { 0 };
+    #endif
+
+    // CMAC subkeys are derived from the key, so they are cached along with it
+    bool cmacSubkeysCached = false;
+    uint8_t cmacKey1[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+    uint8_t cmacKey2[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+
+    // incremental CMAC state, the last block is kept in the buffer until finalCMAC is called
+    uint8_t cmacX[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+    uint8_t cmacBuff[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+    size_t cmacBuffLen = 0;
 
     void keyExpansion(uint8_t* roundKey, const uint8_t* key);
     void cipher(state_t* state, uint8_t* roundKey);
     void decipher(state_t* state, uint8_t* roundKey);
+    #if RADIOLIB_AES_TTABLES
+    void cipherTables(uint8_t* block);
+    #endif
+    #if RADIOLIB_AES_NI_AVAILABLE
+    static bool hasAesNi();
+    void keyExpansionNi();
+    void cipherNi(uint8_t* block);
+    void decipherNi(uint8_t* block);
+    #endif
 
     void subWord(uint8_t* word);
     void rotWord(uint8_t* word);
@@ -164,7 +218,6 @@ class RadioLibAES128 {
     void mixColumns(state_t* state, bool inv);
 
     // cppcheck seems convinced these are nut used, which is not true
-    uint8_t mul(uint8_t a, uint8_t b); // cppcheck-suppress unusedPrivateFunction
     void addRoundKey(uint8_t round, state_t* state, const uint8_t* roundKey); // cppcheck-suppress unusedPrivateFunction
 };
 
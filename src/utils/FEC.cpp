@@ -306,4 +306,75 @@ uint32_t RadioLibBCH::encode(uint32_t dataword) {
 	return(res);
 }
 
+int8_t RadioLibBCH::decode(uint32_t* codeword) {
+  uint32_t cw = *codeword;
+
+  // calculate syndromes S1 = r(alpha) and S3 = r(alpha^3)
+  // bit 0 is parity, so bit i is the coefficient of x^(i - 1)
+  int32_t s1 = 0;
+  int32_t s3 = 0;
+  for(uint8_t i = 0; i < this->n; i++) {
+    if(cw & ((uint32_t)1 << (i + 1))) {
+      s1 ^= this->alphaTo[i];
+      s3 ^= this->alphaTo[(3*i) % this->n];
+    }
+  }
+
+  int8_t numErrors = 0;
+  if((s1 != 0) || (s3 != 0)) {
+    // S1 == 0 with S3 != 0 means more than two errors
+    if(s1 == 0) {
+      return(-1);
+    }
+
+    // S1^3 in index form
+    int32_t s1Cubed = this->alphaTo[(3*this->indexOf[s1]) % this->n];
+    if(s3 == s1Cubed) {
+      // single error at position given directly by S1
+      cw ^= ((uint32_t)1 << (this->indexOf[s1] + 1));
+      numErrors = 1;
+
+    } else {
+      // two errors, error locator polynomial is 1 + S1*x + ((S3 + S1^3)/S1)*x^2
+      int32_t sigma1 = this->indexOf[s1];
+      int32_t sigma2 = (this->indexOf[s3 ^ s1Cubed] - sigma1 + this->n) % this->n;
+
+      // Chien search - error at position i if the locator polynomial has root alpha^-i
+      uint32_t errors = 0;
+      for(uint8_t i = 0; i < this->n; i++) {
+        int32_t inv = (this->n - i) % this->n;
+        int32_t sum = 1 ^ this->alphaTo[(sigma1 + inv) % this->n] ^ this->alphaTo[(sigma2 + 2*inv) % this->n];
+        if(sum == 0) {
+          errors |= ((uint32_t)1 << (i + 1));
+          numErrors++;
+        }
+      }
+
+      // if the locator does not have two distinct roots, there were more errors than we can correct
+      if(numErrors != 2) {
+        return(-1);
+      }
+      cw ^= errors;
+    }
+  }
+
+  // check even parity, wrong parity bit can only be fixed if there is enough error correction left
+  uint32_t parity = cw;
+  parity ^= parity >> 16;
+  parity ^= parity >> 8;
+  parity ^= parity >> 4;
+  parity ^= parity >> 2;
+  parity ^= parity >> 1;
+  if(parity & 0x01) {
+    if(numErrors >= 2) {
+      return(-1);
+    }
+    cw ^= 0x01;
+    numErrors++;
+  }
+
+  *codeword = cw;
+  return(numErrors);
+}
+
 RadioLibBCH RadioLibBCHInstance;
@@ -51,6 +51,16 @@ class RadioLibBCH {
     */
     uint32_t encode(uint32_t dataword);
 
+    /*!
+      \brief Decoding method - corrects up to two bit errors in a code word and checks its even parity bit.
+      Syndromes are evaluated using the Galois field tables, error positions are found by Chien search.
+      Only double error correcting codes (such as BCH(31, 21) used by POCSAG) are supported.
+      \param codeword Pointer to the code word with error check bits and parity bit in the least significant bit.
+      Will be overwritten by the corrected code word.
+      \returns Number of corrected bits (including the parity bit), or -1 if the code word is uncorrectable.
+    */
+    int8_t decode(uint32_t* codeword);
+
   private:
     uint8_t n = 0;
     uint8_t k = 0;
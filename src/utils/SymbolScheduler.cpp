@@ -0,0 +1,160 @@
+#include "SymbolScheduler.h"
+
+RadioLibSymbolScheduler* RadioLibSymbolScheduler::active = nullptr;
+volatile bool RadioLibSymbolScheduler::claimed = false;
+
+RadioLibSymbolScheduler::RadioLibSymbolScheduler(PhysicalLayer* phy) {
+  this->phyLayer = phy;
+}
+
+int16_t RadioLibSymbolScheduler::push(uint32_t frf, RadioLibTime_t len) {
+  Module* mod = this->phyLayer->getMod();
+
+  // without a timer, send the symbol right away and wait for it to end
+  if(!this->timer) {
+    RadioLibTime_t start = mod->hal->micros();
+    int16_t state = this->send(frf);
+    mod->waitForMicroseconds(start, len);
+    return(state);
+  }
+
+  // wait for space in the queue
+  size_t tail = (this->queueTail + 1) % RADIOLIB_SYMBOL_QUEUE_SIZE;
+  while(tail == RADIOLIB_ATOMIC_LOAD(this->queueHead)) {
+    // the callback may have stopped just before the last symbol was queued
+    this->start();
+    mod->hal->yield();
+  }
+  this->queue[this->queueTail].frf = frf;
+  this->queue[this->queueTail].len = len;
+  RADIOLIB_ATOMIC_STORE(this->queueTail, tail);
+
+  // start sending, unless the timer callback is already doing that
+  // the callback checks the queue again after it stops, so one of the two will always see the new symbol
+  RADIOLIB_ATOMIC_FENCE();
+  this->start();
+  return(RADIOLIB_ERR_NONE);
+}
+
+void RadioLibSymbolScheduler::flush() {
+  Module* mod = this->phyLayer->getMod();
+  while(this->isBusy()) {
+    this->start();
+    mod->hal->yield();
+  }
+}
+
+void RadioLibSymbolScheduler::stop() {
+  // wait for the callback to finish, it would otherwise still be using the queue and the timer
+  this->flush();
+  if(active == this) {
+    active = nullptr;
+  }
+  RADIOLIB_ATOMIC_STORE(this->queueHead, 0);
+  RADIOLIB_ATOMIC_STORE(this->queueTail, 0);
+  this->started = false;
+}
+
+bool RadioLibSymbolScheduler::isBusy() const {
+  return(RADIOLIB_ATOMIC_LOAD(this->running) || (RADIOLIB_ATOMIC_LOAD(this->queueHead) != RADIOLIB_ATOMIC_LOAD(this->queueTail)));
+}
+
+void RadioLibSymbolScheduler::timerCb() {
+  if(active != nullptr) {
+    active->next();
+  }
+}
+
+int16_t RadioLibSymbolScheduler::send(uint32_t frf) {
+  if(this->started) {
+    return(this->phyLayer->setDirectFrequency(frf));
+  }
+  this->started = true;
+  return(this->phyLayer->transmitDirect(frf));
+}
+
+void RadioLibSymbolScheduler::start() {
+  // nothing to do if the timer callback is already sending, or there is nothing to send
+  if(RADIOLIB_ATOMIC_LOAD(this->queueHead) == RADIOLIB_ATOMIC_LOAD(this->queueTail)) {
+    return;
+  }
+  if(RADIOLIB_ATOMIC_TEST_AND_SET(this->running)) {
+    return;
+  }
+
+  // the timer callback is not running, so only this context uses the queue now
+  Module* mod = this->phyLayer->getMod();
+  if(RADIOLIB_ATOMIC_TEST_AND_SET(claimed)) {
+    // another scheduler is sending from the timer callback, so send the queued symbols synchronously
+    this->deadline = mod->hal->micros();
+    this->drain();
+    RADIOLIB_ATOMIC_STORE(this->running, false);
+    return;
+  }
+  if(active != this) {
+    mod->hal->timerStop();
+    active = this;
+  }
+  RadioLibTime_t start = mod->hal->micros();
+  this->deadline = start;
+  if(this->next()) {
+    return;
+  }
+
+  // the HAL has no timer, so wait for the symbol that was just sent and transmit the rest synchronously
+  this->timer = false;
+  active = nullptr;
+  RADIOLIB_ATOMIC_STORE(claimed, false);
+  this->drain();
+  RADIOLIB_ATOMIC_STORE(this->running, false);
+}
+
+void RadioLibSymbolScheduler::drain() {
+  Module* mod = this->phyLayer->getMod();
+  RadioLibTime_t now = mod->hal->micros();
+  if((long)(this->deadline - now) > 0) {
+    mod->waitForMicroseconds(now, this->deadline - now);
+  }
+  while(this->queueHead != this->queueTail) {
+    Symbol_t* sym = &this->queue[this->queueHead];
+    RadioLibTime_t start = mod->hal->micros();
+    this->send(sym->frf);
+    mod->waitForMicroseconds(start, sym->len);
+    this->queueHead = (this->queueHead + 1) % RADIOLIB_SYMBOL_QUEUE_SIZE;
+  }
+}
+
+bool RadioLibSymbolScheduler::next() {
+  Module* mod = this->phyLayer->getMod();
+  size_t head = this->queueHead;
+  if(head == RADIOLIB_ATOMIC_LOAD(this->queueTail)) {
+    // stop and hand the timer over to other schedulers, then check the queue again - a symbol queued
+    // just before running was cleared would otherwise not be sent until the next one is queued
+    RADIOLIB_ATOMIC_STORE(claimed, false);
+    RADIOLIB_ATOMIC_STORE(this->running, false);
+    RADIOLIB_ATOMIC_FENCE();
+    if((head == RADIOLIB_ATOMIC_LOAD(this->queueTail)) || RADIOLIB_ATOMIC_TEST_AND_SET(this->running)) {
+      // nothing left, or push already started again, after this the callback no longer touches the queue
+      return(true);
+    }
+    if(RADIOLIB_ATOMIC_TEST_AND_SET(claimed)) {
+      // another scheduler took the timer in the meantime, the next push or flush sends the symbol instead
+      RADIOLIB_ATOMIC_STORE(this->running, false);
+      return(true);
+    }
+    active = this;
+
+    // the new symbol starts now rather than at the end of the previous one
+    this->deadline = mod->hal->micros();
+  }
+
+  // send the symbol and schedule the next one relative to the end of this one
+  Symbol_t* sym = &this->queue[head];
+  this->send(sym->frf);
+  this->deadline += sym->len;
+  RADIOLIB_ATOMIC_STORE(this->queueHead, (head + 1) % RADIOLIB_SYMBOL_QUEUE_SIZE);
+
+  RadioLibTime_t now = mod->hal->micros();
+  RadioLibTime_t delay = ((long)(this->deadline - now) > 0) ? (this->deadline - now) : 0;
+  return(mod->hal->timerStart(delay, RadioLibSymbolScheduler::timerCb) != RADIOLIB_ERR_UNSUPPORTED);
+}
@@ -0,0 +1,89 @@
+#if !defined(_RADIOLIB_SYMBOL_SCHEDULER_H)
+#define _RADIOLIB_SYMBOL_SCHEDULER_H
+
+#include "../TypeDef.h"
+#include "../Module.h"
+#include "../protocols/PhysicalLayer/PhysicalLayer.h"
+
+/*!
+  \class RadioLibSymbolScheduler
+  \brief Paces symbols of direct mode protocols (RTTY, FSK4, Pager etc.), each symbol being a raw frequency
+  transmitted for a given time. When the HAL implements timerStart, symbols are queued and sent
+  from the timer callback, so that the CPU is free during transmission. Otherwise, each symbol
+  is sent immediately and the call blocks for its duration, like RadioLib did before.
+  Only one scheduler can use the HAL timer at a time, others send their symbols synchronously
+  while the timer is in use.
+*/
+class RadioLibSymbolScheduler {
+  public:
+    /*!
+      \brief Default constructor.
+      \param phy Pointer to the wireless module providing PhysicalLayer communication.
+    */
+    explicit RadioLibSymbolScheduler(PhysicalLayer* phy);
+
+    /*!
+      \brief Queue a symbol. The first symbol after stop starts direct mode transmission,
+      subsequent symbols only change the frequency. Blocks while the queue is full.
+      \param frf Raw frequency value of the symbol.
+      \param len Length of the symbol in microseconds.
+      \returns \ref status_codes
+    */
+    int16_t push(uint32_t frf, RadioLibTime_t len);
+
+    /*!
+      \brief Wait until all queued symbols have been transmitted. The module keeps transmitting
+      at the frequency of the last symbol afterwards.
+    */
+    void flush();
+
+    /*!
+      \brief Wait for the queued symbols and the timer callback to finish, then reset the scheduler.
+      The next symbol will start a new transmission. Does not change the module mode, that is up to the caller.
+    */
+    void stop();
+
+    /*!
+      \brief Check whether symbols are still being transmitted from the timer callback.
+      \returns True if there are symbols left to transmit, false otherwise.
+    */
+    bool isBusy() const;
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    struct Symbol_t {
+      uint32_t frf;
+      RadioLibTime_t len;
+    };
+
+    PhysicalLayer* phyLayer;
+
+    // symbols are produced by push and consumed by the timer callback, which may run in a different thread
+    // running is set by whichever side starts sending and cleared only by the consumer
+    Symbol_t queue[RADIOLIB_SYMBOL_QUEUE_SIZE];
+    volatile size_t queueHead = 0;
+    volatile size_t queueTail = 0;
+    volatile bool running = false;
+
+    // whether the transmission was started and only the frequency has to be changed
+    bool started = false;
+
+    // whether the HAL timer can be used, cleared the first time the HAL reports otherwise
+    bool timer = true;
+
+    // end of the symbol currently being transmitted, used to avoid accumulating timer latency
+    RadioLibTime_t deadline = 0;
+
+    // scheduler whose symbols are sent from the timer callback, claimed is set while its callback is running
+    static RadioLibSymbolScheduler* active;
+    static volatile bool claimed;
+    static void timerCb();
+
+    int16_t send(uint32_t frf);
+    void start();
+    void drain();
+    bool next();
+};
+
+#endif
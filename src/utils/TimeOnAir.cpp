@@ -0,0 +1,75 @@
+#include "TimeOnAir.h"
+
+RadioLibTimeOnAir::RadioLibTimeOnAir() {
+  this->type = RADIOLIB_TIME_ON_AIR_NONE;
+}
+
+void RadioLibTimeOnAir::setLoRa(uint8_t sf, float bw, uint8_t cr, uint32_t preambleLength, bool explicitHeader, bool crc, bool ldro, bool longSync) {
+  // see e.g. SX1268 datasheet v1.1 section 6.1.4 and SX1276 datasheet rev. 7 section 4.1.1.7
+  // preamble, 8 symbols of header and 4.25 symbols of sync, or 6.25 for SF5 and SF6 on newer chips
+  bool lowSf = longSync && (sf < 7);
+  this->loraSymbols_x4 = (preambleLength + 8) * 4 + (lowSf ? 25 : 17);
+
+  // numerator of the payload symbol count, without the payload itself
+  this->loraOffset = (crc ? 16 : 0) - 4*(int32_t)sf + (lowSf ? 0 : 8) + (explicitHeader ? 20 : 0);
+  this->loraDivisor = 4*(ldro ? (sf - 2) : sf);
+  this->loraCr = cr;
+
+  // symbol length in us
+  this->symbolLength = (float)((uint32_t)1 << sf) * 1000.0f / bw;
+  this->type = RADIOLIB_TIME_ON_AIR_LORA;
+}
+
+void RadioLibTimeOnAir::setBitRate(float bitLength, uint32_t overheadBits, size_t fixedLen) {
+  this->bitLength = bitLength;
+  this->overheadBits = overheadBits;
+  this->fixedLen = fixedLen;
+  this->type = RADIOLIB_TIME_ON_AIR_BIT_RATE;
+}
+
+void RadioLibTimeOnAir::setLRFHSS(uint8_t hdrCount, uint8_t crNum, uint8_t crDen) {
+  this->hdrCount = hdrCount;
+  this->crNum = crNum;
+  this->crDen = crDen;
+  this->type = RADIOLIB_TIME_ON_AIR_LR_FHSS;
+}
+
+void RadioLibTimeOnAir::invalidate() {
+  this->type = RADIOLIB_TIME_ON_AIR_NONE;
+}
+
+bool RadioLibTimeOnAir::isValid() const {
+  return(this->type != RADIOLIB_TIME_ON_AIR_NONE);
+}
+
+RadioLibTime_t RadioLibTimeOnAir::get(size_t len) const {
+  switch(this->type) {
+    case(RADIOLIB_TIME_ON_AIR_LORA): {
+      // add (divisor - 1) to the numerator to get integer ceil
+      int32_t bits = 8*(int32_t)len + this->loraOffset;
+      uint32_t symbols_x4 = this->loraSymbols_x4;
+      if(bits > 0) {
+        symbols_x4 += 4 * ((bits + this->loraDivisor - 1) / this->loraDivisor) * this->loraCr;
+      }
+      return((RadioLibTime_t)((float)symbols_x4 * this->symbolLength / 4.0f));
+    }
+
+    case(RADIOLIB_TIME_ON_AIR_BIT_RATE): {
+      size_t payloadLen = (this->fixedLen > 0) ? this->fixedLen : len;
+      return((RadioLibTime_t)((float)(this->overheadBits + 8*(uint32_t)payloadLen) * this->bitLength));
+    }
+
+    case(RADIOLIB_TIME_ON_AIR_LR_FHSS): {
+      // payload with CRC and trellis tail, coded and split into blocks with 2 extra bits each
+      uint32_t bits = ((uint32_t)len + 2) * 8 + 6;
+      bits = (bits * this->crDen + this->crNum - 1) / this->crNum;
+      uint32_t payloadBits = (bits / RADIOLIB_TIME_ON_AIR_LR_FHSS_FRAG_BITS) * RADIOLIB_TIME_ON_AIR_LR_FHSS_BLOCK_BITS;
+      if(bits % RADIOLIB_TIME_ON_AIR_LR_FHSS_FRAG_BITS) {
+        payloadBits += (bits % RADIOLIB_TIME_ON_AIR_LR_FHSS_FRAG_BITS) + 2;
+      }
+      return((RadioLibTime_t)(this->hdrCount * RADIOLIB_TIME_ON_AIR_LR_FHSS_HEADER_BITS + payloadBits) * RADIOLIB_TIME_ON_AIR_LR_FHSS_BIT_LEN_US);
+    }
+  }
+
+  return(0);
+}
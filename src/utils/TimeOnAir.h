@@ -0,0 +1,104 @@
+#if !defined(_RADIOLIB_TIME_ON_AIR_H)
+#define _RADIOLIB_TIME_ON_AIR_H
+
+#include "../TypeDef.h"
+
+// modulation types
+#define RADIOLIB_TIME_ON_AIR_NONE                               (0)
+#define RADIOLIB_TIME_ON_AIR_LORA                               (1)
+#define RADIOLIB_TIME_ON_AIR_BIT_RATE                           (2)
+#define RADIOLIB_TIME_ON_AIR_LR_FHSS                            (3)
+
+// LR-FHSS frame structure
+#define RADIOLIB_TIME_ON_AIR_LR_FHSS_HEADER_BITS                (114)
+#define RADIOLIB_TIME_ON_AIR_LR_FHSS_FRAG_BITS                  (48)
+#define RADIOLIB_TIME_ON_AIR_LR_FHSS_BLOCK_BITS                 (50)
+#define RADIOLIB_TIME_ON_AIR_LR_FHSS_BIT_LEN_US                 (2048)    // 488.28125 bps
+
+/*!
+  \class RadioLibTimeOnAir
+  \brief Time-on-air calculator shared by the drivers. Everything that only depends on the modulation
+  is calculated once in one of the set methods, so that get only has to add the payload.
+  Drivers keep an instance, invalidate it whenever modulation or packet parameters change
+  and configure it again on the next getTimeOnAir call.
+*/
+class RadioLibTimeOnAir {
+  public:
+    /*!
+      \brief Default constructor, the calculator is invalid until configured.
+    */
+    RadioLibTimeOnAir();
+
+    /*!
+      \brief Configure for LoRa modulation.
+      \param sf Spreading factor.
+      \param bw Bandwidth in kHz.
+      \param cr Coding rate denominator (5 to 8 for 4/5 to 4/8).
+      \param preambleLength Number of preamble symbols.
+      \param explicitHeader Whether explicit header is used.
+      \param crc Whether payload CRC is enabled.
+      \param ldro Whether low data rate optimization is enabled.
+      \param longSync Whether SF5 and SF6 use the longer sync of SX126x, SX128x and LR11x0.
+      Should be false for SX127x, where all spreading factors use the same sync length.
+    */
+    void setLoRa(uint8_t sf, float bw, uint8_t cr, uint32_t preambleLength, bool explicitHeader, bool crc, bool ldro, bool longSync = true);
+
+    /*!
+      \brief Configure for modulations with constant bit rate, such as FSK or FLRC.
+      \param bitLength Length of a single bit in microseconds, including coding overhead.
+      \param overheadBits Number of bits sent in addition to the payload (preamble, sync word, CRC etc.).
+      \param fixedLen Packet length in fixed length mode, payload length passed to get is ignored in that case.
+      Set to 0 for variable length packets.
+    */
+    void setBitRate(float bitLength, uint32_t overheadBits = 0, size_t fixedLen = 0);
+
+    /*!
+      \brief Configure for LR-FHSS modulation.
+      \param hdrCount Number of header replicas.
+      \param crNum Coding rate numerator (e.g. 1 for coding rate 1/3).
+      \param crDen Coding rate denominator (e.g. 3 for coding rate 1/3).
+    */
+    void setLRFHSS(uint8_t hdrCount, uint8_t crNum, uint8_t crDen);
+
+    /*!
+      \brief Drop the current configuration, called when modulation or packet parameters change.
+    */
+    void invalidate();
+
+    /*!
+      \brief Check whether the calculator is configured.
+      \returns True if configured since the last invalidate, false otherwise.
+    */
+    bool isValid() const;
+
+    /*!
+      \brief Get time-on-air of a packet.
+      \param len Payload length in bytes.
+      \returns Time-on-air in microseconds, or 0 if the calculator is not configured.
+    */
+    RadioLibTime_t get(size_t len) const;
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    uint8_t type;
+
+    // LoRa, number of symbols is kept multiplied by 4 to handle the .25 symbols of sync
+    uint32_t loraSymbols_x4 = 0;
+    int32_t loraOffset = 0;
+    uint8_t loraDivisor = 0;
+    uint8_t loraCr = 0;
+    float symbolLength = 0;
+
+    // bit rate
+    uint32_t overheadBits = 0;
+    size_t fixedLen = 0;
+    float bitLength = 0;
+
+    // LR-FHSS
+    uint8_t hdrCount = 0;
+    uint8_t crNum = 0;
+    uint8_t crDen = 0;
+};
+
+#endif